@@ -0,0 +1,98 @@
+#include <IO/Archive.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Packs the assets in one archive that the engine mounts at startup instead of opening the loose
+// files one by one. Run from the directory of the executable, the files are packed under the paths
+// the engine opens them with. Without arguments the default assets are packed in the default
+// archive, otherwise the first argument is the archive and the others are the files and
+// directories to pack
+
+static constexpr char ARCHIVE_PATH[] = "Assets.cydpak";
+
+static const char* const DEFAULT_SOURCES[] = {
+    "Pipelines.json",
+    "Materials.json",
+    "../Shaders/",
+    "../Engine/Data/Meshes/",
+    "../Engine/Data/Materials/" };
+
+static bool IsPacked( const std::filesystem::path& path )
+{
+   // The engine only reads the mesh file of the OBJ meshes that were converted
+   if( path.extension() == ".obj" )
+   {
+      std::filesystem::path meshPath = path;
+      return !std::filesystem::exists( meshPath.replace_extension( ".cydmesh" ) );
+   }
+
+   return true;
+}
+
+static void AddSource( const std::string& source, std::vector<EMP::ArchiveSource>& sources )
+{
+   if( !std::filesystem::is_directory( source ) )
+   {
+      sources.push_back( { source, source } );
+      return;
+   }
+
+   for( const auto& entry : std::filesystem::recursive_directory_iterator( source ) )
+   {
+      if( entry.is_regular_file() && IsPacked( entry.path() ) )
+      {
+         const std::string path = entry.path().generic_string();
+         sources.push_back( { path, path } );
+      }
+   }
+}
+
+int main( int argc, char** argv )
+{
+   std::string archivePath = ARCHIVE_PATH;
+   std::vector<std::string> sourcePaths(
+       std::begin( DEFAULT_SOURCES ), std::end( DEFAULT_SOURCES ) );
+
+   if( argc > 1 )
+   {
+      archivePath = argv[1];
+      sourcePaths.assign( argv + 2, argv + argc );
+   }
+
+   const auto start = std::chrono::steady_clock::now();
+
+   std::vector<EMP::ArchiveSource> sources;
+   for( const std::string& sourcePath : sourcePaths )
+   {
+      if( !std::filesystem::exists( sourcePath ) )
+      {
+         printf( "Could not find %s\n", sourcePath.c_str() );
+         return 1;
+      }
+
+      AddSource( sourcePath, sources );
+   }
+
+   if( !EMP::WriteArchive( archivePath, sources ) )
+   {
+      printf( "Could not write %s\n", archivePath.c_str() );
+      return 1;
+   }
+
+   const std::chrono::duration<double, std::milli> duration =
+       std::chrono::steady_clock::now() - start;
+
+   printf(
+       "Packed archive --> %s, %zu files, %ju bytes in %.1fms\n",
+       archivePath.c_str(),
+       sources.size(),
+       static_cast<uintmax_t>( std::filesystem::file_size( archivePath ) ),
+       duration.count() );
+
+   return 0;
+}
@@ -0,0 +1,160 @@
+#include <Graph/CSRGraph.h>
+
+#include <cassert>
+
+namespace EMP
+{
+void CSRGraph::reset()
+{
+   m_nodeCount = 0;
+   m_built     = false;
+   m_pendingEdges.clear();
+   m_offsets.clear();
+   m_edges.clear();
+}
+
+void CSRGraph::reserve( uint32_t nodeCount, uint32_t edgeCount )
+{
+   m_offsets.reserve( nodeCount + 1 );
+   m_edges.reserve( edgeCount );
+   m_pendingEdges.reserve( edgeCount );
+}
+
+CSRGraph::NodeHandle CSRGraph::addNode() { return addNodes( 1 ); }
+
+CSRGraph::NodeHandle CSRGraph::addNodes( uint32_t count )
+{
+   assert( m_nodeCount + count < INVALID_NODE && "CSRGraph: Ran out of node handles" );
+
+   const NodeHandle first = m_nodeCount;
+   m_nodeCount += count;
+   m_built = false;
+
+   return first;
+}
+
+void CSRGraph::addEdge( NodeHandle from, NodeHandle to )
+{
+   assert( from < m_nodeCount && to < m_nodeCount && "CSRGraph: Edge refers to an invalid node" );
+
+   m_pendingEdges.push_back( { from, to } );
+   m_built = false;
+}
+
+void CSRGraph::build()
+{
+   if( m_built ) return;
+
+   // Bring the already compacted edges back in the pending list so that everything is sorted
+   // together. Building incrementally is rare, the common case is one build after population
+   if( !m_edges.empty() )
+   {
+      const uint32_t prevNodeCount = static_cast<uint32_t>( m_offsets.size() ) - 1;
+      for( NodeHandle node = 0; node < prevNodeCount; ++node )
+      {
+         for( uint32_t i = m_offsets[node]; i < m_offsets[node + 1]; ++i )
+         {
+            m_pendingEdges.push_back( { node, m_edges[i] } );
+         }
+      }
+   }
+
+   // Counting sort of the edges by source node. This is stable so children stay in the order in
+   // which they were added
+   m_offsets.assign( m_nodeCount + 1, 0 );
+   for( const PendingEdge& edge : m_pendingEdges )
+   {
+      m_offsets[edge.from + 1]++;
+   }
+
+   for( uint32_t i = 0; i < m_nodeCount; ++i )
+   {
+      m_offsets[i + 1] += m_offsets[i];
+   }
+
+   m_edges.resize( m_pendingEdges.size() );
+
+   std::vector<uint32_t> cursors( m_offsets.begin(), m_offsets.end() - 1 );
+   for( const PendingEdge& edge : m_pendingEdges )
+   {
+      m_edges[cursors[edge.from]++] = edge.to;
+   }
+
+   m_pendingEdges.clear();
+   m_built = true;
+}
+
+bool CSRGraph::topologicalSort( std::vector<NodeHandle>& order ) const
+{
+   assert( m_built && "CSRGraph: Graph needs to be built before sorting" );
+
+   std::vector<uint32_t> inDegrees( m_nodeCount, 0 );
+   for( const NodeHandle child : m_edges )
+   {
+      inDegrees[child]++;
+   }
+
+   // The output doubles as the queue of nodes without any remaining incoming edge
+   order.clear();
+   order.reserve( m_nodeCount );
+   for( NodeHandle node = 0; node < m_nodeCount; ++node )
+   {
+      if( inDegrees[node] == 0 ) order.push_back( node );
+   }
+
+   for( size_t head = 0; head < order.size(); ++head )
+   {
+      for( const NodeHandle child : getChildren( order[head] ) )
+      {
+         if( --inDegrees[child] == 0 ) order.push_back( child );
+      }
+   }
+
+   // Nodes that are part of a cycle never reach an in-degree of 0
+   return order.size() == m_nodeCount;
+}
+
+bool CSRGraph::topologicalLevels(
+    std::vector<NodeHandle>& order,
+    std::vector<uint32_t>& levelOffsets ) const
+{
+   assert( m_built && "CSRGraph: Graph needs to be built before sorting" );
+
+   std::vector<uint32_t> inDegrees( m_nodeCount, 0 );
+   for( const NodeHandle child : m_edges )
+   {
+      inDegrees[child]++;
+   }
+
+   order.clear();
+   order.reserve( m_nodeCount );
+   levelOffsets.clear();
+
+   for( NodeHandle node = 0; node < m_nodeCount; ++node )
+   {
+      if( inDegrees[node] == 0 ) order.push_back( node );
+   }
+
+   // Every pass over the current level produces the next one right after it in the output
+   size_t levelBegin = 0;
+   while( levelBegin < order.size() )
+   {
+      const size_t levelEnd = order.size();
+      levelOffsets.push_back( static_cast<uint32_t>( levelBegin ) );
+
+      for( size_t i = levelBegin; i < levelEnd; ++i )
+      {
+         for( const NodeHandle child : getChildren( order[i] ) )
+         {
+            if( --inDegrees[child] == 0 ) order.push_back( child );
+         }
+      }
+
+      levelBegin = levelEnd;
+   }
+
+   levelOffsets.push_back( static_cast<uint32_t>( order.size() ) );
+
+   return order.size() == m_nodeCount;
+}
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <Multithreading/ThreadPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace EMP
+{
+// Directed graph stored in compressed sparse row (CSR) form. Nodes and edges are added freely and
+// then compacted with build(), after which adjacency lookups are a pair of offsets into a single
+// contiguous edge array. There is no limit on the amount of nodes or children per node. Visitors
+// are plain callables taking a NodeHandle, they are inlined instead of going through a vtable.
+class CSRGraph
+{
+  public:
+   using NodeHandle = uint32_t;
+
+   static constexpr NodeHandle INVALID_NODE = std::numeric_limits<NodeHandle>::max();
+
+   CSRGraph()                      = default;
+   CSRGraph( const CSRGraph& )     = delete;
+   CSRGraph( CSRGraph&& ) noexcept = default;
+   CSRGraph& operator=( const CSRGraph& ) = delete;
+   CSRGraph& operator=( CSRGraph&& ) noexcept = default;
+   ~CSRGraph()                                = default;
+
+   // Resets the whole graph
+   void reset();
+
+   // Preallocates memory to avoid growing while the graph is being populated
+   void reserve( uint32_t nodeCount, uint32_t edgeCount );
+
+   NodeHandle addNode();
+   NodeHandle addNodes( uint32_t count );  // Returns the handle of the first node added
+   void addEdge( NodeHandle from, NodeHandle to );
+
+   // Compacts the pending edges into the CSR arrays. Needs to be called after adding nodes/edges
+   // and before any traversal
+   void build();
+   bool isBuilt() const { return m_built; }
+
+   uint32_t getNodeCount() const { return m_nodeCount; }
+   uint32_t getEdgeCount() const { return static_cast<uint32_t>( m_edges.size() ); }
+
+   std::span<const NodeHandle> getChildren( NodeHandle node ) const
+   {
+      return { m_edges.data() + m_offsets[node], m_edges.data() + m_offsets[node + 1] };
+   }
+   uint32_t getChildrenCount( NodeHandle node ) const
+   {
+      return m_offsets[node + 1] - m_offsets[node];
+   }
+
+   // Kahn's algorithm. Returns false if the graph contains a cycle, in which case the order only
+   // contains the nodes that could be sorted
+   bool topologicalSort( std::vector<NodeHandle>& order ) const;
+
+   // Same as above but also groups the nodes by depth (longest path from a source). Nodes inside
+   // the same level do not depend on each other and can be processed in parallel
+   bool topologicalLevels(
+       std::vector<NodeHandle>& order,
+       std::vector<uint32_t>& levelOffsets ) const;
+
+   // Visit/Search functions
+   // ==============================================================================================
+   template <class Visitor>
+   void depthFirstSearch( NodeHandle root, Visitor&& visitor ) const
+   {
+      std::vector<uint8_t> visited( m_nodeCount, 0 );
+      std::vector<NodeHandle> stack;
+      stack.push_back( root );
+
+      while( !stack.empty() )
+      {
+         const NodeHandle node = stack.back();
+         stack.pop_back();
+
+         if( visited[node] ) continue;
+         visited[node] = 1;
+
+         visitor( node );
+
+         // Pushing in reverse so that the children are visited in insertion order
+         const std::span<const NodeHandle> children = getChildren( node );
+         for( auto it = children.rbegin(); it != children.rend(); ++it )
+         {
+            if( !visited[*it] ) stack.push_back( *it );
+         }
+      }
+   }
+
+   template <class Visitor>
+   void breadthFirstSearch( NodeHandle root, Visitor&& visitor ) const
+   {
+      std::vector<uint8_t> visited( m_nodeCount, 0 );
+      std::vector<NodeHandle> queue;
+      queue.reserve( m_nodeCount );
+
+      queue.push_back( root );
+      visited[root] = 1;
+
+      for( size_t head = 0; head < queue.size(); ++head )
+      {
+         const NodeHandle node = queue[head];
+         visitor( node );
+
+         for( const NodeHandle child : getChildren( node ) )
+         {
+            if( !visited[child] )
+            {
+               visited[child] = 1;
+               queue.push_back( child );
+            }
+         }
+      }
+   }
+
+   // Level-synchronous BFS. Every level of the frontier is split in chunks that are visited on the
+   // threadpool and on the calling thread, so it can be called from a worker. The visitor is called
+   // concurrently and must be thread-safe. Nodes of a level are all visited before any node of the
+   // next level
+   template <class Visitor>
+   void parallelBreadthFirstSearch( ThreadPool& threadPool, NodeHandle root, Visitor&& visitor )
+       const
+   {
+      std::vector<std::atomic<uint8_t>> visited( m_nodeCount );
+      visited[root].store( 1, std::memory_order_relaxed );
+
+      std::vector<NodeHandle> frontier = { root };
+      std::vector<std::vector<NodeHandle>> chunkFrontiers;
+
+      while( !frontier.empty() )
+      {
+         const uint32_t frontierSize = static_cast<uint32_t>( frontier.size() );
+         const uint32_t chunkCount =
+             ( frontierSize + PARALLEL_CHUNK_SIZE - 1 ) / PARALLEL_CHUNK_SIZE;
+
+         chunkFrontiers.resize( chunkCount );
+
+         auto visitChunk = [&]( uint32_t chunkIdx )
+         {
+            std::vector<NodeHandle>& next = chunkFrontiers[chunkIdx];
+            next.clear();
+
+            const uint32_t begin = chunkIdx * PARALLEL_CHUNK_SIZE;
+            const uint32_t end   = std::min( begin + PARALLEL_CHUNK_SIZE, frontierSize );
+            for( uint32_t i = begin; i < end; ++i )
+            {
+               const NodeHandle node = frontier[i];
+               visitor( node );
+
+               for( const NodeHandle child : getChildren( node ) )
+               {
+                  // Cheap relaxed read first to avoid hammering the cache line with exchanges
+                  if( visited[child].load( std::memory_order_relaxed ) == 0 &&
+                      visited[child].exchange( 1, std::memory_order_relaxed ) == 0 )
+                  {
+                     next.push_back( child );
+                  }
+               }
+            }
+         };
+
+         // The calling thread visits chunks too, it never waits for a chunk nobody started
+         threadPool.parallelFor( ThreadPool::Lane::NORMAL, chunkCount, visitChunk );
+
+         // Gather the next level
+         frontier.clear();
+         for( uint32_t i = 0; i < chunkCount; ++i )
+         {
+            frontier.insert( frontier.end(), chunkFrontiers[i].begin(), chunkFrontiers[i].end() );
+         }
+      }
+   }
+
+  private:
+   static constexpr uint32_t PARALLEL_CHUNK_SIZE = 1024;
+
+   struct PendingEdge
+   {
+      NodeHandle from;
+      NodeHandle to;
+   };
+
+   uint32_t m_nodeCount = 0;
+   bool m_built         = false;
+
+   std::vector<PendingEdge> m_pendingEdges;  // Edges added since the last build
+   std::vector<uint32_t> m_offsets;          // m_nodeCount + 1 offsets into m_edges
+   std::vector<NodeHandle> m_edges;          // Children of all nodes, contiguous per node
+};
+}
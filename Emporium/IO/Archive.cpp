@@ -0,0 +1,219 @@
+#include <IO/Archive.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+namespace EMP
+{
+static_assert( sizeof( ArchiveHeader ) == 32, "Archive: A new header needs a new version" );
+static_assert( sizeof( ArchiveEntry ) == 40, "Archive: New entries need a new version" );
+static_assert( std::is_trivially_copyable_v<ArchiveHeader> );
+static_assert( std::is_trivially_copyable_v<ArchiveEntry> );
+
+// FNV-1a, names are short
+static uint64_t HashName( std::string_view name )
+{
+   uint64_t hash = 0xCBF29CE484222325ULL;
+   for( const char c : name )
+   {
+      hash ^= static_cast<uint8_t>( c );
+      hash *= 0x100000001B3ULL;
+   }
+
+   return hash;
+}
+
+static uint64_t AlignData( uint64_t offset )
+{
+   return ( offset + Archive::DATA_ALIGNMENT - 1 ) & ~uint64_t( Archive::DATA_ALIGNMENT - 1 );
+}
+
+std::string NormalizeArchiveName( std::string_view path )
+{
+   std::string name( path );
+   std::replace( name.begin(), name.end(), '\\', '/' );
+
+   return std::filesystem::path( name ).lexically_normal().generic_string();
+}
+
+// ================================================================================================
+bool WriteArchive( const std::string& path, const std::vector<ArchiveSource>& sources )
+{
+   std::vector<ArchiveEntry> entries( sources.size() );
+   std::string names;
+
+   std::ofstream stream( path, std::ios::binary | std::ios::trunc );
+   if( !stream.is_open() ) return false;
+
+   // Written again once the offsets are known
+   ArchiveHeader header;
+   header.entryCount = static_cast<uint32_t>( sources.size() );
+   stream.write( reinterpret_cast<const char*>( &header ), sizeof( ArchiveHeader ) );
+
+   uint64_t offset = sizeof( ArchiveHeader );
+   std::vector<char> data;
+   for( size_t i = 0; i < sources.size(); ++i )
+   {
+      std::ifstream source( sources[i].path, std::ios::binary | std::ios::ate );
+      if( !source.is_open() )
+      {
+         printf( "Archive: Could not read %s\n", sources[i].path.c_str() );
+         return false;
+      }
+
+      data.resize( static_cast<size_t>( source.tellg() ) );
+      source.seekg( 0 );
+      source.read( data.data(), data.size() );
+
+      const uint64_t alignedOffset = AlignData( offset );
+      const std::vector<char> padding( alignedOffset - offset, 0 );
+      stream.write( padding.data(), padding.size() );
+      stream.write( data.data(), data.size() );
+
+      const std::string name = NormalizeArchiveName( sources[i].name );
+
+      std::error_code error;
+      const auto sourceTime = std::filesystem::last_write_time( sources[i].path, error );
+
+      entries[i].nameHash   = HashName( name );
+      entries[i].offset     = alignedOffset;
+      entries[i].size       = data.size();
+      entries[i].nameOffset = static_cast<uint32_t>( names.size() );
+      entries[i].nameSize   = static_cast<uint32_t>( name.size() );
+      entries[i].sourceTime = error ? 0 : sourceTime.time_since_epoch().count();
+
+      names += name;
+      offset = alignedOffset + data.size();
+   }
+
+   std::sort(
+       entries.begin(),
+       entries.end(),
+       [&names]( const ArchiveEntry& a, const ArchiveEntry& b )
+       {
+          if( a.nameHash != b.nameHash ) return a.nameHash < b.nameHash;
+          return names.compare( a.nameOffset, a.nameSize, names, b.nameOffset, b.nameSize ) < 0;
+       } );
+
+   const auto duplicate = std::adjacent_find(
+       entries.begin(),
+       entries.end(),
+       [&names]( const ArchiveEntry& a, const ArchiveEntry& b )
+       {
+          return a.nameHash == b.nameHash &&
+                 names.compare( a.nameOffset, a.nameSize, names, b.nameOffset, b.nameSize ) == 0;
+       } );
+
+   if( duplicate != entries.end() )
+   {
+      printf(
+          "Archive: %s is packed twice\n",
+          names.substr( duplicate->nameOffset, duplicate->nameSize ).c_str() );
+      return false;
+   }
+
+   // The index is read in place, its entries are aligned
+   header.indexOffset = AlignData( offset );
+   header.namesOffset = header.indexOffset + entries.size() * sizeof( ArchiveEntry );
+
+   const std::vector<char> padding( header.indexOffset - offset, 0 );
+   stream.write( padding.data(), padding.size() );
+   stream.write(
+       reinterpret_cast<const char*>( entries.data() ), entries.size() * sizeof( ArchiveEntry ) );
+   stream.write( names.data(), names.size() );
+
+   stream.seekp( 0 );
+   stream.write( reinterpret_cast<const char*>( &header ), sizeof( ArchiveHeader ) );
+
+   return stream.good();
+}
+
+// ================================================================================================
+bool Archive::open( const std::string& path )
+{
+   m_header  = nullptr;
+   m_entries = nullptr;
+   m_names   = nullptr;
+
+   if( !m_file.open( path ) ) return false;
+
+   const ArchiveHeader* header = reinterpret_cast<const ArchiveHeader*>( m_file.getData() );
+   if( m_file.getSize() < sizeof( ArchiveHeader ) || header->magic != ArchiveHeader::MAGIC ||
+       header->version != ArchiveHeader::VERSION )
+   {
+      printf(
+          "Archive: %s is not an archive of version %u, it has to be packed again\n",
+          path.c_str(),
+          ArchiveHeader::VERSION );
+      m_file.close();
+      return false;
+   }
+
+   const ArchiveEntry* entries =
+       reinterpret_cast<const ArchiveEntry*>( m_file.getData() + header->indexOffset );
+   const uint64_t indexSize = uint64_t( header->entryCount ) * sizeof( ArchiveEntry );
+
+   bool isComplete = header->indexOffset + indexSize <= header->namesOffset &&
+                     header->namesOffset <= m_file.getSize();
+
+   const uint64_t namesSize = m_file.getSize() - header->namesOffset;
+   for( uint32_t i = 0; isComplete && i < header->entryCount; ++i )
+   {
+      isComplete = entries[i].offset + entries[i].size <= header->indexOffset &&
+                   uint64_t( entries[i].nameOffset ) + entries[i].nameSize <= namesSize;
+   }
+
+   if( !isComplete )
+   {
+      printf( "Archive: %s is truncated\n", path.c_str() );
+      m_file.close();
+      return false;
+   }
+
+   m_header  = header;
+   m_entries = entries;
+   m_names   = reinterpret_cast<const char*>( m_file.getData() + header->namesOffset );
+
+   return true;
+}
+
+bool Archive::find(
+    std::string_view name,
+    const uint8_t*& data,
+    size_t& size,
+    int64_t& sourceTime ) const
+{
+   if( !m_header ) return false;
+
+   const uint64_t hash            = HashName( name );
+   const ArchiveEntry* entriesEnd = m_entries + m_header->entryCount;
+
+   const ArchiveEntry* entry = std::lower_bound(
+       m_entries,
+       entriesEnd,
+       hash,
+       []( const ArchiveEntry& entry, uint64_t hash ) { return entry.nameHash < hash; } );
+
+   // Names sharing a hash are next to each other
+   for( ; entry != entriesEnd && entry->nameHash == hash; ++entry )
+   {
+      if( std::string_view( m_names + entry->nameOffset, entry->nameSize ) == name )
+      {
+         data       = m_file.getData() + entry->offset;
+         size       = static_cast<size_t>( entry->size );
+         sourceTime = entry->sourceTime;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+std::string_view Archive::getEntryName( uint32_t index ) const
+{
+   return std::string_view( m_names + m_entries[index].nameOffset, m_entries[index].nameSize );
+}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <IO/MappedFile.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+Many files packed in one, read in place from a single mapping. Opening a packed file is a search
+in the index, there is no system call and no seek.
+
+An archive is the header followed by:
+   - The data of the files, each one aligned on 64 bytes so it can be used where it is mapped
+   - The index, entryCount ArchiveEntry sorted on the hash of their name
+   - The names of the files, one after the other without terminator
+
+Names are the paths the files are opened with, normalized. Each entry keeps the last write time of
+the file it was packed from, the loose file is used instead once it is edited. The structs are
+written as they are in memory, the archive is only read back by the same platform. Archives of
+another version are rejected, they have to be packed again.
+*/
+namespace EMP
+{
+struct ArchiveHeader
+{
+   static constexpr uint32_t MAGIC   = 0x4B505943;  // "CYPK"
+   static constexpr uint32_t VERSION = 2;
+
+   uint32_t magic      = MAGIC;
+   uint32_t version    = VERSION;
+   uint32_t entryCount = 0;
+   uint32_t reserved   = 0;
+
+   // From the start of the archive
+   uint64_t indexOffset = 0;
+   uint64_t namesOffset = 0;
+};
+
+struct ArchiveEntry
+{
+   uint64_t nameHash   = 0;
+   uint64_t offset     = 0;  // From the start of the archive
+   uint64_t size       = 0;
+   uint32_t nameOffset = 0;  // From the start of the names
+   uint32_t nameSize   = 0;
+   int64_t sourceTime  = 0;  // Last write of the packed file, in ticks of the file clock
+};
+
+// File on disk packed under the name it is opened with
+struct ArchiveSource
+{
+   std::string name;
+   std::string path;
+};
+
+// Forward slashes, no "." or empty component, "dir/../" collapsed
+std::string NormalizeArchiveName( std::string_view path );
+
+bool WriteArchive( const std::string& path, const std::vector<ArchiveSource>& sources );
+
+class Archive
+{
+  public:
+   static constexpr size_t DATA_ALIGNMENT = 64;
+
+   // Fails on missing files, and on archives that are truncated or of another version
+   bool open( const std::string& path );
+
+   // The name has to be normalized. Fails when there is no file of that name
+   bool find(
+       std::string_view name,
+       const uint8_t*& data,
+       size_t& size,
+       int64_t& sourceTime ) const;
+
+   uint32_t getEntryCount() const { return m_header ? m_header->entryCount : 0; }
+   std::string_view getEntryName( uint32_t index ) const;
+
+  private:
+   MappedFile m_file;
+   const ArchiveHeader* m_header = nullptr;
+   const ArchiveEntry* m_entries = nullptr;
+   const char* m_names           = nullptr;
+};
+}
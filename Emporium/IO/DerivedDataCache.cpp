@@ -0,0 +1,214 @@
+#include <IO/DerivedDataCache.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+namespace EMP
+{
+static constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+static constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+static uint64_t RotateLeft( uint64_t value, int bits )
+{
+   return ( value << bits ) | ( value >> ( 64 - bits ) );
+}
+
+static uint64_t Read64( const uint8_t* data )
+{
+   uint64_t value;
+   std::memcpy( &value, data, sizeof( value ) );
+   return value;
+}
+
+static uint32_t Read32( const uint8_t* data )
+{
+   uint32_t value;
+   std::memcpy( &value, data, sizeof( value ) );
+   return value;
+}
+
+static uint64_t Round( uint64_t accumulator, uint64_t input )
+{
+   accumulator += input * PRIME2;
+   accumulator = RotateLeft( accumulator, 31 );
+   return accumulator * PRIME1;
+}
+
+static uint64_t MergeRound( uint64_t hash, uint64_t accumulator )
+{
+   hash ^= Round( 0, accumulator );
+   return hash * PRIME1 + PRIME4;
+}
+
+// ================================================================================================
+uint64_t DerivedDataCache::Hash( const void* data, size_t size, uint64_t seed )
+{
+   const uint8_t* bytes = static_cast<const uint8_t*>( data );
+   const uint8_t* end   = bytes + size;
+
+   uint64_t hash = 0;
+
+   // Four independent lanes over stripes of 32 bytes
+   if( size >= 32 )
+   {
+      uint64_t lanes[4] = { seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1 };
+
+      for( ; bytes + 32 <= end; bytes += 32 )
+      {
+         lanes[0] = Round( lanes[0], Read64( bytes ) );
+         lanes[1] = Round( lanes[1], Read64( bytes + 8 ) );
+         lanes[2] = Round( lanes[2], Read64( bytes + 16 ) );
+         lanes[3] = Round( lanes[3], Read64( bytes + 24 ) );
+      }
+
+      hash = RotateLeft( lanes[0], 1 ) + RotateLeft( lanes[1], 7 ) + RotateLeft( lanes[2], 12 ) +
+             RotateLeft( lanes[3], 18 );
+
+      for( uint64_t lane : lanes )
+      {
+         hash = MergeRound( hash, lane );
+      }
+   }
+   else
+   {
+      hash = seed + PRIME5;
+   }
+
+   hash += size;
+
+   for( ; bytes + 8 <= end; bytes += 8 )
+   {
+      hash ^= Round( 0, Read64( bytes ) );
+      hash = RotateLeft( hash, 27 ) * PRIME1 + PRIME4;
+   }
+
+   if( bytes + 4 <= end )
+   {
+      hash ^= Read32( bytes ) * PRIME1;
+      hash = RotateLeft( hash, 23 ) * PRIME2 + PRIME3;
+      bytes += 4;
+   }
+
+   for( ; bytes < end; ++bytes )
+   {
+      hash ^= *bytes * PRIME5;
+      hash = RotateLeft( hash, 11 ) * PRIME1;
+   }
+
+   // Avalanche
+   hash ^= hash >> 33;
+   hash *= PRIME2;
+   hash ^= hash >> 29;
+   hash *= PRIME3;
+   hash ^= hash >> 32;
+
+   return hash;
+}
+
+// ================================================================================================
+DerivedDataCache::DerivedDataCache( std::string directory ) : m_directory( std::move( directory ) )
+{
+   if( !m_directory.empty() && m_directory.back() != '/' && m_directory.back() != '\\' )
+   {
+      m_directory += '/';
+   }
+
+   std::error_code error;
+   std::filesystem::create_directories( m_directory, error );
+
+   if( error )
+   {
+      printf(
+          "DerivedDataCache: Could not create %s, nothing will be kept\n", m_directory.c_str() );
+   }
+}
+
+std::string DerivedDataCache::_getPath( uint64_t key, std::string_view extension ) const
+{
+   char name[17];
+   snprintf( name, sizeof( name ), "%016llx", static_cast<unsigned long long>( key ) );
+
+   std::string path = m_directory;
+   path += name;
+   path += extension;
+
+   return path;
+}
+
+bool DerivedDataCache::load( uint64_t key, std::string_view extension, MappedFile& data )
+{
+   if( !data.open( _getPath( key, extension ) ) )
+   {
+      m_missCount++;
+      return false;
+   }
+
+   m_hitCount++;
+   m_hitBytes += data.getSize();
+
+   return true;
+}
+
+bool DerivedDataCache::store(
+    uint64_t key,
+    std::string_view extension,
+    const void* data,
+    size_t size )
+{
+   const std::string path = _getPath( key, extension );
+
+   // Other threads or instances of the application could be storing the same entry
+   const size_t writer   = std::hash<std::thread::id>()( std::this_thread::get_id() );
+   const std::string tmp = path + "." + std::to_string( writer ) + "." +
+                           std::to_string( m_tempFileCount++ ) + ".tmp";
+
+   {
+      std::ofstream stream( tmp, std::ios::binary | std::ios::trunc );
+      if( !stream.is_open() ) return false;
+
+      stream.write( static_cast<const char*>( data ), size );
+
+      if( !stream.good() )
+      {
+         stream.close();
+         std::error_code error;
+         std::filesystem::remove( tmp, error );
+         return false;
+      }
+   }
+
+   // Fails when the entry is mapped by a load on some platforms, it is the same data anyway
+   std::error_code error;
+   std::filesystem::rename( tmp, path, error );
+
+   if( error )
+   {
+      std::filesystem::remove( tmp, error );
+      return false;
+   }
+
+   m_storeCount++;
+   m_storedBytes += size;
+
+   return true;
+}
+
+DerivedDataCache::Stats DerivedDataCache::getStats() const
+{
+   Stats stats;
+   stats.hitCount    = m_hitCount;
+   stats.missCount   = m_missCount;
+   stats.storeCount  = m_storeCount;
+   stats.hitBytes    = m_hitBytes;
+   stats.storedBytes = m_storedBytes;
+
+   return stats;
+}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <IO/MappedFile.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace EMP
+{
+// Data derived from source files (decoded images, cooked meshes...) kept on disk so it is only
+// computed once. Entries are keyed by the hash of the content of their source file and of the
+// parameters of the processing, a source file that changes or that is processed differently gets
+// a new entry. Entries are never evicted, the directory can be deleted at any time.
+//
+// Loads and stores can be done from any thread. Hits are mapped in memory, nothing is read until
+// the data is used.
+class DerivedDataCache
+{
+  public:
+   struct Stats
+   {
+      uint64_t hitCount    = 0;
+      uint64_t missCount   = 0;
+      uint64_t storeCount  = 0;
+      uint64_t hitBytes    = 0;  // Mapped by the hits
+      uint64_t storedBytes = 0;
+   };
+
+   // The directory is created if it does not exist
+   explicit DerivedDataCache( std::string directory );
+
+   DerivedDataCache( const DerivedDataCache& ) = delete;
+   DerivedDataCache( DerivedDataCache&& )      = delete;
+   DerivedDataCache& operator=( const DerivedDataCache& ) = delete;
+   DerivedDataCache& operator=( DerivedDataCache&& ) = delete;
+
+   // 64-bit hash after xxHash64, the seed chains the hashes of the parameters and of the source
+   static uint64_t Hash( const void* data, size_t size, uint64_t seed = 0 );
+
+   // Maps the entry of the key, a miss when there is none. The extension tells the kinds of
+   // derived data apart
+   bool load( uint64_t key, std::string_view extension, MappedFile& data );
+
+   // Written to a temporary file renamed once complete, a load never sees a partial entry
+   bool store( uint64_t key, std::string_view extension, const void* data, size_t size );
+
+   Stats getStats() const;
+
+  private:
+   std::string _getPath( uint64_t key, std::string_view extension ) const;
+
+   std::string m_directory;
+
+   std::atomic<uint64_t> m_hitCount      = 0;
+   std::atomic<uint64_t> m_missCount     = 0;
+   std::atomic<uint64_t> m_storeCount    = 0;
+   std::atomic<uint64_t> m_hitBytes      = 0;
+   std::atomic<uint64_t> m_storedBytes   = 0;
+   std::atomic<uint64_t> m_tempFileCount = 0;  // Temporary files of concurrent stores never clash
+};
+}
@@ -0,0 +1,125 @@
+#include <IO/MappedFile.h>
+
+#include <utility>
+
+#if defined( _WIN32 )
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace EMP
+{
+MappedFile::MappedFile( MappedFile&& other ) noexcept { *this = std::move( other ); }
+
+MappedFile& MappedFile::operator=( MappedFile&& other ) noexcept
+{
+   if( this != &other )
+   {
+      close();
+
+      m_data = std::exchange( other.m_data, nullptr );
+      m_size = std::exchange( other.m_size, 0 );
+
+#if defined( _WIN32 )
+      m_file    = std::exchange( other.m_file, nullptr );
+      m_mapping = std::exchange( other.m_mapping, nullptr );
+#endif
+   }
+
+   return *this;
+}
+
+bool MappedFile::open( const std::string& path )
+{
+   close();
+
+#if defined( _WIN32 )
+   HANDLE file = CreateFileA(
+       path.c_str(),
+       GENERIC_READ,
+       FILE_SHARE_READ,
+       nullptr,
+       OPEN_EXISTING,
+       FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+       nullptr );
+   if( file == INVALID_HANDLE_VALUE ) return false;
+
+   LARGE_INTEGER size = {};
+   if( !GetFileSizeEx( file, &size ) || size.QuadPart == 0 )
+   {
+      CloseHandle( file );
+      return false;
+   }
+
+   HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+   if( !mapping )
+   {
+      CloseHandle( file );
+      return false;
+   }
+
+   const void* data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+   if( !data )
+   {
+      CloseHandle( mapping );
+      CloseHandle( file );
+      return false;
+   }
+
+   m_file    = file;
+   m_mapping = mapping;
+   m_data    = static_cast<const uint8_t*>( data );
+   m_size    = static_cast<size_t>( size.QuadPart );
+#else
+   const int file = ::open( path.c_str(), O_RDONLY );
+   if( file < 0 ) return false;
+
+   struct stat status = {};
+   if( fstat( file, &status ) != 0 || status.st_size == 0 )
+   {
+      ::close( file );
+      return false;
+   }
+
+   const size_t size = static_cast<size_t>( status.st_size );
+   void* data        = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, file, 0 );
+
+   // The mapping keeps the file alive on its own
+   ::close( file );
+
+   if( data == MAP_FAILED ) return false;
+
+   madvise( data, size, MADV_SEQUENTIAL );
+
+   m_data = static_cast<const uint8_t*>( data );
+   m_size = size;
+#endif
+
+   return true;
+}
+
+void MappedFile::close()
+{
+   if( !m_data ) return;
+
+#if defined( _WIN32 )
+   UnmapViewOfFile( m_data );
+   CloseHandle( m_mapping );
+   CloseHandle( m_file );
+
+   m_file    = nullptr;
+   m_mapping = nullptr;
+#else
+   munmap( const_cast<uint8_t*>( m_data ), m_size );
+#endif
+
+   m_data = nullptr;
+   m_size = 0;
+}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace EMP
+{
+// Read-only view of a whole file mapped in memory. Nothing is read when the file is opened, the
+// pages are brought in by the system the first time they are touched
+class MappedFile
+{
+  public:
+   MappedFile() = default;
+   explicit MappedFile( const std::string& path ) { open( path ); }
+
+   MappedFile( const MappedFile& ) = delete;
+   MappedFile& operator=( const MappedFile& ) = delete;
+   MappedFile( MappedFile&& other ) noexcept;
+   MappedFile& operator=( MappedFile&& other ) noexcept;
+   ~MappedFile() { close(); }
+
+   // Fails on missing or empty files, a file that was open is closed first
+   bool open( const std::string& path );
+   void close();
+
+   bool isOpen() const { return m_data != nullptr; }
+
+   const uint8_t* getData() const { return m_data; }
+   size_t getSize() const { return m_size; }
+
+  private:
+   const uint8_t* m_data = nullptr;
+   size_t m_size         = 0;
+
+#if defined( _WIN32 )
+   void* m_file    = nullptr;
+   void* m_mapping = nullptr;
+#endif
+};
+}
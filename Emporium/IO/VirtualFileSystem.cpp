@@ -0,0 +1,144 @@
+#include <IO/VirtualFileSystem.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <utility>
+
+namespace EMP
+{
+VirtualFile::VirtualFile( MappedFile&& looseFile ) : m_looseFile( std::move( looseFile ) )
+{
+   m_data = m_looseFile.getData();
+   m_size = m_looseFile.getSize();
+}
+
+VirtualFile::VirtualFile( VirtualFile&& other ) noexcept { *this = std::move( other ); }
+
+VirtualFile& VirtualFile::operator=( VirtualFile&& other ) noexcept
+{
+   if( this != &other )
+   {
+      m_looseFile = std::move( other.m_looseFile );
+      m_data      = std::exchange( other.m_data, nullptr );
+      m_size      = std::exchange( other.m_size, 0 );
+   }
+
+   return *this;
+}
+
+void VirtualFile::close()
+{
+   m_looseFile.close();
+   m_data = nullptr;
+   m_size = 0;
+}
+
+// ================================================================================================
+bool VirtualFileSystem::mount( const std::string& archivePath )
+{
+   auto archive = std::make_unique<Archive>();
+   if( !archive->open( archivePath ) ) return false;
+
+   printf(
+       "Mounted archive --> %s, %u files\n", archivePath.c_str(), archive->getEntryCount() );
+
+   m_archives.push_back( std::move( archive ) );
+
+   return true;
+}
+
+bool VirtualFileSystem::open( const std::string& path, VirtualFile& file ) const
+{
+   file.close();
+
+   if( !m_archives.empty() )
+   {
+      const std::string name = NormalizeArchiveName( path );
+      for( const std::unique_ptr<Archive>& archive : m_archives )
+      {
+         int64_t sourceTime = 0;
+         if( !archive->find( name, file.m_data, file.m_size, sourceTime ) ) continue;
+
+         // A file edited since it was packed is read from disk, there is no need to pack again
+         // to see the edit. Packaged builds have no loose files, the lookup fails right away
+         std::error_code error;
+         const auto looseTime = std::filesystem::last_write_time( path, error );
+         if( error || looseTime.time_since_epoch().count() <= sourceTime )
+         {
+            m_packedOpenCount++;
+            return true;
+         }
+
+         file.m_data = nullptr;
+         file.m_size = 0;
+         m_staleCount++;
+         break;
+      }
+   }
+
+   if( !file.m_looseFile.open( path ) )
+   {
+      m_missCount++;
+      return false;
+   }
+
+   file.m_data = file.m_looseFile.getData();
+   file.m_size = file.m_looseFile.getSize();
+   m_looseOpenCount++;
+
+   return true;
+}
+
+std::vector<std::string> VirtualFileSystem::list( const std::string& directory ) const
+{
+   std::string prefix = directory;
+   if( !prefix.empty() && prefix.back() != '/' && prefix.back() != '\\' )
+   {
+      prefix += '/';
+   }
+
+   std::vector<std::string> paths;
+
+   const std::string packedPrefix = NormalizeArchiveName( prefix );
+   for( const std::unique_ptr<Archive>& archive : m_archives )
+   {
+      for( uint32_t i = 0; i < archive->getEntryCount(); ++i )
+      {
+         const std::string_view name = archive->getEntryName( i );
+         if( name.size() > packedPrefix.size() && name.starts_with( packedPrefix ) &&
+             name.find( '/', packedPrefix.size() ) == std::string_view::npos )
+         {
+            paths.push_back( prefix + std::string( name.substr( packedPrefix.size() ) ) );
+         }
+      }
+   }
+
+   std::error_code error;
+   for( const auto& entry : std::filesystem::directory_iterator( directory, error ) )
+   {
+      if( entry.is_regular_file() )
+      {
+         paths.push_back( prefix + entry.path().filename().generic_string() );
+      }
+   }
+
+   // Files both packed and on disk are listed once
+   std::sort( paths.begin(), paths.end() );
+   paths.erase( std::unique( paths.begin(), paths.end() ), paths.end() );
+
+   return paths;
+}
+
+VirtualFileSystem::Stats VirtualFileSystem::getStats() const
+{
+   Stats stats;
+   stats.archiveCount    = static_cast<uint32_t>( m_archives.size() );
+   stats.packedOpenCount = m_packedOpenCount;
+   stats.looseOpenCount  = m_looseOpenCount;
+   stats.staleCount      = m_staleCount;
+   stats.missCount       = m_missCount;
+
+   return stats;
+}
+}
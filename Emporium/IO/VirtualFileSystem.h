@@ -0,0 +1,87 @@
+#pragma once
+
+#include <IO/Archive.h>
+#include <IO/MappedFile.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace EMP
+{
+// Read-only file opened through the virtual file system, either packed in an archive or a loose
+// file mapped on its own
+class VirtualFile
+{
+  public:
+   VirtualFile() = default;
+   explicit VirtualFile( MappedFile&& looseFile );
+
+   VirtualFile( const VirtualFile& ) = delete;
+   VirtualFile& operator=( const VirtualFile& ) = delete;
+   VirtualFile( VirtualFile&& other ) noexcept;
+   VirtualFile& operator=( VirtualFile&& other ) noexcept;
+   ~VirtualFile() = default;
+
+   void close();
+
+   bool isOpen() const { return m_data != nullptr; }
+
+   const uint8_t* getData() const { return m_data; }
+   size_t getSize() const { return m_size; }
+
+  private:
+   friend class VirtualFileSystem;
+
+   MappedFile m_looseFile;
+   const uint8_t* m_data = nullptr;  // In the archive or in the loose file
+   size_t m_size         = 0;
+};
+
+// Files are looked up in the mounted archives first, in the order they were mounted, then on disk.
+// The paths are the ones of the loose files, an archive packs files under the path they are opened
+// with. A packed file whose loose file was written after it was packed is read from disk instead.
+// Archives are mounted at startup before any file is opened, files can then be opened from any
+// thread.
+class VirtualFileSystem
+{
+  public:
+   struct Stats
+   {
+      uint32_t archiveCount    = 0;
+      uint64_t packedOpenCount = 0;  // Found in an archive
+      uint64_t looseOpenCount  = 0;  // Mapped from disk
+      uint64_t staleCount      = 0;  // Packed but edited on disk since, the loose file was mapped
+      uint64_t missCount       = 0;
+   };
+
+   VirtualFileSystem() = default;
+
+   VirtualFileSystem( const VirtualFileSystem& ) = delete;
+   VirtualFileSystem( VirtualFileSystem&& )      = delete;
+   VirtualFileSystem& operator=( const VirtualFileSystem& ) = delete;
+   VirtualFileSystem& operator=( VirtualFileSystem&& ) = delete;
+
+   // Fails on missing archives, the files are then read from disk
+   bool mount( const std::string& archivePath );
+
+   bool open( const std::string& path, VirtualFile& file ) const;
+
+   // Paths of the files right in a directory, packed or on disk. Each path is the directory
+   // followed by the name of the file
+   std::vector<std::string> list( const std::string& directory ) const;
+
+   Stats getStats() const;
+
+  private:
+   std::vector<std::unique_ptr<Archive>> m_archives;
+
+   mutable std::atomic<uint64_t> m_packedOpenCount = 0;
+   mutable std::atomic<uint64_t> m_looseOpenCount  = 0;
+   mutable std::atomic<uint64_t> m_staleCount      = 0;
+   mutable std::atomic<uint64_t> m_missCount       = 0;
+};
+}
@@ -0,0 +1,430 @@
+#pragma once
+
+#include <Common/Include.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace EMP
+{
+// Read-mostly hash map made for caches that are shared between threads.
+//
+// Reads are lock-free: keys are spread over shards, each shard owns an open-addressing table
+// (linear probing) of pointers to immutable entries. Writers lock their shard only. Entries and
+// tables that get replaced are kept alive until clear() or destruction so that a reader never
+// touches freed memory, which means erasing is supported but does not give memory back.
+//
+// findOrCreate/tryEmplace guarantee that the value of a key is built once even when many threads
+// ask for it at the same time. The builder runs outside of the shard lock, other threads asking
+// for the same key wait on the entry itself. A builder that throws leaves the key absent, the
+// exception goes to its caller and the waiting threads try to build the value again.
+template <class K, class V, class Hash = std::hash<K>, class KeyEqual = std::equal_to<K>>
+class ConcurrentHashMap
+{
+  public:
+   ConcurrentHashMap()
+   {
+      for( Shard& shard : m_shards )
+      {
+         _resetShard( shard );
+      }
+   }
+   NON_COPIABLE( ConcurrentHashMap );
+   ~ConcurrentHashMap() { clear(); }
+
+   size_t size() const { return m_size.load( std::memory_order_relaxed ); }
+   bool empty() const { return size() == 0; }
+
+   // Lock-free. Returns nullptr if the key is not present or if its value is still being built.
+   // The pointer stays valid until the key is erased/reassigned and clear() is called
+   const V* find( const K& key ) const
+   {
+      const size_t hash  = _hash( key );
+      const Entry* entry = _findEntry( m_shards[_shardIndex( hash )], key, hash );
+      if( entry && entry->state.load( std::memory_order_acquire ) == READY )
+      {
+         return &entry->value;
+      }
+
+      return nullptr;
+   }
+
+   bool contains( const K& key ) const { return find( key ) != nullptr; }
+
+   // Returns the value associated with the key, building it if it was not present. The factory
+   // either returns a V or initializes a default-constructed V passed by reference. The latter is
+   // for types that should not be copied around (e.g. types releasing resources on destruction)
+   template <class Factory>
+   const V& findOrCreate( const K& key, Factory&& factory )
+   {
+      if( const V* value = find( key ) ) return *value;
+
+      bool created = false;
+      return _findOrCreateEntry( key, std::forward<Factory>( factory ), created )->value;
+   }
+
+   // Same as above but returns whether the value was built by this call
+   template <class Factory>
+   bool tryEmplace( const K& key, Factory&& factory )
+   {
+      if( find( key ) ) return false;
+
+      bool created = false;
+      _findOrCreateEntry( key, std::forward<Factory>( factory ), created );
+      return created;
+   }
+
+   // Returns false if the key was already present, in which case the map is left untouched
+   bool insert( const K& key, const V& value )
+   {
+      return tryEmplace( key, [&value]() { return value; } );
+   }
+
+   // Replaces the entry of the key if present. Readers currently holding the previous value can
+   // keep using it until clear() is called
+   void insertOrAssign( const K& key, const V& value )
+   {
+      const size_t hash = _hash( key );
+      Shard& shard      = m_shards[_shardIndex( hash )];
+
+      Entry* newEntry = new Entry( hash, key );
+      newEntry->value = value;
+      newEntry->state.store( READY, std::memory_order_relaxed );
+
+      std::unique_lock<std::mutex> lock( shard.mutex );
+
+      std::atomic<Entry*>* slot = _findSlot( shard, key, hash );
+      if( slot )
+      {
+         shard.retiredEntries.push_back( slot->load( std::memory_order_relaxed ) );
+         slot->store( newEntry, std::memory_order_release );
+      }
+      else
+      {
+         _insertLocked( shard, newEntry );
+         m_size.fetch_add( 1, std::memory_order_relaxed );
+      }
+   }
+
+   bool erase( const K& key )
+   {
+      const size_t hash = _hash( key );
+      Shard& shard      = m_shards[_shardIndex( hash )];
+
+      std::unique_lock<std::mutex> lock( shard.mutex );
+
+      std::atomic<Entry*>* slot = _findSlot( shard, key, hash );
+      if( !slot ) return false;
+
+      // Leaving a tombstone so that probing sequences going through this slot are not cut short
+      shard.retiredEntries.push_back( slot->load( std::memory_order_relaxed ) );
+      slot->store( TOMBSTONE, std::memory_order_release );
+      shard.liveCount--;
+      m_size.fetch_sub( 1, std::memory_order_relaxed );
+
+      return true;
+   }
+
+   // Visits every built key/value pair. Entries inserted during the iteration may be missed
+   template <class Visitor>
+   void forEach( Visitor&& visitor ) const
+   {
+      for( const Shard& shard : m_shards )
+      {
+         const Table* table = shard.table.load( std::memory_order_acquire );
+         for( size_t i = 0; i < table->capacity; ++i )
+         {
+            const Entry* entry = table->slots[i].load( std::memory_order_acquire );
+            if( entry && entry != TOMBSTONE &&
+                entry->state.load( std::memory_order_acquire ) == READY )
+            {
+               visitor( entry->key, entry->value );
+            }
+         }
+      }
+   }
+
+   // Destroys every entry and gives back all memory. This is NOT safe to call while other threads
+   // are accessing the map
+   void clear()
+   {
+      for( Shard& shard : m_shards )
+      {
+         std::unique_lock<std::mutex> lock( shard.mutex );
+
+         const Table* table = shard.table.load( std::memory_order_relaxed );
+         for( size_t i = 0; i < table->capacity; ++i )
+         {
+            const Entry* entry = table->slots[i].load( std::memory_order_relaxed );
+            if( entry != TOMBSTONE ) delete entry;
+         }
+
+         for( const Entry* entry : shard.retiredEntries )
+         {
+            delete entry;
+         }
+
+         _resetShard( shard );
+      }
+
+      m_size.store( 0, std::memory_order_relaxed );
+   }
+
+  private:
+   static constexpr uint32_t SHARD_COUNT           = 16;
+   static constexpr size_t INITIAL_SHARD_CAPACITY = 16;  // Needs to be a power of 2
+
+   // States of an entry
+   static constexpr uint32_t BUILDING = 0;
+   static constexpr uint32_t READY    = 1;
+   static constexpr uint32_t FAILED   = 2;  // The builder threw, the entry is no longer in the map
+
+   struct Entry
+   {
+      Entry( size_t entryHash, const K& entryKey ) : hash( entryHash ), key( entryKey ) {}
+
+      const size_t hash;
+      const K key;
+      V value = {};
+      std::atomic<uint32_t> state = BUILDING;
+   };
+
+   inline static Entry* const TOMBSTONE = reinterpret_cast<Entry*>( uintptr_t( 1 ) );
+
+   struct Table
+   {
+      explicit Table( size_t tableCapacity )
+          : capacity( tableCapacity ), slots( new std::atomic<Entry*>[tableCapacity] )
+      {
+         for( size_t i = 0; i < capacity; ++i )
+         {
+            slots[i].store( nullptr, std::memory_order_relaxed );
+         }
+      }
+
+      const size_t capacity;
+      std::unique_ptr<std::atomic<Entry*>[]> slots;
+   };
+
+   struct alignas( 64 ) Shard
+   {
+      std::atomic<Table*> table = nullptr;
+
+      // Writer state, protected by the mutex
+      std::mutex mutex;
+      size_t usedCount = 0;  // Slots that are not empty, including tombstones
+      size_t liveCount = 0;
+      std::vector<std::unique_ptr<Table>> tables;  // Current table is the last one
+      std::vector<const Entry*> retiredEntries;
+   };
+
+   static size_t _hash( const K& key )
+   {
+      // Mixing the hash since std::hash is often the identity for integral types and we use both
+      // the low (slot) and the high (shard) bits
+      uint64_t hash = static_cast<uint64_t>( Hash()( key ) );
+      hash ^= hash >> 33;
+      hash *= 0xff51afd7ed558ccdULL;
+      hash ^= hash >> 33;
+      hash *= 0xc4ceb9fe1a85ec53ULL;
+      hash ^= hash >> 33;
+      return static_cast<size_t>( hash );
+   }
+
+   static uint32_t _shardIndex( size_t hash )
+   {
+      return static_cast<uint32_t>( hash >> ( sizeof( size_t ) * 8 - 4 ) ) & ( SHARD_COUNT - 1 );
+   }
+
+   static void _resetShard( Shard& shard )
+   {
+      shard.tables.clear();
+      shard.retiredEntries.clear();
+      shard.tables.push_back( std::make_unique<Table>( INITIAL_SHARD_CAPACITY ) );
+      shard.table.store( shard.tables.back().get(), std::memory_order_release );
+      shard.usedCount = 0;
+      shard.liveCount = 0;
+   }
+
+   static const Entry* _findEntry( const Shard& shard, const K& key, size_t hash )
+   {
+      const Table* table = shard.table.load( std::memory_order_acquire );
+      const size_t mask  = table->capacity - 1;
+
+      size_t i = hash & mask;
+      for( size_t probe = 0; probe < table->capacity; ++probe, i = ( i + 1 ) & mask )
+      {
+         const Entry* entry = table->slots[i].load( std::memory_order_acquire );
+         if( entry == nullptr ) return nullptr;
+         if( entry == TOMBSTONE ) continue;
+         if( entry->hash == hash && KeyEqual()( entry->key, key ) ) return entry;
+      }
+
+      return nullptr;
+   }
+
+   // Needs the shard lock
+   static std::atomic<Entry*>* _findSlot( Shard& shard, const K& key, size_t hash )
+   {
+      Table* table      = shard.table.load( std::memory_order_relaxed );
+      const size_t mask = table->capacity - 1;
+
+      size_t i = hash & mask;
+      for( size_t probe = 0; probe < table->capacity; ++probe, i = ( i + 1 ) & mask )
+      {
+         Entry* entry = table->slots[i].load( std::memory_order_relaxed );
+         if( entry == nullptr ) return nullptr;
+         if( entry == TOMBSTONE ) continue;
+         if( entry->hash == hash && KeyEqual()( entry->key, key ) ) return &table->slots[i];
+      }
+
+      return nullptr;
+   }
+
+   // Needs the shard lock
+   static void _insertLocked( Shard& shard, Entry* entry )
+   {
+      // Keeping the load factor under 50% since linear probing degrades quickly past that
+      const Table* table = shard.table.load( std::memory_order_relaxed );
+      if( ( shard.usedCount + 1 ) * 2 > table->capacity )
+      {
+         _rehashLocked( shard );
+         table = shard.table.load( std::memory_order_relaxed );
+      }
+
+      const size_t mask = table->capacity - 1;
+      size_t i          = entry->hash & mask;
+      while( table->slots[i].load( std::memory_order_relaxed ) != nullptr )
+      {
+         i = ( i + 1 ) & mask;
+      }
+
+      table->slots[i].store( entry, std::memory_order_release );
+      shard.usedCount++;
+      shard.liveCount++;
+   }
+
+   // Needs the shard lock. Readers still probing the previous table keep seeing valid entries
+   static void _rehashLocked( Shard& shard )
+   {
+      const Table* oldTable = shard.table.load( std::memory_order_relaxed );
+
+      // Only growing when tombstones are not the reason we are running out of slots
+      size_t newCapacity = INITIAL_SHARD_CAPACITY;
+      while( newCapacity < ( shard.liveCount + 1 ) * 4 )
+      {
+         newCapacity *= 2;
+      }
+
+      auto newTable     = std::make_unique<Table>( newCapacity );
+      const size_t mask = newCapacity - 1;
+      for( size_t slot = 0; slot < oldTable->capacity; ++slot )
+      {
+         Entry* entry = oldTable->slots[slot].load( std::memory_order_relaxed );
+         if( entry == nullptr || entry == TOMBSTONE ) continue;
+
+         size_t i = entry->hash & mask;
+         while( newTable->slots[i].load( std::memory_order_relaxed ) != nullptr )
+         {
+            i = ( i + 1 ) & mask;
+         }
+         newTable->slots[i].store( entry, std::memory_order_relaxed );
+      }
+
+      shard.usedCount = shard.liveCount;
+      shard.table.store( newTable.get(), std::memory_order_release );
+      shard.tables.push_back( std::move( newTable ) );
+   }
+
+   // Needs the shard lock. Takes a pending entry out of the map, threads waiting on it keep it
+   void _removePendingLocked( Shard& shard, Entry* entry )
+   {
+      // Nothing to do when it was erased or reassigned in the meantime, that retired it already
+      std::atomic<Entry*>* slot = _findSlot( shard, entry->key, entry->hash );
+      if( !slot || slot->load( std::memory_order_relaxed ) != entry ) return;
+
+      slot->store( TOMBSTONE, std::memory_order_release );
+      shard.liveCount--;
+      m_size.fetch_sub( 1, std::memory_order_relaxed );
+      shard.retiredEntries.push_back( entry );
+   }
+
+   template <class Factory>
+   Entry* _findOrCreateEntry( const K& key, Factory&& factory, bool& created )
+   {
+      const size_t hash = _hash( key );
+      Shard& shard      = m_shards[_shardIndex( hash )];
+
+      for( ;; )
+      {
+         Entry* entry = nullptr;
+         {
+            std::unique_lock<std::mutex> lock( shard.mutex );
+
+            std::atomic<Entry*>* slot = _findSlot( shard, key, hash );
+            if( slot )
+            {
+               entry = slot->load( std::memory_order_relaxed );
+            }
+            else
+            {
+               // Publishing an entry that is not ready yet so that concurrent callers wait on it
+               // instead of building the value a second time
+               entry = new Entry( hash, key );
+               _insertLocked( shard, entry );
+               m_size.fetch_add( 1, std::memory_order_relaxed );
+               created = true;
+            }
+         }
+
+         if( !created )
+         {
+            entry->state.wait( BUILDING, std::memory_order_acquire );
+
+            // The builder threw, trying again
+            if( entry->state.load( std::memory_order_acquire ) == FAILED ) continue;
+
+            return entry;
+         }
+
+         try
+         {
+            if constexpr( std::is_invocable_v<Factory, V&> )
+            {
+               factory( entry->value );
+            }
+            else
+            {
+               entry->value = factory();
+            }
+         }
+         catch( ... )
+         {
+            {
+               std::unique_lock<std::mutex> lock( shard.mutex );
+               _removePendingLocked( shard, entry );
+            }
+
+            created = false;
+            entry->state.store( FAILED, std::memory_order_release );
+            entry->state.notify_all();
+            throw;
+         }
+
+         entry->state.store( READY, std::memory_order_release );
+         entry->state.notify_all();
+
+         return entry;
+      }
+   }
+
+   std::array<Shard, SHARD_COUNT> m_shards;
+   std::atomic<size_t> m_size = 0;
+};
+}
@@ -0,0 +1,385 @@
+#pragma once
+
+#include <Common/Include.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+
+namespace EMP
+{
+// Lock-free single-producer/single-consumer ring buffers. Exactly one thread may push and exactly
+// one (other) thread may pop. Every operation is wait-free: it either succeeds right away or
+// reports that the buffer is full/empty.
+//
+// The producer and the consumer indices live on their own cache line, each side also keeps a
+// cached copy of the other side's index so that the shared line is only read when the cached
+// value says the buffer looks full (or empty).
+static constexpr size_t CACHE_LINE_SIZE = 64;
+
+template <class T>
+class SPSCRingBuffer
+{
+  public:
+   // Capacity is rounded up to the next power of 2
+   explicit SPSCRingBuffer( size_t capacity )
+   {
+      m_capacity = 1;
+      while( m_capacity < capacity )
+      {
+         m_capacity <<= 1;
+      }
+
+      m_mask     = m_capacity - 1;
+      m_elements = std::make_unique<T[]>( m_capacity );
+   }
+   NON_COPIABLE( SPSCRingBuffer );
+   ~SPSCRingBuffer() = default;
+
+   size_t getCapacity() const { return m_capacity; }
+
+   // Approximate when called from a thread that is neither the producer nor the consumer. The tail
+   // is loaded first, the head can only have moved further since so the difference never wraps
+   size_t size() const
+   {
+      const size_t tail = m_consumer.tail.load( std::memory_order_acquire );
+      const size_t head = m_producer.head.load( std::memory_order_acquire );
+      return head - tail;
+   }
+   bool empty() const { return size() == 0; }
+
+   // Producer
+   // ==============================================================================================
+   template <class... Args>
+   bool tryEmplace( Args&&... args )
+   {
+      const size_t head = m_producer.head.load( std::memory_order_relaxed );
+      if( _freeSlots( head, 1 ) == 0 ) return false;
+
+      m_elements[head & m_mask] = T( std::forward<Args>( args )... );
+      m_producer.head.store( head + 1, std::memory_order_release );
+      return true;
+   }
+
+   bool tryPush( const T& element ) { return tryEmplace( element ); }
+   bool tryPush( T&& element ) { return tryEmplace( std::move( element ) ); }
+
+   // Pushes as many elements as there is room for, returns how many were pushed
+   size_t tryPushBatch( std::span<const T> elements )
+   {
+      const size_t head  = m_producer.head.load( std::memory_order_relaxed );
+      const size_t count = std::min( elements.size(), _freeSlots( head, elements.size() ) );
+
+      for( size_t i = 0; i < count; ++i )
+      {
+         m_elements[( head + i ) & m_mask] = elements[i];
+      }
+
+      m_producer.head.store( head + count, std::memory_order_release );
+      return count;
+   }
+
+   // Zero-copy writes. Returns a contiguous writable region of at most maxCount elements, it can be
+   // shorter than the free space when it reaches the end of the storage. Nothing is visible to
+   // the consumer until endWrite is called with the amount of elements actually written
+   std::span<T> beginWrite( size_t maxCount )
+   {
+      const size_t head  = m_producer.head.load( std::memory_order_relaxed );
+      const size_t start = head & m_mask;
+      const size_t count =
+          std::min( { maxCount, _freeSlots( head, maxCount ), m_capacity - start } );
+      return { m_elements.get() + start, count };
+   }
+
+   void endWrite( size_t count )
+   {
+      const size_t head = m_producer.head.load( std::memory_order_relaxed );
+      m_producer.head.store( head + count, std::memory_order_release );
+   }
+
+   // Consumer
+   // ==============================================================================================
+   bool tryPop( T& element )
+   {
+      const size_t tail = m_consumer.tail.load( std::memory_order_relaxed );
+      if( _availableSlots( tail, 1 ) == 0 ) return false;
+
+      element = std::move( m_elements[tail & m_mask] );
+      m_consumer.tail.store( tail + 1, std::memory_order_release );
+      return true;
+   }
+
+   // Pops as many elements as are available and fit, returns how many were popped
+   size_t tryPopBatch( std::span<T> elements )
+   {
+      const size_t tail  = m_consumer.tail.load( std::memory_order_relaxed );
+      const size_t count = std::min( elements.size(), _availableSlots( tail, elements.size() ) );
+
+      for( size_t i = 0; i < count; ++i )
+      {
+         elements[i] = std::move( m_elements[( tail + i ) & m_mask] );
+      }
+
+      m_consumer.tail.store( tail + count, std::memory_order_release );
+      return count;
+   }
+
+   // Zero-copy reads. Returns the contiguous readable region, elements stay owned by the buffer
+   // until endRead is called with the amount of elements consumed
+   std::span<const T> beginRead()
+   {
+      const size_t tail  = m_consumer.tail.load( std::memory_order_relaxed );
+      const size_t start = tail & m_mask;
+      const size_t untilEnd = m_capacity - start;
+      const size_t count    = std::min( _availableSlots( tail, untilEnd ), untilEnd );
+      return { m_elements.get() + start, count };
+   }
+
+   void endRead( size_t count )
+   {
+      const size_t tail = m_consumer.tail.load( std::memory_order_relaxed );
+      m_consumer.tail.store( tail + count, std::memory_order_release );
+   }
+
+  private:
+   // Producer side, only reloads the consumer's index when the cached one is not enough
+   size_t _freeSlots( size_t head, size_t wanted )
+   {
+      size_t freeSlots = m_capacity - ( head - m_producer.cachedTail );
+      if( freeSlots < wanted )
+      {
+         m_producer.cachedTail = m_consumer.tail.load( std::memory_order_acquire );
+         freeSlots             = m_capacity - ( head - m_producer.cachedTail );
+      }
+      return freeSlots;
+   }
+
+   // Consumer side, same idea
+   size_t _availableSlots( size_t tail, size_t wanted )
+   {
+      size_t available = m_consumer.cachedHead - tail;
+      if( available < wanted )
+      {
+         m_consumer.cachedHead = m_producer.head.load( std::memory_order_acquire );
+         available             = m_consumer.cachedHead - tail;
+      }
+      return available;
+   }
+
+   // Indices are never wrapped, only masked when indexing
+   struct alignas( CACHE_LINE_SIZE ) Producer
+   {
+      std::atomic<size_t> head = 0;
+      size_t cachedTail        = 0;
+   };
+
+   struct alignas( CACHE_LINE_SIZE ) Consumer
+   {
+      std::atomic<size_t> tail = 0;
+      size_t cachedHead        = 0;
+   };
+
+   Producer m_producer;
+   Consumer m_consumer;
+
+   alignas( CACHE_LINE_SIZE ) size_t m_capacity = 0;
+   size_t m_mask = 0;
+   std::unique_ptr<T[]> m_elements;
+};
+
+// Same as above but for variable-size records of raw bytes (log lines, profiling samples...).
+// Every record is prefixed by its size and padded to 8 bytes. A record never wraps around the end
+// of the storage, the leftover space is skipped instead
+class SPSCByteRingBuffer
+{
+  public:
+   // Capacity in bytes, rounded up to the next power of 2
+   explicit SPSCByteRingBuffer( size_t capacity )
+   {
+      m_capacity = RECORD_ALIGNMENT * 2;
+      while( m_capacity < capacity )
+      {
+         m_capacity <<= 1;
+      }
+
+      m_mask  = m_capacity - 1;
+      m_bytes = std::make_unique<std::byte[]>( m_capacity );
+   }
+   NON_COPIABLE( SPSCByteRingBuffer );
+   ~SPSCByteRingBuffer() = default;
+
+   size_t getCapacity() const { return m_capacity; }
+
+   // Largest record that can ever fit
+   size_t getMaxRecordSize() const { return m_capacity / 2 - HEADER_SIZE; }
+
+   bool empty() const
+   {
+      const size_t tail = m_consumer.tail.load( std::memory_order_acquire );
+      return m_producer.head.load( std::memory_order_acquire ) == tail;
+   }
+
+   // Producer
+   // ==============================================================================================
+   bool tryWrite( const void* data, uint32_t size )
+   {
+      const std::span<std::byte> record = beginWrite( size );
+      if( record.empty() ) return false;
+
+      memcpy( record.data(), data, size );
+      return endWrite();
+   }
+
+   // Zero-copy writes. Reserves a record of the given size, returns an empty span if there is not
+   // enough room. The record is published to the consumer with endWrite. Records can't be empty
+   std::span<std::byte> beginWrite( uint32_t size )
+   {
+      assert( size > 0 && size <= getMaxRecordSize() && "SPSCByteRingBuffer: Invalid record size" );
+
+      const size_t head       = m_producer.head.load( std::memory_order_relaxed );
+      const size_t recordSize = _alignedRecordSize( size );
+      const size_t untilEnd   = m_capacity - ( head & m_mask );
+
+      // Records do not wrap, if it does not fit before the end we need to skip what is left
+      const size_t needed = recordSize > untilEnd ? untilEnd + recordSize : recordSize;
+      if( !_hasRoom( head, needed ) )
+      {
+         m_producer.pendingSize = INVALID_SIZE;
+         return {};
+      }
+
+      size_t recordStart = head;
+      if( recordSize > untilEnd )
+      {
+         _writeHeader( head, PADDING_FLAG );
+         recordStart = head + untilEnd;
+      }
+
+      m_producer.pendingStart = recordStart;
+      m_producer.pendingSize  = size;
+      return { m_bytes.get() + ( recordStart & m_mask ) + HEADER_SIZE, size };
+   }
+
+   bool endWrite()
+   {
+      if( m_producer.pendingSize == INVALID_SIZE ) return false;
+
+      const uint32_t size = m_producer.pendingSize;
+      _writeHeader( m_producer.pendingStart, size );
+
+      m_producer.pendingSize = INVALID_SIZE;
+      m_producer.head.store(
+          m_producer.pendingStart + _alignedRecordSize( size ), std::memory_order_release );
+      return true;
+   }
+
+   // Consumer
+   // ==============================================================================================
+
+   // Returns the next record without consuming it, an empty span means there is nothing to read
+   std::span<const std::byte> peek()
+   {
+      size_t tail = m_consumer.tail.load( std::memory_order_relaxed );
+      if( !_hasRecord( tail ) ) return {};
+
+      uint32_t size = _readHeader( tail );
+      if( size == PADDING_FLAG )
+      {
+         // Skipping the end of the storage, the actual record starts at the beginning
+         tail += m_capacity - ( tail & m_mask );
+         m_consumer.tail.store( tail, std::memory_order_release );
+
+         if( !_hasRecord( tail ) ) return {};
+         size = _readHeader( tail );
+      }
+
+      return { m_bytes.get() + ( tail & m_mask ) + HEADER_SIZE, size };
+   }
+
+   // Consumes the record returned by the last peek
+   void pop()
+   {
+      const size_t tail   = m_consumer.tail.load( std::memory_order_relaxed );
+      const uint32_t size = _readHeader( tail );
+      m_consumer.tail.store( tail + _alignedRecordSize( size ), std::memory_order_release );
+   }
+
+   // Copies the next record out, returns its size or 0 if there was nothing to read. Returns the
+   // required size without consuming anything if the destination is too small
+   size_t tryRead( void* dst, size_t dstSize )
+   {
+      const std::span<const std::byte> record = peek();
+      if( record.empty() ) return 0;
+      if( record.size() > dstSize ) return record.size();
+
+      memcpy( dst, record.data(), record.size() );
+      pop();
+      return record.size();
+   }
+
+  private:
+   static constexpr size_t RECORD_ALIGNMENT = 8;
+   static constexpr size_t HEADER_SIZE      = RECORD_ALIGNMENT;  // Keeping the payload aligned
+   static constexpr uint32_t PADDING_FLAG   = 0xFFFFFFFF;
+   static constexpr uint32_t INVALID_SIZE   = 0xFFFFFFFF;
+
+   static size_t _alignedRecordSize( size_t size )
+   {
+      return ( HEADER_SIZE + size + RECORD_ALIGNMENT - 1 ) & ~( RECORD_ALIGNMENT - 1 );
+   }
+
+   void _writeHeader( size_t position, uint32_t size )
+   {
+      memcpy( m_bytes.get() + ( position & m_mask ), &size, sizeof( size ) );
+   }
+
+   uint32_t _readHeader( size_t position ) const
+   {
+      uint32_t size;
+      memcpy( &size, m_bytes.get() + ( position & m_mask ), sizeof( size ) );
+      return size;
+   }
+
+   bool _hasRoom( size_t head, size_t count )
+   {
+      if( m_capacity - ( head - m_producer.cachedTail ) >= count ) return true;
+
+      m_producer.cachedTail = m_consumer.tail.load( std::memory_order_acquire );
+      return m_capacity - ( head - m_producer.cachedTail ) >= count;
+   }
+
+   bool _hasRecord( size_t tail )
+   {
+      if( m_consumer.cachedHead != tail ) return true;
+
+      m_consumer.cachedHead = m_producer.head.load( std::memory_order_acquire );
+      return m_consumer.cachedHead != tail;
+   }
+
+   struct alignas( CACHE_LINE_SIZE ) Producer
+   {
+      std::atomic<size_t> head = 0;
+      size_t cachedTail        = 0;
+      size_t pendingStart      = 0;
+      uint32_t pendingSize     = INVALID_SIZE;
+   };
+
+   struct alignas( CACHE_LINE_SIZE ) Consumer
+   {
+      std::atomic<size_t> tail = 0;
+      size_t cachedHead        = 0;
+   };
+
+   Producer m_producer;
+   Consumer m_consumer;
+
+   alignas( CACHE_LINE_SIZE ) size_t m_capacity = 0;
+   size_t m_mask = 0;
+   std::unique_ptr<std::byte[]> m_bytes;
+};
+}
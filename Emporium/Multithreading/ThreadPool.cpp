@@ -1,34 +1,249 @@
 #include <Multithreading/ThreadPool.h>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#if defined( _WIN32 )
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined( __linux__ )
+#include <pthread.h>
+#endif
+
 namespace EMP
 {
+// Starvation limits, a task that waited longer than this is picked before higher priority lanes.
+// Frame critical work is always picked first, a starved lane never overtakes it
+static constexpr std::array<std::chrono::milliseconds, 4> MAX_LANE_WAIT = {
+    std::chrono::milliseconds( 0 ),    // FRAME_CRITICAL
+    std::chrono::milliseconds( 8 ),    // NORMAL
+    std::chrono::milliseconds( 100 ),  // BACKGROUND
+    std::chrono::milliseconds( 33 ),   // IO
+};
+
+static void PinThreadToCore( std::thread& thread, uint32_t core )
+{
+#if defined( _WIN32 )
+   SetThreadAffinityMask( thread.native_handle(), DWORD_PTR( 1 ) << core );
+#elif defined( __linux__ )
+   cpu_set_t cpuSet;
+   CPU_ZERO( &cpuSet );
+   CPU_SET( core, &cpuSet );
+   pthread_setaffinity_np( thread.native_handle(), sizeof( cpu_set_t ), &cpuSet );
+#else
+   (void)thread;
+   (void)core;
+#endif
+}
+
 ThreadPool::ThreadPool() : m_shutdown( false ) {}
 
-void ThreadPool::init( int numberOfThreads )
+void ThreadPool::init( int numberOfThreads, bool pinThreads )
 {
+   m_shutdown     = false;
+   m_mainThreadId = std::this_thread::get_id();
+
+   // Leaving room for other lanes even when all IO tasks are blocked
+   m_maxIOTasks = std::max( 1, numberOfThreads / 2 );
+
+   // Long running work never holds every worker, one is always free for the frame
+   m_maxLongRunningTasks = std::max( 0, numberOfThreads - 1 );
+
+   const uint32_t coreCount = std::max( 1u, std::thread::hardware_concurrency() );
+
    m_threads.resize( numberOfThreads );
-   for( int i = 0; i < m_threads.size(); i++ )
+   for( uint32_t i = 0; i < m_threads.size(); i++ )
    {
       m_threads[i] = std::thread( ThreadWorker( this, i ) );
+
+      if( pinThreads && coreCount > 1 )
+      {
+         // Core 0 is left to the main thread
+         PinThreadToCore( m_threads[i], 1 + ( i % ( coreCount - 1 ) ) );
+      }
    }
 }
 
 void ThreadPool::shutdown()
 {
-   m_shutdown = true;
+   {
+      std::unique_lock<std::mutex> lock( m_conditionalMutex );
+      m_shutdown = true;
+   }
    m_conditionalLock.notify_all();
 
-   for( int i = 0; i < m_threads.size(); ++i )
+   for( uint32_t i = 0; i < m_threads.size(); ++i )
    {
       if( m_threads[i].joinable() )
       {
          m_threads[i].join();
       }
    }
+
+   m_threads.clear();
 }
 
 ThreadPool::~ThreadPool() { shutdown(); }
 
+void ThreadPool::pumpMainThread()
+{
+   // Only running what was there when we started so that tasks resubmitting themselves do not
+   // keep the main thread here forever
+   int taskCount = m_mainThreadQueue.size();
+
+   Task task;
+   while( taskCount-- > 0 && m_mainThreadQueue.dequeue( task ) )
+   {
+      m_mainThreadStats.add( Clock::now() - task.enqueueTime );
+      task.function();
+   }
+}
+
+void ThreadPool::parallelFor(
+    Lane lane,
+    uint32_t count,
+    const std::function<void( uint32_t )>& body )
+{
+   if( count == 0 ) return;
+
+   struct Work
+   {
+      std::atomic<uint32_t> next = 0;
+      std::atomic<uint32_t> done = 0;
+      uint32_t count             = 0;
+
+      // Only used while there are indices left, the helpers starting late do not touch it
+      const std::function<void( uint32_t )>* body = nullptr;
+   };
+
+   auto work   = std::make_shared<Work>();
+   work->count = count;
+   work->body  = &body;
+
+   auto run = [work]()
+   {
+      for( uint32_t idx = work->next++; idx < work->count; idx = work->next++ )
+      {
+         ( *work->body )( idx );
+
+         if( ++work->done == work->count )
+         {
+            work->done.notify_all();
+         }
+      }
+   };
+
+   const uint32_t helperCount = std::min( getThreadCount(), count - 1 );
+   for( uint32_t i = 0; i < helperCount; ++i )
+   {
+      submit( lane, run );
+   }
+
+   run();
+
+   for( uint32_t done = work->done; done < count; done = work->done )
+   {
+      work->done.wait( done );
+   }
+}
+
+ThreadPool::LaneStats ThreadPool::getLaneStats( Lane lane ) const
+{
+   const uint32_t laneIdx = static_cast<uint32_t>( lane );
+
+   std::unique_lock<std::mutex> lock( m_conditionalMutex );
+   return m_laneStats[laneIdx].get( static_cast<uint32_t>( m_lanes[laneIdx].size() ) );
+}
+
+ThreadPool::LaneStats ThreadPool::getMainThreadStats() const
+{
+   return m_mainThreadStats.get( static_cast<uint32_t>( m_mainThreadQueue.size() ) );
+}
+
+void ThreadPool::resetStats()
+{
+   {
+      std::unique_lock<std::mutex> lock( m_conditionalMutex );
+      m_laneStats = {};
+   }
+
+   m_mainThreadStats = {};
+}
+
+void ThreadPool::StatsAccumulator::add( Clock::duration wait )
+{
+   executed++;
+   totalWait += wait;
+   maxWait = std::max( maxWait, wait );
+}
+
+ThreadPool::LaneStats ThreadPool::StatsAccumulator::get( uint32_t queueDepth ) const
+{
+   using Milliseconds = std::chrono::duration<double, std::milli>;
+
+   LaneStats stats;
+   stats.queueDepth    = queueDepth;
+   stats.executed      = executed;
+   stats.averageWaitMs = executed ? Milliseconds( totalWait ).count() / executed : 0.0;
+   stats.maxWaitMs     = Milliseconds( maxWait ).count();
+   return stats;
+}
+
+bool ThreadPool::_isLaneAvailable( Lane lane ) const
+{
+   if( lane != Lane::BACKGROUND && lane != Lane::IO ) return true;
+
+   // No worker to spare, long running work only starts when no frame work is waiting
+   if( m_maxLongRunningTasks == 0 )
+   {
+      return m_lanes[static_cast<uint32_t>( Lane::FRAME_CRITICAL )].empty() &&
+             m_lanes[static_cast<uint32_t>( Lane::NORMAL )].empty();
+   }
+
+   if( m_runningBackgroundTasks + m_runningIOTasks >= m_maxLongRunningTasks ) return false;
+
+   return lane != Lane::IO || m_runningIOTasks < m_maxIOTasks;
+}
+
+ThreadPool::Lane ThreadPool::_selectLane( Clock::time_point now ) const
+{
+   static_assert( MAX_LANE_WAIT.size() == LANE_COUNT );
+
+   if( !m_lanes[static_cast<uint32_t>( Lane::FRAME_CRITICAL )].empty() )
+   {
+      return Lane::FRAME_CRITICAL;
+   }
+
+   Lane highestPriority = Lane::COUNT;
+   Lane mostStarved     = Lane::COUNT;
+   Clock::duration mostOverdue( 0 );
+
+   for( uint32_t i = 0; i < LANE_COUNT; ++i )
+   {
+      const std::deque<Task>& queue = m_lanes[i];
+      if( queue.empty() ) continue;
+      if( !_isLaneAvailable( Lane( i ) ) ) continue;
+
+      if( highestPriority == Lane::COUNT )
+      {
+         highestPriority = Lane( i );
+         continue;
+      }
+
+      // Lower priority lane, check whether its oldest task has been waiting for too long
+      const Clock::duration overdue = ( now - queue.front().enqueueTime ) - MAX_LANE_WAIT[i];
+      if( overdue > mostOverdue )
+      {
+         mostOverdue = overdue;
+         mostStarved = Lane( i );
+      }
+   }
+
+   return mostStarved != Lane::COUNT ? mostStarved : highestPriority;
+}
+
 ThreadPool::ThreadWorker::ThreadWorker( ThreadPool* threadPool, const int threadIdx )
     : m_threadPool( threadPool ), m_threadIdx( threadIdx )
 {
@@ -36,22 +251,50 @@ ThreadPool::ThreadWorker::ThreadWorker( ThreadPool* threadPool, const int thread
 
 void ThreadPool::ThreadWorker::operator()()
 {
-   std::function<void()> function;
-   bool dequeued;
-   while( !m_threadPool->m_shutdown )
+   ThreadPool& pool = *m_threadPool;
+
+   Task task;
+   while( true )
    {
+      Lane lane = Lane::COUNT;
       {
-         std::unique_lock<std::mutex> lock( m_threadPool->m_conditionalMutex );
-         if( m_threadPool->m_queue.empty() )
-         {
-            m_threadPool->m_conditionalLock.wait( lock );
-         }
-         dequeued = m_threadPool->m_queue.dequeue( function );
+         std::unique_lock<std::mutex> lock( pool.m_conditionalMutex );
+         pool.m_conditionalLock.wait(
+             lock,
+             [&]()
+             {
+                if( pool.m_shutdown ) return true;
+                lane = pool._selectLane( Clock::now() );
+                return lane != Lane::COUNT;
+             } );
+
+         if( pool.m_shutdown ) return;
+
+         const uint32_t laneIdx  = static_cast<uint32_t>( lane );
+         std::deque<Task>& queue = pool.m_lanes[laneIdx];
+
+         task = std::move( queue.front() );
+         queue.pop_front();
+
+         pool.m_laneStats[laneIdx].add( Clock::now() - task.enqueueTime );
+         if( lane == Lane::IO ) pool.m_runningIOTasks++;
+         if( lane == Lane::BACKGROUND ) pool.m_runningBackgroundTasks++;
       }
-      if( dequeued )
+
+      task.function();
+      task.function = nullptr;
+
+      if( lane == Lane::IO || lane == Lane::BACKGROUND )
       {
-         function();
+         {
+            std::unique_lock<std::mutex> lock( pool.m_conditionalMutex );
+            if( lane == Lane::IO ) pool.m_runningIOTasks--;
+            if( lane == Lane::BACKGROUND ) pool.m_runningBackgroundTasks--;
+         }
+
+         // A long running task might have been held back by the limits
+         pool.m_conditionalLock.notify_one();
       }
    }
 }
-}
\ No newline at end of file
+}
@@ -2,6 +2,10 @@
 
 #include <Multithreading/ThreadSafeQueue.h>
 
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <thread>
 #include <functional>
 #include <future>
@@ -11,6 +15,28 @@ namespace EMP
 class ThreadPool
 {
   public:
+   // Work submitted to the workers is sorted in lanes. Lanes are served in this order, a task that
+   // waited longer than the starvation limit of its lane jumps ahead of higher priority lanes, but
+   // never ahead of frame critical work. Background and IO tasks together leave at least one worker
+   // free for the frame. With a single worker, they only start when no frame critical or normal
+   // task is waiting, but a running one still holds the worker until it is done
+   enum class Lane : uint32_t
+   {
+      FRAME_CRITICAL,  // Needs to be done before the end of the current frame
+      NORMAL,
+      BACKGROUND,  // Long running work like noise baking or mesh decoding
+      IO,          // Blocking file reads/writes, only a part of the workers can run these at once
+      COUNT
+   };
+
+   struct LaneStats
+   {
+      uint32_t queueDepth = 0;  // Tasks waiting to be picked up
+      uint64_t executed   = 0;  // Tasks picked up since the last stats reset
+      double averageWaitMs = 0.0;
+      double maxWaitMs     = 0.0;
+   };
+
    ThreadPool();
 
    ThreadPool( const ThreadPool& ) = delete;
@@ -19,31 +45,86 @@ class ThreadPool
    ThreadPool& operator=( ThreadPool&& ) = delete;
    ~ThreadPool();
 
-   // Initialize or shutdown the threadpool
-   void init( int numberOfThreads );
+   // Initialize or shutdown the threadpool. Workers can be pinned to a core each, skipping the
+   // first core which is left to the main thread. The calling thread is considered the main thread
+   void init( int numberOfThreads, bool pinThreads = false );
    void shutdown();
 
    bool isInit() const { return !m_threads.empty(); }
+   uint32_t getThreadCount() const { return static_cast<uint32_t>( m_threads.size() ); }
 
    // Submit work to the threadpool
    template <typename F, typename... Args>
    auto submit( F&& f, Args&&... args ) -> std::future<decltype( f( args... ) )>
    {
-      std::function<decltype( f( args... ) )()> func =
-          std::bind( std::forward<F>( f ), std::forward<Args>( args )... );
-
-      auto taskPtr = std::make_shared<std::packaged_task<decltype( f( args... ) )()>>( func );
+      return submit( Lane::NORMAL, std::forward<F>( f ), std::forward<Args>( args )... );
+   }
 
-      std::function<void()> voidFunc = [taskPtr]() { ( *taskPtr )(); };
+   template <typename F, typename... Args>
+   auto submit( Lane lane, F&& f, Args&&... args ) -> std::future<decltype( f( args... ) )>
+   {
+      std::function<void()> voidFunc;
+      auto future = _package( voidFunc, std::forward<F>( f ), std::forward<Args>( args )... );
 
-      m_queue.enqueue( voidFunc );
+      {
+         std::unique_lock<std::mutex> lock( m_conditionalMutex );
+         std::deque<Task>& queue = m_lanes[static_cast<uint32_t>( lane )];
+         queue.push_back( { std::move( voidFunc ), Clock::now() } );
+      }
 
       m_conditionalLock.notify_one();
 
-      return taskPtr->get_future();
+      return future;
+   }
+
+   // Runs the body for every index in [0, count) on the workers and on the calling thread. The
+   // calling thread takes indices too and only waits for the ones a worker already started, so it
+   // is never stuck behind the queue, even when it is a worker itself. Without workers, everything
+   // runs on the calling thread
+   void parallelFor( Lane lane, uint32_t count, const std::function<void( uint32_t )>& body );
+
+   // Submit work that needs to run on the main thread (e.g. anything touching the window). It is
+   // executed the next time the main thread pumps the queue, once per frame
+   template <typename F, typename... Args>
+   auto submitToMainThread( F&& f, Args&&... args ) -> std::future<decltype( f( args... ) )>
+   {
+      std::function<void()> voidFunc;
+      auto future = _package( voidFunc, std::forward<F>( f ), std::forward<Args>( args )... );
+
+      m_mainThreadQueue.enqueue( Task{ std::move( voidFunc ), Clock::now() } );
+
+      return future;
    }
 
+   // Runs the main thread work that was submitted before this call. Work submitted by these tasks
+   // is left for the next pump
+   void pumpMainThread();
+
+   bool isMainThread() const { return std::this_thread::get_id() == m_mainThreadId; }
+
+   LaneStats getLaneStats( Lane lane ) const;
+   LaneStats getMainThreadStats() const;
+   void resetStats();
+
   private:
+   using Clock = std::chrono::steady_clock;
+
+   struct Task
+   {
+      std::function<void()> function;
+      Clock::time_point enqueueTime;
+   };
+
+   struct StatsAccumulator
+   {
+      uint64_t executed         = 0;
+      Clock::duration totalWait = {};
+      Clock::duration maxWait   = {};
+
+      void add( Clock::duration wait );
+      LaneStats get( uint32_t queueDepth ) const;
+   };
+
    class ThreadWorker
    {
      public:
@@ -51,14 +132,43 @@ class ThreadPool
       void operator()();
 
      private:
-      int m_threadIdx;
       ThreadPool* m_threadPool;
+      int m_threadIdx;
    };
 
+   template <typename F, typename... Args>
+   static auto _package( std::function<void()>& voidFunc, F&& f, Args&&... args )
+       -> std::future<decltype( f( args... ) )>
+   {
+      std::function<decltype( f( args... ) )()> func =
+          std::bind( std::forward<F>( f ), std::forward<Args>( args )... );
+
+      auto taskPtr = std::make_shared<std::packaged_task<decltype( f( args... ) )()>>( func );
+
+      voidFunc = [taskPtr]() { ( *taskPtr )(); };
+
+      return taskPtr->get_future();
+   }
+
+   // Need the lock. Returns the lane to pick from or Lane::COUNT if nothing can run right now
+   Lane _selectLane( Clock::time_point now ) const;
+   bool _isLaneAvailable( Lane lane ) const;
+
+   static constexpr uint32_t LANE_COUNT = static_cast<uint32_t>( Lane::COUNT );
+
    bool m_shutdown;
    std::condition_variable m_conditionalLock;
-   std::mutex m_conditionalMutex;
-   ThreadSafeQueue<std::function<void()>> m_queue;
+   mutable std::mutex m_conditionalMutex;
+   std::array<std::deque<Task>, LANE_COUNT> m_lanes;
+   std::array<StatsAccumulator, LANE_COUNT> m_laneStats;
+   uint32_t m_runningIOTasks         = 0;
+   uint32_t m_runningBackgroundTasks = 0;
+   uint32_t m_maxIOTasks             = 1;
+   uint32_t m_maxLongRunningTasks    = 0;  // Background and IO tasks running at once
    std::vector<std::thread> m_threads;
+
+   std::thread::id m_mainThreadId;
+   ThreadSafeQueue<Task> m_mainThreadQueue;
+   StatsAccumulator m_mainThreadStats;  // Only touched by the main thread
 };
-}
\ No newline at end of file
+}
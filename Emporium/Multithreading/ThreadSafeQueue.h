@@ -13,13 +13,13 @@ class ThreadSafeQueue
 
    ~ThreadSafeQueue() = default;
 
-   bool empty()
+   bool empty() const
    {
       std::unique_lock<std::mutex> lock( _mutex );
       return m_queue.empty();
    }
 
-   int size()
+   int size() const
    {
       std::unique_lock<std::mutex> lock( _mutex );
       return m_queue.size();
@@ -31,6 +31,12 @@ class ThreadSafeQueue
       m_queue.push( elem );
    }
 
+   void enqueue( T&& elem )
+   {
+      std::unique_lock<std::mutex> lock( _mutex );
+      m_queue.push( std::move( elem ) );
+   }
+
    bool dequeue( T& elem )
    {
       std::unique_lock<std::mutex> lock( _mutex );
@@ -46,7 +52,7 @@ class ThreadSafeQueue
    }
 
   private:
-   std::mutex _mutex;
+   mutable std::mutex _mutex;
    std::queue<T> m_queue;
 };
 }
\ No newline at end of file
@@ -0,0 +1,253 @@
+#include <Multithreading/TimerWheel.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace EMP
+{
+TimerWheel::TimerWheel() { m_slots.fill( INVALID_INDEX ); }
+
+TimerWheel::Handle TimerWheel::schedule( uint64_t delay, Callback callback )
+{
+   return schedulePeriodic( 0, std::move( callback ), delay );
+}
+
+TimerWheel::Handle TimerWheel::schedulePeriodic( uint64_t period, Callback callback )
+{
+   return schedulePeriodic( period, std::move( callback ), period );
+}
+
+TimerWheel::Handle
+TimerWheel::schedulePeriodic( uint64_t period, Callback callback, uint64_t firstDelay )
+{
+   assert( callback && "TimerWheel: Scheduling an empty callback" );
+
+   const uint32_t index = _allocate();
+
+   Timer& timer   = m_timers[index];
+   timer.callback = std::move( callback );
+   timer.period   = period;
+   timer.state    = State::SCHEDULED;
+
+   // Timers always fire on a later tick, never while the current one is being processed
+   timer.expiry = m_now + std::max<uint64_t>( firstDelay, 1 );
+
+   _link( index );
+
+   return { index, timer.generation };
+}
+
+TimerWheel::Handle TimerWheel::schedule(
+    uint64_t delay,
+    ThreadPool& pool,
+    ThreadPool::Lane lane,
+    Callback callback )
+{
+   return schedule(
+       delay, [&pool, lane, callback = std::move( callback )]() { pool.submit( lane, callback ); } );
+}
+
+TimerWheel::Handle TimerWheel::schedulePeriodic(
+    uint64_t period,
+    ThreadPool& pool,
+    ThreadPool::Lane lane,
+    Callback callback )
+{
+   return schedulePeriodic(
+       period,
+       [&pool, lane, callback = std::move( callback )]() { pool.submit( lane, callback ); } );
+}
+
+bool TimerWheel::cancel( Handle handle )
+{
+   if( !isScheduled( handle ) ) return false;
+
+   Timer& timer = m_timers[handle.index];
+   if( timer.state == State::FIRING )
+   {
+      // Freed once its callback returns
+      timer.state = State::CANCELLED;
+      return true;
+   }
+
+   _unlink( handle.index );
+   _free( handle.index );
+
+   return true;
+}
+
+bool TimerWheel::isScheduled( Handle handle ) const
+{
+   if( handle.index >= m_timers.size() ) return false;
+
+   const Timer& timer = m_timers[handle.index];
+   return timer.generation == handle.generation &&
+          ( timer.state == State::SCHEDULED || timer.state == State::FIRING );
+}
+
+void TimerWheel::advance( uint64_t ticks ) { advanceTo( m_now + ticks ); }
+
+void TimerWheel::advanceTo( uint64_t now )
+{
+   while( m_now < now )
+   {
+      if( m_timerCount == 0 )
+      {
+         // Nothing can expire on the way
+         m_now = now;
+         return;
+      }
+
+      _tick();
+   }
+}
+
+void TimerWheel::_tick()
+{
+   m_now++;
+
+   // Bringing down the timers of the higher levels that now fall within range of a lower level
+   for( uint32_t level = 1; level < LEVEL_COUNT; ++level )
+   {
+      const uint64_t levelMask = ( uint64_t( 1 ) << ( SLOT_BITS * level ) ) - 1;
+      if( ( m_now & levelMask ) != 0 ) break;
+
+      _cascade( level );
+   }
+
+   // Everything left in the current slot of the first level expires now. Timers scheduled or
+   // rescheduled by the callbacks always land in another slot
+   uint32_t& head = m_slots[m_now & SLOT_MASK];
+   while( head != INVALID_INDEX )
+   {
+      _fire( head );
+   }
+}
+
+void TimerWheel::_cascade( uint32_t level )
+{
+   const uint32_t slot = level * SLOT_COUNT + ( ( m_now >> ( SLOT_BITS * level ) ) & SLOT_MASK );
+
+   uint32_t index = m_slots[slot];
+   m_slots[slot]  = INVALID_INDEX;
+
+   while( index != INVALID_INDEX )
+   {
+      const uint32_t next = m_timers[index].next;
+      _link( index );
+      index = next;
+   }
+}
+
+void TimerWheel::_fire( uint32_t index )
+{
+   _unlink( index );
+
+   // The callback can schedule other timers and grow the storage, not keeping references around
+   Callback callback = std::move( m_timers[index].callback );
+
+   if( m_timers[index].period == 0 )
+   {
+      _free( index );
+      callback();
+      return;
+   }
+
+   m_timers[index].state = State::FIRING;
+
+   callback();
+
+   Timer& timer = m_timers[index];
+   if( timer.state == State::CANCELLED )
+   {
+      _free( index );
+      return;
+   }
+
+   timer.callback = std::move( callback );
+   timer.expiry   = m_now + timer.period;
+   timer.state    = State::SCHEDULED;
+   _link( index );
+}
+
+void TimerWheel::_link( uint32_t index )
+{
+   Timer& timer = m_timers[index];
+
+   // Picking the first level whose range covers the time left, far timers are parked at the end
+   // of the last level's range and get cascaded again until they are close enough
+   const uint64_t delta  = std::min( timer.expiry - m_now, MAX_DELTA - 1 );
+   const uint64_t expiry = m_now + delta;
+
+   uint32_t level = 0;
+   while( delta >> ( SLOT_BITS * ( level + 1 ) ) )
+   {
+      level++;
+   }
+
+   timer.slot = level * SLOT_COUNT + ( ( expiry >> ( SLOT_BITS * level ) ) & SLOT_MASK );
+   timer.prev = INVALID_INDEX;
+   timer.next = m_slots[timer.slot];
+
+   if( timer.next != INVALID_INDEX )
+   {
+      m_timers[timer.next].prev = index;
+   }
+
+   m_slots[timer.slot] = index;
+}
+
+void TimerWheel::_unlink( uint32_t index )
+{
+   Timer& timer = m_timers[index];
+
+   if( timer.prev != INVALID_INDEX )
+   {
+      m_timers[timer.prev].next = timer.next;
+   }
+   else
+   {
+      m_slots[timer.slot] = timer.next;
+   }
+
+   if( timer.next != INVALID_INDEX )
+   {
+      m_timers[timer.next].prev = timer.prev;
+   }
+
+   timer.prev = INVALID_INDEX;
+   timer.next = INVALID_INDEX;
+   timer.slot = INVALID_INDEX;
+}
+
+uint32_t TimerWheel::_allocate()
+{
+   m_timerCount++;
+
+   if( m_firstFree != INVALID_INDEX )
+   {
+      const uint32_t index = m_firstFree;
+      m_firstFree          = m_timers[index].next;
+      m_timers[index].next = INVALID_INDEX;
+      return index;
+   }
+
+   assert( m_timers.size() < INVALID_INDEX && "TimerWheel: Ran out of timer handles" );
+
+   m_timers.emplace_back();
+   return static_cast<uint32_t>( m_timers.size() - 1 );
+}
+
+void TimerWheel::_free( uint32_t index )
+{
+   Timer& timer   = m_timers[index];
+   timer.callback = nullptr;
+   timer.state    = State::FREE;
+   timer.generation++;  // Invalidates the handles still pointing to this timer
+
+   timer.next  = m_firstFree;
+   m_firstFree = index;
+
+   m_timerCount--;
+}
+}
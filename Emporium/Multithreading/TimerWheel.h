@@ -0,0 +1,113 @@
+#pragma once
+
+#include <Multithreading/ThreadPool.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace EMP
+{
+// Hierarchical timer wheel. Callbacks are scheduled a number of ticks in the future, what a tick
+// represents is up to whoever advances the wheel (a frame, a millisecond...). Scheduling and
+// cancelling are O(1) and advancing an empty wheel costs nothing, so deferred or low-rate work can
+// be scheduled instead of polled every frame.
+//
+// The wheel is not thread safe. Callbacks run on the thread that advances it, other threads can
+// go through ThreadPool::submitToMainThread to schedule timers on a wheel owned by the main thread
+class TimerWheel
+{
+  public:
+   using Callback = std::function<void()>;
+
+   struct Handle
+   {
+      uint32_t index      = INVALID_INDEX;
+      uint32_t generation = 0;
+
+      bool isValid() const { return index != INVALID_INDEX; }
+   };
+
+   TimerWheel();
+   TimerWheel( const TimerWheel& ) = delete;
+   TimerWheel& operator=( const TimerWheel& ) = delete;
+   ~TimerWheel() = default;
+
+   // Calls the callback once, delay ticks from now. A delay of 0 fires on the next advance
+   Handle schedule( uint64_t delay, Callback callback );
+
+   // Calls the callback every period ticks, starting firstDelay ticks from now
+   Handle schedulePeriodic( uint64_t period, Callback callback, uint64_t firstDelay );
+   Handle schedulePeriodic( uint64_t period, Callback callback );
+
+   // Same as above but the callback is submitted to a lane of the threadpool when the timer fires
+   // instead of running on the thread advancing the wheel
+   Handle schedule( uint64_t delay, ThreadPool& pool, ThreadPool::Lane lane, Callback callback );
+   Handle schedulePeriodic(
+       uint64_t period,
+       ThreadPool& pool,
+       ThreadPool::Lane lane,
+       Callback callback );
+
+   // Returns false if the timer already fired or was already cancelled. A periodic timer can
+   // cancel itself from its own callback
+   bool cancel( Handle handle );
+   bool isScheduled( Handle handle ) const;
+
+   // Moves the wheel forward, firing every timer that expires on the way in expiration order
+   void advance( uint64_t ticks = 1 );
+   void advanceTo( uint64_t now );
+
+   uint64_t getNow() const { return m_now; }
+   uint32_t getTimerCount() const { return m_timerCount; }
+
+  private:
+   static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+   static constexpr uint32_t SLOT_BITS   = 6;
+   static constexpr uint32_t SLOT_COUNT  = 1 << SLOT_BITS;
+   static constexpr uint32_t SLOT_MASK   = SLOT_COUNT - 1;
+   static constexpr uint32_t LEVEL_COUNT = 4;
+
+   // Timers further than this are parked in the last level and cascaded again until they are close
+   static constexpr uint64_t MAX_DELTA = uint64_t( 1 ) << ( SLOT_BITS * LEVEL_COUNT );
+
+   enum class State : uint8_t
+   {
+      FREE,
+      SCHEDULED,
+      FIRING,    // Its callback is currently running
+      CANCELLED  // Cancelled from its own callback
+   };
+
+   struct Timer
+   {
+      Callback callback;
+      uint64_t expiry     = 0;
+      uint64_t period     = 0;
+      uint32_t prev       = INVALID_INDEX;
+      uint32_t next       = INVALID_INDEX;  // Also used to chain free timers
+      uint32_t slot       = INVALID_INDEX;  // Index in m_slots of the list it belongs to
+      uint32_t generation = 0;
+      State state         = State::FREE;
+   };
+
+   uint32_t _allocate();
+   void _free( uint32_t index );
+
+   void _link( uint32_t index );
+   void _unlink( uint32_t index );
+
+   void _cascade( uint32_t level );
+   void _fire( uint32_t index );
+   void _tick();
+
+   std::vector<Timer> m_timers;
+   std::array<uint32_t, SLOT_COUNT * LEVEL_COUNT> m_slots;  // Head of the list of each slot
+
+   uint64_t m_now        = 0;
+   uint32_t m_firstFree  = INVALID_INDEX;
+   uint32_t m_timerCount = 0;
+};
+}
@@ -1,8 +1,12 @@
 #include <Application.h>
 
+#include <Graphics/Utility/GraphicsIO.h>
+
 #include <Input/GLFWWindow.h>
 
+#include <IO/VirtualFileSystem.h>
 #include <Multithreading/ThreadPool.h>
+#include <Multithreading/TimerWheel.h>
 
 #include <Profiling.h>
 
@@ -11,14 +15,22 @@
 
 namespace CYD
 {
+// Packed by the asset packer next to the executable
+static constexpr char ASSET_ARCHIVE_PATH[] = "Assets.cydpak";
+
 Application::Application( uint32_t width, uint32_t height, const char* title )
 {
+   // Assets are read from the archive when there is one, from loose files otherwise
+   GraphicsIO::GetFileSystem().mount( ASSET_ARCHIVE_PATH );
+
    // Create window
    m_window = std::make_unique<Window>();
    m_window->init( width, height, title );
 
    m_threadPool = std::make_unique<EMP::ThreadPool>();
    m_threadPool->init( std::thread::hardware_concurrency() );
+
+   m_frameTimers = std::make_unique<EMP::TimerWheel>();
 }
 
 void Application::startLoop()
@@ -39,6 +51,12 @@ void Application::startLoop()
 
       Trace::FrameStart();  // Profiling
 
+      // Work that other threads need done on the main thread
+      m_threadPool->pumpMainThread();
+
+      // Deferred and periodic work that expired since the last frame
+      m_frameTimers->advance();
+
       // User overloaded tick
       tick( deltaS.count() );
 
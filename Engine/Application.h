@@ -16,6 +16,7 @@ class Window;
 namespace EMP
 {
 class ThreadPool;
+class TimerWheel;
 }
 
 // =================================================================================================
@@ -40,6 +41,10 @@ class Application
    std::unique_ptr<Window> m_window;
    std::unique_ptr<EMP::ThreadPool> m_threadPool;
 
+   // Deferred and periodic work, advanced by the main loop once per frame before every tick.
+   // Callbacks run on the main thread unless they were scheduled on a threadpool lane
+   std::unique_ptr<EMP::TimerWheel> m_frameTimers;
+
   private:
    bool m_running = false;
 };
@@ -6,13 +6,14 @@
 #include "../NOISE.h"
 
 layout( set = 0, binding = 0 ) uniform Views { View views[MAX_VIEWS]; };
+layout( set = 0, binding = 3 ) uniform ShadowCascades { ShadowCascadesData shadowCascades; };
 layout( set = 1, binding = 0 ) uniform Lights { Light lights[MAX_LIGHTS]; };
 layout( set = 1, binding = 1 ) uniform sampler2DShadow shadowMap;
 layout( set = 1, binding = 5 ) uniform sampler2D displacementMap;
 
 layout( location = 0 ) in vec2 inUV;
 layout( location = 1 ) in vec3 inWorldPos;
-layout( location = 2 ) in vec3 inShadowCoord;
+layout( location = 2 ) in float inViewDepth;
 
 layout( location = 0 ) out vec4 outColor;
 
@@ -42,7 +43,8 @@ void main()
    // Factors
    // ============================================================================================
    const float fakeFresnel = pow( clamp( 1.0 - dot( N, -V ), 0.0, 1.0 ), 1.0 );
-   const float shadow      = ShadowPCF( shadowMap, inShadowCoord );
+   const float shadow =
+       CascadedShadowPCF( shadowMap, shadowCascades, inWorldPos, inViewDepth );
 
    // Foam
    // ============================================================================================
@@ -16,6 +16,16 @@ struct Light
 
 const float PI = 3.141592653589793;
 
+// ================================================================================================
+// Keep these defines and structs in sync with "ShadowCascadesShaderParams"
+#define MAX_SHADOW_CASCADES 4
+
+struct ShadowCascadesData
+{
+   mat4 worldToShadow[MAX_SHADOW_CASCADES];  // World space to shadow map UV and depth
+   vec4 splits;                              // View depth where each cascade ends
+};
+
 // ================================================================================================
 
 vec3 GammaToLinear( vec3 color )
@@ -106,4 +116,25 @@ float ShadowPCF( sampler2DShadow shadowMap, vec3 shadowCoords )
    */
 
    return shadow;
+}
+
+float CascadedShadowPCF(
+    sampler2DShadow shadowMap,
+    ShadowCascadesData cascades,
+    vec3 worldPos,
+    float viewDepth )
+{
+   // The cascades are in the same shadow map, the first one whose split contains the fragment is
+   // the one with the most resolution
+   for( int i = 0; i < MAX_SHADOW_CASCADES; ++i )
+   {
+      if( viewDepth < cascades.splits[i] )
+      {
+         const vec4 shadowCoords = cascades.worldToShadow[i] * vec4( worldPos, 1.0 );
+         return ShadowPCF( shadowMap, shadowCoords.xyz );
+      }
+   }
+
+   // Past the shadow distance
+   return 1.0;
 }
\ No newline at end of file
@@ -0,0 +1,12 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// Static casters of the cascade, at the same texels as the square it is copied to
+layout(set = 0, binding = 0) uniform sampler2D staticShadowMap;
+
+// =================================================================================================
+
+void main()
+{
+    gl_FragDepth = texelFetch( staticShadowMap, ivec2( gl_FragCoord.xy ), 0 ).r;
+}
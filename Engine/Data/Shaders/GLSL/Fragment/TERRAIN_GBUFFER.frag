@@ -3,12 +3,13 @@
 
 #include "LIGHTING.h"
 
+layout( set = 0, binding = 3 ) uniform ShadowCascades { ShadowCascadesData shadowCascades; };
 layout( set = 1, binding = 1 ) uniform sampler2DShadow shadowMap;
 layout( set = 1, binding = 5 ) uniform sampler2D heightMap;
 
 layout( location = 0 ) in vec2 inUV;
 layout( location = 1 ) in vec3 inWorldPos;
-layout( location = 2 ) in vec3 inShadowCoord;
+layout( location = 2 ) in float inViewDepth;
 
 layout( location = 0 ) out vec4 outAlbedo;
 layout( location = 1 ) out vec4 outNormal;
@@ -61,8 +62,11 @@ void main()
       unlitColor = snowColor;
    }
 
+   const float shadow =
+       CascadedShadowPCF( shadowMap, shadowCascades, inWorldPos, inViewDepth );
+
    outAlbedo = vec4( unlitColor, 1.0 );
-   outShadow = vec4( ShadowPCF( shadowMap, inShadowCoord ), 0.0, 0.0, 1.0 );
+   outShadow = vec4( shadow, 0.0, 0.0, 1.0 );
    outNormal = vec4( normal, 1.0 );
    outDepth  = gl_FragCoord.z;
 }
@@ -0,0 +1,17 @@
+// VERTEX.h
+// Used in vertex shaders reading the compact vertex formats
+
+// ================================================================================================
+// Keep in sync with "EncodeOctahedral" in VertexLayout.cpp
+vec3 DecodeOctahedral( vec2 encoded )
+{
+   vec3 normal = vec3( encoded, 1.0 - abs( encoded.x ) - abs( encoded.y ) );
+
+   // The lower half of the octahedron is unfolded over the corners of the upper one
+   const float fold = max( -normal.z, 0.0 );
+   normal.x += normal.x >= 0.0 ? -fold : fold;
+   normal.y += normal.y >= 0.0 ? -fold : fold;
+
+   return normalize( normal );
+}
+// ================================================================================================
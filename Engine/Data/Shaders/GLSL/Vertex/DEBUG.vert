@@ -15,14 +15,11 @@ layout( set = 0, binding = 0 ) uniform EnvironmentView
 };
 
 layout( location = 0 ) in vec3 inPosition;
-layout( location = 1 ) in vec4 inColor;
-layout( location = 2 ) in vec3 inTexCoords;  // Unused
-layout( location = 3 ) in vec3 inNormals;    // Unused
 
 layout( location = 0 ) out vec4 outColor;
 
 void main()
 {
    gl_Position = proj * view * model * vec4( inPosition, 1.0 );
-   outColor    = inColor;
+   outColor    = vec4( 1.0 );  // The color comes from the debug parameters
 }
\ No newline at end of file
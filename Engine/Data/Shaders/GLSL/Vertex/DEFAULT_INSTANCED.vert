@@ -1,6 +1,7 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+#include "../VERTEX.h"
 #include "INSTANCING.h"
 
 layout( push_constant ) uniform PushModel { layout( offset = 0 ) mat4 modelMat; };
@@ -15,9 +16,8 @@ layout( set = 0, binding = 0 ) uniform EnvironmentView
 // Vertex Inputs
 // =================================================================================================
 layout( location = 0 ) in vec3 inPosition;
-layout( location = 1 ) in vec3 inNormal;
-layout( location = 2 ) in vec3 inTexCoord;
-layout( location = 3 ) in vec4 inColor;  // Not used
+layout( location = 1 ) in vec2 inNormal;  // Octahedral
+layout( location = 2 ) in vec2 inTexCoord;
 
 // Interpolators
 // =================================================================================================
@@ -34,8 +34,8 @@ void main()
    worldPos = vec3( finalModelMat * vec4( inPosition, 1.0 ) );  // World coordinates
    camPos   = vec3( pos );
 
-   outTexCoord = inTexCoord.xy;
-   outNormal   = normalize( vec3( finalModelMat * vec4( inNormal, 0.0 ) ) );
+   outTexCoord = inTexCoord;
+   outNormal   = normalize( vec3( finalModelMat * vec4( DecodeOctahedral( inNormal ), 0.0 ) ) );
 
    gl_Position = projMat * viewMat * vec4( worldPos, 1.0 );
 }
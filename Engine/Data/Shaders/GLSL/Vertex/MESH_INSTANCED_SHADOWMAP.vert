@@ -0,0 +1,22 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+#include "INSTANCING.h"
+
+// Constant Buffers & Uniforms
+// =================================================================================================
+layout( push_constant ) uniform PushConstant { mat4 model; };
+
+layout( set = 0, binding = 3 ) uniform ShadowView { mat4 shadowViewProj; };
+
+// Vertex Inputs
+// =================================================================================================
+layout( location = 0 ) in vec3 inPosition;  // Only the positions cast shadows
+
+// =================================================================================================
+void main()
+{
+   const mat4 instanceModel = model * mat4( instances[gl_InstanceIndex].modelMat );
+
+   gl_Position = shadowViewProj * instanceModel * vec4( inPosition, 1.0 );
+}
@@ -4,9 +4,7 @@
 // Vertex Inputs
 // =================================================================================================
 layout( location = 0 ) in vec3 inPosition;
-layout( location = 1 ) in vec3 inNormal;
-layout( location = 2 ) in vec3 inTexCoords;
-layout( location = 3 ) in vec4 inColor;  // Not used
+layout( location = 2 ) in vec2 inTexCoords;
 
 // Interpolators
 // =================================================================================================
@@ -15,6 +13,6 @@ layout( location = 0 ) out vec2 outUV;
 // =================================================================================================
 void main()
 {
-   outUV       = inTexCoords.xy;
+   outUV       = inTexCoords;
    gl_Position = vec4( inPosition, 1.0 );
 }
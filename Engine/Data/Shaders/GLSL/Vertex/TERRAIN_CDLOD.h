@@ -0,0 +1,63 @@
+// TERRAIN_CDLOD.h
+// Used by the CDLOD terrain vertex shaders
+
+// ================================================================================================
+// Keep these defines and structs in sync with "TerrainComponent" and "TerrainQuadtree::Patch"
+#define MAX_TERRAIN_LODS 12
+#define MAX_TERRAIN_PATCHES 2048
+
+struct TerrainParams
+{
+   vec4 morphRanges[MAX_TERRAIN_LODS];  // Start and inverse length of the morph of each LOD
+   vec4 viewPosition;                   // In the space of the terrain
+   float size;
+   float heightScale;
+   float gridResolution;
+   float padding;
+};
+
+struct TerrainPatch
+{
+   vec2 origin;
+   float size;
+   uint lodAndStep;  // LOD in the low byte, step between the grid vertices above it
+};
+
+layout( set = 0, binding = 1 ) uniform InstancesData
+{
+   TerrainParams terrain;
+   TerrainPatch patches[MAX_TERRAIN_PATCHES];
+};
+// ================================================================================================
+
+vec2 TerrainUV( vec2 pos ) { return ( pos + 0.5 * terrain.size ) / terrain.size; }
+
+// Position in the space of the terrain of a vertex of the patch grid. Further from the view, the
+// vertex morphs into the grid of the next LOD so that the patches of both LODs meet without cracks
+vec3 TerrainVertex( vec2 gridPos, sampler2D heightMap, out vec2 uv )
+{
+   const TerrainPatch terrainPatch = patches[gl_InstanceIndex];
+   const uint lod                  = terrainPatch.lodAndStep & 0xFF;
+   const float gridStep            = float( terrainPatch.lodAndStep >> 8 );
+   const float cellSize            = terrainPatch.size / terrain.gridResolution;
+
+   // Quarter patches only use every other vertex of the grid, the ones in between collapse
+   vec2 gridIdx = floor( gridPos * terrain.gridResolution / gridStep + 0.5 ) * gridStep;
+
+   vec2 pos     = terrainPatch.origin + gridIdx * cellSize;
+   float height = texture( heightMap, TerrainUV( pos ) ).r * terrain.heightScale;
+
+   const vec4 morphRange = terrain.morphRanges[lod];
+   const float viewDistance =
+       distance( vec3( pos.x, height, pos.y ), terrain.viewPosition.xyz );
+   const float morph = clamp( ( viewDistance - morphRange.x ) * morphRange.y, 0.0, 1.0 );
+
+   // Odd vertices of the grid slide onto the even ones
+   gridIdx -= mod( gridIdx, 2.0 * gridStep ) * morph;
+
+   pos    = terrainPatch.origin + gridIdx * cellSize;
+   uv     = TerrainUV( pos );
+   height = texture( heightMap, uv ).r * terrain.heightScale;
+
+   return vec3( pos.x, height, pos.y );
+}
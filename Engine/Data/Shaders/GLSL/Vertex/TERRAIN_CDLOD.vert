@@ -0,0 +1,36 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+#include "../VIEW.h"
+#include "TERRAIN_CDLOD.h"
+
+// Constant Buffers & Uniforms
+// =================================================================================================
+layout( push_constant ) uniform PushConstant { mat4 model; };
+
+layout( set = 0, binding = 0 ) uniform Views { View views[MAX_VIEWS]; };
+layout( set = 1, binding = 5 ) uniform sampler2D heightMap;
+
+// Vertex Inputs
+// =================================================================================================
+layout( location = 2 ) in vec2 inTexCoords;  // The positions are rebuilt from the UVs
+
+// Interpolators
+// =================================================================================================
+layout( location = 0 ) out vec2 outUV;
+layout( location = 1 ) out vec3 outWorldPos;
+layout( location = 2 ) out float outViewDepth;
+
+// =================================================================================================
+void main()
+{
+   const View mainView = views[0];
+
+   const vec3 pos = TerrainVertex( inTexCoords, heightMap, outUV );
+
+   const vec4 worldPos = model * vec4( pos, 1.0 );
+   gl_Position         = mainView.proj * mainView.view * worldPos;
+
+   outWorldPos  = worldPos.xyz;
+   outViewDepth = -( mainView.view * worldPos ).z;
+}
@@ -0,0 +1,24 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+#include "TERRAIN_CDLOD.h"
+
+// Constant Buffers & Uniforms
+// =================================================================================================
+layout( push_constant ) uniform PushConstant { mat4 model; };
+
+layout( set = 0, binding = 3 ) uniform ShadowView { mat4 shadowViewProj; };
+layout( set = 1, binding = 5 ) uniform sampler2D heightMap;
+
+// Vertex Inputs
+// =================================================================================================
+layout( location = 2 ) in vec2 inTexCoords;  // The positions are rebuilt from the UVs
+
+// =================================================================================================
+void main()
+{
+   vec2 uv;
+   const vec3 pos = TerrainVertex( inTexCoords, heightMap, uv );
+
+   gl_Position = shadowViewProj * model * vec4( pos, 1.0 );
+}
@@ -30,6 +30,7 @@ enum class ComponentType : int16_t
    FULLSCREEN,
    INSTANCED,
    TESSELLATED,
+   TERRAIN,
 
    // Procedural
    // ==============================================================================================
@@ -66,6 +67,7 @@ static const char* GetComponentName( ComponentType type )
        "Fullscreen",
        "Instanced",
        "Tessellated",
+       "Terrain",
        "Procedural Displacement",
        "Procedural Material",
        "Ocean",
@@ -5,7 +5,10 @@
 #include <ECS/Components/ComponentTypes.h>
 
 #include <Graphics/Handles/ResourceHandle.h>
+#include <Graphics/Scene/Bounds.h>
+#include <Graphics/Scene/Mesh.h>
 
+#include <memory>
 #include <string_view>
 
 // ================================================================================================
@@ -20,6 +23,10 @@ class MeshComponent final : public BaseComponent
   public:
    MeshComponent() = default;
    explicit MeshComponent( const std::string_view assetName ) : asset( assetName ) {}
+   MeshComponent( const std::string_view assetName, float maxDisplacement )
+       : asset( assetName ), maxDisplacement( maxDisplacement )
+   {
+   }
    COPIABLE( MeshComponent );
    virtual ~MeshComponent() = default;
 
@@ -30,7 +37,37 @@ class MeshComponent final : public BaseComponent
    // Mesh buffer handles and params
    VertexBufferHandle vertexBuffer;
    IndexBufferHandle indexBuffer;
+   IndexType indexType  = IndexType::UNSIGNED_INT32;
    uint32_t vertexCount = 0;
    uint32_t indexCount  = 0;
+
+   // The dequantization of the positions goes in the model matrix the mesh is drawn with
+   PositionQuantization positionQuantization;
+
+   // Levels of detail in the index buffer, the render systems draw the selected one
+   std::array<MeshLod, MAX_MESH_LODS> lods = {};
+   uint32_t lodCount                       = 0;
+   uint32_t lod                            = 0;  // Selected from the main view every frame
+
+   // Local space bounds of the mesh, filled when the mesh is found in the cache. Meshes without
+   // valid bounds are never culled
+   AABB bounds;
+   BoundingSphere boundingSphere;
+
+   // Optional conservative bound for meshes displaced on the GPU (tessellation, height maps), in
+   // local units. Displaced meshes are only culled when this is set
+   float maxDisplacement = 0.0f;
+
+   // CPU triangles used when the renderable is an occluder, shared with the mesh cache
+   std::shared_ptr<const OccluderGeometry> occluder;
+
+   // Culled one by one when the full detail LOD is drawn, shared with the mesh cache
+   std::shared_ptr<const std::vector<Meshlet>> meshlets;
+
+   AABB getDisplacedBounds() const { return bounds.inflate( maxDisplacement ); }
+
+   // Range of the index buffer to draw, all of it for meshes without LODs
+   uint32_t getFirstIndex() const { return lodCount ? lods[lod].firstIndex : 0; }
+   uint32_t getIndexCount() const { return lodCount ? lods[lod].indexCount : indexCount; }
 };
 }
@@ -21,8 +21,17 @@ class RenderableComponent final : public BaseComponent
    };
 
    RenderableComponent() = default;
-   RenderableComponent( Type type, bool isShadowCasting = false, bool isShadowReceiving = false )
-       : type( type ), isShadowCasting( isShadowCasting ), isShadowReceiving( isShadowReceiving )
+   RenderableComponent(
+       Type type,
+       bool isShadowCasting   = false,
+       bool isShadowReceiving = false,
+       bool isOccluder        = false,
+       bool isStatic          = false )
+       : type( type ),
+         isShadowCasting( isShadowCasting ),
+         isShadowReceiving( isShadowReceiving ),
+         isOccluder( isOccluder ),
+         isStatic( isStatic )
    {
    }
    COPIABLE( RenderableComponent );
@@ -43,5 +52,7 @@ class RenderableComponent final : public BaseComponent
    bool isInstanced       = false;
    bool isTessellated     = false;
    bool isTransparent     = false;
+   bool isOccluder        = false;  // Hides other renderables, needs occluder geometry on the mesh
+   bool isStatic          = false;  // Rarely moves, its shadows are cached until it does
 };
 }
@@ -0,0 +1,14 @@
+#include <ECS/Components/Rendering/TerrainComponent.h>
+
+#include <Graphics/GRIS/RenderInterface.h>
+
+namespace CYD
+{
+TerrainComponent::~TerrainComponent()
+{
+   if( shadowPatchesBuffer )
+   {
+      GRIS::DestroyBuffer( shadowPatchesBuffer );
+   }
+}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <ECS/Components/BaseComponent.h>
+
+#include <ECS/Components/ComponentTypes.h>
+
+#include <Graphics/Handles/ResourceHandle.h>
+#include <Graphics/Scene/Bounds.h>
+#include <Graphics/Scene/TerrainQuadtree.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// ================================================================================================
+// Definition
+// ================================================================================================
+/*
+Square heightfield terrain drawn with CDLOD. A single grid patch is instanced over the nodes of the
+quadtree selected for the view, the heights come from the displacement of the entity.
+*/
+namespace CYD
+{
+class TerrainComponent final : public BaseComponent
+{
+  public:
+   TerrainComponent() = default;
+   TerrainComponent(
+       float size,
+       float heightScale,
+       uint32_t lodCount,
+       float lodDistance,
+       float morphRatio = 0.7f )
+       : size( size ),
+         heightScale( heightScale ),
+         lodCount( lodCount ),
+         lodDistance( lodDistance ),
+         morphRatio( morphRatio )
+   {
+   }
+   COPIABLE( TerrainComponent );
+   virtual ~TerrainComponent();
+
+   static constexpr ComponentType TYPE = ComponentType::TERRAIN;
+
+   // Keep in sync with MAX_TERRAIN_PATCHES in TERRAIN_CDLOD.h
+   static constexpr uint32_t MAX_PATCHES = 2048;
+
+   // Quads per side of the patch mesh, a multiple of 4 so that quarter patches can morph too
+   static constexpr uint32_t PATCH_RESOLUTION = 32;
+
+   struct ShaderParams  // GPU, followed by the patches
+   {
+      glm::vec4 morphRanges[TerrainQuadtree::MAX_LODS];  // Start and inverse length of the morph
+      glm::vec4 viewPosition;                            // In the space of the terrain
+      float size;
+      float heightScale;
+      float gridResolution;
+      float padding;
+   };
+
+   float size        = 1.0f;  // Local units, centered on the origin
+   float heightScale = 1.0f;  // Local height of a displacement of 1
+   uint32_t lodCount = 1;
+   float lodDistance = 1.0f;  // World distance covered by the finest LOD
+   float morphRatio  = 0.7f;
+
+   // The shadows are drawn with patches selected around a snapped view position and without
+   // culling, they do not change when the view turns and cached shadows stay valid
+   BufferHandle shadowPatchesBuffer;
+   uint32_t shadowPatchCount = 0;
+
+   // World bounds of the shadow patches that changed this frame, cached shadows are only rendered
+   // again where they are
+   std::vector<AABB> shadowChangedBounds;
+
+   // Last selection for the main view
+   TerrainQuadtree::Stats stats;
+   bool hasHeightBounds = false;  // Node bounds are conservative until the heights are known
+};
+}
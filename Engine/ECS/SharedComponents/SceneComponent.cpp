@@ -11,6 +11,10 @@ SceneComponent::SceneComponent()
    // Lights
    lightsBuffer = GRIS::CreateUniformBuffer( sizeof( lights ), "SceneComponent Lights Buffer" );
 
+   // Shadows
+   shadowCascadesBuffer = GRIS::CreateUniformBuffer(
+       sizeof( shadowCascades ), "SceneComponent Shadow Cascades Buffer" );
+
    // Views
    viewsBuffer = GRIS::CreateUniformBuffer( sizeof( views ), "SceneComponent Views Buffer" );
    inverseViewsBuffer =
@@ -29,6 +33,7 @@ SceneComponent::~SceneComponent()
 #endif
 
    GRIS::DestroyBuffer( lightsBuffer );
+   GRIS::DestroyBuffer( shadowCascadesBuffer );
    GRIS::DestroyBuffer( viewsBuffer );
    GRIS::DestroyBuffer( inverseViewsBuffer );
    GRIS::DestroyTexture( shadowMap );
@@ -13,6 +13,21 @@
 
 #include <array>
 
+// ================================================================================================
+// Forwards
+// ================================================================================================
+namespace CYD
+{
+class BVH;
+class MeshCache;
+class MeshLodSelector;
+class OcclusionCuller;
+class ShadowCache;
+}
+
+// ================================================================================================
+// Definition
+// ================================================================================================
 namespace CYD
 {
 class SceneComponent final : public BaseSharedComponent
@@ -73,11 +88,42 @@ class SceneComponent final : public BaseSharedComponent
 
    LightShaderParams lights[MAX_LIGHTS] = {};
 
+   // Shadows
+   // =============================================================================================
+   static constexpr uint32_t MAX_SHADOW_CASCADES = 4;
+
+   // Keep in sync with "ShadowCascades" in LIGHTING.h
+   struct ShadowCascadesShaderParams
+   {
+      glm::mat4 worldToShadowMats[MAX_SHADOW_CASCADES];  // World space to shadow map UV and depth
+      glm::vec4 splits;  // View depth where each cascade ends, zero for the unused ones
+   };
+
+   ShadowCascadesShaderParams shadowCascades = {};
+
+   // Static layers of the cascades, null until the shadow map system has ticked
+   const ShadowCache* shadowCache = nullptr;
+
+   // Spatial Queries
+   // =============================================================================================
+   // World bounds of the meshes in the scene, null until the spatial index system has ticked
+   const BVH* spatialIndex = nullptr;
+
+   // Occluders rasterized from the main view this frame, null when there are none
+   OcclusionCuller* occlusionCuller = nullptr;
+
+   // Levels of detail picked for the main view this frame, null until the mesh LOD system ticked
+   const MeshLodSelector* meshLodSelector = nullptr;
+
+   // Meshes streamed from disk, null until the mesh loader system has ticked
+   const MeshCache* meshCache = nullptr;
+
    // Ressource Handles
    // =============================================================================================
    BufferHandle viewsBuffer;
    BufferHandle inverseViewsBuffer;
    BufferHandle lightsBuffer;
+   BufferHandle shadowCascadesBuffer;
    TextureHandle shadowMap;  // TODO This shouldn't be here, not a very elegant solution
    GBuffer gbuffer;
 
@@ -68,8 +68,11 @@ void DebugDrawSystem::tick( double /*deltaS*/ )
          {
             const DebugDrawComponent::SphereParams& sphere = debug.params.sphere;
 
+            const Mesh& sphereMesh = m_meshes.getMesh( "DEBUG_SPHERE" );
+
             modelMatrix =
-                Transform::GetModelMatrix( transform.scaling, glm::quat(), transform.position );
+                Transform::GetModelMatrix( transform.scaling, glm::quat(), transform.position ) *
+                sphereMesh.positionQuantization.getDequantizationMatrix();
 
             // Update model transform push constant
             GRIS::UpdateConstantBuffer(
@@ -77,9 +80,8 @@ void DebugDrawSystem::tick( double /*deltaS*/ )
 
             GRIS::BindUniformBuffer( cmdList, scene.debugParamsBuffer, 1, 0 );
 
-            const Mesh& sphereMesh = m_meshes.getMesh( "DEBUG_SPHERE" );
             GRIS::BindVertexBuffer<Vertex>( cmdList, sphereMesh.vertexBuffer );
-            GRIS::BindIndexBuffer<uint32_t>( cmdList, sphereMesh.indexBuffer );
+            GRIS::BindIndexBuffer( cmdList, sphereMesh.indexBuffer, sphereMesh.indexType );
             GRIS::DrawIndexed( cmdList, sphereMesh.indexCount );
          }
          break;
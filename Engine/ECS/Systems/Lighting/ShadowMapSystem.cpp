@@ -12,19 +12,148 @@
 
 #include <Profiling.h>
 #include <ECS/EntityManager.h>
+#include <ECS/Components/Procedural/ProceduralDisplacementComponent.h>
+#include <ECS/Components/Rendering/TerrainComponent.h>
 #include <ECS/SharedComponents/SceneComponent.h>
 
+#include <chrono>
+#include <cstring>
+
 namespace CYD
 {
-static constexpr uint32_t SHADOWMAP_DIM  = 2048;
-static bool s_initialized                = false;
-static PipelineIndex s_shadowmapPipeline = INVALID_PIPELINE_IDX;
-static Framebuffer s_shadowmapFB         = {};
+// Each cascade gets a square of the shadow map atlas, 2x2 of them
+static constexpr uint32_t CASCADE_COUNT = SceneComponent::MAX_SHADOW_CASCADES;
+static constexpr uint32_t CASCADE_DIM   = 2048;
+static constexpr uint32_t ATLAS_COLUMNS = 2;
+static constexpr uint32_t SHADOWMAP_DIM = CASCADE_DIM * ATLAS_COLUMNS;
+
+static constexpr float SHADOW_DISTANCE = 6000.0f;
+static constexpr float CASTER_DISTANCE = 5000.0f;  // Depth range of the previous single sun view
+
+// The cascades further away are rendered less often, the ones that are only due share a budget of
+// updates per frame
+static constexpr uint32_t UPDATE_INTERVALS[CASCADE_COUNT] = { 1, 2, 4, 8 };
+static constexpr uint32_t MAX_UPDATES_PER_FRAME           = 2;
+
+// Uniform buffer offsets have to be aligned, 256 bytes covers every device
+static constexpr uint32_t CASCADE_VIEW_STRIDE = 256;
+
+static_assert( CASCADE_COUNT <= ShadowCascades::MAX_CASCADES );
+static_assert( CASCADE_COUNT <= ATLAS_COLUMNS * ATLAS_COLUMNS );
+
+static bool s_initialized                           = false;
+static PipelineIndex s_meshShadowmapPipeline        = INVALID_PIPELINE_IDX;
+static PipelineIndex s_instancedShadowmapPipeline   = INVALID_PIPELINE_IDX;
+static PipelineIndex s_tessellatedShadowmapPipeline = INVALID_PIPELINE_IDX;
+static PipelineIndex s_terrainPipeline              = INVALID_PIPELINE_IDX;
+static PipelineIndex s_terrainShadowmapPipeline     = INVALID_PIPELINE_IDX;
+static PipelineIndex s_clearPipeline                = INVALID_PIPELINE_IDX;
+static PipelineIndex s_compositePipeline            = INVALID_PIPELINE_IDX;
+static Framebuffer s_shadowmapFB                    = {};
+static Framebuffer s_staticShadowmapFB              = {};
 
 static void Initialize()
 {
-   s_shadowmapPipeline = StaticPipelines::FindByName( "TERRAIN_SHADOWMAP" );  // Hardcoded
-   s_initialized       = true;
+   s_meshShadowmapPipeline        = StaticPipelines::FindByName( "MESH_SHADOWMAP" );
+   s_instancedShadowmapPipeline   = StaticPipelines::FindByName( "MESH_INSTANCED_SHADOWMAP" );
+   s_tessellatedShadowmapPipeline = StaticPipelines::FindByName( "TERRAIN_SHADOWMAP" );
+   s_terrainPipeline              = StaticPipelines::FindByName( "TERRAIN_CDLOD" );
+   s_terrainShadowmapPipeline     = StaticPipelines::FindByName( "TERRAIN_CDLOD_SHADOWMAP" );
+   s_clearPipeline                = StaticPipelines::FindByName( "SHADOWMAP_CLEAR" );
+   s_compositePipeline            = StaticPipelines::FindByName( "SHADOWMAP_COMPOSITE" );
+   s_initialized                  = true;
+}
+
+// CDLOD terrains place their patches in the vertex shader and tessellated terrains displace their
+// patches in the evaluation shader, the other casters only need their positions
+static PipelineIndex GetShadowmapPipeline(
+    const RenderableComponent& renderable,
+    const MaterialComponent& material )
+{
+   if( material.pipelineIdx == s_terrainPipeline ) return s_terrainShadowmapPipeline;
+   if( renderable.isTessellated ) return s_tessellatedShadowmapPipeline;
+   if( renderable.isInstanced ) return s_instancedShadowmapPipeline;
+
+   return s_meshShadowmapPipeline;
+}
+
+// Only the terrain pipelines sample the height map of their material
+static bool ReadsMaterial( PipelineIndex pipelineIdx )
+{
+   return pipelineIdx == s_terrainShadowmapPipeline ||
+          pipelineIdx == s_tessellatedShadowmapPipeline;
+}
+
+static bool HasMoved( const TransformComponent& previous, const TransformComponent& current )
+{
+   return previous.position != current.position || previous.scaling != current.scaling ||
+          previous.rotation != current.rotation;
+}
+
+// Displacement generated on the GPU changes the shape of a caster without moving it
+static Noise::ShaderParams GetDisplacement( const EntityManager& ecs, EntityHandle handle )
+{
+   const Entity* entity = ecs.getEntity( handle );
+   const ProceduralDisplacementComponent* displacement =
+       entity ? entity->getComponent<ProceduralDisplacementComponent>() : nullptr;
+
+   return displacement ? displacement->params : Noise::ShaderParams();
+}
+
+static const TerrainComponent* GetTerrain( const EntityManager& ecs, EntityHandle handle )
+{
+   const Entity* entity = ecs.getEntity( handle );
+   return entity ? entity->getComponent<TerrainComponent>() : nullptr;
+}
+
+static Rectangle GetCascadeRect( uint32_t cascadeIdx )
+{
+   Rectangle rect;
+   rect.offset.x      = static_cast<int32_t>( ( cascadeIdx % ATLAS_COLUMNS ) * CASCADE_DIM );
+   rect.offset.y      = static_cast<int32_t>( ( cascadeIdx / ATLAS_COLUMNS ) * CASCADE_DIM );
+   rect.extent.width  = CASCADE_DIM;
+   rect.extent.height = CASCADE_DIM;
+   return rect;
+}
+
+// From world space to the UVs of the cascade in the atlas, the depth stays in NDC
+static glm::mat4 GetWorldToShadowMat( const ShadowCascades::Cascade& cascade, uint32_t cascadeIdx )
+{
+   const Rectangle rect = GetCascadeRect( cascadeIdx );
+
+   const float scale = 0.5f * CASCADE_DIM / SHADOWMAP_DIM;
+   const glm::vec2 offset =
+       glm::vec2( rect.offset.x, rect.offset.y ) / static_cast<float>( SHADOWMAP_DIM );
+
+   // clang-format off
+   const glm::mat4 ndcToAtlas = glm::mat4( scale,            0.0f,             0.0f, 0.0f,
+                                           0.0f,             scale,            0.0f, 0.0f,
+                                           0.0f,             0.0f,             1.0f, 0.0f,
+                                           offset.x + scale, offset.y + scale, 0.0f, 1.0f );
+   // clang-format on
+
+   return ndcToAtlas * cascade.projMat * cascade.viewMat;
+}
+
+ShadowMapSystem::ShadowMapSystem( const MaterialCache& materials, EMP::ThreadPool& threadPool )
+    : RenderSystem( materials, threadPool ),
+      m_cascades( CASCADE_COUNT, CASCADE_DIM, SHADOW_DISTANCE, CASTER_DISTANCE )
+{
+   for( uint32_t i = 0; i < CASCADE_COUNT; ++i )
+   {
+      m_cascades.setUpdateInterval( i, UPDATE_INTERVALS[i] );
+   }
+
+   m_cascades.setMaxUpdatesPerFrame( MAX_UPDATES_PER_FRAME );
+
+   m_cascadeViewsBuffer = GRIS::CreateUniformBuffer(
+       CASCADE_COUNT * CASCADE_VIEW_STRIDE, "Shadow Cascade Views Buffer" );
+}
+
+ShadowMapSystem::~ShadowMapSystem()
+{
+   GRIS::DestroyBuffer( m_cascadeViewsBuffer );
+   GRIS::DestroyTexture( m_staticShadowMap );
 }
 
 void ShadowMapSystem::tick( double /*deltaS*/ )
@@ -52,108 +181,383 @@ void ShadowMapSystem::tick( double /*deltaS*/ )
 
       scene.shadowMap = GRIS::CreateTexture( texDesc );
 
-      ClearValue clear;
-      clear.depthStencil.depth   = 0.0f;
-      clear.depthStencil.stencil = 0;
+      texDesc.name      = "Static Shadow Map";
+      m_staticShadowMap = GRIS::CreateTexture( texDesc );
 
+      // Cached cascades are kept from one frame to the next, each cascade clears its own square
       s_shadowmapFB.resize( SHADOWMAP_DIM, SHADOWMAP_DIM );
-      s_shadowmapFB.setToClearAll( true );
-      s_shadowmapFB.attach( 0, scene.shadowMap, Access::DEPTH_STENCIL_ATTACHMENT_READ, clear );
+      s_shadowmapFB.setToClearAll( false );
+      s_shadowmapFB.attach( 0, scene.shadowMap, Access::DEPTH_STENCIL_ATTACHMENT_READ );
+
+      s_staticShadowmapFB.resize( SHADOWMAP_DIM, SHADOWMAP_DIM );
+      s_staticShadowmapFB.setToClearAll( false );
+      s_staticShadowmapFB.attach( 0, m_staticShadowMap, Access::DEPTH_STENCIL_ATTACHMENT_READ );
    }
 
+   const uint32_t mainViewIdx = getViewIndex( scene, "MAIN" );
+   const uint32_t sunViewIdx  = getViewIndex( scene, "SUN" );
+
+   // The sun view only gives the orientation of the light
+   m_cascades.update(
+       scene.inverseViews[mainViewIdx].invViewMat,
+       scene.inverseViews[mainViewIdx].invProjMat,
+       scene.views[sunViewIdx].viewMat );
+
+   m_cache.beginFrame();
+
+   // The casters are culled against each cascade, their bounds are the same for all of them
+   updateWorldBounds();
+
+   // Cascades whose static layer is invalidated are rendered this frame too
+   _invalidateStaticLayers();
+
+   // Every cascade is sampled, rendered this frame or not
+   SceneComponent::ShadowCascadesShaderParams& params = scene.shadowCascades;
+   params.splits                                      = glm::vec4( 0.0f );
+
+   for( uint32_t i = 0; i < CASCADE_COUNT; ++i )
+   {
+      const ShadowCascades::Cascade& cascade = m_cascades.getCascade( i );
+
+      params.worldToShadowMats[i] = GetWorldToShadowMat( cascade, i );
+      params.splits[i]            = cascade.splitFar;
+
+      if( cascade.needsRender )
+      {
+         const glm::mat4 viewProjMat   = cascade.projMat * cascade.viewMat;
+         const UploadToBufferInfo info = { i * CASCADE_VIEW_STRIDE, sizeof( viewProjMat ) };
+         GRIS::UploadToBuffer( m_cascadeViewsBuffer, &viewProjMat, info );
+      }
+   }
+
+   const UploadToBufferInfo info = { 0, sizeof( params ) };
+   GRIS::UploadToBuffer( scene.shadowCascadesBuffer, &params, info );
+
    const CmdListHandle cmdList = RenderGraph::GetCommandList( RenderGraph::Pass::PRE_RENDER );
    CYD_SCOPED_GPUTRACE( cmdList, "ShadowMapSystem" );
 
-   // TODO go through this loop once per light view
-   GRIS::BeginRendering( cmdList, s_shadowmapFB );
+   for( uint32_t i = 0; i < CASCADE_COUNT; ++i )
+   {
+      if( m_cascades.getCascade( i ).needsRender )
+      {
+         _renderCascade( cmdList, scene, i );
+      }
+   }
 
-   GRIS::SetViewport( cmdList, {} );
-   GRIS::SetScissor( cmdList, {} );
+   scene.shadowCache = &m_cache;
+}
 
-   const PipelineInfo& pipInfo = *StaticPipelines::Get( s_shadowmapPipeline );
-   GRIS::BindPipeline( cmdList, s_shadowmapPipeline );
+void ShadowMapSystem::_invalidateStaticLayers()
+{
+   CYD_TRACE( "Static Casters" );
 
-   // Tracking
-   std::string_view prevMesh;
-   PipelineIndex prevPipeline = INVALID_PIPELINE_IDX;
-   MaterialIndex prevMaterial = INVALID_MATERIAL_IDX;
+   m_frame++;
+   m_changedBounds.clear();
 
-   for( const auto& entityEntry : m_entities )
+   for( uint32_t i = 0; i < m_entities.size(); ++i )
    {
+      const EntityEntry& entityEntry        = m_entities[i];
       const RenderableComponent& renderable = *std::get<RenderableComponent*>( entityEntry.arch );
 
-      if( !renderable.isShadowCasting ) continue;
+      // Casters that stop being static or casting shadows are swept below since they are not
+      // marked as seen
+      if( !renderable.isStatic || !renderable.isShadowCasting ) continue;
 
       const TransformComponent& transform = *std::get<TransformComponent*>( entityEntry.arch );
-      const MaterialComponent& material   = *std::get<MaterialComponent*>( entityEntry.arch );
       const MeshComponent& mesh           = *std::get<MeshComponent*>( entityEntry.arch );
 
-      const glm::mat4 modelMatrix =
-          Transform::GetModelMatrix( transform.scaling, transform.rotation, transform.position );
+      const Noise::ShaderParams displacement = GetDisplacement( *m_ecs, entityEntry.handle );
 
-      GRIS::NamedUpdateConstantBuffer( cmdList, "Model", &modelMatrix, pipInfo );
+      // The ECS has no change notifications, changes are found by comparing with the last state
+      const auto [it, isNew] = m_staticCasters.try_emplace( entityEntry.handle );
+      StaticCaster& caster   = it->second;
+      caster.lastSeenFrame   = m_frame;
 
-      GRIS::NamedBufferBinding(
-          cmdList, scene.viewsBuffer, "Views", pipInfo, 0, sizeof( scene.views ) );
+      const bool hasChanged =
+          isNew || HasMoved( caster.transform, transform ) ||
+          caster.vertexBuffer != mesh.vertexBuffer || caster.lod != mesh.lod ||
+          std::memcmp( &caster.displacement, &displacement, sizeof( displacement ) ) != 0;
 
-      if( renderable.isInstanced )
+      // Terrains select their shadow patches again as the view moves, only the patches that
+      // changed are in the way of the cascades
+      if( !hasChanged )
       {
-         CYD_ASSERT( renderable.instancesBuffer && "Invalid instance buffer" );
-         GRIS::NamedBufferBinding( cmdList, renderable.instancesBuffer, "InstancesData", pipInfo );
+         if( const TerrainComponent* terrain = GetTerrain( *m_ecs, entityEntry.handle ) )
+         {
+            m_changedBounds.insert(
+                m_changedBounds.end(),
+                terrain->shadowChangedBounds.begin(),
+                terrain->shadowChangedBounds.end() );
+         }
+         continue;
       }
 
-      if( renderable.isTessellated )
+      // Both where it was and where it is now
+      if( !isNew )
       {
-         CYD_ASSERT( renderable.tessellationBuffer && "Invalid tessellation params buffer" );
-         GRIS::NamedBufferBinding(
-             cmdList, renderable.tessellationBuffer, "TessellationParams", pipInfo );
+         m_changedBounds.push_back( caster.worldBounds );
       }
+      m_changedBounds.push_back( m_worldBounds[i] );
+
+      caster.transform    = transform;
+      caster.vertexBuffer = mesh.vertexBuffer;
+      caster.lod          = mesh.lod;
+      caster.displacement = displacement;
+      caster.worldBounds  = m_worldBounds[i];
+   }
 
-      if( prevMaterial != material.materialIdx )
+   for( auto it = m_staticCasters.begin(); it != m_staticCasters.end(); )
+   {
+      if( it->second.lastSeenFrame != m_frame )
       {
-         m_materials.bind( cmdList, material.materialIdx, 1 /*set*/ );
-         prevMaterial = material.materialIdx;
+         m_changedBounds.push_back( it->second.worldBounds );
+         it = m_staticCasters.erase( it );
+      }
+      else
+      {
+         ++it;
       }
+   }
+
+   if( m_changedBounds.empty() ) return;
 
-      if( prevMesh != mesh.asset )
+   m_changedCuller.resize( static_cast<uint32_t>( m_changedBounds.size() ) );
+   for( uint32_t i = 0; i < m_changedBounds.size(); ++i )
+   {
+      if( m_changedBounds[i].isValid() )
       {
-         if( mesh.vertexBuffer )
-         {
-            GRIS::BindVertexBuffer<Vertex>( cmdList, mesh.vertexBuffer );
-            if( mesh.indexBuffer )
-            {
-               // This renderable has an index buffer, use it to draw
-               GRIS::BindIndexBuffer<uint32_t>( cmdList, mesh.indexBuffer );
-            }
-         }
+         m_changedCuller.setBounds( i, m_changedBounds[i] );
+      }
+      else
+      {
+         m_changedCuller.setAlwaysVisible( i );
+      }
+   }
 
-         prevMesh = mesh.asset;
+   // A cached layer was rendered with the current frustum of its cascade, moved cascades miss
+   // anyway. The cascade shows the stale layer until it is rendered again, it cannot wait for its
+   // interval
+   for( uint32_t i = 0; i < CASCADE_COUNT; ++i )
+   {
+      if( !m_cache.isValid( i ) ) continue;
+
+      m_changedCuller.cull( m_cascades.getCascade( i ).frustum, m_changedVisible );
+      if( !m_changedVisible.empty() )
+      {
+         m_cache.invalidate( i );
+         m_cascades.requestRender( i );
       }
+   }
+}
+
+void ShadowMapSystem::_renderCascade(
+    CmdListHandle cmdList,
+    const SceneComponent& scene,
+    uint32_t cascadeIdx )
+{
+   CYD_TRACE( "Cascade" );
+
+   const ShadowCascades::Cascade& cascade = m_cascades.getCascade( cascadeIdx );
+
+   // Casters outside of the cascade cannot cast shadows inside of it
+   cullEntities( cascade.frustum );
+
+   const glm::mat4 viewProjMat = cascade.projMat * cascade.viewMat;
+   if( !m_cache.lookup( cascadeIdx, viewProjMat ) )
+   {
+      const auto start = std::chrono::steady_clock::now();
+
+      _renderLayer( cmdList, scene, cascadeIdx, true /*isStatic*/ );
+
+      const float renderMs =
+          std::chrono::duration<float, std::milli>( std::chrono::steady_clock::now() - start )
+              .count();
+
+      m_cache.store( cascadeIdx, viewProjMat, renderMs );
+   }
+
+   _renderLayer( cmdList, scene, cascadeIdx, false /*isStatic*/ );
+}
+
+void ShadowMapSystem::_renderLayer(
+    CmdListHandle cmdList,
+    const SceneComponent& scene,
+    uint32_t cascadeIdx,
+    bool isStatic )
+{
+   // Sorting the draws by shadow map pipeline, material and mesh
+   const glm::vec3 lightPosition = m_cascades.getLightPosition( cascadeIdx );
+
+   m_drawList.clear();
+
+   for( const uint32_t entityIdx : m_visibleEntities )
+   {
+      const RenderableComponent& renderable =
+          *std::get<RenderableComponent*>( m_entities[entityIdx].arch );
+      const MaterialComponent& material =
+          *std::get<MaterialComponent*>( m_entities[entityIdx].arch );
 
-      if( renderable.instanceCount )
+      if( !renderable.isShadowCasting || renderable.isStatic != isStatic ) continue;
+
+      addDraw(
+          lightPosition, entityIdx, 0 /*pass*/, GetShadowmapPipeline( renderable, material ) );
+   }
+
+   // The mesh shadow map pipeline does not read the instances and the instanced casters have their
+   // own, no batch is auto-instanced and the batches of the previous cascade are not overwritten in
+   // the instances buffer
+   m_drawList.sort();
+   batchDraws( s_meshShadowmapPipeline );
+
+   // Large draw lists are recorded on the worker threads
+   const bool inParallel = shouldRecordInParallel();
+   GRIS::BeginRendering( cmdList, isStatic ? s_staticShadowmapFB : s_shadowmapFB, inParallel );
+
+   recordBatches(
+       cmdList,
+       inParallel,
+       [this, &scene, cascadeIdx, isStatic](
+           CmdListHandle chunkList, uint32_t firstBatch, uint32_t lastBatch )
+       { _recordBatches( chunkList, scene, cascadeIdx, isStatic, firstBatch, lastBatch ); } );
+
+   GRIS::EndRendering( cmdList );
+}
+
+void ShadowMapSystem::_recordBatches(
+    CmdListHandle cmdList,
+    const SceneComponent& scene,
+    uint32_t cascadeIdx,
+    bool isStatic,
+    uint32_t firstBatch,
+    uint32_t lastBatch ) const
+{
+   // Only drawing in the square of the cascade
+   const Rectangle rect = GetCascadeRect( cascadeIdx );
+
+   Viewport viewport;
+   viewport.offsetX = static_cast<float>( rect.offset.x );
+   viewport.offsetY = static_cast<float>( rect.offset.y );
+   viewport.width   = static_cast<float>( rect.extent.width );
+   viewport.height  = static_cast<float>( rect.extent.height );
+
+   GRIS::SetViewport( cmdList, viewport );
+   GRIS::SetScissor( cmdList, rect );
+
+   // The first chunk fills the square before any caster is drawn. The static layer starts from the
+   // far reverse-Z depth, the cascade from its static layer
+   if( firstBatch == 0 )
+   {
+      if( isStatic )
       {
-         if( mesh.indexCount )
-         {
-            GRIS::DrawIndexedInstanced( cmdList, mesh.indexCount, renderable.instanceCount );
-         }
-         else
-         {
-            GRIS::DrawInstanced( cmdList, mesh.vertexCount, renderable.instanceCount );
-         }
+         GRIS::BindPipeline( cmdList, s_clearPipeline );
       }
       else
       {
-         if( mesh.indexCount )
+         GRIS::BindPipeline( cmdList, s_compositePipeline );
+         GRIS::BindTexture( cmdList, m_staticShadowMap, 0 );
+      }
+
+      GRIS::Draw( cmdList, 3, 0 );
+   }
+
+   if( firstBatch == lastBatch ) return;
+
+   const PipelineInfo* pipInfo = nullptr;
+   PipelineIndex pipelineIdx   = INVALID_PIPELINE_IDX;
+
+   const std::span<const DrawList::Packet> packets = m_drawList.getPackets();
+
+   for( uint32_t batchIdx = firstBatch; batchIdx < lastBatch; ++batchIdx )
+   {
+      const DrawBatch& batch         = m_batches[batchIdx];
+      const size_t i                 = batch.firstPacket;
+      const EntityEntry& entityEntry = m_entities[packets[i].entityIdx];
+
+      const RenderableComponent& renderable = *std::get<RenderableComponent*>( entityEntry.arch );
+      const MaterialComponent& material     = *std::get<MaterialComponent*>( entityEntry.arch );
+      const MeshComponent& mesh             = *std::get<MeshComponent*>( entityEntry.arch );
+
+      // Nothing is bound yet at the start of a chunk
+      const uint32_t changes = batchIdx == firstBatch
+                                   ? DrawList::ALL
+                                   : DrawList::GetStateChanges( packets[i - 1].key, packets[i].key );
+
+      if( changes & DrawList::PIPELINE )
+      {
+         pipelineIdx = GetShadowmapPipeline( renderable, material );
+         pipInfo     = StaticPipelines::Get( pipelineIdx );
+         GRIS::BindPipeline( cmdList, pipelineIdx );
+      }
+
+      GRIS::NamedBufferBinding(
+          cmdList, scene.viewsBuffer, "Views", *pipInfo, 0, sizeof( scene.views ) );
+
+      GRIS::NamedBufferBinding(
+          cmdList,
+          m_cascadeViewsBuffer,
+          "ShadowView",
+          *pipInfo,
+          cascadeIdx * CASCADE_VIEW_STRIDE,
+          sizeof( glm::mat4 ) );
+
+      // Terrains cast shadows with the patches selected for the shadows, not for the main view
+      const TerrainComponent* terrain =
+          pipelineIdx == s_terrainShadowmapPipeline ? GetTerrain( *m_ecs, entityEntry.handle )
+                                                    : nullptr;
+
+      if( terrain )
+      {
+         if( terrain->shadowPatchesBuffer )
          {
-            GRIS::DrawIndexed( cmdList, mesh.indexCount );
+            GRIS::NamedBufferBinding(
+                cmdList, terrain->shadowPatchesBuffer, "InstancesData", *pipInfo );
          }
-         else
+      }
+      else if( renderable.isInstanced )
+      {
+         CYD_ASSERT( renderable.instancesBuffer && "Invalid instance buffer" );
+         GRIS::NamedBufferBinding(
+             cmdList, renderable.instancesBuffer, "InstancesData", *pipInfo );
+      }
+
+      if( renderable.isTessellated )
+      {
+         CYD_ASSERT( renderable.tessellationBuffer && "Invalid tessellation params buffer" );
+         GRIS::NamedBufferBinding(
+             cmdList, renderable.tessellationBuffer, "TessellationParams", *pipInfo );
+      }
+
+      if( ( changes & DrawList::MATERIAL ) && ReadsMaterial( pipelineIdx ) )
+      {
+         m_materials.bind( cmdList, material.materialIdx, 1 /*set*/ );
+      }
+
+      if( ( changes & DrawList::MESH ) && mesh.vertexBuffer )
+      {
+         GRIS::BindVertexBuffer<Vertex>( cmdList, mesh.vertexBuffer );
+         if( mesh.indexBuffer )
          {
-            GRIS::Draw( cmdList, mesh.vertexCount );
+            // This renderable has an index buffer, use it to draw
+            GRIS::BindIndexBuffer( cmdList, mesh.indexBuffer, mesh.indexType );
          }
       }
-   }
 
-   GRIS::EndRendering( cmdList );
+      // The state above is still bound when there is nothing to draw, the next batches rely on it
+      if( terrain )
+      {
+         if( terrain->shadowPatchCount == 0 ) continue;
+
+         const TransformComponent& transform = *std::get<TransformComponent*>( entityEntry.arch );
+
+         const glm::mat4 modelMatrix =
+             Transform::GetModelMatrix( transform.scaling, transform.rotation, transform.position );
+
+         GRIS::NamedUpdateConstantBuffer( cmdList, "Model", &modelMatrix, *pipInfo );
+         GRIS::DrawIndexedInstanced( cmdList, mesh.indexCount, terrain->shadowPatchCount );
+         continue;
+      }
+
+      drawBatch( cmdList, batch, *pipInfo );
+   }
 }
 }
\ No newline at end of file
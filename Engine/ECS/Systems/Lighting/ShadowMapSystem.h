@@ -9,21 +9,93 @@
 #include <ECS/Components/Rendering/MaterialComponent.h>
 #include <ECS/Components/Rendering/MeshComponent.h>
 
+#include <Graphics/Scene/Bounds.h>
+#include <Graphics/Scene/FrustumCuller.h>
+#include <Graphics/Scene/ShadowCache.h>
+#include <Graphics/Scene/ShadowCascades.h>
+#include <Graphics/Utility/Noise.h>
+
+#include <unordered_map>
+#include <vector>
+
 // ================================================================================================
 // Definition
 // ================================================================================================
+/*
+Renders the shadow casters in the cascades of the shadow map atlas. Static casters are kept in a
+second atlas, the static layer of a cascade is only rendered again when the cascade moves or when
+a static caster changes inside of it, and the cascade is then rendered in the same frame whatever
+its update interval. The cascade is drawn by copying its static layer and adding the dynamic casters
+on top.
+*/
 namespace CYD
 {
 class MaterialCache;
+class SceneComponent;
 
 class ShadowMapSystem final : public RenderSystem
 {
   public:
    ShadowMapSystem() = delete;
-   ShadowMapSystem( const MaterialCache& materials ) : RenderSystem( materials ) {}
+   ShadowMapSystem( const MaterialCache& materials, EMP::ThreadPool& threadPool );
    NON_COPIABLE( ShadowMapSystem );
-   virtual ~ShadowMapSystem() = default;
+   virtual ~ShadowMapSystem();
 
    void tick( double deltaS ) override;
+
+   const ShadowCascades& getCascades() const { return m_cascades; }
+   const ShadowCache& getCache() const { return m_cache; }
+
+  private:
+   // Invalidates the static layers that a new, moved, reshaped or removed static caster was or is
+   // now in, and the ones changed terrain patches are in. Needs the world bounds of the frame
+   void _invalidateStaticLayers();
+
+   // Culls the casters of one cascade, renders its static layer again when it is not cached and
+   // then the dynamic casters in its part of the shadow map
+   void _renderCascade( CmdListHandle cmdList, const SceneComponent& scene, uint32_t cascadeIdx );
+
+   // Sorts and records either the static or the dynamic visible casters of a cascade
+   void _renderLayer(
+       CmdListHandle cmdList,
+       const SceneComponent& scene,
+       uint32_t cascadeIdx,
+       bool isStatic );
+
+   void _recordBatches(
+       CmdListHandle cmdList,
+       const SceneComponent& scene,
+       uint32_t cascadeIdx,
+       bool isStatic,
+       uint32_t firstBatch,
+       uint32_t lastBatch ) const;
+
+   // State a static caster was last rendered with, changes are detected against it
+   struct StaticCaster
+   {
+      TransformComponent transform;
+      VertexBufferHandle vertexBuffer;
+      uint32_t lod = 0;
+      Noise::ShaderParams displacement;
+      AABB worldBounds;  // Invalid when always visible
+      uint64_t lastSeenFrame = 0;
+   };
+
+   ShadowCascades m_cascades;
+   ShadowCache m_cache;
+
+   // Static casters of the cascades, with the same layout as the shadow map
+   TextureHandle m_staticShadowMap;
+
+   std::unordered_map<EntityHandle, StaticCaster> m_staticCasters;
+   uint64_t m_frame = 0;
+
+   // Bounds before and after the changes of the frame, culled against each cached cascade
+   std::vector<AABB> m_changedBounds;
+   FrustumCuller m_changedCuller;
+   std::vector<uint32_t> m_changedVisible;
+
+   // View projection of each cascade for the shadow map pipeline, at aligned offsets
+   BufferHandle m_cascadeViewsBuffer;
 };
 }
\ No newline at end of file
@@ -15,17 +15,26 @@
 namespace CYD
 {
 class MaterialCache;
+class SceneComponent;
 
 class ForwardRenderSystem final : public RenderSystem
 {
   public:
    ForwardRenderSystem() = delete;
-   ForwardRenderSystem( const MaterialCache& materials ) : RenderSystem( materials ) {}
+   ForwardRenderSystem( const MaterialCache& materials, EMP::ThreadPool& threadPool )
+       : RenderSystem( materials, threadPool )
+   {
+   }
    NON_COPIABLE( ForwardRenderSystem );
    virtual ~ForwardRenderSystem() = default;
 
-   void sort() override;
-
    void tick( double deltaS ) override;
+
+  private:
+   void _recordBatches(
+       CmdListHandle cmdList,
+       const SceneComponent& scene,
+       uint32_t firstBatch,
+       uint32_t lastBatch ) const;
 };
 }
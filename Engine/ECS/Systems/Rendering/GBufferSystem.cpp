@@ -18,21 +18,6 @@
 
 namespace CYD
 {
-// ================================================================================================
-void GBufferSystem::sort()
-{
-   auto deferredRenderSort = []( const EntityEntry& first, const EntityEntry& second )
-   {
-      const RenderableComponent& firstRenderable  = *std::get<RenderableComponent*>( first.arch );
-      const RenderableComponent& secondRenderable = *std::get<RenderableComponent*>( second.arch );
-
-      return firstRenderable.type == RenderableComponent::Type::DEFERRED ||
-             secondRenderable.type != RenderableComponent::Type::DEFERRED;
-   };
-
-   std::sort( m_entities.begin(), m_entities.end(), deferredRenderSort );
-}
-
 // ================================================================================================
 void GBufferSystem::tick( double /*deltaS*/ )
 {
@@ -57,51 +42,90 @@ void GBufferSystem::tick( double /*deltaS*/ )
    const uint32_t mainViewIdx = getViewIndex( scene, "MAIN" );
    const uint32_t sunViewIdx  = getViewIndex( scene, "SUN" );
 
-   // Tracking
-   std::string_view prevMesh;
-   PipelineIndex prevPipeline = INVALID_PIPELINE_IDX;
-   MaterialIndex prevMaterial = INVALID_MATERIAL_IDX;
+   // Only drawing what the main view can see
+   cullEntities( scene, mainViewIdx );
+
+   // Sorting the draws by state, occluders first since they are the most likely to hide the rest
+   m_drawList.clear();
+
+   for( const uint32_t entityIdx : m_visibleEntities )
+   {
+      const EntityEntry& entityEntry = m_entities[entityIdx];
+
+      // Read-only components
+      const RenderableComponent& renderable = *std::get<RenderableComponent*>( entityEntry.arch );
+      const MaterialComponent& material     = *std::get<MaterialComponent*>( entityEntry.arch );
+
+      // Deferred renderables only
+      if( renderable.type != RenderableComponent::Type::DEFERRED || !renderable.isVisible )
+      {
+         continue;
+      }
+
+      if( StaticPipelines::Get( material.pipelineIdx ) == nullptr )
+      {
+         // TODO WARNINGS
+         printf( "GBufferSystem: Passed a null pipeline, skipping entity\n" );
+         continue;
+      }
+
+      const uint32_t pass = renderable.isOccluder ? 0 : 1;
+      addDraw( scene, mainViewIdx, entityIdx, pass, material.pipelineIdx );
+   }
 
-   // Rendering to the gbuffer
-   GRIS::BeginRendering( cmdList, scene.gbuffer );
+   m_drawList.sort();
+   batchDraws();
 
+   // Rendering to the gbuffer, large draw lists are recorded on the worker threads
+   const bool inParallel = shouldRecordInParallel();
+   GRIS::BeginRendering( cmdList, scene.gbuffer, inParallel );
+
+   recordBatches(
+       cmdList,
+       inParallel,
+       [this, &scene]( CmdListHandle chunkList, uint32_t firstBatch, uint32_t lastBatch )
+       { _recordBatches( chunkList, scene, firstBatch, lastBatch ); } );
+
+   GRIS::EndRendering( cmdList );
+}
+
+// ================================================================================================
+void GBufferSystem::_recordBatches(
+    CmdListHandle cmdList,
+    const SceneComponent& scene,
+    uint32_t firstBatch,
+    uint32_t lastBatch ) const
+{
    // Dynamic state
    GRIS::SetViewport( cmdList, {} );
    GRIS::SetScissor( cmdList, {} );
 
-   // Iterate through entities
-   for( const auto& entityEntry : m_entities )
+   // Iterate through the batches of sorted draws
+   const std::span<const DrawList::Packet> packets = m_drawList.getPackets();
+   const PipelineInfo* curPipInfo                  = nullptr;
+
+   for( uint32_t batchIdx = firstBatch; batchIdx < lastBatch; ++batchIdx )
    {
+      const DrawBatch& batch         = m_batches[batchIdx];
+      const size_t i                 = batch.firstPacket;
+      const EntityEntry& entityEntry = m_entities[packets[i].entityIdx];
+
       // Read-only components
       const RenderableComponent& renderable = *std::get<RenderableComponent*>( entityEntry.arch );
-      if( renderable.type != RenderableComponent::Type::DEFERRED )
-      {
-         // Deferred renderables only
-         break;
-      }
+      const MaterialComponent& material     = *std::get<MaterialComponent*>( entityEntry.arch );
+      const MeshComponent& mesh             = *std::get<MeshComponent*>( entityEntry.arch );
 
-      if( !renderable.isVisible ) continue;
-
-      const TransformComponent& transform = *std::get<TransformComponent*>( entityEntry.arch );
-      const MaterialComponent& material   = *std::get<MaterialComponent*>( entityEntry.arch );
-      const MeshComponent& mesh           = *std::get<MeshComponent*>( entityEntry.arch );
+      // Nothing is bound yet at the start of a chunk
+      const uint32_t changes = batchIdx == firstBatch
+                                   ? DrawList::ALL
+                                   : DrawList::GetStateChanges( packets[i - 1].key, packets[i].key );
 
       // Pipeline
       // ==========================================================================================
-      const PipelineInfo* curPipInfo = nullptr;
-      if( prevPipeline != material.pipelineIdx )
+      if( changes & DrawList::PIPELINE )
       {
          curPipInfo = StaticPipelines::Get( material.pipelineIdx );
-         if( curPipInfo == nullptr )
-         {
-            // TODO WARNINGS
-            printf( "GBufferSystem: Passed a null pipeline, skipping entity\n" );
-            continue;
-         }
-
          GRIS::BindPipeline( cmdList, curPipInfo );
-
-         prevPipeline = material.pipelineIdx;
       }
 
       // Optional Buffers
@@ -117,6 +141,7 @@ void GBufferSystem::tick( double /*deltaS*/ )
          sampler.addressMode = AddressMode::CLAMP_TO_BORDER;
          sampler.borderColor = BorderColor::OPAQUE_BLACK;
          GRIS::BindTexture( cmdList, scene.shadowMap, sampler, 1, 1 );
+         GRIS::BindUniformBuffer( cmdList, scene.shadowCascadesBuffer, 3, 0 );
       }
 
       if( renderable.isInstanced )
@@ -133,64 +158,28 @@ void GBufferSystem::tick( double /*deltaS*/ )
              cmdList, renderable.tessellationBuffer, "TessellationParams", *curPipInfo );
       }
 
-      // Push Constants
-      // ==========================================================================================
-      const glm::mat4 modelMatrix =
-          Transform::GetModelMatrix( transform.scaling, transform.rotation, transform.position );
-
-      GRIS::NamedUpdateConstantBuffer( cmdList, "Model", &modelMatrix, *curPipInfo );
-
       // Material
       // ==========================================================================================
-      if( material.materialIdx != INVALID_MATERIAL_IDX )
+      if( ( changes & DrawList::MATERIAL ) && material.materialIdx != INVALID_MATERIAL_IDX )
       {
          m_materials.bind( cmdList, material.materialIdx, 1 /*set*/ );
-         prevMaterial = material.materialIdx;
       }
 
       // Vertex and index buffers
       // ==========================================================================================
-      if( prevMesh != mesh.asset )
+      if( ( changes & DrawList::MESH ) && mesh.vertexBuffer )
       {
-         if( mesh.vertexBuffer )
+         GRIS::BindVertexBuffer<Vertex>( cmdList, mesh.vertexBuffer );
+         if( mesh.indexBuffer )
          {
-            GRIS::BindVertexBuffer<Vertex>( cmdList, mesh.vertexBuffer );
-            if( mesh.indexBuffer )
-            {
-               // This renderable has an index buffer, use it to draw
-               GRIS::BindIndexBuffer<uint32_t>( cmdList, mesh.indexBuffer );
-            }
+            // This renderable has an index buffer, use it to draw
+            GRIS::BindIndexBuffer( cmdList, mesh.indexBuffer, mesh.indexType );
          }
-
-         prevMesh = mesh.asset;
       }
 
       // Draw
       // ==========================================================================================
-      if( renderable.instanceCount )
-      {
-         if( mesh.indexCount )
-         {
-            GRIS::DrawIndexedInstanced( cmdList, mesh.indexCount, renderable.instanceCount );
-         }
-         else
-         {
-            GRIS::DrawInstanced( cmdList, mesh.vertexCount, renderable.instanceCount );
-         }
-      }
-      else
-      {
-         if( mesh.indexCount )
-         {
-            GRIS::DrawIndexed( cmdList, mesh.indexCount );
-         }
-         else
-         {
-            GRIS::Draw( cmdList, mesh.vertexCount );
-         }
-      }
+      drawBatch( cmdList, batch, *curPipInfo );
    }
-
-   GRIS::EndRendering( cmdList );
 }
 }
@@ -15,17 +15,26 @@
 namespace CYD
 {
 class MaterialCache;
+class SceneComponent;
 
 class GBufferSystem final : public RenderSystem
 {
   public:
    GBufferSystem() = delete;
-   GBufferSystem( const MaterialCache& materials ) : RenderSystem( materials ) {}
+   GBufferSystem( const MaterialCache& materials, EMP::ThreadPool& threadPool )
+       : RenderSystem( materials, threadPool )
+   {
+   }
    NON_COPIABLE( GBufferSystem );
    virtual ~GBufferSystem() = default;
 
-   void sort() override;
-
    void tick( double deltaS ) override;
+
+  private:
+   void _recordBatches(
+       CmdListHandle cmdList,
+       const SceneComponent& scene,
+       uint32_t firstBatch,
+       uint32_t lastBatch ) const;
 };
 }
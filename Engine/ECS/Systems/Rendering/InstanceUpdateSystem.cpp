@@ -22,10 +22,12 @@ void InstanceUpdateSystem::tick( double /*deltaS*/ )
    {
       RenderableComponent& renderable = *std::get<RenderableComponent*>( entityEntry.arch );
       InstancedComponent& instanced   = *std::get<InstancedComponent*>( entityEntry.arch );
+      const MeshComponent& mesh       = *std::get<MeshComponent*>( entityEntry.arch );
 
       renderable.isInstanced = true;
 
-      if( instanced.needsUpdate )
+      // The quantization of the positions is only known once the mesh is loaded
+      if( instanced.needsUpdate && mesh.vertexBuffer )
       {
          // Creating GPU data
          for( uint32_t instanceIdx = 0; instanceIdx < instanced.count; ++instanceIdx )
@@ -39,7 +41,8 @@ void InstanceUpdateSystem::tick( double /*deltaS*/ )
 
             shaderParams.modelMat = glm::toMat4( glm::conjugate( rotation ) ) *
                                     glm::scale( glm::mat4( 1.0f ), glm::vec3( 1.0f ) / scaling ) *
-                                    glm::translate( glm::mat4( 1.0f ), position );
+                                    glm::translate( glm::mat4( 1.0f ), position ) *
+                                    mesh.positionQuantization.getDequantizationMatrix();
          }
 
          const size_t bufferSize = sizeof( InstancedComponent::ShaderParams ) * instanced.count;
@@ -6,10 +6,12 @@
 
 #include <ECS/Components/Rendering/RenderableComponent.h>
 #include <ECS/Components/Rendering/InstancedComponent.h>
+#include <ECS/Components/Rendering/MeshComponent.h>
 
 namespace CYD
 {
-class InstanceUpdateSystem final : public CommonSystem<RenderableComponent, InstancedComponent>
+class InstanceUpdateSystem final
+    : public CommonSystem<RenderableComponent, InstancedComponent, MeshComponent>
 {
   public:
    InstanceUpdateSystem() = default;
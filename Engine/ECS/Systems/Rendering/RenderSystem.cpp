@@ -1,13 +1,55 @@
 #include <ECS/Systems/Rendering/RenderSystem.h>
 
+#include <Graphics/PipelineInfos.h>
+#include <Graphics/StaticPipelines.h>
+#include <Graphics/GRIS/RenderInterface.h>
 #include <Graphics/GRIS/RenderHelpers.h>
+#include <Graphics/Scene/OcclusionCuller.h>
+#include <Graphics/Utility/Transforms.h>
 
 #include <ECS/SharedComponents/SceneComponent.h>
 
 #include <ECS/EntityManager.h>
 
+#include <Multithreading/ThreadPool.h>
+
+#include <Profiling.h>
+
+#include <algorithm>
+#include <cmath>
+
 namespace CYD
 {
+// Keep in sync with MAX_INSTANCES in INSTANCING.h
+static constexpr uint32_t MAX_BATCH_INSTANCES = 1024;
+
+// Batches are bound at offsets of the instances buffer, 256 bytes covers every uniform buffer
+// offset alignment
+static constexpr uint32_t INSTANCES_ALIGNMENT =
+    256 / sizeof( InstancedComponent::ShaderParams );
+
+// Below this many batches per chunk, a secondary command list and a worker wake-up cost more than
+// the recording they save
+static constexpr uint32_t MIN_BATCHES_PER_CHUNK = 256;
+
+// Each chunk holds on to a command buffer of its worker until the frame is done
+static constexpr uint32_t MAX_RECORDING_CHUNKS = 8;
+
+static bool ReadsInstancesData( const PipelineInfo& pipInfo )
+{
+   for( const ShaderSetInfo& shaderSetInfo : pipInfo.pipLayout.shaderSets )
+   {
+      for( const ShaderBindingInfo& shaderBindingInfo : shaderSetInfo.shaderBindings )
+      {
+         if( shaderBindingInfo.name == "InstancesData" ) return true;
+      }
+   }
+
+   return false;
+}
+
+RenderSystem::~RenderSystem() { GRIS::DestroyBuffer( m_instancesBuffer ); }
+
 uint32_t RenderSystem::getViewIndex( const SceneComponent& scene, std::string_view name ) const
 {
    // Finding main view
@@ -59,4 +101,426 @@ void RenderSystem::bindInverseView(
        viewOffset,
        sizeof( SceneComponent::InverseViewShaderParams ) );
 }
+
+void RenderSystem::cullEntities( const SceneComponent& scene, uint32_t viewIndex )
+{
+   CYD_TRACE( "Culling" );
+
+   updateWorldBounds();
+
+   m_culler.cull( scene.frustums[viewIndex], m_visibleEntities );
+
+   if( scene.occlusionCuller && scene.occlusionCuller->getViewIndex() == viewIndex )
+   {
+      scene.occlusionCuller->cull( m_worldBounds, m_visibleEntities );
+   }
+
+   _cullMeshlets( scene, viewIndex );
+}
+
+void RenderSystem::cullEntities( const Frustum& frustum )
+{
+   CYD_TRACE( "Culling" );
+
+   CYD_ASSERT(
+       m_worldBounds.size() == m_entities.size() &&
+       "RenderSystem: Culling without up to date world bounds" );
+
+   m_culler.cull( frustum, m_visibleEntities );
+
+   m_meshletDraws.clear();
+   m_meshletRanges.clear();
+}
+
+void RenderSystem::_cullMeshlets( const SceneComponent& scene, uint32_t viewIndex )
+{
+   CYD_TRACE( "Meshlet Culling" );
+
+   m_meshletDraws.assign( m_entities.size(), {} );
+   m_meshletRanges.clear();
+
+   glm::vec4 worldPlanes[6];
+   scene.frustums[viewIndex].getPlanes( worldPlanes );
+
+   const glm::vec4 viewPosition = glm::vec4( glm::vec3( scene.views[viewIndex].position ), 1.0f );
+
+   MeshletCullStats stats;
+
+   const auto isHidden = [&]( uint32_t entityIdx )
+   {
+      const EntityEntry& entityEntry        = m_entities[entityIdx];
+      const RenderableComponent& renderable = *std::get<RenderableComponent*>( entityEntry.arch );
+      const MeshComponent& mesh             = *std::get<MeshComponent*>( entityEntry.arch );
+      const TransformComponent& transform   = *std::get<TransformComponent*>( entityEntry.arch );
+
+      // The coarser LODs are not split in meshlets, and the cones only hold under uniform scaling
+      const glm::vec3& scaling = transform.scaling;
+      if( !mesh.meshlets || mesh.lod != 0 || renderable.isInstanced || renderable.isTessellated ||
+          scaling.x != scaling.y || scaling.x != scaling.z )
+      {
+         return false;
+      }
+
+      const glm::mat4 modelMatrix =
+          Transform::GetModelMatrix( transform.scaling, transform.rotation, transform.position );
+
+      // Planes brought to the local space of the mesh still measure world distances
+      glm::vec4 localPlanes[6];
+      for( uint32_t i = 0; i < 6; ++i )
+      {
+         localPlanes[i] = glm::transpose( modelMatrix ) * worldPlanes[i];
+      }
+
+      const glm::vec3 localView = glm::vec3( glm::inverse( modelMatrix ) * viewPosition );
+
+      MeshletDraw& draw = m_meshletDraws[entityIdx];
+      draw.firstRange   = static_cast<uint32_t>( m_meshletRanges.size() );
+
+      CullMeshlets(
+          *mesh.meshlets, localView, localPlanes, std::abs( scaling.x ), m_meshletRanges, stats );
+
+      draw.rangeCount = static_cast<uint32_t>( m_meshletRanges.size() ) - draw.firstRange;
+
+      // A single range covering the whole mesh is drawn as usual, and can still be batched
+      const bool isWhole = draw.rangeCount == 1 &&
+                           m_meshletRanges[draw.firstRange].indexCount == mesh.getIndexCount();
+      if( isWhole )
+      {
+         m_meshletRanges.pop_back();
+         draw.rangeCount = 0;
+         return false;
+      }
+
+      draw.isCulled = true;
+      return draw.rangeCount == 0;
+   };
+
+   m_visibleEntities.erase(
+       std::remove_if( m_visibleEntities.begin(), m_visibleEntities.end(), isHidden ),
+       m_visibleEntities.end() );
+}
+
+bool RenderSystem::_isMeshletCulled( uint32_t entityIdx ) const
+{
+   return entityIdx < m_meshletDraws.size() && m_meshletDraws[entityIdx].isCulled;
+}
+
+void RenderSystem::updateWorldBounds()
+{
+   m_culler.resize( static_cast<uint32_t>( m_entities.size() ) );
+   m_worldBounds.resize( m_entities.size() );
+
+   for( uint32_t i = 0; i < m_entities.size(); ++i )
+   {
+      const EntityEntry& entityEntry        = m_entities[i];
+      const RenderableComponent& renderable = *std::get<RenderableComponent*>( entityEntry.arch );
+      const MeshComponent& mesh             = *std::get<MeshComponent*>( entityEntry.arch );
+
+      // Meshes still streaming in have nothing to draw yet
+      if( !mesh.vertexCount )
+      {
+         m_culler.setNeverVisible( i );
+         m_worldBounds[i] = AABB();
+         continue;
+      }
+
+      // Instances are spread around by their own transforms, the mesh bounds say nothing about
+      // where they end up. Same for displaced meshes unless we know how far they can go
+      const bool unknownDisplacement = renderable.isTessellated && mesh.maxDisplacement <= 0.0f;
+      if( !mesh.bounds.isValid() || renderable.isInstanced || unknownDisplacement )
+      {
+         m_culler.setAlwaysVisible( i );
+         m_worldBounds[i] = AABB();
+         continue;
+      }
+
+      const TransformComponent& transform = *std::get<TransformComponent*>( entityEntry.arch );
+
+      const glm::mat4 modelMatrix =
+          Transform::GetModelMatrix( transform.scaling, transform.rotation, transform.position );
+
+      m_worldBounds[i] = mesh.getDisplacedBounds().transform( modelMatrix );
+      m_culler.setBounds( i, m_worldBounds[i] );
+   }
+}
+
+void RenderSystem::addDraw(
+    const SceneComponent& scene,
+    uint32_t viewIndex,
+    uint32_t entityIdx,
+    uint32_t pass,
+    PipelineIndex pipelineIdx )
+{
+   addDraw( glm::vec3( scene.views[viewIndex].position ), entityIdx, pass, pipelineIdx );
+}
+
+void RenderSystem::addDraw(
+    const glm::vec3& viewPosition,
+    uint32_t entityIdx,
+    uint32_t pass,
+    PipelineIndex pipelineIdx )
+{
+   const EntityEntry& entityEntry    = m_entities[entityIdx];
+   const MaterialComponent& material = *std::get<MaterialComponent*>( entityEntry.arch );
+   const MeshComponent& mesh         = *std::get<MeshComponent*>( entityEntry.arch );
+
+   // Entities without bounds are sorted by their origin
+   const AABB& bounds = m_worldBounds[entityIdx];
+   const glm::vec3 position =
+       bounds.isValid() ? bounds.getCenter()
+                        : std::get<TransformComponent*>( entityEntry.arch )->position;
+
+   const glm::vec3 toView = viewPosition - position;
+
+   const uint64_t key = DrawList::MakeKey(
+       pass,
+       pipelineIdx,
+       material.materialIdx,
+       mesh.vertexBuffer,
+       glm::dot( toView, toView ) );
+
+   m_drawList.add( key, entityIdx );
+}
+
+void RenderSystem::batchDraws( PipelineIndex pipelineOverride )
+{
+   CYD_TRACE( "Batching" );
+
+   const std::span<const DrawList::Packet> packets = m_drawList.getPackets();
+
+   const auto getEntry = [&]( uint32_t packetIdx ) -> const EntityEntry&
+   { return m_entities[packets[packetIdx].entityIdx]; };
+
+   PipelineIndex prevPipelineIdx = INVALID_PIPELINE_IDX;
+   bool pipelineReadsInstances   = false;
+
+   const auto canInstance = [&]( uint32_t packetIdx )
+   {
+      const EntityEntry& entityEntry        = getEntry( packetIdx );
+      const RenderableComponent& renderable = *std::get<RenderableComponent*>( entityEntry.arch );
+      const MaterialComponent& material     = *std::get<MaterialComponent*>( entityEntry.arch );
+
+      const PipelineIndex pipelineIdx =
+          pipelineOverride != INVALID_PIPELINE_IDX ? pipelineOverride : material.pipelineIdx;
+
+      if( pipelineIdx != prevPipelineIdx )
+      {
+         const PipelineInfo* pipInfo = StaticPipelines::Get( pipelineIdx );
+         pipelineReadsInstances      = pipInfo && ReadsInstancesData( *pipInfo );
+         prevPipelineIdx             = pipelineIdx;
+      }
+
+      // Instanced and tessellated renderables have their own buffers bound per draw
+      return pipelineReadsInstances && !renderable.isInstanced && !renderable.isTessellated;
+   };
+
+   const auto canMerge = [&]( uint32_t prevPacketIdx, uint32_t packetIdx )
+   {
+      const EntityEntry& prevEntry = getEntry( prevPacketIdx );
+      const EntityEntry& entry     = getEntry( packetIdx );
+
+      return std::get<RenderableComponent*>( prevEntry.arch )->isShadowReceiving ==
+                 std::get<RenderableComponent*>( entry.arch )->isShadowReceiving &&
+             std::get<MeshComponent*>( prevEntry.arch )->lod ==
+                 std::get<MeshComponent*>( entry.arch )->lod &&
+             !_isMeshletCulled( packets[prevPacketIdx].entityIdx ) &&
+             !_isMeshletCulled( packets[packetIdx].entityIdx );
+   };
+
+   const uint32_t slotCount = m_drawList.batch(
+       m_batches, MAX_BATCH_INSTANCES, INSTANCES_ALIGNMENT, canInstance, canMerge );
+
+   m_instances.assign( slotCount, {} );
+   for( const DrawBatch& batch : m_batches )
+   {
+      if( !batch.isInstanced ) continue;
+
+      for( uint32_t i = 0; i < batch.packetCount; ++i )
+      {
+         const EntityEntry& entityEntry      = getEntry( batch.firstPacket + i );
+         const TransformComponent& transform = *std::get<TransformComponent*>( entityEntry.arch );
+         const MeshComponent& mesh           = *std::get<MeshComponent*>( entityEntry.arch );
+
+         const glm::mat4 modelMatrix =
+             Transform::GetModelMatrix( transform.scaling, transform.rotation, transform.position );
+         m_instances[batch.firstInstance + i].modelMat =
+             modelMatrix * mesh.positionQuantization.getDequantizationMatrix();
+      }
+   }
+
+   if( m_instances.empty() ) return;
+
+   const size_t instancesSize = m_instances.size() * sizeof( InstancedComponent::ShaderParams );
+   if( instancesSize > m_instancesCapacity )
+   {
+      // Growing geometrically, the previous buffer is released once the frames using it are done
+      m_instancesCapacity = std::max( instancesSize, m_instancesCapacity * 2 );
+
+      GRIS::DestroyBuffer( m_instancesBuffer );
+      m_instancesBuffer = GRIS::CreateUniformBuffer( m_instancesCapacity, "Auto Instances Buffer" );
+   }
+
+   const UploadToBufferInfo info = { 0, instancesSize };
+   GRIS::UploadToBuffer( m_instancesBuffer, m_instances.data(), info );
+}
+
+void RenderSystem::_drawMeshletRanges(
+    CmdListHandle cmdList,
+    uint32_t entityIdx,
+    bool isAutoInstanced ) const
+{
+   const MeshletDraw& draw = m_meshletDraws[entityIdx];
+
+   for( uint32_t i = draw.firstRange; i < draw.firstRange + draw.rangeCount; ++i )
+   {
+      const IndexRange& range = m_meshletRanges[i];
+
+      if( isAutoInstanced )
+      {
+         GRIS::DrawIndexedInstanced( cmdList, range.indexCount, 1, range.firstIndex );
+      }
+      else
+      {
+         GRIS::DrawIndexed( cmdList, range.indexCount, range.firstIndex );
+      }
+   }
+}
+
+void RenderSystem::drawBatch(
+    CmdListHandle cmdList,
+    const DrawBatch& batch,
+    const PipelineInfo& pipInfo ) const
+{
+   const uint32_t entityIdx       = m_drawList.getPackets()[batch.firstPacket].entityIdx;
+   const EntityEntry& entityEntry = m_entities[entityIdx];
+
+   const RenderableComponent& renderable = *std::get<RenderableComponent*>( entityEntry.arch );
+   const MeshComponent& mesh             = *std::get<MeshComponent*>( entityEntry.arch );
+
+   if( batch.isInstanced )
+   {
+      // The model matrices are all in the instances
+      const glm::mat4 identity( 1.0f );
+      GRIS::NamedUpdateConstantBuffer( cmdList, "Model", &identity, pipInfo );
+
+      GRIS::NamedBufferBinding(
+          cmdList,
+          m_instancesBuffer,
+          "InstancesData",
+          pipInfo,
+          batch.firstInstance * sizeof( InstancedComponent::ShaderParams ),
+          batch.packetCount * sizeof( InstancedComponent::ShaderParams ) );
+
+      // Entities with culled meshlets are never merged with others
+      if( _isMeshletCulled( entityIdx ) )
+      {
+         _drawMeshletRanges( cmdList, entityIdx, true );
+      }
+      else if( mesh.indexCount )
+      {
+         GRIS::DrawIndexedInstanced(
+             cmdList, mesh.getIndexCount(), batch.packetCount, mesh.getFirstIndex() );
+      }
+      else
+      {
+         GRIS::DrawInstanced( cmdList, mesh.vertexCount, batch.packetCount );
+      }
+
+      return;
+   }
+
+   // Instanced renderables can have no instance to draw, like a terrain out of the view
+   if( renderable.isInstanced && renderable.instanceCount == 0 ) return;
+
+   const TransformComponent& transform = *std::get<TransformComponent*>( entityEntry.arch );
+
+   // Quantized positions are brought back to the local space of the mesh first, instances do it
+   // in their own model matrices since they go in between
+   glm::mat4 modelMatrix =
+       Transform::GetModelMatrix( transform.scaling, transform.rotation, transform.position );
+   if( !renderable.isInstanced )
+   {
+      modelMatrix *= mesh.positionQuantization.getDequantizationMatrix();
+   }
+
+   GRIS::NamedUpdateConstantBuffer( cmdList, "Model", &modelMatrix, pipInfo );
+
+   if( renderable.instanceCount )
+   {
+      if( mesh.indexCount )
+      {
+         GRIS::DrawIndexedInstanced(
+             cmdList, mesh.getIndexCount(), renderable.instanceCount, mesh.getFirstIndex() );
+      }
+      else
+      {
+         GRIS::DrawInstanced( cmdList, mesh.vertexCount, renderable.instanceCount );
+      }
+   }
+   else
+   {
+      if( _isMeshletCulled( entityIdx ) )
+      {
+         _drawMeshletRanges( cmdList, entityIdx, false );
+      }
+      else if( mesh.indexCount )
+      {
+         GRIS::DrawIndexed( cmdList, mesh.getIndexCount(), mesh.getFirstIndex() );
+      }
+      else
+      {
+         GRIS::Draw( cmdList, mesh.vertexCount );
+      }
+   }
+}
+
+bool RenderSystem::shouldRecordInParallel() const
+{
+   return m_threadPool.getThreadCount() > 1 && m_batches.size() >= 2 * MIN_BATCHES_PER_CHUNK;
+}
+
+void RenderSystem::recordBatches(
+    CmdListHandle cmdList,
+    bool inParallel,
+    const RecordFunction& recordFunc )
+{
+   CYD_TRACE( "Recording" );
+
+   const uint32_t batchCount = static_cast<uint32_t>( m_batches.size() );
+
+   if( !inParallel )
+   {
+      recordFunc( cmdList, 0, batchCount );
+      return;
+   }
+
+   CYD_ASSERT( m_threadPool.isInit() && "RenderSystem: Recording in parallel without workers" );
+
+   const uint32_t chunkCount = std::clamp(
+       batchCount / MIN_BATCHES_PER_CHUNK,
+       1u,
+       std::min( m_threadPool.getThreadCount(), MAX_RECORDING_CHUNKS ) );
+
+   std::vector<CmdListHandle> secondaryLists( chunkCount );
+
+   // Every chunk has its own secondary list, from the command pools of its recording thread
+   m_threadPool.parallelFor(
+       EMP::ThreadPool::Lane::FRAME_CRITICAL,
+       chunkCount,
+       [&]( uint32_t chunkIdx )
+       {
+          const uint32_t firstBatch = batchCount * chunkIdx / chunkCount;
+          const uint32_t lastBatch  = batchCount * ( chunkIdx + 1 ) / chunkCount;
+
+          secondaryLists[chunkIdx] = GRIS::CreateSecondaryCommandList( cmdList, "Draw Chunk" );
+          recordFunc( secondaryLists[chunkIdx], firstBatch, lastBatch );
+       } );
+
+   GRIS::ExecuteCommandLists( cmdList, secondaryLists );
+
+   for( const CmdListHandle secondaryList : secondaryLists )
+   {
+      GRIS::DestroyCommandList( secondaryList );
+   }
+}
 }
\ No newline at end of file
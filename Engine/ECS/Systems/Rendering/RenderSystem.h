@@ -5,10 +5,27 @@
 #include <Common/Include.h>
 
 #include <ECS/Components/Transforms/TransformComponent.h>
+#include <ECS/Components/Rendering/InstancedComponent.h>
 #include <ECS/Components/Rendering/MaterialComponent.h>
 #include <ECS/Components/Rendering/MeshComponent.h>
 #include <ECS/Components/Rendering/RenderableComponent.h>
 
+#include <Graphics/Scene/Bounds.h>
+#include <Graphics/Scene/DrawList.h>
+#include <Graphics/Scene/FrustumCuller.h>
+#include <Graphics/Scene/Meshlets.h>
+
+#include <functional>
+#include <vector>
+
+// ================================================================================================
+// Forwards
+// ================================================================================================
+namespace EMP
+{
+class ThreadPool;
+}
+
 // ================================================================================================
 // Definition
 // ================================================================================================
@@ -23,9 +40,12 @@ class RenderSystem
 {
   public:
    RenderSystem() = delete;
-   RenderSystem( const MaterialCache& materials ) : m_materials( materials ) {}
+   RenderSystem( const MaterialCache& materials, EMP::ThreadPool& threadPool )
+       : m_materials( materials ), m_threadPool( threadPool )
+   {
+   }
    NON_COPIABLE( RenderSystem );
-   virtual ~RenderSystem() = default;
+   virtual ~RenderSystem();
 
   protected:
    uint32_t getViewIndex( const SceneComponent& scene, std::string_view name ) const;
@@ -42,6 +62,95 @@ class RenderSystem
        const PipelineInfo* pipInfo,
        uint32_t viewIndex ) const;
 
+   // Culls the entities against the frustum of a view, and against the occluders when they were
+   // rasterized from that view. The indices in m_entities of the ones to draw are written to
+   // m_visibleEntities, in the same order as they appear in m_entities. The meshlets of the
+   // visible entities are culled too, the ones with none left are dropped
+   void cullEntities( const SceneComponent& scene, uint32_t viewIndex );
+
+   // For systems culling against several frustums in a frame, the world bounds are only updated
+   // once and each frustum is culled against them. No occlusion culling
+   void updateWorldBounds();
+   void cullEntities( const Frustum& frustum );
+
+   // Adds a culled entity to m_drawList, keyed on its pass, state and distance to the view. The
+   // pipeline is passed in for systems that override the one of the material
+   void addDraw(
+       const SceneComponent& scene,
+       uint32_t viewIndex,
+       uint32_t entityIdx,
+       uint32_t pass,
+       PipelineIndex pipelineIdx );
+   void addDraw(
+       const glm::vec3& viewPosition,
+       uint32_t entityIdx,
+       uint32_t pass,
+       PipelineIndex pipelineIdx );
+
+   // Consecutive draws sharing their pass, pipeline, material and mesh in the sorted m_drawList
+   // are merged in a single instanced draw. Only for pipelines that read the model matrices from
+   // "InstancesData", their batches of one go through the instances buffer too. The instance
+   // slots of a batch are its model matrices in m_instances
+   using DrawBatch = DrawList::Batch;
+
+   // Fills m_batches and uploads the model matrices of the instanced ones. The pipeline override
+   // is for systems that do not draw with the pipeline of the material
+   void batchDraws( PipelineIndex pipelineOverride = INVALID_PIPELINE_IDX );
+
+   // Model push constant, instances binding and draw call of a batch. The other bindings and the
+   // state of its first entity are up to the caller
+   void drawBatch(
+       CmdListHandle cmdList,
+       const DrawBatch& batch,
+       const PipelineInfo& pipInfo ) const;
+
+   // Records the batches in [firstBatch, lastBatch) of m_batches, along with the dynamic state and
+   // the bindings shared by all of them. Called once per chunk of batches, on the worker threads
+   // when recording in parallel
+   using RecordFunction =
+       std::function<void( CmdListHandle cmdList, uint32_t firstBatch, uint32_t lastBatch )>;
+
+   // Whether m_batches is large enough to be worth splitting over the worker threads. When it is,
+   // the render pass has to be begun with secondary contents
+   bool shouldRecordInParallel() const;
+
+   // Records all of m_batches in the current render pass of cmdList. In parallel, chunks of
+   // batches are recorded in secondary command lists by the worker threads, then executed in the
+   // order of the draw list
+   void recordBatches( CmdListHandle cmdList, bool inParallel, const RecordFunction& recordFunc );
+
    const MaterialCache& m_materials;
+   EMP::ThreadPool& m_threadPool;
+
+   FrustumCuller m_culler;
+   std::vector<AABB> m_worldBounds;  // Invalid for the entities that are always visible
+   std::vector<uint32_t> m_visibleEntities;
+
+   DrawList m_drawList;
+
+   std::vector<DrawBatch> m_batches;
+   std::vector<InstancedComponent::ShaderParams> m_instances;
+   BufferHandle m_instancesBuffer;
+   size_t m_instancesCapacity = 0;
+
+  private:
+   // Culls the meshlets of the visible entities drawn at full detail, from the view
+   void _cullMeshlets( const SceneComponent& scene, uint32_t viewIndex );
+
+   // Whether only some meshlets of the entity are drawn, as ranges of m_meshletRanges
+   bool _isMeshletCulled( uint32_t entityIdx ) const;
+
+   // Draws the meshlet ranges of an entity, as single instances for auto-instanced batches
+   void _drawMeshletRanges( CmdListHandle cmdList, uint32_t entityIdx, bool isAutoInstanced ) const;
+
+   // Per entity, empty when the meshlets were not culled
+   struct MeshletDraw
+   {
+      uint32_t firstRange = 0;
+      uint32_t rangeCount = 0;
+      bool isCulled       = false;
+   };
+   std::vector<MeshletDraw> m_meshletDraws;
+   std::vector<IndexRange> m_meshletRanges;
 };
 }
@@ -0,0 +1,389 @@
+#include <ECS/Systems/Rendering/TerrainSystem.h>
+
+#include <Graphics/GRIS/RenderInterface.h>
+#include <Graphics/Utility/Transforms.h>
+
+#include <ECS/SharedComponents/SceneComponent.h>
+#include <ECS/EntityManager.h>
+
+#include <Multithreading/ThreadPool.h>
+
+#include <Profiling.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <tuple>
+
+namespace CYD
+{
+static constexpr size_t PATCHES_BUFFER_SIZE =
+    sizeof( TerrainComponent::ShaderParams ) +
+    TerrainComponent::MAX_PATCHES * sizeof( TerrainQuadtree::Patch );
+
+// The occluder is a grid of 2^depth tiles per side, a few hundred triangles for the culler
+static constexpr uint32_t OCCLUDER_DEPTH = 4;
+
+// Box of a patch in the space of the terrain, over the whole height range
+static AABB GetPatchBounds( const TerrainQuadtree::Patch& patch, float heightScale )
+{
+   return { glm::vec3( patch.origin.x, 0.0f, patch.origin.y ),
+            glm::vec3( patch.origin.x + patch.size, heightScale, patch.origin.y + patch.size ) };
+}
+
+static bool IsPatchBefore(
+    const TerrainQuadtree::Patch& first,
+    const TerrainQuadtree::Patch& second )
+{
+   return std::tie( first.origin.x, first.origin.y, first.size, first.lodAndStep ) <
+          std::tie( second.origin.x, second.origin.y, second.size, second.lodAndStep );
+}
+
+// Whether a vertex of the patch is far enough from the view position to morph. The root never does
+static bool CanMorph(
+    const TerrainQuadtree& quadtree,
+    const TerrainQuadtree::Patch& patch,
+    const AABB& bounds,
+    const glm::vec3& viewPosition )
+{
+   const uint32_t lod = patch.lodAndStep & 0xFF;
+   if( lod + 1 >= quadtree.getLodCount() ) return false;
+
+   const glm::vec3 farthest =
+       glm::max( glm::abs( viewPosition - bounds.min ), glm::abs( viewPosition - bounds.max ) );
+   return glm::length( farthest ) > quadtree.getMorphStart( lod );
+}
+
+// Heightfield over the tiles of a LOD of the quadtree, in the space of the terrain. Every vertex
+// takes the lowest height of the tiles around it, so the triangles of a tile stay under the lowest
+// height of that tile and never hide what the terrain does not
+static std::shared_ptr<const OccluderGeometry> BuildOccluder(
+    const TerrainQuadtree& quadtree,
+    uint32_t depth )
+{
+   const uint32_t rootLod      = quadtree.getLodCount() - 1;
+   const uint32_t lod          = rootLod - std::min( depth, rootLod );
+   const uint32_t tilesPerSide = 1 << ( rootLod - lod );
+   const uint32_t side         = tilesPerSide + 1;
+   const float tileSize        = quadtree.getNodeSize( lod );
+   const float origin          = -0.5f * tileSize * tilesPerSide;
+
+   auto occluder = std::make_shared<OccluderGeometry>();
+   occluder->positions.reserve( side * side );
+   occluder->indices.reserve( tilesPerSide * tilesPerSide * 6 );
+
+   for( uint32_t z = 0; z < side; ++z )
+   {
+      for( uint32_t x = 0; x < side; ++x )
+      {
+         float height = std::numeric_limits<float>::max();
+         for( uint32_t tileZ = z ? z - 1 : 0; tileZ <= std::min( z, tilesPerSide - 1 ); ++tileZ )
+         {
+            for( uint32_t tileX = x ? x - 1 : 0; tileX <= std::min( x, tilesPerSide - 1 ); ++tileX )
+            {
+               height = std::min( height, quadtree.getNodeHeights( lod, tileX, tileZ ).x );
+            }
+         }
+
+         occluder->positions.emplace_back( origin + x * tileSize, height, origin + z * tileSize );
+      }
+   }
+
+   for( uint32_t z = 0; z < tilesPerSide; ++z )
+   {
+      for( uint32_t x = 0; x < tilesPerSide; ++x )
+      {
+         const uint32_t corner = z * side + x;
+         occluder->indices.insert(
+             occluder->indices.end(),
+             { corner, corner + side, corner + side + 1, corner, corner + side + 1, corner + 1 } );
+      }
+   }
+
+   return occluder;
+}
+
+bool TerrainSystem::BuildSettings::operator==( const BuildSettings& other ) const
+{
+   return size == other.size && heightScale == other.heightScale && lodCount == other.lodCount &&
+          noiseType == other.noiseType && width == other.width && height == other.height &&
+          isAnimated == other.isAnimated &&
+          std::memcmp( &noiseParams, &other.noiseParams, sizeof( noiseParams ) ) == 0;
+}
+
+// ================================================================================================
+void TerrainSystem::tick( double /*deltaS*/ )
+{
+   CYD_TRACE( "TerrainSystem" );
+
+   const SceneComponent& scene = m_ecs->getSharedComponent<SceneComponent>();
+
+   const auto mainView = std::find( scene.viewNames.begin(), scene.viewNames.end(), "MAIN" );
+   if( mainView == scene.viewNames.end() ) return;
+
+   const uint32_t mainViewIdx =
+       static_cast<uint32_t>( std::distance( scene.viewNames.begin(), mainView ) );
+
+   glm::vec4 worldPlanes[6];
+   scene.frustums[mainViewIdx].getPlanes( worldPlanes );
+
+   m_frame++;
+
+   for( const auto& entityEntry : m_entities )
+   {
+      RenderableComponent& renderable = *std::get<RenderableComponent*>( entityEntry.arch );
+      TerrainComponent& terrain       = *std::get<TerrainComponent*>( entityEntry.arch );
+      MeshComponent& mesh             = *std::get<MeshComponent*>( entityEntry.arch );
+
+      const TransformComponent& transform = *std::get<TransformComponent*>( entityEntry.arch );
+      const ProceduralDisplacementComponent& displacement =
+          *std::get<ProceduralDisplacementComponent*>( entityEntry.arch );
+
+      Terrain& state      = m_terrains[entityEntry.handle];
+      state.lastSeenFrame = m_frame;
+
+      if( _updateQuadtree( state, terrain, displacement ) )
+      {
+         // Until the heights are known, the base plane of the terrain is all that is under it
+         const uint32_t occluderDepth = terrain.hasHeightBounds ? OCCLUDER_DEPTH : 0;
+         state.occluder               = BuildOccluder( *state.quadtree, occluderDepth );
+         state.needsShadowPatches     = true;
+      }
+
+      // The mesh loader fills the occluder of the patch mesh, the one of the terrain replaces it
+      mesh.occluder = state.occluder;
+
+      TerrainQuadtree& quadtree = *state.quadtree;
+
+      // The selection happens in the space of the terrain, the ranges are scaled along X and the
+      // terrains are expected to be scaled uniformly
+      const glm::mat4 modelMat =
+          Transform::GetModelMatrix( transform.scaling, transform.rotation, transform.position );
+      const glm::mat4 invModelMat = glm::inverse( modelMat );
+
+      quadtree.setLodDistance( terrain.lodDistance / transform.scaling.x, terrain.morphRatio );
+
+      const glm::vec3 viewPosition = glm::vec3(
+          invModelMat * glm::vec4( glm::vec3( scene.views[mainViewIdx].position ), 1.0f ) );
+
+      // A plane goes to the space of the terrain through the transpose of the model matrix
+      glm::vec4 planes[6];
+      for( uint32_t i = 0; i < 6; ++i )
+      {
+         planes[i] = glm::transpose( modelMat ) * worldPlanes[i];
+      }
+
+      quadtree.select( viewPosition, planes, m_patches );
+      terrain.stats = quadtree.getStats();
+
+      renderable.isInstanced = true;
+      _uploadPatches(
+          renderable.instancesBuffer, terrain, quadtree, viewPosition, renderable.instanceCount );
+
+      // Shadows only select again once the view moved by a leaf, the patches and their morph are
+      // the same until then
+      const float leafSize = quadtree.getNodeSize( 0 );
+      const glm::vec3 shadowViewPosition =
+          glm::floor( viewPosition / leafSize + 0.5f ) * leafSize;
+
+      terrain.shadowChangedBounds.clear();
+
+      // Other morph ranges change every patch
+      if( terrain.lodDistance != state.shadowLodDistance ||
+          terrain.morphRatio != state.shadowMorphRatio )
+      {
+         state.needsShadowPatches = true;
+      }
+
+      if( state.needsShadowPatches || shadowViewPosition != state.shadowViewPosition )
+      {
+         quadtree.select( shadowViewPosition, nullptr, m_patches );
+         _uploadPatches(
+             terrain.shadowPatchesBuffer,
+             terrain,
+             quadtree,
+             shadowViewPosition,
+             terrain.shadowPatchCount );
+
+         if( state.needsShadowPatches )
+         {
+            const AABB terrainBounds = {
+                glm::vec3( -0.5f * terrain.size, 0.0f, -0.5f * terrain.size ),
+                glm::vec3( 0.5f * terrain.size, terrain.heightScale, 0.5f * terrain.size ) };
+            terrain.shadowChangedBounds.push_back( terrainBounds.transform( modelMat ) );
+         }
+         else
+         {
+            _findChangedShadowPatches( state, terrain, quadtree, shadowViewPosition, modelMat );
+         }
+
+         state.shadowPatches      = m_patches;
+         state.shadowViewPosition = shadowViewPosition;
+         state.shadowLodDistance  = terrain.lodDistance;
+         state.shadowMorphRatio   = terrain.morphRatio;
+         state.needsShadowPatches = false;
+      }
+   }
+
+   for( auto it = m_terrains.begin(); it != m_terrains.end(); )
+   {
+      if( it->second.lastSeenFrame != m_frame )
+      {
+         it = m_terrains.erase( it );
+      }
+      else
+      {
+         ++it;
+      }
+   }
+}
+
+bool TerrainSystem::_updateQuadtree(
+    Terrain& state,
+    TerrainComponent& terrain,
+    const ProceduralDisplacementComponent& displacement )
+{
+   BuildSettings settings;
+   settings.size        = terrain.size;
+   settings.heightScale = terrain.heightScale;
+   settings.lodCount    = terrain.lodCount;
+   settings.noiseType   = displacement.type;
+   settings.noiseParams = displacement.params;
+   settings.width       = displacement.width;
+   settings.height      = displacement.height;
+   settings.isAnimated  = displacement.speed > 0.0f;
+
+   if( state.quadtree && state.settings == settings )
+   {
+      // The heights finished generating, the build of older settings was dropped with its future
+      if( state.pendingBuild.valid() &&
+          state.pendingBuild.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready )
+      {
+         state.quadtree          = state.pendingBuild.get();
+         terrain.hasHeightBounds = true;
+         return true;
+      }
+
+      return false;
+   }
+
+   state.settings = settings;
+
+   // Until the heights are known, every node can go from the bottom to the top of the terrain
+   state.quadtree = std::make_unique<TerrainQuadtree>();
+   state.quadtree->buildFlat( settings.size, settings.heightScale, settings.lodCount );
+   state.pendingBuild = {};
+
+   terrain.hasHeightBounds = false;
+
+   // Only the simplex noise has a CPU version. Animated displacement changes every frame, its
+   // bounds stay conservative
+   if( settings.noiseType != Noise::Type::SIMPLEX_NOISE || settings.isAnimated ||
+       settings.width == 0 || settings.height == 0 )
+   {
+      return true;
+   }
+
+   state.pendingBuild = m_threadPool.submit(
+       EMP::ThreadPool::Lane::BACKGROUND,
+       [settings]()
+       {
+          CYD_TRACE( "Terrain Heights" );
+
+          std::vector<float> heights( static_cast<size_t>( settings.width ) * settings.height );
+          Noise::GenerateSimplex(
+              settings.width, settings.height, settings.noiseParams, heights.data() );
+
+          auto quadtree = std::make_unique<TerrainQuadtree>();
+          quadtree->build(
+              heights.data(),
+              settings.width,
+              settings.height,
+              settings.size,
+              settings.heightScale,
+              settings.lodCount );
+
+          return quadtree;
+       } );
+
+   return true;
+}
+
+void TerrainSystem::_findChangedShadowPatches(
+    const Terrain& state,
+    TerrainComponent& terrain,
+    const TerrainQuadtree& quadtree,
+    const glm::vec3& viewPosition,
+    const glm::mat4& modelMat )
+{
+   m_previousPatches = state.shadowPatches;
+   std::sort( m_previousPatches.begin(), m_previousPatches.end(), IsPatchBefore );
+
+   // The area of a patch that is no longer selected is covered by new patches
+   for( const TerrainQuadtree::Patch& patch : m_patches )
+   {
+      const AABB bounds = GetPatchBounds( patch, terrain.heightScale );
+
+      const bool isUnchanged =
+          std::binary_search(
+              m_previousPatches.begin(), m_previousPatches.end(), patch, IsPatchBefore ) &&
+          !CanMorph( quadtree, patch, bounds, state.shadowViewPosition ) &&
+          !CanMorph( quadtree, patch, bounds, viewPosition );
+
+      if( !isUnchanged )
+      {
+         terrain.shadowChangedBounds.push_back( bounds.transform( modelMat ) );
+      }
+   }
+}
+
+void TerrainSystem::_uploadPatches(
+    BufferHandle& buffer,
+    const TerrainComponent& terrain,
+    const TerrainQuadtree& quadtree,
+    const glm::vec3& viewPosition,
+    uint32_t& patchCount )
+{
+   if( m_patches.size() > TerrainComponent::MAX_PATCHES )
+   {
+      // TODO WARNINGS
+      printf( "TerrainSystem: Too many patches selected, increase the LOD distance\n" );
+      m_patches.resize( TerrainComponent::MAX_PATCHES );
+   }
+
+   TerrainComponent::ShaderParams params = {};
+   for( uint32_t lod = 0; lod < quadtree.getLodCount(); ++lod )
+   {
+      // The root never morphs, its range never ends
+      const float start     = quadtree.getMorphStart( lod );
+      const float end       = quadtree.getLodRange( lod );
+      const float invLength = lod + 1 < quadtree.getLodCount() ? 1.0f / ( end - start ) : 0.0f;
+
+      params.morphRanges[lod] = glm::vec4( start, invLength, 0.0f, 0.0f );
+   }
+
+   params.viewPosition   = glm::vec4( viewPosition, 1.0f );
+   params.size           = terrain.size;
+   params.heightScale    = terrain.heightScale;
+   params.gridResolution = static_cast<float>( TerrainComponent::PATCH_RESOLUTION );
+
+   if( !buffer )
+   {
+      buffer = GRIS::CreateUniformBuffer( PATCHES_BUFFER_SIZE, "Terrain Patches Buffer" );
+   }
+
+   const UploadToBufferInfo paramsInfo = { 0, sizeof( params ) };
+   GRIS::UploadToBuffer( buffer, &params, paramsInfo );
+
+   if( !m_patches.empty() )
+   {
+      const UploadToBufferInfo patchesInfo = {
+          sizeof( params ), m_patches.size() * sizeof( TerrainQuadtree::Patch ) };
+      GRIS::UploadToBuffer( buffer, m_patches.data(), patchesInfo );
+   }
+
+   patchCount = static_cast<uint32_t>( m_patches.size() );
+}
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <ECS/Systems/CommonSystem.h>
+
+#include <Common/Include.h>
+
+#include <ECS/Components/Procedural/ProceduralDisplacementComponent.h>
+#include <ECS/Components/Rendering/MeshComponent.h>
+#include <ECS/Components/Rendering/RenderableComponent.h>
+#include <ECS/Components/Rendering/TerrainComponent.h>
+#include <ECS/Components/Transforms/TransformComponent.h>
+
+#include <Graphics/Scene/TerrainQuadtree.h>
+
+#include <future>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// ================================================================================================
+// Forwards
+// ================================================================================================
+namespace EMP
+{
+class ThreadPool;
+}
+
+// ================================================================================================
+// Definition
+// ================================================================================================
+/*
+Selects the patches of the terrains for the main view and for the shadows, and uploads them to the
+instance buffers of their renderables. The quadtree bounds of a terrain are built from the heights
+of its displacement, generated again on the CPU in the background whenever it changes. The lowest
+heights of the quadtree tiles also give the terrains an occluder that stays under their surface.
+*/
+namespace CYD
+{
+class TerrainSystem final : public CommonSystem<
+                                RenderableComponent,
+                                TransformComponent,
+                                TerrainComponent,
+                                ProceduralDisplacementComponent,
+                                MeshComponent>
+{
+  public:
+   explicit TerrainSystem( EMP::ThreadPool& threadPool ) : m_threadPool( threadPool ) {}
+   NON_COPIABLE( TerrainSystem );
+   virtual ~TerrainSystem() = default;
+
+   void tick( double deltaS ) override;
+
+  private:
+   // Settings and displacement a quadtree was built with, changes are detected against them
+   struct BuildSettings
+   {
+      float size        = 0.0f;
+      float heightScale = 0.0f;
+      uint32_t lodCount = 0;
+
+      Noise::Type noiseType = Noise::Type::COUNT;
+      Noise::ShaderParams noiseParams;
+      uint32_t width  = 0;
+      uint32_t height = 0;
+      bool isAnimated = false;
+
+      bool operator==( const BuildSettings& other ) const;
+   };
+
+   struct Terrain
+   {
+      std::unique_ptr<TerrainQuadtree> quadtree;
+      std::future<std::unique_ptr<TerrainQuadtree>> pendingBuild;
+      BuildSettings settings;
+
+      std::shared_ptr<const OccluderGeometry> occluder;
+
+      // Last shadow selection, and the view position and morph settings it was made with
+      std::vector<TerrainQuadtree::Patch> shadowPatches;
+      glm::vec3 shadowViewPosition = glm::vec3( 0.0f );
+      float shadowLodDistance      = 0.0f;
+      float shadowMorphRatio       = 0.0f;
+      bool needsShadowPatches      = true;
+
+      uint64_t lastSeenFrame = 0;
+   };
+
+   // Starts building the quadtree again when the terrain or its displacement changed, and swaps in
+   // the build that finished. True when the quadtree changed
+   bool _updateQuadtree(
+       Terrain& state,
+       TerrainComponent& terrain,
+       const ProceduralDisplacementComponent& displacement );
+
+   // Adds the bounds of the shadow patches in m_patches that were not in the last selection, or
+   // that morph from either view position
+   void _findChangedShadowPatches(
+       const Terrain& state,
+       TerrainComponent& terrain,
+       const TerrainQuadtree& quadtree,
+       const glm::vec3& viewPosition,
+       const glm::mat4& modelMat );
+
+   void _uploadPatches(
+       BufferHandle& buffer,
+       const TerrainComponent& terrain,
+       const TerrainQuadtree& quadtree,
+       const glm::vec3& viewPosition,
+       uint32_t& patchCount );
+
+   EMP::ThreadPool& m_threadPool;
+
+   std::unordered_map<EntityHandle, Terrain> m_terrains;
+   std::vector<TerrainQuadtree::Patch> m_patches;
+   std::vector<TerrainQuadtree::Patch> m_previousPatches;  // Sorted
+   uint64_t m_frame = 0;
+};
+}
@@ -5,8 +5,13 @@
 
 #include <Graphics/Scene/MeshCache.h>
 
+#include <ECS/EntityManager.h>
+#include <ECS/SharedComponents/SceneComponent.h>
+
 #include <Profiling.h>
 
+#include <algorithm>
+
 namespace CYD
 {
 static bool findMesh( MeshComponent& mesh, MeshCache& cache )
@@ -17,8 +22,18 @@ static bool findMesh( MeshComponent& mesh, MeshCache& cache )
    {
       mesh.vertexBuffer = loadedMesh.vertexBuffer;
       mesh.indexBuffer  = loadedMesh.indexBuffer;
+      mesh.indexType    = loadedMesh.indexType;
       mesh.vertexCount  = loadedMesh.vertexCount;
       mesh.indexCount   = loadedMesh.indexCount;
+      mesh.lods         = loadedMesh.lods;
+      mesh.lodCount     = loadedMesh.lodCount;
+
+      mesh.positionQuantization = loadedMesh.positionQuantization;
+
+      mesh.bounds         = loadedMesh.bounds;
+      mesh.boundingSphere = loadedMesh.boundingSphere;
+      mesh.occluder       = loadedMesh.occluder;
+      mesh.meshlets       = loadedMesh.meshlets;
 
       return true;
    }
@@ -29,23 +44,41 @@ static bool findMesh( MeshComponent& mesh, MeshCache& cache )
 void MeshLoaderSystem::tick( double /*deltaS*/ )
 {
    CYD_TRACE( "MeshLoaderSystem" );
-   
+
    const CmdListHandle cmdList = RenderGraph::GetCommandList( RenderGraph::Pass::LOAD );
 
-   for( const auto& entityEntry : m_entities )
+   // Meshes are streamed in, entities keep an empty mesh that is not drawn until theirs is ready
+   m_meshCache.uploadStreamedMeshes( cmdList );
+
+   const auto isDone = [this]( const EntityEntry& entityEntry )
    {
       MeshComponent& mesh = *std::get<MeshComponent*>( entityEntry.arch );
+      if( mesh.asset.empty() ) return true;
 
-      if( !mesh.asset.empty() && !findMesh( mesh, m_meshCache ) )
+      switch( m_meshCache.requestMesh( mesh.asset ) )
       {
-         m_meshCache.loadMeshFromPath( cmdList, mesh.asset );
-
-         const bool foundMesh = findMesh( mesh, m_meshCache );
-         CYD_ASSERT( foundMesh && "MeshLoaderSystem: A named mesh could not be loaded" );
+         case MeshCache::StreamingState::LOADED:
+         {
+            const bool foundMesh = findMesh( mesh, m_meshCache );
+            CYD_ASSERT( foundMesh && "MeshLoaderSystem: A streamed mesh is not in the cache" );
+            return foundMesh;
+         }
+         case MeshCache::StreamingState::FAILED:
+            CYD_ASSERT( !"MeshLoaderSystem: A named mesh could not be loaded" );
+            return true;
+         case MeshCache::StreamingState::LOADING:
+            return false;
       }
-   }
 
-   // We don't want to spend more time on loading these entities' resources
-   m_entities.clear();
+      return false;
+   };
+
+   // We don't want to spend more time on the entities that have their mesh
+   m_entities.erase(
+       std::remove_if( m_entities.begin(), m_entities.end(), isDone ), m_entities.end() );
+
+   // Write component
+   SceneComponent& scene = m_ecs->getSharedComponent<SceneComponent>();
+   scene.meshCache       = &m_meshCache;
 }
 }
@@ -0,0 +1,65 @@
+#include <ECS/Systems/Scene/MeshLodSystem.h>
+
+#include <Graphics/Scene/Bounds.h>
+#include <Graphics/Utility/Transforms.h>
+
+#include <ECS/EntityManager.h>
+#include <ECS/SharedComponents/SceneComponent.h>
+
+#include <Profiling.h>
+
+#include <algorithm>
+
+namespace CYD
+{
+void MeshLodSystem::tick( double /*deltaS*/ )
+{
+   CYD_TRACE( "MeshLodSystem" );
+
+   // Write component
+   SceneComponent& scene = m_ecs->getSharedComponent<SceneComponent>();
+
+   const auto it = std::find( scene.viewNames.begin(), scene.viewNames.end(), "MAIN" );
+   if( it == scene.viewNames.end() )
+   {
+      scene.meshLodSelector = nullptr;
+      return;
+   }
+
+   const uint32_t viewIndex = static_cast<uint32_t>( std::distance( scene.viewNames.begin(), it ) );
+
+   const SceneComponent::ViewShaderParams& view = scene.views[viewIndex];
+   m_selector.begin( glm::vec3( view.position ), view.projMat, scene.extent.height );
+
+   for( const auto& entityEntry : m_entities )
+   {
+      const TransformComponent& transform   = *std::get<TransformComponent*>( entityEntry.arch );
+      const RenderableComponent& renderable = *std::get<RenderableComponent*>( entityEntry.arch );
+      MeshComponent& mesh                   = *std::get<MeshComponent*>( entityEntry.arch );
+
+      // Instances are spread around by their own transforms and displaced meshes are reshaped on
+      // the GPU, neither are simplified
+      if( mesh.lodCount <= 1 || !mesh.boundingSphere.isValid() || renderable.isInstanced ||
+          renderable.isTessellated )
+      {
+         mesh.lod = 0;
+         continue;
+      }
+
+      const glm::mat4 modelMatrix =
+          Transform::GetModelMatrix( transform.scaling, transform.rotation, transform.position );
+
+      const glm::vec3 scales = glm::abs( transform.scaling );
+      const float worldScale = std::max( std::max( scales.x, scales.y ), scales.z );
+
+      mesh.lod = m_selector.select(
+          mesh.lods,
+          mesh.lodCount,
+          mesh.lod,
+          mesh.boundingSphere.transform( modelMatrix ),
+          worldScale );
+   }
+
+   scene.meshLodSelector = &m_selector;
+}
+}
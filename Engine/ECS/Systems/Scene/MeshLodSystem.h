@@ -0,0 +1,35 @@
+#pragma once
+
+#include <ECS/Systems/CommonSystem.h>
+
+#include <Common/Include.h>
+
+#include <Graphics/Scene/MeshLodSelector.h>
+
+#include <ECS/Components/Transforms/TransformComponent.h>
+#include <ECS/Components/Rendering/MeshComponent.h>
+#include <ECS/Components/Rendering/RenderableComponent.h>
+
+// ================================================================================================
+// Definition
+// ================================================================================================
+/*
+Selects the level of detail of the meshes from the main view every frame, the render systems and
+the shadows all draw the selected one. Publishes the selector in the scene component for its stats
+*/
+namespace CYD
+{
+class MeshLodSystem final
+    : public CommonSystem<TransformComponent, MeshComponent, RenderableComponent>
+{
+  public:
+   MeshLodSystem() = default;
+   NON_COPIABLE( MeshLodSystem );
+   virtual ~MeshLodSystem() = default;
+
+   void tick( double deltaS ) override;
+
+  private:
+   MeshLodSelector m_selector;
+};
+}
@@ -0,0 +1,59 @@
+#include <ECS/Systems/Scene/OcclusionSystem.h>
+
+#include <Graphics/Scene/Mesh.h>
+#include <Graphics/Utility/Transforms.h>
+
+#include <ECS/EntityManager.h>
+#include <ECS/SharedComponents/SceneComponent.h>
+
+#include <Profiling.h>
+
+#include <algorithm>
+
+namespace CYD
+{
+void OcclusionSystem::tick( double /*deltaS*/ )
+{
+   CYD_TRACE( "OcclusionSystem" );
+
+   // Write component
+   SceneComponent& scene = m_ecs->getSharedComponent<SceneComponent>();
+
+   const auto it = std::find( scene.viewNames.begin(), scene.viewNames.end(), "MAIN" );
+   if( it == scene.viewNames.end() )
+   {
+      scene.occlusionCuller = nullptr;
+      return;
+   }
+
+   const uint32_t viewIndex = static_cast<uint32_t>( std::distance( scene.viewNames.begin(), it ) );
+
+   const SceneComponent::ViewShaderParams& view = scene.views[viewIndex];
+   m_culler.begin( view.projMat * view.viewMat, viewIndex );
+
+   for( const auto& entityEntry : m_entities )
+   {
+      const TransformComponent& transform   = *std::get<TransformComponent*>( entityEntry.arch );
+      const MeshComponent& mesh             = *std::get<MeshComponent*>( entityEntry.arch );
+      const RenderableComponent& renderable = *std::get<RenderableComponent*>( entityEntry.arch );
+
+      if( !renderable.isOccluder || !renderable.isVisible || !mesh.occluder ) continue;
+
+      const glm::mat4 modelMatrix =
+          Transform::GetModelMatrix( transform.scaling, transform.rotation, transform.position );
+
+      m_culler.addOccluder( *mesh.occluder, modelMatrix );
+   }
+
+   // Nothing can be hidden without occluders, skipping the tests altogether
+   if( m_culler.getStats().occluderCount == 0 )
+   {
+      scene.occlusionCuller = nullptr;
+      return;
+   }
+
+   m_culler.rasterize( m_threadPool );
+
+   scene.occlusionCuller = &m_culler;
+}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <ECS/Systems/CommonSystem.h>
+
+#include <Common/Include.h>
+
+#include <Graphics/Scene/OcclusionCuller.h>
+
+#include <ECS/Components/Transforms/TransformComponent.h>
+#include <ECS/Components/Rendering/MeshComponent.h>
+#include <ECS/Components/Rendering/RenderableComponent.h>
+
+// ================================================================================================
+// Forwards
+// ================================================================================================
+namespace EMP
+{
+class ThreadPool;
+}
+
+// ================================================================================================
+// Definition
+// ================================================================================================
+/*
+Rasterizes the occluders of the scene from the main view every frame and publishes the result in
+the scene component, render systems test what survived frustum culling against it
+*/
+namespace CYD
+{
+class OcclusionSystem final
+    : public CommonSystem<TransformComponent, MeshComponent, RenderableComponent>
+{
+  public:
+   explicit OcclusionSystem( EMP::ThreadPool& threadPool ) : m_threadPool( threadPool ) {}
+   NON_COPIABLE( OcclusionSystem );
+   virtual ~OcclusionSystem() = default;
+
+   // Ticks without entities too, so that the scene never keeps the occlusion of a previous frame
+   bool hasToTick() const noexcept override { return true; }
+   void tick( double deltaS ) override;
+
+  private:
+   EMP::ThreadPool& m_threadPool;
+
+   OcclusionCuller m_culler;
+};
+}
@@ -0,0 +1,104 @@
+#include <ECS/Systems/Scene/SpatialIndexSystem.h>
+
+#include <Common/Assert.h>
+
+#include <Graphics/Utility/Transforms.h>
+
+#include <ECS/EntityManager.h>
+#include <ECS/SharedComponents/SceneComponent.h>
+
+#include <Profiling.h>
+
+namespace CYD
+{
+static bool HasMoved( const TransformComponent& previous, const TransformComponent& current )
+{
+   return previous.position != current.position || previous.scaling != current.scaling ||
+          previous.rotation != current.rotation;
+}
+
+static bool HasChanged( const AABB& previous, const AABB& current )
+{
+   return previous.min != current.min || previous.max != current.max;
+}
+
+void SpatialIndexSystem::tick( double /*deltaS*/ )
+{
+   CYD_TRACE( "SpatialIndexSystem" );
+
+   m_frame++;
+
+   for( const auto& entityEntry : m_entities )
+   {
+      const TransformComponent& transform   = *std::get<TransformComponent*>( entityEntry.arch );
+      const MeshComponent& mesh             = *std::get<MeshComponent*>( entityEntry.arch );
+      const RenderableComponent& renderable = *std::get<RenderableComponent*>( entityEntry.arch );
+
+      // Same rules as culling, anything without meaningful bounds stays out of the index. These
+      // entities are swept below since they are not marked as seen
+      const bool unknownDisplacement = renderable.isTessellated && mesh.maxDisplacement <= 0.0f;
+      if( !mesh.bounds.isValid() || renderable.isInstanced || unknownDisplacement )
+      {
+         continue;
+      }
+
+      CYD_ASSERT( entityEntry.handle <= std::numeric_limits<uint32_t>::max() );
+
+      TrackedEntity& tracked = m_trackedEntities[entityEntry.handle];
+      tracked.lastSeenFrame  = m_frame;
+
+      // The ECS has no change notifications, moves are found by comparing with the last transform.
+      // The local bounds change when the mesh is swapped or reloaded, or when its displacement
+      // changes
+      const AABB localBounds = mesh.getDisplacedBounds();
+
+      const bool isNew = tracked.proxy == BVH::INVALID_PROXY;
+      if( !isNew && !HasMoved( tracked.transform, transform ) &&
+          !HasChanged( tracked.localBounds, localBounds ) )
+      {
+         continue;
+      }
+
+      tracked.transform   = transform;
+      tracked.localBounds = localBounds;
+
+      const glm::mat4 modelMatrix =
+          Transform::GetModelMatrix( transform.scaling, transform.rotation, transform.position );
+      const AABB worldBounds = localBounds.transform( modelMatrix );
+
+      if( isNew )
+      {
+         tracked.proxy = m_bvh.insert( worldBounds, static_cast<uint32_t>( entityEntry.handle ) );
+      }
+      else
+      {
+         m_bvh.update( tracked.proxy, worldBounds );
+      }
+   }
+
+   // Removing the entities that left the system or lost their bounds
+   for( auto it = m_trackedEntities.begin(); it != m_trackedEntities.end(); )
+   {
+      if( it->second.lastSeenFrame != m_frame )
+      {
+         m_bvh.remove( it->second.proxy );
+         it = m_trackedEntities.erase( it );
+      }
+      else
+      {
+         ++it;
+      }
+   }
+
+   m_bvh.refit();
+
+   if( m_bvh.needsRebuild() && !m_bvh.isRebuilding() )
+   {
+      m_bvh.rebuildAsync( m_threadPool );
+   }
+
+   // Write component
+   SceneComponent& scene = m_ecs->getSharedComponent<SceneComponent>();
+   scene.spatialIndex    = &m_bvh;
+}
+}
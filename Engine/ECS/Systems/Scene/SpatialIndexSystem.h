@@ -0,0 +1,59 @@
+#pragma once
+
+#include <ECS/Systems/CommonSystem.h>
+
+#include <Common/Include.h>
+
+#include <Graphics/Scene/BVH.h>
+
+#include <ECS/Components/Transforms/TransformComponent.h>
+#include <ECS/Components/Rendering/MeshComponent.h>
+#include <ECS/Components/Rendering/RenderableComponent.h>
+
+#include <unordered_map>
+
+// ================================================================================================
+// Forwards
+// ================================================================================================
+namespace EMP
+{
+class ThreadPool;
+}
+
+// ================================================================================================
+// Definition
+// ================================================================================================
+/*
+Keeps a BVH of the world bounds of the meshes in the scene and publishes it in the scene component
+for spatial queries. The user values of the BVH are entity handles
+*/
+namespace CYD
+{
+class SpatialIndexSystem final
+    : public CommonSystem<TransformComponent, MeshComponent, RenderableComponent>
+{
+  public:
+   explicit SpatialIndexSystem( EMP::ThreadPool& threadPool ) : m_threadPool( threadPool ) {}
+   NON_COPIABLE( SpatialIndexSystem );
+   virtual ~SpatialIndexSystem() = default;
+
+   void tick( double deltaS ) override;
+
+  private:
+   // Last transform and local bounds the proxy of an entity was updated with, changes are
+   // detected against them
+   struct TrackedEntity
+   {
+      BVH::ProxyHandle proxy = BVH::INVALID_PROXY;
+      TransformComponent transform;
+      AABB localBounds;
+      uint64_t lastSeenFrame = 0;
+   };
+
+   EMP::ThreadPool& m_threadPool;
+
+   BVH m_bvh;
+   std::unordered_map<EntityHandle, TrackedEntity> m_trackedEntities;
+   uint64_t m_frame = 0;
+};
+}
@@ -22,7 +22,8 @@ static bool s_drawPipelinesWindow = false;
 static bool s_drawAboutWindow     = false;
 static bool s_drawStatsOverlay    = false;
 
-ImGuiSystem::ImGuiSystem( const EntityManager& entityManager ) : m_entityManager( entityManager )
+ImGuiSystem::ImGuiSystem( const EntityManager& entityManager, const EMP::ThreadPool& threadPool )
+    : m_entityManager( entityManager ), m_threadPool( threadPool )
 {
    // We initialize the UI here
    // It needs to be after the WindowSystem is initialized because if we initialize it before, we override ImGui's GLFW callbacks
@@ -72,7 +73,7 @@ void ImGuiSystem::tick( double /*deltaS*/ )
 
    if( s_drawStatsOverlay )
    {
-      UI::DrawStatsOverlay( cmdList );
+      UI::DrawStatsOverlay( cmdList, m_threadPool, scene );
    }
 
    if( scene.resolutionChanged )
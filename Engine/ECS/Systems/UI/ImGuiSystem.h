@@ -4,6 +4,14 @@
 
 #include <Common/Include.h>
 
+// ================================================================================================
+// Forwards
+// ================================================================================================
+namespace EMP
+{
+class ThreadPool;
+}
+
 // ================================================================================================
 // Definition
 // ================================================================================================
@@ -13,7 +21,7 @@ class ImGuiSystem final : public CommonSystem<>
 {
   public:
    ImGuiSystem() = delete;
-   ImGuiSystem( const EntityManager& entityManager );
+   ImGuiSystem( const EntityManager& entityManager, const EMP::ThreadPool& threadPool );
    NON_COPIABLE( ImGuiSystem );
    virtual ~ImGuiSystem();
 
@@ -22,5 +30,6 @@ class ImGuiSystem final : public CommonSystem<>
 
   private:
    const EntityManager& m_entityManager;
+   const EMP::ThreadPool& m_threadPool;
 };
 }
@@ -172,6 +172,7 @@ class D3D12RenderBackendImp
    IndexBufferHandle createIndexBuffer(
        CmdListHandle transferList,
        uint32_t count,
+       IndexType type,
        const void* pIndices,
        const std::string_view name )
    {
@@ -201,7 +202,9 @@ class D3D12RenderBackendImp
 
    void beginRendering( CmdListHandle cmdList ) const {}
 
-   void beginRendering( CmdListHandle cmdList, const Framebuffer& fb ) const {}
+   void beginRendering( CmdListHandle cmdList, const Framebuffer& fb, bool secondaryContents ) const
+   {
+   }
 
    void nextPass( CmdListHandle cmdList ) const {}
 
@@ -423,10 +426,11 @@ VertexBufferHandle D3D12RenderBackend::createVertexBuffer(
 IndexBufferHandle D3D12RenderBackend::createIndexBuffer(
     CmdListHandle transferList,
     uint32_t count,
+    IndexType type,
     const void* pIndices,
     const std::string_view name )
 {
-   return _imp->createIndexBuffer( transferList, count, pIndices, name );
+   return _imp->createIndexBuffer( transferList, count, type, pIndices, name );
 }
 
 BufferHandle D3D12RenderBackend::createUniformBuffer( size_t size, const std::string_view name )
@@ -474,9 +478,12 @@ void D3D12RenderBackend::beginRendering( CmdListHandle cmdList )
    _imp->beginRendering( cmdList );
 }
 
-void D3D12RenderBackend::beginRendering( CmdListHandle cmdList, const Framebuffer& fb )
+void D3D12RenderBackend::beginRendering(
+    CmdListHandle cmdList,
+    const Framebuffer& fb,
+    bool secondaryContents )
 {
-   _imp->beginRendering( cmdList, fb );
+   _imp->beginRendering( cmdList, fb, secondaryContents );
 }
 
 void D3D12RenderBackend::nextPass( CmdListHandle cmdList ) { _imp->nextPass( cmdList ); }
@@ -122,6 +122,7 @@ class D3D12RenderBackend final : public RenderBackend
    IndexBufferHandle createIndexBuffer(
        CmdListHandle transferList,
        uint32_t count,
+       IndexType type,
        const void* pIndices,
        const std::string_view name ) override;
 
@@ -143,7 +144,8 @@ class D3D12RenderBackend final : public RenderBackend
    // ==============================================================================================
    void beginFrame() override;
    void beginRendering( CmdListHandle cmdList ) override;
-   void beginRendering( CmdListHandle cmdList, const Framebuffer& fb ) override;
+   void beginRendering( CmdListHandle cmdList, const Framebuffer& fb, bool secondaryContents )
+       override;
    void nextPass( CmdListHandle cmdList ) override;
    void endRendering( CmdListHandle cmdList ) override;
    void draw( CmdListHandle cmdList, size_t vertexCount, size_t firstVertex ) override;
@@ -26,6 +26,8 @@ class RenderBackend
    virtual void cleanup()       = 0;
    virtual void reloadShaders() = 0;
 
+   virtual void releaseUnusedResources() {}
+
    virtual void waitUntilIdle() {}
 
    // Command Buffers/Lists
@@ -40,6 +42,17 @@ class RenderBackend
 
    virtual void syncOnCommandList( CmdListHandle /*from*/, CmdListHandle /*to*/ ) {}
 
+   virtual CmdListHandle
+   createSecondaryCommandList( CmdListHandle /*parent*/, const std::string_view /*name*/ )
+   {
+      return {};
+   }
+   virtual void executeCommandLists(
+       CmdListHandle /*parent*/,
+       const std::vector<CmdListHandle>& /*secondaryCmdLists*/ )
+   {
+   }
+
    virtual void syncOnSwapchain( CmdListHandle /*cmdList*/ ) {}
    virtual void syncToSwapchain( CmdListHandle /*cmdList*/ ) {}
 
@@ -116,6 +129,7 @@ class RenderBackend
    virtual IndexBufferHandle createIndexBuffer(
        CmdListHandle transferList,
        uint32_t count,
+       IndexType type,
        const void* pIndices,
        const std::string_view name ) = 0;
 
@@ -150,7 +164,8 @@ class RenderBackend
    // ==============================================================================================
    virtual void beginFrame()                                                               = 0;
    virtual void beginRendering( CmdListHandle cmdList )                                    = 0;
-   virtual void beginRendering( CmdListHandle cmdList, const Framebuffer& fb )             = 0;
+   virtual void
+   beginRendering( CmdListHandle cmdList, const Framebuffer& fb, bool secondaryContents ) = 0;
    virtual void nextPass( CmdListHandle cmdList )                                          = 0;
    virtual void endRendering( CmdListHandle cmdList )                                      = 0;
    virtual void draw( CmdListHandle cmdList, size_t vertexCount, size_t firstVertex )      = 0;
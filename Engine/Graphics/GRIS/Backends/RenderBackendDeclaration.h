@@ -109,6 +109,7 @@
       IndexBufferHandle createIndexBuffer(                                                         \
           CmdListHandle transferList,                                                              \
           uint32_t count,                                                                          \
+          IndexType type,                                                                          \
           const void* pIndices,                                                                    \
           const std::string_view name ) override;                                                  \
                                                                                                    \
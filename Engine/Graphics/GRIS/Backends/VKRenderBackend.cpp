@@ -137,6 +137,8 @@ class VKRenderBackendImp
    void cleanup() const { m_mainDevice.cleanup(); }
    void reloadShaders() { m_reloadShadersQueued = true; }
 
+   void releaseUnusedResources() const { m_mainDevice.releaseUnusedResources(); }
+
    void waitUntilIdle() const { m_mainDevice.waitUntilIdle(); }
 
    CmdListHandle
@@ -194,6 +196,31 @@ class VKRenderBackendImp
       m_coreHandles.remove( cmdList );
    }
 
+   CmdListHandle createSecondaryCommandList( CmdListHandle parent, const std::string_view name )
+   {
+      const auto parentCmdBuffer = static_cast<vk::CommandBuffer*>( m_coreHandles.get( parent ) );
+
+      const auto cmdBuffer = m_mainDevice.createSecondaryCommandBuffer( *parentCmdBuffer, name );
+      cmdBuffer->startRecording();
+      return m_coreHandles.add( cmdBuffer, HandleType::CMDLIST );
+   }
+
+   void
+   executeCommandLists( CmdListHandle parent, const std::vector<CmdListHandle>& secondaryLists )
+   {
+      auto parentCmdBuffer = static_cast<vk::CommandBuffer*>( m_coreHandles.get( parent ) );
+
+      std::vector<vk::CommandBuffer*> cmdBuffers;
+      cmdBuffers.reserve( secondaryLists.size() );
+      for( const CmdListHandle secondaryList : secondaryLists )
+      {
+         cmdBuffers.push_back(
+             static_cast<vk::CommandBuffer*>( m_coreHandles.get( secondaryList ) ) );
+      }
+
+      parentCmdBuffer->executeCommands( cmdBuffers );
+   }
+
    void syncOnSwapchain( CmdListHandle cmdList )
    {
       const auto cmdBuffer = static_cast<vk::CommandBuffer*>( m_coreHandles.get( cmdList ) );
@@ -457,13 +484,13 @@ class VKRenderBackendImp
    IndexBufferHandle createIndexBuffer(
        CmdListHandle transferList,
        uint32_t count,
+       IndexType type,
        const void* pIndices,
        const std::string_view name )
    {
       const auto cmdBuffer = static_cast<vk::CommandBuffer*>( m_coreHandles.get( transferList ) );
 
-      // TODO Dynamic uint32_t/uint16_t
-      const size_t bufferSize = count * sizeof( uint32_t );
+      const size_t bufferSize = count * GetIndexSizeInBytes( type );
 
       // Staging
       vk::Buffer* staging = m_mainDevice.createStagingBuffer( bufferSize );
@@ -642,7 +669,7 @@ class VKRenderBackendImp
       m_mainSwapchain->setClear( false );
    }
 
-   void beginRendering( CmdListHandle cmdList, const Framebuffer& fb ) const
+   void beginRendering( CmdListHandle cmdList, const Framebuffer& fb, bool secondaryContents ) const
    {
       auto cmdBuffer = static_cast<vk::CommandBuffer*>( m_coreHandles.get( cmdList ) );
 
@@ -660,7 +687,7 @@ class VKRenderBackendImp
          }
       }
 
-      cmdBuffer->beginRendering( fb, vkTextures );
+      cmdBuffer->beginRendering( fb, vkTextures, secondaryContents );
    }
 
    void nextPass( CmdListHandle cmdList ) const
@@ -797,6 +824,7 @@ void VKRenderBackend::uninitializeUIBackend() { _imp->uninitializeUIBackend(); }
 void VKRenderBackend::drawUI( CmdListHandle cmdList ) { _imp->drawUI( cmdList ); }
 void VKRenderBackend::cleanup() { _imp->cleanup(); }
 void VKRenderBackend::reloadShaders() { _imp->reloadShaders(); }
+void VKRenderBackend::releaseUnusedResources() { _imp->releaseUnusedResources(); }
 void VKRenderBackend::waitUntilIdle() { _imp->waitUntilIdle(); }
 
 CmdListHandle VKRenderBackend::createCommandList(
@@ -832,6 +860,19 @@ void VKRenderBackend::destroyCommandList( CmdListHandle cmdList )
    _imp->destroyCommandList( cmdList );
 }
 
+CmdListHandle
+VKRenderBackend::createSecondaryCommandList( CmdListHandle parent, const std::string_view name )
+{
+   return _imp->createSecondaryCommandList( parent, name );
+}
+
+void VKRenderBackend::executeCommandLists(
+    CmdListHandle parent,
+    const std::vector<CmdListHandle>& secondaryLists )
+{
+   _imp->executeCommandLists( parent, secondaryLists );
+}
+
 void VKRenderBackend::syncOnSwapchain( CmdListHandle cmdList ) { _imp->syncOnSwapchain( cmdList ); }
 
 void VKRenderBackend::syncToSwapchain( CmdListHandle cmdList ) { _imp->syncToSwapchain( cmdList ); }
@@ -965,10 +1006,11 @@ VertexBufferHandle VKRenderBackend::createVertexBuffer(
 IndexBufferHandle VKRenderBackend::createIndexBuffer(
     CmdListHandle transferList,
     uint32_t count,
+    IndexType type,
     const void* pIndices,
     const std::string_view name )
 {
-   return _imp->createIndexBuffer( transferList, count, pIndices, name );
+   return _imp->createIndexBuffer( transferList, count, type, pIndices, name );
 }
 
 BufferHandle VKRenderBackend::createUniformBuffer( size_t size, const std::string_view name )
@@ -1034,9 +1076,12 @@ void VKRenderBackend::beginFrame() { _imp->beginFrame(); }
 
 void VKRenderBackend::beginRendering( CmdListHandle cmdList ) { _imp->beginRendering( cmdList ); }
 
-void VKRenderBackend::beginRendering( CmdListHandle cmdList, const Framebuffer& fb )
+void VKRenderBackend::beginRendering(
+    CmdListHandle cmdList,
+    const Framebuffer& fb,
+    bool secondaryContents )
 {
-   _imp->beginRendering( cmdList, fb );
+   _imp->beginRendering( cmdList, fb, secondaryContents );
 }
 
 void VKRenderBackend::nextPass( CmdListHandle cmdList ) { _imp->nextPass( cmdList ); }
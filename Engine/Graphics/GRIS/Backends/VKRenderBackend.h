@@ -36,6 +36,8 @@ class VKRenderBackend final : public RenderBackend
    void cleanup() override;
    void reloadShaders() override;
 
+   void releaseUnusedResources() override;
+
    void waitUntilIdle() override;
 
    // Command Buffers/Lists
@@ -51,6 +53,12 @@ class VKRenderBackend final : public RenderBackend
    void syncOnCommandList( CmdListHandle from, CmdListHandle to ) override;
    void destroyCommandList( CmdListHandle cmdList ) override;
 
+   CmdListHandle
+   createSecondaryCommandList( CmdListHandle parent, const std::string_view name ) override;
+   void executeCommandLists(
+       CmdListHandle parent,
+       const std::vector<CmdListHandle>& secondaryLists ) override;
+
    void syncOnSwapchain( CmdListHandle cmdList ) override;
    void syncToSwapchain( CmdListHandle cmdList ) override;
 
@@ -129,6 +137,7 @@ class VKRenderBackend final : public RenderBackend
    IndexBufferHandle createIndexBuffer(
        CmdListHandle transferList,
        uint32_t count,
+       IndexType type,
        const void* pIndices,
        const std::string_view name ) override;
 
@@ -160,7 +169,8 @@ class VKRenderBackend final : public RenderBackend
    // ==============================================================================================
    void beginFrame() override;
    void beginRendering( CmdListHandle cmdList ) override;
-   void beginRendering( CmdListHandle cmdList, const Framebuffer& fb ) override;
+   void beginRendering( CmdListHandle cmdList, const Framebuffer& fb, bool secondaryContents )
+       override;
    void nextPass( CmdListHandle cmdList ) override;
    void endRendering( CmdListHandle cmdList ) override;
    void draw( CmdListHandle cmdList, size_t vertexCount, size_t firstVertex ) override;
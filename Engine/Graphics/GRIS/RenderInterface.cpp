@@ -75,6 +75,12 @@ void RenderBackendCleanup()
    b->cleanup();
 }
 
+void ReleaseUnusedResources()
+{
+   CYD_TRACE( "Release Unused Resources" );
+   b->releaseUnusedResources();
+}
+
 void ReloadShaders()
 {
    CYD_TRACE( "Reloading Shaders" );
@@ -99,6 +105,16 @@ void WaitOnCommandList( CmdListHandle cmdList ) { b->waitOnCommandList( cmdList
 void SyncOnCommandList( CmdListHandle from, CmdListHandle to ) { b->syncOnCommandList( from, to ); }
 void DestroyCommandList( CmdListHandle cmdList ) { b->destroyCommandList( cmdList ); }
 
+CmdListHandle CreateSecondaryCommandList( CmdListHandle parent, const std::string_view name )
+{
+   return b->createSecondaryCommandList( parent, name );
+}
+
+void ExecuteCommandLists( CmdListHandle parent, const std::vector<CmdListHandle>& secondaryLists )
+{
+   b->executeCommandLists( parent, secondaryLists );
+}
+
 void SyncOnSwapchain( CmdListHandle cmdList ) { b->syncOnSwapchain( cmdList ); }
 void SyncToSwapchain( CmdListHandle cmdList ) { b->syncToSwapchain( cmdList ); }
 
@@ -171,6 +187,15 @@ void BindIndexBuffer<uint32_t>(
    b->bindIndexBuffer( cmdList, bufferHandle, IndexType::UNSIGNED_INT32, offset );
 }
 
+void BindIndexBuffer(
+    CmdListHandle cmdList,
+    IndexBufferHandle bufferHandle,
+    IndexType type,
+    uint32_t offset )
+{
+   b->bindIndexBuffer( cmdList, bufferHandle, type, offset );
+}
+
 void BindTexture( CmdListHandle cmdList, TextureHandle texHandle, uint32_t binding, uint32_t set )
 {
    b->bindTexture( cmdList, texHandle, binding, set );
@@ -242,7 +267,9 @@ static TextureHandle LoadImageFromStorage(
        inputDesc.width == 0 && inputDesc.height == 0 &&
        "VKRenderBackend: Created a texture with a path but specified dimensions" );
 
-   std::vector<void*> imageData;
+   // Mapped from the derived data cache or decoded, the pixels live as long as the images
+   std::vector<GraphicsIO::Image> images( layerCount );
+   std::vector<const void*> imageData;
    int prevWidth     = 0;
    int prevHeight    = 0;
    int prevLayerSize = 0;
@@ -253,14 +280,16 @@ static TextureHandle LoadImageFromStorage(
 
    for( uint32_t i = 0; i < layerCount; ++i )
    {
-      imageData.push_back(
-          GraphicsIO::LoadImage( paths[i], inputDesc.format, width, height, layerSize ) );
-
-      if( !imageData.back() )
+      if( !GraphicsIO::LoadImage( paths[i], inputDesc.format, images[i] ) )
       {
          return Handle();
       }
 
+      imageData.push_back( images[i].pixels );
+      width     = images[i].width;
+      height    = images[i].height;
+      layerSize = images[i].size;
+
       // Sanity check
       if( prevWidth == 0 ) prevWidth = width;
       if( prevHeight == 0 ) prevHeight = height;
@@ -285,11 +314,6 @@ static TextureHandle LoadImageFromStorage(
    TextureHandle texHandle = b->createTexture(
        transferList, newDesc, static_cast<uint32_t>( imageData.size() ), imageData.data() );
 
-   for( uint32_t i = 0; i < imageData.size(); ++i )
-   {
-      GraphicsIO::FreeImage( imageData[i] );
-   }
-
    return texHandle;
 }
 
@@ -336,10 +360,11 @@ VertexBufferHandle CreateVertexBuffer(
 IndexBufferHandle CreateIndexBuffer(
     CmdListHandle transferList,
     uint32_t count,
+    IndexType type,
     const void* pIndices,
     const std::string_view name )
 {
-   return b->createIndexBuffer( transferList, count, pIndices, name );
+   return b->createIndexBuffer( transferList, count, type, pIndices, name );
 }
 
 BufferHandle CreateUniformBuffer( size_t size, const std::string_view name )
@@ -395,9 +420,9 @@ void BeginFrame()
 
 void BeginRendering( CmdListHandle cmdList ) { b->beginRendering( cmdList ); }
 
-void BeginRendering( CmdListHandle cmdList, const Framebuffer& fb )
+void BeginRendering( CmdListHandle cmdList, const Framebuffer& fb, bool secondaryContents )
 {
-   b->beginRendering( cmdList, fb );
+   b->beginRendering( cmdList, fb, secondaryContents );
 }
 
 void NextPass( CmdListHandle cmdList ) { b->nextPass( cmdList ); }
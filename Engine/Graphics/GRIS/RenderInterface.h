@@ -40,8 +40,10 @@ bool InitializeUIBackend();
 void UninitializeUIBackend();
 void DrawUI( CmdListHandle cmdList );
 
-// Cleanup rendering resources
+// Cleanup rendering resources. Releasing unused resources goes through every resource slot so it
+// is better done at a lower rate than the per-frame cleanup
 void RenderBackendCleanup();
+void ReleaseUnusedResources();
 void ReloadShaders();
 
 // Wait until all devices are idle
@@ -65,6 +67,13 @@ void WaitOnCommandList( CmdListHandle cmdList );  // Spinlock until command list
 void SyncOnCommandList( CmdListHandle from, CmdListHandle to );
 void DestroyCommandList( CmdListHandle cmdList );
 
+// Secondary command lists record part of the render pass of their parent and can be created and
+// recorded on any thread. The parent has to begin rendering with secondary contents, and executes
+// them in the given order. They are destroyed like any other command list once executed, dynamic
+// state and bindings are not inherited from the parent
+CmdListHandle CreateSecondaryCommandList( CmdListHandle parent, const std::string_view name = "" );
+void ExecuteCommandLists( CmdListHandle parent, const std::vector<CmdListHandle>& secondaryLists );
+
 // Tying rendering synchronization together
 void SyncOnSwapchain( CmdListHandle cmdList );
 void SyncToSwapchain( CmdListHandle cmdList );
@@ -88,6 +97,11 @@ void BindVertexBuffer( CmdListHandle cmdList, VertexBufferHandle bufferHandle );
 
 template <class Type>
 void BindIndexBuffer( CmdListHandle cmdList, IndexBufferHandle bufferHandle, uint32_t offset = 0 );
+void BindIndexBuffer(
+    CmdListHandle cmdList,
+    IndexBufferHandle bufferHandle,
+    IndexType type,
+    uint32_t offset = 0 );
 
 // Bind shader resources by binding/set
 void BindTexture(
@@ -152,6 +166,7 @@ VertexBufferHandle CreateVertexBuffer(
 IndexBufferHandle CreateIndexBuffer(
     CmdListHandle transferList,
     uint32_t count,
+    IndexType type,
     const void* pIndices,
     const std::string_view name );
 
@@ -178,7 +193,7 @@ void DestroyBuffer( BufferHandle bufferHandle );
 // ===============================================================================================
 void BeginFrame();
 void BeginRendering( CmdListHandle cmdList );
-void BeginRendering( CmdListHandle cmdList, const Framebuffer& fb );
+void BeginRendering( CmdListHandle cmdList, const Framebuffer& fb, bool secondaryContents = false );
 void NextPass( CmdListHandle cmdList );
 void EndRendering( CmdListHandle cmdList );
 void Draw( CmdListHandle cmdList, size_t vertexCount, size_t firstVertex = 0 );
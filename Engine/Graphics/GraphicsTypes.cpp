@@ -1,5 +1,7 @@
 #include <Graphics/GraphicsTypes.h>
 
+#include <limits>
+
 namespace CYD
 {
 bool IsColorFormat( PixelFormat format )
@@ -24,11 +26,15 @@ uint32_t GetPixelSizeInBytes( PixelFormat format )
       case PixelFormat::R16_UNORM:
          return 2;
       case PixelFormat::BGRA8_UNORM:
+      case PixelFormat::RGBA8_UNORM:
       case PixelFormat::RGBA8_SRGB:
+      case PixelFormat::RG16F:
+      case PixelFormat::RG16_SNORM:
       case PixelFormat::R32F:
       case PixelFormat::D32_SFLOAT:
          return 4;
       case PixelFormat::RGBA16F:
+      case PixelFormat::RGBA16_UNORM:
       case PixelFormat::RG32F:
          return 8;
       case PixelFormat::RGB32F:
@@ -40,6 +46,28 @@ uint32_t GetPixelSizeInBytes( PixelFormat format )
    return 0;
 }
 
+uint32_t GetIndexSizeInBytes( IndexType type )
+{
+   switch( type )
+   {
+      case IndexType::UNSIGNED_INT8:
+         return 1;
+      case IndexType::UNSIGNED_INT16:
+         return 2;
+      case IndexType::UNSIGNED_INT32:
+         return 4;
+   }
+
+   return 0;
+}
+
+IndexType GetNarrowestIndexType( uint32_t vertexCount )
+{
+   // 8-bit indices need an extension on most devices and would save little
+   return vertexCount <= std::numeric_limits<uint16_t>::max() + 1u ? IndexType::UNSIGNED_INT16
+                                                                  : IndexType::UNSIGNED_INT32;
+}
+
 bool Extent2D::operator==( const Extent2D& other ) const
 {
    return width == other.width && height == other.height;
@@ -110,8 +110,11 @@ enum class PixelFormat : uint8_t
    RGBA8_UNORM,
    RGBA8_SRGB,
    RGBA16F,
+   RGBA16_UNORM,
    RGBA32F,
    RGB32F,
+   RG16F,
+   RG16_SNORM,
    RG32F,
    R32F,
    R8_UNORM,
@@ -352,6 +355,10 @@ struct SamplerInfo
 // Helper functions
 bool IsColorFormat( PixelFormat format );
 uint32_t GetPixelSizeInBytes( PixelFormat format );
+uint32_t GetIndexSizeInBytes( IndexType type );
+
+// 16-bit indices when they can address every vertex
+IndexType GetNarrowestIndexType( uint32_t vertexCount );
 
 // ================================================================================================
 // Transfer structs
@@ -32,6 +32,8 @@ Handle HandleManager::add( void* p, HandleType handleType )
 {
    uint32_t type = static_cast<uint32_t>( handleType );
 
+   std::unique_lock<std::mutex> lock( _mutex );
+
    CYD_ASSERT( _activeEntryCount < ( MAX_ENTRIES - 1 ) );
 
    CYD_ASSERT( type >= 0 && type <= 31 );
@@ -58,6 +60,8 @@ Handle HandleManager::add( void* p, HandleType handleType )
 
 void HandleManager::update( Handle handle, void* newData )
 {
+   std::unique_lock<std::mutex> lock( _mutex );
+
    const int index = handle._index;
    CYD_ASSERT( _entries[index]._counter == handle._counter );
    CYD_ASSERT( _entries[index]._active == true );
@@ -67,6 +71,8 @@ void HandleManager::update( Handle handle, void* newData )
 
 void HandleManager::remove( const Handle handle )
 {
+   std::unique_lock<std::mutex> lock( _mutex );
+
    const uint32_t index = handle._index;
    CYD_ASSERT( _entries[index]._counter == handle._counter );
    CYD_ASSERT( _entries[index]._active == true );
@@ -3,6 +3,7 @@
 #include <Graphics/Handles/ResourceHandle.h>
 
 #include <cstdint>
+#include <mutex>
 
 namespace CYD
 {
@@ -52,6 +53,10 @@ class HandleManager
 
    HandleEntry _entries[MAX_ENTRIES];
 
+   // Handles can be added and removed from worker threads (secondary command lists). Lookups are
+   // not locked, an entry being looked up is never the one being added or removed
+   std::mutex _mutex;
+
    int _activeEntryCount;
    uint32_t _firstFreeEntry;
 };
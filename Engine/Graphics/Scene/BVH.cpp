@@ -0,0 +1,855 @@
+#include <Graphics/Scene/BVH.h>
+
+#include <Common/Assert.h>
+
+#include <Graphics/Scene/Frustum.h>
+
+#include <Multithreading/ThreadPool.h>
+
+#include <Profiling.h>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <memory>
+
+#include <immintrin.h>
+
+namespace CYD
+{
+// Binned SAH build parameters
+static constexpr uint32_t BIN_COUNT = 16;
+
+// Inserted proxies are tested linearly, rebuild once there are too many of them
+static constexpr uint32_t MAX_PENDING_PROXIES = 64;
+
+static float SurfaceArea( const AABB& box )
+{
+   if( !box.isValid() ) return 0.0f;
+
+   const glm::vec3 size = box.max - box.min;
+   return 2.0f * ( size.x * size.y + size.y * size.z + size.z * size.x );
+}
+
+// Scalar tests, used for the proxies that are not in the tree yet
+// ================================================================================================
+static bool FrustumIntersects( const glm::vec4* planes, const AABB& box )
+{
+   for( uint32_t p = 0; p < Frustum::COUNT; ++p )
+   {
+      // Corner of the box the furthest along the normal
+      const glm::vec3 positive = glm::vec3(
+          planes[p].x > 0.0f ? box.max.x : box.min.x,
+          planes[p].y > 0.0f ? box.max.y : box.min.y,
+          planes[p].z > 0.0f ? box.max.z : box.min.z );
+
+      if( glm::dot( glm::vec3( planes[p] ), positive ) + planes[p].w < 0.0f ) return false;
+   }
+
+   return true;
+}
+
+static bool SphereIntersects( const BoundingSphere& sphere, const AABB& box )
+{
+   const glm::vec3 closest = glm::clamp( sphere.center, box.min, box.max );
+   const glm::vec3 delta   = closest - sphere.center;
+
+   return glm::dot( delta, delta ) <= sphere.radius * sphere.radius;
+}
+
+// Along an axis the ray is parallel to, the slab does not limit the distance and the origin only
+// has to be between its planes. The slab test would compute 0 * inf = NaN for an origin on a plane
+static bool RayIntersects(
+    const glm::vec3& origin,
+    const glm::vec3& invDirection,
+    const glm::bvec3& isParallel,
+    const AABB& box,
+    float maxDistance,
+    float& distance )
+{
+   float enter = 0.0f;
+   float exit  = maxDistance;
+   for( glm::length_t axis = 0; axis < 3; ++axis )
+   {
+      if( isParallel[axis] )
+      {
+         if( origin[axis] < box.min[axis] || origin[axis] > box.max[axis] ) return false;
+         continue;
+      }
+
+      const float t0 = ( box.min[axis] - origin[axis] ) * invDirection[axis];
+      const float t1 = ( box.max[axis] - origin[axis] ) * invDirection[axis];
+
+      enter = std::max( enter, std::min( t0, t1 ) );
+      exit  = std::min( exit, std::max( t0, t1 ) );
+   }
+
+   distance = enter;
+   return enter <= exit;
+}
+
+// Same as above for the 4 slots of a node along one axis, lanes that miss get an empty range
+static void ClipSlab(
+    const float* mins,
+    const float* maxs,
+    __m128 origin,
+    __m128 invDirection,
+    bool isParallel,
+    __m128& enter,
+    __m128& exit )
+{
+   const __m128 boxMin = _mm_load_ps( mins );
+   const __m128 boxMax = _mm_load_ps( maxs );
+
+   if( isParallel )
+   {
+      const __m128 isInside =
+          _mm_and_ps( _mm_cmple_ps( boxMin, origin ), _mm_cmple_ps( origin, boxMax ) );
+      exit = _mm_or_ps(
+          _mm_and_ps( isInside, exit ), _mm_andnot_ps( isInside, _mm_set1_ps( -1.0f ) ) );
+      return;
+   }
+
+   const __m128 t0 = _mm_mul_ps( _mm_sub_ps( boxMin, origin ), invDirection );
+   const __m128 t1 = _mm_mul_ps( _mm_sub_ps( boxMax, origin ), invDirection );
+
+   enter = _mm_max_ps( enter, _mm_min_ps( t0, t1 ) );
+   exit  = _mm_min_ps( exit, _mm_max_ps( t0, t1 ) );
+}
+
+// ================================================================================================
+// Node
+// ================================================================================================
+void BVH::Node::setBounds( uint32_t slot, const AABB& bounds )
+{
+   minX[slot] = bounds.min.x;
+   minY[slot] = bounds.min.y;
+   minZ[slot] = bounds.min.z;
+   maxX[slot] = bounds.max.x;
+   maxY[slot] = bounds.max.y;
+   maxZ[slot] = bounds.max.z;
+}
+
+AABB BVH::Node::getBounds() const
+{
+   AABB bounds;
+   for( uint32_t slot = 0; slot < WIDTH; ++slot )
+   {
+      if( children[slot] == INVALID_IDX ) continue;
+
+      bounds.extend( AABB{
+          glm::vec3( minX[slot], minY[slot], minZ[slot] ),
+          glm::vec3( maxX[slot], maxY[slot], maxZ[slot] ) } );
+   }
+
+   return bounds;
+}
+
+// ================================================================================================
+// Build
+// ================================================================================================
+// Top-down binned SAH build. Nodes are created in pre-order, children always come after their
+// parent which lets a refit go through the nodes backwards
+class BVH::TreeBuilder
+{
+  public:
+   TreeBuilder( Tree& tree, const std::vector<AABB>& bounds ) : m_tree( tree ), m_bounds( bounds )
+   {
+      m_centroids.resize( bounds.size() );
+      for( const uint32_t proxyIdx : tree.proxies )
+      {
+         m_centroids[proxyIdx] = bounds[proxyIdx].getCenter();
+      }
+   }
+
+   uint32_t buildNode( uint32_t begin, uint32_t end, uint32_t parent )
+   {
+      const uint32_t nodeIdx = static_cast<uint32_t>( m_tree.nodes.size() );
+
+      Node& node  = m_tree.nodes.emplace_back();
+      node.parent = parent;
+      for( uint32_t slot = 0; slot < WIDTH; ++slot )
+      {
+         node.setBounds( slot, AABB() );
+         node.children[slot] = INVALID_IDX;
+      }
+
+      // Splitting the range in two and then each half in two to get the 4 children
+      uint32_t groups[WIDTH + 1];
+      uint32_t groupCount = 0;
+
+      if( end - begin <= WIDTH )
+      {
+         for( uint32_t i = begin; i < end; ++i )
+         {
+            groups[groupCount++] = i;
+         }
+      }
+      else
+      {
+         const uint32_t mid = _split( begin, end );
+
+         groups[groupCount++] = begin;
+         if( mid - begin > 1 ) groups[groupCount++] = _split( begin, mid );
+         groups[groupCount++] = mid;
+         if( end - mid > 1 ) groups[groupCount++] = _split( mid, end );
+      }
+      groups[groupCount] = end;
+
+      for( uint32_t slot = 0; slot < groupCount; ++slot )
+      {
+         const uint32_t groupBegin = groups[slot];
+         const uint32_t groupEnd   = groups[slot + 1];
+
+         if( groupEnd - groupBegin == 1 )
+         {
+            const uint32_t proxyIdx = m_tree.proxies[groupBegin];
+
+            m_tree.nodes[nodeIdx].children[slot] = LEAF_FLAG | proxyIdx;
+            m_tree.nodes[nodeIdx].setBounds( slot, m_bounds[proxyIdx] );
+            m_tree.locations[groupBegin] = nodeIdx << 2 | slot;
+         }
+         else
+         {
+            // Growing the nodes invalidates the references
+            const uint32_t childIdx = buildNode( groupBegin, groupEnd, nodeIdx );
+
+            m_tree.nodes[nodeIdx].children[slot] = childIdx;
+            m_tree.nodes[nodeIdx].setBounds( slot, m_tree.nodes[childIdx].getBounds() );
+         }
+      }
+
+      return nodeIdx;
+   }
+
+  private:
+   struct Bin
+   {
+      AABB bounds;
+      uint32_t count = 0;
+   };
+
+   // Partitions [begin, end) in two non-empty ranges and returns where the second one starts
+   uint32_t _split( uint32_t begin, uint32_t end )
+   {
+      uint32_t* pProxies = m_tree.proxies.data();
+
+      AABB centroidBounds;
+      for( uint32_t i = begin; i < end; ++i )
+      {
+         centroidBounds.extend( m_centroids[pProxies[i]] );
+      }
+
+      float bestCost    = std::numeric_limits<float>::max();
+      uint32_t bestAxis = 0;
+      uint32_t bestBin  = 0;
+
+      for( uint32_t axis = 0; axis < 3; ++axis )
+      {
+         const float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+         if( extent <= 0.0f ) continue;
+
+         const float scale = BIN_COUNT * ( 1.0f - 1e-6f ) / extent;
+
+         Bin bins[BIN_COUNT];
+         for( uint32_t i = begin; i < end; ++i )
+         {
+            const uint32_t proxyIdx = pProxies[i];
+            const uint32_t binIdx   = _getBin( proxyIdx, axis, centroidBounds.min[axis], scale );
+
+            bins[binIdx].bounds.extend( m_bounds[proxyIdx] );
+            bins[binIdx].count++;
+         }
+
+         // Cost of the right side of every split plane, then sweeping from the left
+         float rightCosts[BIN_COUNT];
+         AABB rightBounds;
+         uint32_t rightCount = 0;
+         for( uint32_t bin = BIN_COUNT - 1; bin > 0; --bin )
+         {
+            rightBounds.extend( bins[bin].bounds );
+            rightCount += bins[bin].count;
+            rightCosts[bin - 1] = SurfaceArea( rightBounds ) * rightCount;
+         }
+
+         AABB leftBounds;
+         uint32_t leftCount = 0;
+         for( uint32_t bin = 0; bin < BIN_COUNT - 1; ++bin )
+         {
+            leftBounds.extend( bins[bin].bounds );
+            leftCount += bins[bin].count;
+
+            const float cost = SurfaceArea( leftBounds ) * leftCount + rightCosts[bin];
+            if( cost < bestCost )
+            {
+               bestCost = cost;
+               bestAxis = axis;
+               bestBin  = bin;
+            }
+         }
+      }
+
+      uint32_t mid = begin;
+      if( bestCost < std::numeric_limits<float>::max() )
+      {
+         const float extent = centroidBounds.max[bestAxis] - centroidBounds.min[bestAxis];
+         const float scale  = BIN_COUNT * ( 1.0f - 1e-6f ) / extent;
+         const float origin = centroidBounds.min[bestAxis];
+
+         uint32_t* pMid = std::partition(
+             pProxies + begin,
+             pProxies + end,
+             [&]( uint32_t proxyIdx )
+             { return _getBin( proxyIdx, bestAxis, origin, scale ) <= bestBin; } );
+
+         mid = static_cast<uint32_t>( pMid - pProxies );
+      }
+
+      // All the centroids are in the same spot, any split is as good as another
+      if( mid == begin || mid == end )
+      {
+         mid = begin + ( end - begin ) / 2;
+         std::nth_element(
+             pProxies + begin,
+             pProxies + mid,
+             pProxies + end,
+             [&]( uint32_t a, uint32_t b )
+             { return m_centroids[a][bestAxis] < m_centroids[b][bestAxis]; } );
+      }
+
+      return mid;
+   }
+
+   uint32_t _getBin( uint32_t proxyIdx, uint32_t axis, float origin, float scale ) const
+   {
+      const float offset = ( m_centroids[proxyIdx][axis] - origin ) * scale;
+      return std::min( static_cast<uint32_t>( offset ), BIN_COUNT - 1 );
+   }
+
+   Tree& m_tree;
+   const std::vector<AABB>& m_bounds;
+   std::vector<glm::vec3> m_centroids;
+};
+
+BVH::Tree BVH::_buildTree( std::vector<uint32_t> proxies, std::vector<AABB> bounds )
+{
+   CYD_TRACE( "BVH Build" );
+
+   Tree tree;
+   tree.proxies = std::move( proxies );
+   tree.locations.resize( tree.proxies.size() );
+
+   if( tree.proxies.empty() ) return tree;
+
+   // A full tree with 1 proxy per leaf slot has about a third as many nodes as proxies
+   tree.nodes.reserve( tree.proxies.size() / 2 + 1 );
+
+   TreeBuilder builder( tree, bounds );
+   builder.buildNode( 0, static_cast<uint32_t>( tree.proxies.size() ), INVALID_IDX );
+
+   return tree;
+}
+
+// ================================================================================================
+// BVH
+// ================================================================================================
+BVH::BVH() = default;
+
+BVH::~BVH()
+{
+   // The build only touches its own data, but it should not outlive the tree it was started for
+   if( m_rebuild.valid() )
+   {
+      m_rebuild.wait();
+   }
+}
+
+BVH::ProxyHandle BVH::insert( const AABB& bounds, uint32_t userData )
+{
+   CYD_ASSERT( bounds.isValid() && "BVH: Inserting a proxy without bounds" );
+
+   uint32_t proxyIdx;
+   if( !m_freeProxies.empty() )
+   {
+      proxyIdx = m_freeProxies.back();
+      m_freeProxies.pop_back();
+   }
+   else
+   {
+      proxyIdx = static_cast<uint32_t>( m_proxies.size() );
+      m_proxies.emplace_back();
+   }
+
+   CYD_ASSERT( proxyIdx < LEAF_FLAG && "BVH: Too many proxies" );
+
+   Proxy& proxy   = m_proxies[proxyIdx];
+   proxy.bounds   = bounds;
+   proxy.userData = userData;
+   proxy.node     = INVALID_IDX;
+   proxy.slot     = 0;
+   proxy.alive    = true;
+
+   m_pendingProxies.push_back( proxyIdx );
+   m_proxyCount++;
+
+   return proxyIdx;
+}
+
+void BVH::update( ProxyHandle proxyIdx, const AABB& bounds )
+{
+   CYD_ASSERT( proxyIdx < m_proxies.size() && m_proxies[proxyIdx].alive );
+
+   Proxy& proxy = m_proxies[proxyIdx];
+   proxy.bounds = bounds;
+
+   // The nodes above are brought up to date in the next refit
+   if( proxy.node != INVALID_IDX )
+   {
+      m_nodes[proxy.node].setBounds( proxy.slot, bounds );
+      _markDirty( proxy.node );
+      m_movesSinceBuild++;
+   }
+}
+
+void BVH::remove( ProxyHandle proxyIdx )
+{
+   CYD_ASSERT( proxyIdx < m_proxies.size() && m_proxies[proxyIdx].alive );
+
+   Proxy& proxy = m_proxies[proxyIdx];
+   if( proxy.node != INVALID_IDX )
+   {
+      Node& node                = m_nodes[proxy.node];
+      node.children[proxy.slot] = INVALID_IDX;
+      node.setBounds( proxy.slot, AABB() );
+      _markDirty( proxy.node );
+   }
+   else
+   {
+      auto it = std::find( m_pendingProxies.begin(), m_pendingProxies.end(), proxyIdx );
+      CYD_ASSERT( it != m_pendingProxies.end() );
+
+      *it = m_pendingProxies.back();
+      m_pendingProxies.pop_back();
+   }
+
+   proxy.alive = false;
+   proxy.node  = INVALID_IDX;
+   m_proxyCount--;
+
+   _freeProxy( proxyIdx );
+}
+
+void BVH::_freeProxy( uint32_t proxyIdx )
+{
+   // A running build could still reference this proxy, it cannot be reused until the build is in
+   if( m_rebuild.valid() )
+   {
+      m_deferredFrees.push_back( proxyIdx );
+   }
+   else
+   {
+      m_freeProxies.push_back( proxyIdx );
+   }
+}
+
+void BVH::_markDirty( uint32_t nodeIdx )
+{
+   // Stopping at the first dirty ancestor, everything above it is dirty already
+   while( nodeIdx != INVALID_IDX && !m_dirtyNodes[nodeIdx] )
+   {
+      m_dirtyNodes[nodeIdx] = true;
+      nodeIdx               = m_nodes[nodeIdx].parent;
+   }
+}
+
+// ================================================================================================
+// Maintenance
+// ================================================================================================
+void BVH::build()
+{
+   // Applying the running build first so that the proxies it holds back are released
+   if( m_rebuild.valid() )
+   {
+      _applyTree( m_rebuild.get() );
+   }
+
+   std::vector<uint32_t> proxies;
+   std::vector<AABB> bounds( m_proxies.size() );
+
+   proxies.reserve( m_proxyCount );
+   for( uint32_t proxyIdx = 0; proxyIdx < m_proxies.size(); ++proxyIdx )
+   {
+      if( !m_proxies[proxyIdx].alive ) continue;
+
+      proxies.push_back( proxyIdx );
+      bounds[proxyIdx] = m_proxies[proxyIdx].bounds;
+   }
+
+   _applyTree( _buildTree( std::move( proxies ), std::move( bounds ) ) );
+}
+
+void BVH::rebuildAsync( EMP::ThreadPool& threadPool )
+{
+   if( m_rebuild.valid() ) return;
+
+   // Snapshot of the proxies, the build works on its own copy
+   struct Snapshot
+   {
+      std::vector<uint32_t> proxies;
+      std::vector<AABB> bounds;
+   };
+
+   auto snapshot = std::make_shared<Snapshot>();
+   snapshot->bounds.resize( m_proxies.size() );
+   snapshot->proxies.reserve( m_proxyCount );
+   for( uint32_t proxyIdx = 0; proxyIdx < m_proxies.size(); ++proxyIdx )
+   {
+      if( !m_proxies[proxyIdx].alive ) continue;
+
+      snapshot->proxies.push_back( proxyIdx );
+      snapshot->bounds[proxyIdx] = m_proxies[proxyIdx].bounds;
+   }
+
+   m_rebuild = threadPool.submit(
+       EMP::ThreadPool::Lane::BACKGROUND,
+       [snapshot]()
+       { return _buildTree( std::move( snapshot->proxies ), std::move( snapshot->bounds ) ); } );
+}
+
+void BVH::_applyTree( Tree&& tree )
+{
+   CYD_TRACE( "BVH Apply" );
+
+   m_nodes = std::move( tree.nodes );
+   m_root  = m_nodes.empty() ? INVALID_IDX : 0;
+
+   // Refitting everything, proxies could have moved since the snapshot was taken
+   m_dirtyNodes.assign( m_nodes.size(), true );
+
+   for( Proxy& proxy : m_proxies )
+   {
+      proxy.node = INVALID_IDX;
+   }
+
+   for( uint32_t i = 0; i < tree.proxies.size(); ++i )
+   {
+      Proxy& proxy        = m_proxies[tree.proxies[i]];
+      const uint32_t node = tree.locations[i] >> 2;
+      const uint32_t slot = tree.locations[i] & ( WIDTH - 1 );
+
+      if( proxy.alive )
+      {
+         proxy.node = node;
+         proxy.slot = slot;
+         m_nodes[node].setBounds( slot, proxy.bounds );
+      }
+      else
+      {
+         // Removed while the build was running
+         m_nodes[node].children[slot] = INVALID_IDX;
+         m_nodes[node].setBounds( slot, AABB() );
+      }
+   }
+
+   // What was inserted while the build was running stays pending
+   m_pendingProxies.clear();
+   for( uint32_t proxyIdx = 0; proxyIdx < m_proxies.size(); ++proxyIdx )
+   {
+      const Proxy& proxy = m_proxies[proxyIdx];
+      if( proxy.alive && proxy.node == INVALID_IDX )
+      {
+         m_pendingProxies.push_back( proxyIdx );
+      }
+   }
+
+   m_freeProxies.insert( m_freeProxies.end(), m_deferredFrees.begin(), m_deferredFrees.end() );
+   m_deferredFrees.clear();
+
+   m_builtProxyCount = static_cast<uint32_t>( tree.proxies.size() );
+   m_movesSinceBuild = 0;
+}
+
+void BVH::refit()
+{
+   CYD_TRACE( "BVH Refit" );
+
+   if( m_rebuild.valid() &&
+       m_rebuild.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready )
+   {
+      _applyTree( m_rebuild.get() );
+   }
+
+   // Children come after their parent, going backwards refits bottom-up in one pass. The bounds of
+   // the proxies were already written in their slot
+   for( uint32_t nodeIdx = static_cast<uint32_t>( m_nodes.size() ); nodeIdx-- > 0; )
+   {
+      if( !m_dirtyNodes[nodeIdx] ) continue;
+
+      Node& node = m_nodes[nodeIdx];
+      for( uint32_t slot = 0; slot < WIDTH; ++slot )
+      {
+         const uint32_t child = node.children[slot];
+         if( child == INVALID_IDX || ( child & LEAF_FLAG ) ) continue;
+
+         node.setBounds( slot, m_nodes[child].getBounds() );
+      }
+
+      m_dirtyNodes[nodeIdx] = false;
+   }
+}
+
+bool BVH::needsRebuild() const
+{
+   // Refitting keeps the tree correct but its quality degrades as things move around
+   return m_pendingProxies.size() > std::max( MAX_PENDING_PROXIES, m_builtProxyCount / 16 ) ||
+          m_movesSinceBuild > std::max( MAX_PENDING_PROXIES, m_builtProxyCount );
+}
+
+// ================================================================================================
+// Queries
+// ================================================================================================
+template <typename NodeTest, typename OnProxy>
+void BVH::_traverse( NodeTest&& nodeTest, OnProxy&& onProxy ) const
+{
+   if( m_root == INVALID_IDX ) return;
+
+   uint32_t stack[64];
+   std::vector<uint32_t> overflow;
+
+   uint32_t stackSize = 0;
+   stack[stackSize++] = m_root;
+
+   while( stackSize > 0 || !overflow.empty() )
+   {
+      uint32_t nodeIdx;
+      if( !overflow.empty() )
+      {
+         nodeIdx = overflow.back();
+         overflow.pop_back();
+      }
+      else
+      {
+         nodeIdx = stack[--stackSize];
+      }
+
+      const Node& node = m_nodes[nodeIdx];
+
+      uint32_t mask = nodeTest( node );
+      while( mask )
+      {
+         const uint32_t slot  = std::countr_zero( mask );
+         const uint32_t child = node.children[slot];
+         mask &= mask - 1;
+
+         if( child == INVALID_IDX ) continue;
+
+         if( child & LEAF_FLAG )
+         {
+            onProxy( child & ~LEAF_FLAG );
+         }
+         else if( stackSize < std::size( stack ) )
+         {
+            stack[stackSize++] = child;
+         }
+         else
+         {
+            overflow.push_back( child );
+         }
+      }
+   }
+}
+
+void BVH::queryFrustum( const Frustum& frustum, std::vector<uint32_t>& userDatas ) const
+{
+   CYD_TRACE( "BVH Frustum Query" );
+
+   glm::vec4 planes[Frustum::COUNT];
+   frustum.getPlanes( planes );
+
+   // Only the corner of every box the furthest along the normal needs to be tested, which one it
+   // is only depends on the signs of the normal
+   struct PlaneTest
+   {
+      __m128 x;
+      __m128 y;
+      __m128 z;
+      __m128 w;
+      bool positiveX;
+      bool positiveY;
+      bool positiveZ;
+   };
+
+   PlaneTest planeTests[Frustum::COUNT];
+   for( uint32_t p = 0; p < Frustum::COUNT; ++p )
+   {
+      planeTests[p].x         = _mm_set1_ps( planes[p].x );
+      planeTests[p].y         = _mm_set1_ps( planes[p].y );
+      planeTests[p].z         = _mm_set1_ps( planes[p].z );
+      planeTests[p].w         = _mm_set1_ps( planes[p].w );
+      planeTests[p].positiveX = planes[p].x > 0.0f;
+      planeTests[p].positiveY = planes[p].y > 0.0f;
+      planeTests[p].positiveZ = planes[p].z > 0.0f;
+   }
+
+   auto nodeTest = [&]( const Node& node ) -> uint32_t
+   {
+      __m128 inside = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+      for( const PlaneTest& plane : planeTests )
+      {
+         const __m128 x = _mm_load_ps( plane.positiveX ? node.maxX : node.minX );
+         const __m128 y = _mm_load_ps( plane.positiveY ? node.maxY : node.minY );
+         const __m128 z = _mm_load_ps( plane.positiveZ ? node.maxZ : node.minZ );
+
+         __m128 distance = _mm_add_ps( _mm_mul_ps( x, plane.x ), plane.w );
+         distance        = _mm_add_ps( distance, _mm_mul_ps( y, plane.y ) );
+         distance        = _mm_add_ps( distance, _mm_mul_ps( z, plane.z ) );
+
+         inside = _mm_and_ps( inside, _mm_cmpge_ps( distance, _mm_setzero_ps() ) );
+      }
+
+      return static_cast<uint32_t>( _mm_movemask_ps( inside ) );
+   };
+
+   _traverse( nodeTest, [&]( uint32_t proxyIdx )
+              { userDatas.push_back( m_proxies[proxyIdx].userData ); } );
+
+   for( const uint32_t proxyIdx : m_pendingProxies )
+   {
+      if( FrustumIntersects( planes, m_proxies[proxyIdx].bounds ) )
+      {
+         userDatas.push_back( m_proxies[proxyIdx].userData );
+      }
+   }
+}
+
+void BVH::querySphere( const BoundingSphere& sphere, std::vector<uint32_t>& userDatas ) const
+{
+   CYD_TRACE( "BVH Sphere Query" );
+
+   const __m128 centerX  = _mm_set1_ps( sphere.center.x );
+   const __m128 centerY  = _mm_set1_ps( sphere.center.y );
+   const __m128 centerZ  = _mm_set1_ps( sphere.center.z );
+   const __m128 radiusSq = _mm_set1_ps( sphere.radius * sphere.radius );
+
+   // Distance from the center to the closest point of every box
+   auto nodeTest = [&]( const Node& node ) -> uint32_t
+   {
+      const __m128 zero = _mm_setzero_ps();
+
+      const __m128 dx = _mm_max_ps(
+          _mm_max_ps( _mm_sub_ps( _mm_load_ps( node.minX ), centerX ), zero ),
+          _mm_sub_ps( centerX, _mm_load_ps( node.maxX ) ) );
+      const __m128 dy = _mm_max_ps(
+          _mm_max_ps( _mm_sub_ps( _mm_load_ps( node.minY ), centerY ), zero ),
+          _mm_sub_ps( centerY, _mm_load_ps( node.maxY ) ) );
+      const __m128 dz = _mm_max_ps(
+          _mm_max_ps( _mm_sub_ps( _mm_load_ps( node.minZ ), centerZ ), zero ),
+          _mm_sub_ps( centerZ, _mm_load_ps( node.maxZ ) ) );
+
+      __m128 distanceSq = _mm_mul_ps( dx, dx );
+      distanceSq        = _mm_add_ps( distanceSq, _mm_mul_ps( dy, dy ) );
+      distanceSq        = _mm_add_ps( distanceSq, _mm_mul_ps( dz, dz ) );
+
+      return static_cast<uint32_t>( _mm_movemask_ps( _mm_cmple_ps( distanceSq, radiusSq ) ) );
+   };
+
+   _traverse( nodeTest, [&]( uint32_t proxyIdx )
+              { userDatas.push_back( m_proxies[proxyIdx].userData ); } );
+
+   for( const uint32_t proxyIdx : m_pendingProxies )
+   {
+      if( SphereIntersects( sphere, m_proxies[proxyIdx].bounds ) )
+      {
+         userDatas.push_back( m_proxies[proxyIdx].userData );
+      }
+   }
+}
+
+BVH::RayHit BVH::raycast( const Ray& ray ) const
+{
+   const glm::vec3 invDirection = 1.0f / ray.direction;
+   const glm::bvec3 isParallel  = glm::equal( ray.direction, glm::vec3( 0.0f ) );
+
+   const __m128 originX = _mm_set1_ps( ray.origin.x );
+   const __m128 originY = _mm_set1_ps( ray.origin.y );
+   const __m128 originZ = _mm_set1_ps( ray.origin.z );
+   const __m128 invDirX = _mm_set1_ps( invDirection.x );
+   const __m128 invDirY = _mm_set1_ps( invDirection.y );
+   const __m128 invDirZ = _mm_set1_ps( invDirection.z );
+
+   RayHit hit;
+   float closest = ray.maxDistance;
+
+   // Slab test, boxes further than the closest hit so far are skipped
+   auto nodeTest = [&]( const Node& node ) -> uint32_t
+   {
+      __m128 enter = _mm_setzero_ps();
+      __m128 exit  = _mm_set1_ps( closest );
+
+      ClipSlab( node.minX, node.maxX, originX, invDirX, isParallel.x, enter, exit );
+      ClipSlab( node.minY, node.maxY, originY, invDirY, isParallel.y, enter, exit );
+      ClipSlab( node.minZ, node.maxZ, originZ, invDirZ, isParallel.z, enter, exit );
+
+      return static_cast<uint32_t>( _mm_movemask_ps( _mm_cmple_ps( enter, exit ) ) );
+   };
+
+   auto onProxy = [&]( uint32_t proxyIdx )
+   {
+      float distance;
+      const AABB& bounds = m_proxies[proxyIdx].bounds;
+      if( RayIntersects( ray.origin, invDirection, isParallel, bounds, closest, distance ) )
+      {
+         closest      = distance;
+         hit.userData = m_proxies[proxyIdx].userData;
+         hit.distance = distance;
+      }
+   };
+
+   _traverse( nodeTest, onProxy );
+
+   for( const uint32_t proxyIdx : m_pendingProxies )
+   {
+      onProxy( proxyIdx );
+   }
+
+   return hit;
+}
+
+// ================================================================================================
+void BVH::queryFrustums( std::span<const Frustum> frustums, QueryResults& results ) const
+{
+   results.userDatas.clear();
+   results.offsets.resize( frustums.size() + 1 );
+   results.offsets[0] = 0;
+
+   for( uint32_t i = 0; i < frustums.size(); ++i )
+   {
+      queryFrustum( frustums[i], results.userDatas );
+      results.offsets[i + 1] = static_cast<uint32_t>( results.userDatas.size() );
+   }
+}
+
+void BVH::querySpheres( std::span<const BoundingSphere> spheres, QueryResults& results ) const
+{
+   results.userDatas.clear();
+   results.offsets.resize( spheres.size() + 1 );
+   results.offsets[0] = 0;
+
+   for( uint32_t i = 0; i < spheres.size(); ++i )
+   {
+      querySphere( spheres[i], results.userDatas );
+      results.offsets[i + 1] = static_cast<uint32_t>( results.userDatas.size() );
+   }
+}
+
+void BVH::raycasts( std::span<const Ray> rays, std::span<RayHit> hits ) const
+{
+   CYD_ASSERT( hits.size() >= rays.size() );
+
+   for( uint32_t i = 0; i < rays.size(); ++i )
+   {
+      hits[i] = raycast( rays[i] );
+   }
+}
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <Common/Include.h>
+
+#include <Graphics/Scene/Bounds.h>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <span>
+#include <vector>
+
+// ================================================================================================
+// Forwards
+// ================================================================================================
+namespace CYD
+{
+class Frustum;
+}
+
+namespace EMP
+{
+class ThreadPool;
+}
+
+// ================================================================================================
+// Definition
+// ================================================================================================
+/*
+Dynamic bounding volume hierarchy over proxies (an AABB and a user value each). Nodes have 4
+children whose bounds are stored in SoA so that a node is tested against a query in one go.
+
+Moving a proxy only refits the nodes above it. Proxies inserted since the last build are tested
+linearly until the next build, which is a binned SAH build that can run on a worker thread while
+the current tree keeps answering queries.
+
+Queries test proxy bounds only, they return the user values of the proxies that were hit.
+*/
+namespace CYD
+{
+class BVH
+{
+  public:
+   BVH();
+   NON_COPIABLE( BVH );
+   ~BVH();
+
+   using ProxyHandle = uint32_t;
+   static constexpr ProxyHandle INVALID_PROXY = std::numeric_limits<uint32_t>::max();
+
+   struct Ray
+   {
+      glm::vec3 origin;
+      glm::vec3 direction;
+      float maxDistance = std::numeric_limits<float>::max();
+   };
+
+   struct RayHit
+   {
+      uint32_t userData = std::numeric_limits<uint32_t>::max();
+      float distance    = std::numeric_limits<float>::max();
+
+      bool isHit() const { return userData != std::numeric_limits<uint32_t>::max(); }
+   };
+
+   // Results of a batch of queries, the hits of query i are in [offsets[i], offsets[i + 1])
+   struct QueryResults
+   {
+      std::vector<uint32_t> userDatas;
+      std::vector<uint32_t> offsets;
+
+      std::span<const uint32_t> get( uint32_t queryIdx ) const
+      {
+         return { userDatas.data() + offsets[queryIdx], userDatas.data() + offsets[queryIdx + 1] };
+      }
+   };
+
+   // Proxies
+   // ==============================================================================================
+   ProxyHandle insert( const AABB& bounds, uint32_t userData );
+   void update( ProxyHandle proxy, const AABB& bounds );
+   void remove( ProxyHandle proxy );
+
+   uint32_t getProxyCount() const { return m_proxyCount; }
+   uint32_t getNodeCount() const { return static_cast<uint32_t>( m_nodes.size() ); }
+
+   // Maintenance
+   // ==============================================================================================
+   // Synchronous build of the whole tree
+   void build();
+
+   // Starts a build on a background lane of the threadpool if none is running. The new tree
+   // replaces the current one in the first refit after it is done
+   void rebuildAsync( EMP::ThreadPool& threadPool );
+   bool isRebuilding() const { return m_rebuild.valid(); }
+
+   // Brings the tree up to date with the proxy changes. Call once before querying, typically once
+   // per frame
+   void refit();
+
+   // True when enough proxies were inserted or moved since the last build that the tree is worth
+   // rebuilding
+   bool needsRebuild() const;
+
+   // Queries
+   // ==============================================================================================
+   void queryFrustum( const Frustum& frustum, std::vector<uint32_t>& userDatas ) const;
+   void querySphere( const BoundingSphere& sphere, std::vector<uint32_t>& userDatas ) const;
+   RayHit raycast( const Ray& ray ) const;
+
+   void queryFrustums( std::span<const Frustum> frustums, QueryResults& results ) const;
+   void querySpheres( std::span<const BoundingSphere> spheres, QueryResults& results ) const;
+   void raycasts( std::span<const Ray> rays, std::span<RayHit> hits ) const;
+
+  private:
+   static constexpr uint32_t WIDTH       = 4;
+   static constexpr uint32_t INVALID_IDX = std::numeric_limits<uint32_t>::max();
+   static constexpr uint32_t LEAF_FLAG   = 0x80000000;  // Child is a proxy instead of a node
+
+   struct alignas( 64 ) Node
+   {
+      float minX[WIDTH];
+      float minY[WIDTH];
+      float minZ[WIDTH];
+      float maxX[WIDTH];
+      float maxY[WIDTH];
+      float maxZ[WIDTH];
+      uint32_t children[WIDTH];
+      uint32_t parent;
+
+      void setBounds( uint32_t slot, const AABB& bounds );
+      AABB getBounds() const;  // Union of all the slots
+   };
+
+   struct Proxy
+   {
+      AABB bounds;
+      uint32_t userData = 0;
+      uint32_t node     = INVALID_IDX;  // INVALID_IDX when not in the tree yet
+      uint32_t slot     = 0;
+      bool alive        = false;
+   };
+
+   // Result of a build, only touches its own data so that it can be done on another thread
+   struct Tree
+   {
+      std::vector<Node> nodes;
+      std::vector<uint32_t> proxies;    // Proxies that were built in the tree
+      std::vector<uint32_t> locations;  // Node << 2 | slot of every built proxy, same order
+   };
+
+   class TreeBuilder;
+   static Tree _buildTree( std::vector<uint32_t> proxies, std::vector<AABB> bounds );
+
+   void _applyTree( Tree&& tree );
+   void _markDirty( uint32_t nodeIdx );
+   void _freeProxy( uint32_t proxyIdx );
+
+   // Visits the nodes for which nodeTest returns a mask of the slots to go through, onProxy is
+   // called for every proxy in these slots
+   template <typename NodeTest, typename OnProxy>
+   void _traverse( NodeTest&& nodeTest, OnProxy&& onProxy ) const;
+
+   std::vector<Node> m_nodes;
+   std::vector<uint8_t> m_dirtyNodes;
+   uint32_t m_root = INVALID_IDX;
+
+   std::vector<Proxy> m_proxies;
+   std::vector<uint32_t> m_freeProxies;
+   std::vector<uint32_t> m_deferredFrees;   // Freed while a build was running
+   std::vector<uint32_t> m_pendingProxies;  // Not in the tree, tested linearly
+   uint32_t m_proxyCount = 0;
+
+   // Changes since the last build, used to decide when to rebuild
+   uint32_t m_builtProxyCount = 0;
+   uint32_t m_movesSinceBuild = 0;
+
+   std::future<Tree> m_rebuild;
+};
+}
@@ -0,0 +1,103 @@
+#include <Graphics/Scene/Bounds.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <immintrin.h>
+
+namespace CYD
+{
+// Loading 4 floats from a position reads one float past it, the last point of the array is done
+// separately so that we never read past the end of the buffer
+static __m128 LoadPosition( const uint8_t* pBytes ) { return _mm_loadu_ps( (const float*)pBytes ); }
+
+static glm::vec3 ToVec3( __m128 value )
+{
+   alignas( 16 ) float values[4];
+   _mm_store_ps( values, value );
+   return glm::vec3( values[0], values[1], values[2] );
+}
+
+AABB ComputeAABB( const void* pPositions, uint32_t count, uint32_t stride )
+{
+   AABB box;
+   if( count == 0 ) return box;
+
+   const uint8_t* pBytes = static_cast<const uint8_t*>( pPositions );
+   const uint32_t last   = count - 1;
+
+   // Two independent accumulators to hide the latency of min/max
+   __m128 min0 = _mm_set1_ps( std::numeric_limits<float>::max() );
+   __m128 max0 = _mm_set1_ps( -std::numeric_limits<float>::max() );
+   __m128 min1 = min0;
+   __m128 max1 = max0;
+
+   uint32_t i = 0;
+   for( ; i + 1 < last; i += 2 )
+   {
+      const __m128 pos0 = LoadPosition( pBytes + size_t( i ) * stride );
+      const __m128 pos1 = LoadPosition( pBytes + size_t( i + 1 ) * stride );
+
+      min0 = _mm_min_ps( min0, pos0 );
+      max0 = _mm_max_ps( max0, pos0 );
+      min1 = _mm_min_ps( min1, pos1 );
+      max1 = _mm_max_ps( max1, pos1 );
+   }
+
+   for( ; i < last; ++i )
+   {
+      const __m128 pos = LoadPosition( pBytes + size_t( i ) * stride );
+
+      min0 = _mm_min_ps( min0, pos );
+      max0 = _mm_max_ps( max0, pos );
+   }
+
+   box.min = ToVec3( _mm_min_ps( min0, min1 ) );
+   box.max = ToVec3( _mm_max_ps( max0, max1 ) );
+
+   const float* pLast = reinterpret_cast<const float*>( pBytes + size_t( last ) * stride );
+   box.extend( glm::vec3( pLast[0], pLast[1], pLast[2] ) );
+
+   return box;
+}
+
+BoundingSphere
+ComputeBoundingSphere( const void* pPositions, uint32_t count, uint32_t stride, const AABB& box )
+{
+   BoundingSphere sphere;
+   if( count == 0 || !box.isValid() ) return sphere;
+
+   const uint8_t* pBytes = static_cast<const uint8_t*>( pPositions );
+   const uint32_t last   = count - 1;
+
+   const glm::vec3 center = box.getCenter();
+
+   // The w component is whatever follows the position in memory, zeroing it out of the distance
+   const __m128 centerReg = _mm_setr_ps( center.x, center.y, center.z, 0.0f );
+   const __m128 xyzMask   = _mm_castsi128_ps( _mm_setr_epi32( -1, -1, -1, 0 ) );
+
+   __m128 maxDistSq = _mm_setzero_ps();
+   for( uint32_t i = 0; i < last; ++i )
+   {
+      const __m128 pos   = LoadPosition( pBytes + size_t( i ) * stride );
+      const __m128 delta = _mm_and_ps( _mm_sub_ps( pos, centerReg ), xyzMask );
+      const __m128 sq    = _mm_mul_ps( delta, delta );
+
+      // Horizontal add of x, y and z
+      const __m128 sum    = _mm_add_ps( sq, _mm_movehl_ps( sq, sq ) );
+      const __m128 distSq = _mm_add_ss( sum, _mm_shuffle_ps( sum, sum, 1 ) );
+
+      maxDistSq = _mm_max_ss( maxDistSq, distSq );
+   }
+
+   const float* pLast        = reinterpret_cast<const float*>( pBytes + size_t( last ) * stride );
+   const glm::vec3 lastDelta = glm::vec3( pLast[0], pLast[1], pLast[2] ) - center;
+
+   const float distSq = std::max( _mm_cvtss_f32( maxDistSq ), glm::dot( lastDelta, lastDelta ) );
+
+   sphere.center = center;
+   sphere.radius = std::sqrt( distSq );
+
+   return sphere;
+}
+}
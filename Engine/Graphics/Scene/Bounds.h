@@ -0,0 +1,81 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <limits>
+
+// ================================================================================================
+// Definition
+// ================================================================================================
+namespace CYD
+{
+struct AABB
+{
+   glm::vec3 min = glm::vec3( std::numeric_limits<float>::max() );
+   glm::vec3 max = glm::vec3( -std::numeric_limits<float>::max() );
+
+   // A default constructed box is empty and contains nothing
+   bool isValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+   glm::vec3 getCenter() const { return ( min + max ) * 0.5f; }
+   glm::vec3 getExtents() const { return ( max - min ) * 0.5f; }
+
+   void extend( const glm::vec3& point )
+   {
+      min = glm::min( min, point );
+      max = glm::max( max, point );
+   }
+
+   void extend( const AABB& other )
+   {
+      min = glm::min( min, other.min );
+      max = glm::max( max, other.max );
+   }
+
+   // Grows the box by the same amount in every direction
+   AABB inflate( float amount ) const { return { min - glm::vec3( amount ), max + amount }; }
+
+   // Box enclosing this one once transformed, the center is transformed and the extents are
+   // projected on the axes of the transform
+   AABB transform( const glm::mat4& matrix ) const
+   {
+      const glm::vec3 localExtents = getExtents();
+
+      const glm::vec3 center  = glm::vec3( matrix * glm::vec4( getCenter(), 1.0f ) );
+      const glm::vec3 extents = glm::abs( glm::vec3( matrix[0] ) ) * localExtents.x +
+                                glm::abs( glm::vec3( matrix[1] ) ) * localExtents.y +
+                                glm::abs( glm::vec3( matrix[2] ) ) * localExtents.z;
+
+      return { center - extents, center + extents };
+   }
+};
+
+struct BoundingSphere
+{
+   glm::vec3 center = glm::vec3( 0.0f );
+   float radius     = -1.0f;
+
+   bool isValid() const { return radius >= 0.0f; }
+
+   // The radius is scaled by the largest scaling of the transform
+   BoundingSphere transform( const glm::mat4& matrix ) const
+   {
+      const glm::vec3 scales = glm::vec3(
+          glm::length( glm::vec3( matrix[0] ) ),
+          glm::length( glm::vec3( matrix[1] ) ),
+          glm::length( glm::vec3( matrix[2] ) ) );
+      const float maxScale = glm::max( scales.x, glm::max( scales.y, scales.z ) );
+
+      return { glm::vec3( matrix * glm::vec4( center, 1.0f ) ), radius * maxScale };
+   }
+};
+
+// Bounds of a set of points, the positions are the first 3 floats of every stride bytes
+AABB ComputeAABB( const void* pPositions, uint32_t count, uint32_t stride );
+
+// Sphere centered on the box of the points, cheaper than the tightest sphere and close enough for
+// culling and LOD selection
+BoundingSphere
+ComputeBoundingSphere( const void* pPositions, uint32_t count, uint32_t stride, const AABB& box );
+}
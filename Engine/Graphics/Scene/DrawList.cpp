@@ -0,0 +1,178 @@
+#include <Graphics/Scene/DrawList.h>
+
+#include <Common/Assert.h>
+
+#include <Profiling.h>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+namespace CYD
+{
+static constexpr uint32_t PASS_BITS     = 4;
+static constexpr uint32_t PIPELINE_BITS = 12;
+static constexpr uint32_t MATERIAL_BITS = 16;
+static constexpr uint32_t MESH_BITS     = 13;
+static constexpr uint32_t DEPTH_BITS    = 19;
+
+static_assert( PASS_BITS + PIPELINE_BITS + MATERIAL_BITS + MESH_BITS + DEPTH_BITS == 64 );
+
+static constexpr uint32_t MESH_SHIFT     = DEPTH_BITS;
+static constexpr uint32_t MATERIAL_SHIFT = MESH_SHIFT + MESH_BITS;
+static constexpr uint32_t PIPELINE_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+static constexpr uint32_t PASS_SHIFT     = PIPELINE_SHIFT + PIPELINE_BITS;
+
+static constexpr uint64_t FieldMask( uint32_t bits, uint32_t shift )
+{
+   return ( ( uint64_t( 1 ) << bits ) - 1 ) << shift;
+}
+
+// Everything above a field, a change in any of them has to rebind that field
+static constexpr uint64_t PIPELINE_MASK = ~uint64_t( 0 ) << PIPELINE_SHIFT;
+static constexpr uint64_t MATERIAL_MASK = ~uint64_t( 0 ) << MATERIAL_SHIFT;
+static constexpr uint64_t MESH_MASK     = FieldMask( MESH_BITS, MESH_SHIFT );
+
+// Below this many draws, std::sort beats the histogram passes
+static constexpr size_t RADIX_SORT_THRESHOLD = 64;
+
+// Invalid indices take the last value of their field
+static uint64_t KeyField( size_t value, uint32_t bits )
+{
+   const uint64_t maxValue = ( uint64_t( 1 ) << bits ) - 1;
+   CYD_ASSERT( ( value == SIZE_MAX || value < maxValue ) && "DrawList: Index too large for key" );
+   return std::min<uint64_t>( value, maxValue );
+}
+
+// ================================================================================================
+uint64_t DrawList::MakeKey(
+    uint32_t pass,
+    PipelineIndex pipelineIdx,
+    MaterialIndex materialIdx,
+    VertexBufferHandle vertexBuffer,
+    float sqDistance )
+{
+   CYD_ASSERT( pass < MAX_PASSES && "DrawList: Pass out of range" );
+
+   // Positive floats order the same way as their bits, the top bits are a logarithmic
+   // quantization of the distance
+   const uint32_t distanceBits = std::bit_cast<uint32_t>( std::max( sqDistance, 0.0f ) );
+   const uint64_t depth        = distanceBits >> ( 31 - DEPTH_BITS );
+
+   // Zero is kept for draws without a vertex buffer, the index of a valid handle can be zero too
+   const uint64_t mesh = vertexBuffer ? vertexBuffer._index + 1 : 0;
+
+   return uint64_t( pass ) << PASS_SHIFT |
+          KeyField( pipelineIdx, PIPELINE_BITS ) << PIPELINE_SHIFT |
+          KeyField( materialIdx, MATERIAL_BITS ) << MATERIAL_SHIFT | mesh << MESH_SHIFT | depth;
+}
+
+// ================================================================================================
+uint32_t DrawList::GetStateChanges( uint64_t prevKey, uint64_t key )
+{
+   const uint64_t diff = prevKey ^ key;
+
+   uint32_t changes = NONE;
+   if( diff & PIPELINE_MASK ) changes |= PIPELINE;
+   if( diff & MATERIAL_MASK ) changes |= MATERIAL;
+   if( diff & MESH_MASK ) changes |= MESH;
+
+   return changes;
+}
+
+// ================================================================================================
+void DrawList::clear()
+{
+   m_packets.clear();
+   m_stats = {};
+}
+
+// ================================================================================================
+void DrawList::sort()
+{
+   CYD_TRACE( "DrawList Sort" );
+
+   const auto start = std::chrono::steady_clock::now();
+
+   if( m_packets.size() < RADIX_SORT_THRESHOLD )
+   {
+      std::sort(
+          m_packets.begin(),
+          m_packets.end(),
+          []( const Packet& first, const Packet& second ) { return first.key < second.key; } );
+   }
+   else
+   {
+      _radixSort();
+   }
+
+   m_stats.sortMs =
+       std::chrono::duration<float, std::milli>( std::chrono::steady_clock::now() - start )
+           .count();
+
+   m_stats.drawCount = static_cast<uint32_t>( m_packets.size() );
+
+   for( size_t i = 0; i < m_packets.size(); ++i )
+   {
+      const uint32_t changes =
+          i == 0 ? ALL : GetStateChanges( m_packets[i - 1].key, m_packets[i].key );
+
+      m_stats.pipelineChanges += ( changes & PIPELINE ) ? 1 : 0;
+      m_stats.materialChanges += ( changes & MATERIAL ) ? 1 : 0;
+      m_stats.meshChanges += ( changes & MESH ) ? 1 : 0;
+   }
+}
+
+// ================================================================================================
+void DrawList::_radixSort()
+{
+   static constexpr uint32_t DIGIT_COUNT = sizeof( uint64_t );
+   static constexpr uint32_t RADIX       = 256;
+
+   const size_t count = m_packets.size();
+   m_scratch.resize( count );
+
+   // All the histograms are built in a single pass over the keys
+   uint32_t histograms[DIGIT_COUNT][RADIX] = {};
+   for( const Packet& packet : m_packets )
+   {
+      for( uint32_t digit = 0; digit < DIGIT_COUNT; ++digit )
+      {
+         ++histograms[digit][( packet.key >> ( digit * 8 ) ) & 0xFF];
+      }
+   }
+
+   Packet* src = m_packets.data();
+   Packet* dst = m_scratch.data();
+
+   for( uint32_t digit = 0; digit < DIGIT_COUNT; ++digit )
+   {
+      const uint32_t shift = digit * 8;
+      uint32_t* histogram  = histograms[digit];
+
+      // Every key has the same digit, most of the passes in practice since the fields rarely use
+      // all of their bits
+      if( histogram[( src[0].key >> shift ) & 0xFF] == count ) continue;
+
+      uint32_t offset = 0;
+      for( uint32_t bucket = 0; bucket < RADIX; ++bucket )
+      {
+         const uint32_t bucketCount = histogram[bucket];
+         histogram[bucket]          = offset;
+         offset += bucketCount;
+      }
+
+      for( size_t i = 0; i < count; ++i )
+      {
+         dst[histogram[( src[i].key >> shift ) & 0xFF]++] = src[i];
+      }
+
+      std::swap( src, dst );
+   }
+
+   if( src != m_packets.data() )
+   {
+      m_packets.swap( m_scratch );
+   }
+}
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <Common/Include.h>
+
+#include <Graphics/GraphicsTypes.h>
+#include <Graphics/Handles/ResourceHandle.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// ================================================================================================
+// Definition
+// ================================================================================================
+/*
+Compact list of the draws of a render system. Every draw packet carries a 64-bit sort key and the
+index of the entity it draws, the list is radix sorted on the keys once all the draws were added.
+
+From the most to the least significant bits, a key holds:
+   pass     (4 bits)  - Ordered buckets inside of a system, lower passes are drawn first
+   pipeline (12 bits)
+   material (16 bits)
+   mesh     (13 bits) - Vertex buffer handle, zero when there is none
+   depth    (19 bits) - Quantized squared distance to the view, closest first
+
+Draws sharing the same state end up next to each other, and going from one draw to the next only
+needs the state whose bits changed in the key to be bound again.
+*/
+namespace CYD
+{
+class DrawList
+{
+  public:
+   DrawList() = default;
+   NON_COPIABLE( DrawList );
+   ~DrawList() = default;
+
+   struct Packet
+   {
+      uint64_t key;
+      uint32_t entityIdx;
+   };
+
+   // State to bind again when going from one packet to the next
+   enum StateChange : uint32_t
+   {
+      NONE     = 0,
+      PIPELINE = 1 << 0,
+      MATERIAL = 1 << 1,
+      MESH     = 1 << 2,
+      ALL      = PIPELINE | MATERIAL | MESH
+   };
+
+   // Run of consecutive packets drawn with a single call. Instanced batches draw one instance per
+   // packet, taken from the instance slots starting at firstInstance
+   struct Batch
+   {
+      uint32_t firstPacket   = 0;
+      uint32_t packetCount   = 0;
+      uint32_t firstInstance = 0;
+      bool isInstanced       = false;
+   };
+
+   struct Stats
+   {
+      uint32_t drawCount       = 0;
+      uint32_t pipelineChanges = 0;
+      uint32_t materialChanges = 0;
+      uint32_t meshChanges     = 0;
+      float sortMs             = 0.0f;
+   };
+
+   static constexpr uint32_t MAX_PASSES = 16;
+
+   // Invalid pipelines and materials still get a key, they are ordered after all of the valid ones
+   static uint64_t MakeKey(
+       uint32_t pass,
+       PipelineIndex pipelineIdx,
+       MaterialIndex materialIdx,
+       VertexBufferHandle vertexBuffer,
+       float sqDistance );
+
+   // Pipelines are rebound along with their material since they can invalidate descriptor sets.
+   // Vertex and index buffers survive a pipeline change
+   static uint32_t GetStateChanges( uint64_t prevKey, uint64_t key );
+
+   void clear();
+   void add( uint64_t key, uint32_t entityIdx ) { m_packets.push_back( { key, entityIdx } ); }
+   void sort();
+
+   // Merges the sorted packets in instanced batches of up to maxInstances. A packet joins the batch
+   // of the previous one when both can be instanced, their keys need no state change and
+   // canMerge( prevPacketIdx, packetIdx ) agrees. canInstance( packetIdx ) is called once per
+   // packet, in order. Instanced batches start on a multiple of alignment in the instance slots,
+   // returns the number of slots used, padding included
+   template <class CanInstance, class CanMerge>
+   uint32_t batch(
+       std::vector<Batch>& batches,
+       uint32_t maxInstances,
+       uint32_t alignment,
+       CanInstance&& canInstance,
+       CanMerge&& canMerge ) const;
+
+   std::span<const Packet> getPackets() const { return m_packets; }
+   bool empty() const { return m_packets.empty(); }
+
+   // Filled when sorting
+   const Stats& getStats() const { return m_stats; }
+
+  private:
+   void _radixSort();
+
+   std::vector<Packet> m_packets;
+   std::vector<Packet> m_scratch;
+
+   Stats m_stats;
+};
+
+// ================================================================================================
+template <class CanInstance, class CanMerge>
+uint32_t DrawList::batch(
+    std::vector<Batch>& batches,
+    uint32_t maxInstances,
+    uint32_t alignment,
+    CanInstance&& canInstance,
+    CanMerge&& canMerge ) const
+{
+   batches.clear();
+
+   uint32_t slotCount = 0;
+   for( uint32_t i = 0; i < m_packets.size(); ++i )
+   {
+      const bool isInstanced = canInstance( i );
+
+      const bool extendsBatch = isInstanced && !batches.empty() && batches.back().isInstanced &&
+                                batches.back().packetCount < maxInstances &&
+                                GetStateChanges( m_packets[i - 1].key, m_packets[i].key ) == NONE &&
+                                canMerge( i - 1, i );
+
+      if( !extendsBatch )
+      {
+         Batch& batch      = batches.emplace_back();
+         batch.firstPacket = i;
+         batch.isInstanced = isInstanced;
+
+         if( isInstanced )
+         {
+            slotCount           = ( slotCount + alignment - 1 ) / alignment * alignment;
+            batch.firstInstance = slotCount;
+         }
+      }
+
+      Batch& batch = batches.back();
+      batch.packetCount++;
+      slotCount += batch.isInstanced ? 1 : 0;
+   }
+
+   return slotCount;
+}
+}
@@ -0,0 +1,244 @@
+#include <Graphics/Scene/FrustumCuller.h>
+
+#include <Common/Assert.h>
+
+#include <Graphics/Scene/Bounds.h>
+#include <Graphics/Scene/Frustum.h>
+
+#include <Profiling.h>
+
+#include <bit>
+#include <cmath>
+
+#include <immintrin.h>
+
+namespace CYD
+{
+// Large enough to intersect any frustum, small enough to not overflow when projected on a plane
+static constexpr float ALWAYS_VISIBLE_EXTENT = 1e30f;
+
+// Behind every plane, whatever the frustum
+static constexpr float NEVER_VISIBLE_EXTENT = -1e30f;
+
+// Broadcasted frustum plane, the absolute value of the normal is used to project the extents
+template <typename Register>
+struct PlaneRegisters
+{
+   Register x;
+   Register y;
+   Register z;
+   Register w;
+   Register absX;
+   Register absY;
+   Register absZ;
+};
+
+// ================================================================================================
+void FrustumCuller::resize( uint32_t count )
+{
+   const uint32_t paddedCount = ( count + BATCH_SIZE - 1 ) / BATCH_SIZE * BATCH_SIZE;
+
+   const uint32_t prevCount = m_count;
+   m_count                  = count;
+
+   m_centerX.resize( paddedCount, 0.0f );
+   m_centerY.resize( paddedCount, 0.0f );
+   m_centerZ.resize( paddedCount, 0.0f );
+   m_extentX.resize( paddedCount, 0.0f );
+   m_extentY.resize( paddedCount, 0.0f );
+   m_extentZ.resize( paddedCount, 0.0f );
+
+   for( uint32_t i = prevCount; i < count; ++i )
+   {
+      setAlwaysVisible( i );
+   }
+}
+
+void FrustumCuller::setBounds( uint32_t index, const AABB& worldBounds )
+{
+   CYD_ASSERT( index < m_count );
+
+   const glm::vec3 center  = worldBounds.getCenter();
+   const glm::vec3 extents = worldBounds.getExtents();
+
+   m_centerX[index] = center.x;
+   m_centerY[index] = center.y;
+   m_centerZ[index] = center.z;
+   m_extentX[index] = extents.x;
+   m_extentY[index] = extents.y;
+   m_extentZ[index] = extents.z;
+}
+
+void FrustumCuller::setAlwaysVisible( uint32_t index )
+{
+   CYD_ASSERT( index < m_count );
+
+   m_centerX[index] = 0.0f;
+   m_centerY[index] = 0.0f;
+   m_centerZ[index] = 0.0f;
+   m_extentX[index] = ALWAYS_VISIBLE_EXTENT;
+   m_extentY[index] = ALWAYS_VISIBLE_EXTENT;
+   m_extentZ[index] = ALWAYS_VISIBLE_EXTENT;
+}
+
+void FrustumCuller::setNeverVisible( uint32_t index )
+{
+   CYD_ASSERT( index < m_count );
+
+   m_centerX[index] = 0.0f;
+   m_centerY[index] = 0.0f;
+   m_centerZ[index] = 0.0f;
+   m_extentX[index] = NEVER_VISIBLE_EXTENT;
+   m_extentY[index] = NEVER_VISIBLE_EXTENT;
+   m_extentZ[index] = NEVER_VISIBLE_EXTENT;
+}
+
+// ================================================================================================
+// A box is outside of the frustum when it is entirely behind one of the planes. The distance of
+// its center to the plane plus its extents projected on the normal is negative in that case
+void FrustumCuller::cull( const Frustum& frustum, std::vector<uint32_t>& visible ) const
+{
+   CYD_TRACE( "FrustumCuller" );
+
+   glm::vec4 planes[Frustum::COUNT];
+   frustum.getPlanes( planes );
+
+#if defined( __AVX__ )
+   using Register = __m256;
+
+   PlaneRegisters<Register> planeRegs[Frustum::COUNT];
+   for( uint32_t p = 0; p < Frustum::COUNT; ++p )
+   {
+      planeRegs[p].x    = _mm256_set1_ps( planes[p].x );
+      planeRegs[p].y    = _mm256_set1_ps( planes[p].y );
+      planeRegs[p].z    = _mm256_set1_ps( planes[p].z );
+      planeRegs[p].w    = _mm256_set1_ps( planes[p].w );
+      planeRegs[p].absX = _mm256_set1_ps( std::abs( planes[p].x ) );
+      planeRegs[p].absY = _mm256_set1_ps( std::abs( planes[p].y ) );
+      planeRegs[p].absZ = _mm256_set1_ps( std::abs( planes[p].z ) );
+   }
+
+   // 8 boxes per iteration
+   auto testBatch = [&]( uint32_t first ) -> uint32_t
+   {
+      const __m256 centerX = _mm256_loadu_ps( &m_centerX[first] );
+      const __m256 centerY = _mm256_loadu_ps( &m_centerY[first] );
+      const __m256 centerZ = _mm256_loadu_ps( &m_centerZ[first] );
+      const __m256 extentX = _mm256_loadu_ps( &m_extentX[first] );
+      const __m256 extentY = _mm256_loadu_ps( &m_extentY[first] );
+      const __m256 extentZ = _mm256_loadu_ps( &m_extentZ[first] );
+
+      __m256 inside = _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) );
+      for( const PlaneRegisters<Register>& plane : planeRegs )
+      {
+         __m256 distance = _mm256_add_ps( _mm256_mul_ps( centerX, plane.x ), plane.w );
+         distance        = _mm256_add_ps( distance, _mm256_mul_ps( centerY, plane.y ) );
+         distance        = _mm256_add_ps( distance, _mm256_mul_ps( centerZ, plane.z ) );
+
+         __m256 radius = _mm256_mul_ps( extentX, plane.absX );
+         radius        = _mm256_add_ps( radius, _mm256_mul_ps( extentY, plane.absY ) );
+         radius        = _mm256_add_ps( radius, _mm256_mul_ps( extentZ, plane.absZ ) );
+
+         const __m256 test = _mm256_cmp_ps(
+             _mm256_add_ps( distance, radius ), _mm256_setzero_ps(), _CMP_GE_OQ );
+         inside = _mm256_and_ps( inside, test );
+      }
+
+      return static_cast<uint32_t>( _mm256_movemask_ps( inside ) );
+   };
+#else
+   using Register = __m128;
+
+   PlaneRegisters<Register> planeRegs[Frustum::COUNT];
+   for( uint32_t p = 0; p < Frustum::COUNT; ++p )
+   {
+      planeRegs[p].x    = _mm_set1_ps( planes[p].x );
+      planeRegs[p].y    = _mm_set1_ps( planes[p].y );
+      planeRegs[p].z    = _mm_set1_ps( planes[p].z );
+      planeRegs[p].w    = _mm_set1_ps( planes[p].w );
+      planeRegs[p].absX = _mm_set1_ps( std::abs( planes[p].x ) );
+      planeRegs[p].absY = _mm_set1_ps( std::abs( planes[p].y ) );
+      planeRegs[p].absZ = _mm_set1_ps( std::abs( planes[p].z ) );
+   }
+
+   auto testHalfBatch = [&]( uint32_t first ) -> uint32_t
+   {
+      const __m128 centerX = _mm_loadu_ps( &m_centerX[first] );
+      const __m128 centerY = _mm_loadu_ps( &m_centerY[first] );
+      const __m128 centerZ = _mm_loadu_ps( &m_centerZ[first] );
+      const __m128 extentX = _mm_loadu_ps( &m_extentX[first] );
+      const __m128 extentY = _mm_loadu_ps( &m_extentY[first] );
+      const __m128 extentZ = _mm_loadu_ps( &m_extentZ[first] );
+
+      __m128 inside = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+      for( const PlaneRegisters<Register>& plane : planeRegs )
+      {
+         __m128 distance = _mm_add_ps( _mm_mul_ps( centerX, plane.x ), plane.w );
+         distance        = _mm_add_ps( distance, _mm_mul_ps( centerY, plane.y ) );
+         distance        = _mm_add_ps( distance, _mm_mul_ps( centerZ, plane.z ) );
+
+         __m128 radius = _mm_mul_ps( extentX, plane.absX );
+         radius        = _mm_add_ps( radius, _mm_mul_ps( extentY, plane.absY ) );
+         radius        = _mm_add_ps( radius, _mm_mul_ps( extentZ, plane.absZ ) );
+
+         const __m128 test = _mm_cmpge_ps( _mm_add_ps( distance, radius ), _mm_setzero_ps() );
+         inside            = _mm_and_ps( inside, test );
+      }
+
+      return static_cast<uint32_t>( _mm_movemask_ps( inside ) );
+   };
+
+   // 8 boxes per iteration, as two halves on SSE
+   auto testBatch = [&]( uint32_t first ) -> uint32_t
+   { return testHalfBatch( first ) | ( testHalfBatch( first + 4 ) << 4 ); };
+#endif
+
+   visible.resize( m_count );
+
+   uint32_t visibleCount = 0;
+   for( uint32_t first = 0; first < m_count; first += BATCH_SIZE )
+   {
+      uint32_t mask = testBatch( first );
+
+      // Ignoring the padding of the last batch
+      const uint32_t remaining = m_count - first;
+      if( remaining < BATCH_SIZE )
+      {
+         mask &= ( 1u << remaining ) - 1;
+      }
+
+      while( mask )
+      {
+         visible[visibleCount++] = first + std::countr_zero( mask );
+         mask &= mask - 1;
+      }
+   }
+
+   visible.resize( visibleCount );
+}
+
+void FrustumCuller::cullScalar( const Frustum& frustum, std::vector<uint32_t>& visible ) const
+{
+   glm::vec4 planes[Frustum::COUNT];
+   frustum.getPlanes( planes );
+
+   visible.clear();
+   for( uint32_t i = 0; i < m_count; ++i )
+   {
+      bool inside = true;
+      for( const glm::vec4& plane : planes )
+      {
+         // Same order of operations as the vectorized path so that both give the same results
+         const float distance = m_centerX[i] * plane.x + plane.w + m_centerY[i] * plane.y +
+                                m_centerZ[i] * plane.z;
+         const float radius = m_extentX[i] * std::abs( plane.x ) +
+                              m_extentY[i] * std::abs( plane.y ) +
+                              m_extentZ[i] * std::abs( plane.z );
+
+         inside &= distance + radius >= 0.0f;
+      }
+
+      if( inside ) visible.push_back( i );
+   }
+}
+}
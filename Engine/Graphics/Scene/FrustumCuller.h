@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Common/Include.h>
+
+#include <cstdint>
+#include <vector>
+
+// ================================================================================================
+// Forwards
+// ================================================================================================
+namespace CYD
+{
+class Frustum;
+struct AABB;
+}
+
+// ================================================================================================
+// Definition
+// ================================================================================================
+/*
+World-space boxes stored as centers and extents in SoA arrays so that they can be tested against
+the planes of a frustum 8 at a time
+*/
+namespace CYD
+{
+class FrustumCuller
+{
+  public:
+   FrustumCuller() = default;
+   NON_COPIABLE( FrustumCuller );
+   ~FrustumCuller() = default;
+
+   // Boxes added when growing are always visible until their bounds are set
+   void resize( uint32_t count );
+   uint32_t getCount() const { return m_count; }
+
+   void setBounds( uint32_t index, const AABB& worldBounds );
+   void setAlwaysVisible( uint32_t index );  // For things without meaningful bounds
+   void setNeverVisible( uint32_t index );   // For things with nothing to draw
+
+   // Fills visible with the indices of the boxes that intersect the frustum, in increasing order
+   void cull( const Frustum& frustum, std::vector<uint32_t>& visible ) const;
+
+   // One box at a time, kept as a reference for the vectorized path
+   void cullScalar( const Frustum& frustum, std::vector<uint32_t>& visible ) const;
+
+  private:
+   static constexpr uint32_t BATCH_SIZE = 8;
+
+   uint32_t m_count = 0;
+
+   // Padded to a multiple of the batch size
+   std::vector<float> m_centerX;
+   std::vector<float> m_centerY;
+   std::vector<float> m_centerZ;
+   std::vector<float> m_extentX;
+   std::vector<float> m_extentY;
+   std::vector<float> m_extentZ;
+};
+}
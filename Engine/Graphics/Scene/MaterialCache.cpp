@@ -6,9 +6,9 @@
 #include <Graphics/GRIS/RenderInterface.h>
 #include <Graphics/Utility/GraphicsIO.h>
 
-#include <json/json.hpp>
+#include <IO/VirtualFileSystem.h>
 
-#include <fstream>
+#include <json/json.hpp>
 
 namespace CYD
 {
@@ -22,8 +22,8 @@ MaterialCache::MaterialCache() { initializeStaticMaterials(); }
 
 MaterialIndex MaterialCache::addMaterial( const std::string& name, const Material::ResourcesDescription& desc )
 {
-   MaterialIndex index   = m_materials.insertObject( name, desc );
-   m_materialNames[name] = index;
+   MaterialIndex index = m_materials.insertObject( name, desc );
+   m_materialNames.insertOrAssign( name, index );
 
    return index;
 }
@@ -52,10 +52,9 @@ void MaterialCache::updateMaterial( MaterialIndex index, TextureHandle texture,
 
 MaterialIndex MaterialCache::getMaterialByName( const std::string& name ) const
 {
-   const auto& findIt = m_materialNames.find( name );
-   if( findIt != m_materialNames.end() )
+   if( const MaterialIndex* index = m_materialNames.find( name ) )
    {
-      return findIt->second;
+      return *index;
    }
 
    return INVALID_MATERIAL_IDX;
@@ -110,16 +109,16 @@ static ImageType StringToTextureType( const std::string& formatString )
 void MaterialCache::initializeStaticMaterials()
 {
    // Parse material infos from JSON description
-   nlohmann::json materialDescriptions;
-   std::ifstream materialsFile( STATIC_MATERIALS_PATH );
-
-   if( !materialsFile.is_open() )
+   EMP::VirtualFile materialsFile;
+   if( !GraphicsIO::GetFileSystem().open( STATIC_MATERIALS_PATH, materialsFile ) )
    {
       CYD_ASSERT( !"StaticMaterials: Could not find materials file" );
       return;
    }
 
-   materialsFile >> materialDescriptions;
+   const char* materialsText = reinterpret_cast<const char*>( materialsFile.getData() );
+   nlohmann::json materialDescriptions =
+       nlohmann::json::parse( materialsText, materialsText + materialsFile.getSize() );
 
    const auto& materials = materialDescriptions.front();
 
@@ -132,8 +131,7 @@ void MaterialCache::initializeStaticMaterials()
 
       // Making sure there is no name duplication
 #if CYD_ASSERTIONS_ENABLED
-      const auto& dupIt = m_materialNames.find( materialName );
-      if( dupIt != m_materialNames.end() )
+      if( m_materialNames.contains( materialName ) )
       {
          CYD_ASSERT( !"Materials: Name already taken, ignoring" );
          continue;
@@ -166,8 +164,8 @@ void MaterialCache::initializeStaticMaterials()
          }
       }
 
-      MaterialIndex index           = m_materials.insertObject();
-      m_materialNames[materialName] = index;
+      MaterialIndex index = m_materials.insertObject();
+      m_materialNames.insertOrAssign( materialName, index );
 
       printf( "Added material --> %s\n", materialName.c_str() );
    }
@@ -7,9 +7,10 @@
 
 #include <Common/ObjectPool.h>
 
+#include <Multithreading/ConcurrentHashMap.h>
+
 #include <cstdint>
 #include <string_view>
-#include <unordered_map>
 
 namespace CYD
 {
@@ -38,6 +39,6 @@ class MaterialCache final
    void initializeStaticMaterials();
 
    EMP::ObjectPool<Material> m_materials;
-   std::unordered_map<std::string, MaterialIndex> m_materialNames;
+   EMP::ConcurrentHashMap<std::string, MaterialIndex> m_materialNames;
 };
 }
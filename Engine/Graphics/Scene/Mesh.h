@@ -1,9 +1,35 @@
 #pragma once
 
 #include <Graphics/Handles/ResourceHandle.h>
+#include <Graphics/Scene/Bounds.h>
+#include <Graphics/Scene/Meshlets.h>
+#include <Graphics/VertexLayout.h>
+
+#include <array>
+#include <memory>
+#include <vector>
 
 namespace CYD
 {
+// Low detail triangles kept on the CPU for occlusion culling. They have to be inside of the mesh
+// they stand for, an occluder that covers more than its mesh would hide things that are visible
+struct OccluderGeometry
+{
+   std::vector<glm::vec3> positions;
+   std::vector<uint32_t> indices;
+};
+
+// Range of the index buffer of a mesh drawing one of its levels of detail. Every LOD uses the same
+// vertices, the coarser ones only have fewer triangles
+struct MeshLod
+{
+   uint32_t firstIndex = 0;
+   uint32_t indexCount = 0;
+   float error         = 0.0f;  // Largest distance to the full detail mesh, in local units
+};
+
+static constexpr uint32_t MAX_MESH_LODS = 4;
+
 struct Mesh
 {
    Mesh() = default;
@@ -11,7 +37,27 @@ struct Mesh
 
    VertexBufferHandle vertexBuffer;
    IndexBufferHandle indexBuffer;
+   IndexType indexType  = IndexType::UNSIGNED_INT32;  // The narrowest one for the vertex count
    uint32_t vertexCount = 0;
-   uint32_t indexCount  = 0;
+   uint32_t indexCount  = 0;  // Of the full detail LOD
+
+   // Encoding of the vertex buffer, it has to match the vertex layout of the pipelines drawing it
+   VertexFormatFlag vertexFormat = 0;
+   PositionQuantization positionQuantization;
+
+   // From the finest to the coarsest, the first LOD is the full detail mesh
+   std::array<MeshLod, MAX_MESH_LODS> lods = {};
+   uint32_t lodCount                       = 0;
+
+   // Local space, computed from the vertices when the mesh is loaded
+   AABB bounds;
+   BoundingSphere boundingSphere;
+
+   // Optional, only for meshes that were given one when loaded
+   std::shared_ptr<const OccluderGeometry> occluder;
+
+   // Clusters of the full detail LOD, whose indices are ordered meshlet by meshlet. Only for loaded
+   // meshes large enough to have more than one
+   std::shared_ptr<const std::vector<Meshlet>> meshlets;
 };
 }
\ No newline at end of file
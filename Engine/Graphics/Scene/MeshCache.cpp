@@ -5,8 +5,20 @@
 #include <Graphics/GraphicsTypes.h>
 #include <Graphics/VertexLayout.h>
 #include <Graphics/GRIS/RenderInterface.h>
+#include <Graphics/Scene/MeshFile.h>
 #include <Graphics/Utility/GraphicsIO.h>
 #include <Graphics/Utility/MeshGeneration.h>
+#include <Graphics/Utility/MeshOptimization.h>
+#include <Graphics/Utility/ObjImporter.h>
+
+#include <IO/DerivedDataCache.h>
+#include <IO/VirtualFileSystem.h>
+#include <Multithreading/ThreadPool.h>
+
+#include <Profiling.h>
+
+#include <algorithm>
+#include <cstdio>
 
 namespace CYD
 {
@@ -14,12 +26,139 @@ namespace CYD
 // ================================================================================================
 static constexpr char MESH_PATH[] = "../Engine/Data/Meshes/";
 
-MeshCache::MeshCache()
+// Mesh on its way from the disk to the cache
+struct MeshCache::StreamedMesh
+{
+   std::string name;
+   Clock::time_point requestTime;
+   CookedMesh cooked;
+   uint64_t derivedDataKey = 0;  // Of the cooked mesh, when it is not in the cache yet
+   bool isValid            = false;
+};
+
+// Meshes cooked ahead of time, either converted next to their OBJ file or cooked by an earlier run
+// and kept in the derived data cache. The key of the cooked mesh is given back on the misses, it
+// is null when the OBJ file is missing as well
+static bool OpenCookedMesh( const std::string& name, MeshFile& file, uint64_t& derivedDataKey )
+{
+   derivedDataKey = 0;
+
+   // Without its OBJ file, a converted mesh is all there is and it is used as it is
+   const std::string meshPath = MESH_PATH + name + MeshFile::EXTENSION;
+
+   EMP::VirtualFile objFile;
+   if( !GraphicsIO::GetFileSystem().open( MESH_PATH + name + ".obj", objFile ) )
+   {
+      return file.open( meshPath );
+   }
+
+   // The cooked mesh depends on the content of the OBJ file and on how it is cooked, a converted
+   // mesh is stale once either changes
+   derivedDataKey =
+       GetMeshSourceKey( objFile.getData(), objFile.getSize(), VertexFormat::COMPACT );
+
+   if( file.open( meshPath ) )
+   {
+      if( file.getHeader().sourceKey == derivedDataKey ) return true;
+
+      printf( "MeshCache: %s is out of date, it is cooked again\n", meshPath.c_str() );
+   }
+
+   EMP::MappedFile cachedFile;
+   if( !GraphicsIO::GetDerivedDataCache().load( derivedDataKey, MeshFile::EXTENSION, cachedFile ) )
+   {
+      return false;
+   }
+
+   return file.open( EMP::VirtualFile( std::move( cachedFile ) ), name );
+}
+
+static void StoreCookedMesh( uint64_t derivedDataKey, CookedMesh& cooked )
+{
+   if( !derivedDataKey ) return;
+
+   cooked.header.sourceKey = derivedDataKey;
+
+   std::vector<uint8_t> file;
+   SerializeMeshFile( cooked, file );
+
+   GraphicsIO::GetDerivedDataCache().store(
+       derivedDataKey, MeshFile::EXTENSION, file.data(), file.size() );
+}
+
+// Mesh streams as they are in a mesh file, mapped or cooked in memory
+static void UploadMesh(
+    CmdListHandle transferList,
+    Mesh& mesh,
+    const MeshFileHeader& header,
+    const void* vertexData,
+    const void* indexData,
+    const MeshLod* lods,
+    const Meshlet* meshlets,
+    const std::string_view name )
+{
+   mesh.vertexFormat         = header.vertexFormat;
+   mesh.positionQuantization = header.positionQuantization;
+   mesh.vertexCount          = header.vertexCount;
+   mesh.indexType            = header.indexType;
+   mesh.indexCount           = lods[0].indexCount;
+   mesh.bounds               = header.bounds;
+   mesh.boundingSphere       = header.boundingSphere;
+
+   std::copy( lods, lods + header.lodCount, mesh.lods.begin() );
+   mesh.lodCount = header.lodCount;
+
+   if( header.meshletCount )
+   {
+      mesh.meshlets = std::make_shared<const std::vector<Meshlet>>(
+          meshlets, meshlets + header.meshletCount );
+   }
+
+   mesh.vertexBuffer = GRIS::CreateVertexBuffer(
+       transferList, header.vertexCount, header.vertexStride, vertexData, name );
+
+   mesh.indexBuffer = GRIS::CreateIndexBuffer(
+       transferList, header.indexCount, header.indexType, indexData, name );
+
+   printf(
+       "Added mesh --> %.*s, %u vertices of %u bytes, %zu bytes saved\n",
+       static_cast<int>( name.size() ),
+       name.data(),
+       header.vertexCount,
+       header.vertexStride,
+       size_t( header.vertexCount ) * ( sizeof( Vertex ) - header.vertexStride ) );
+}
+
+static void UploadMesh(
+    CmdListHandle transferList,
+    Mesh& mesh,
+    const CookedMesh& cooked,
+    const std::string_view name )
+{
+   UploadMesh(
+       transferList,
+       mesh,
+       cooked.header,
+       cooked.vertexData.data(),
+       cooked.indexData.data(),
+       cooked.lods.data(),
+       cooked.meshlets.data(),
+       name );
+}
+
+MeshCache::MeshCache( EMP::ThreadPool& threadPool ) : m_threadPool( threadPool )
 {
    // Initialize default meshes
    _initDefaultMeshes();
 }
 
+MeshCache::~MeshCache()
+{
+   // Meshes still being read or decoded are dropped once their task is done
+   std::unique_lock<std::mutex> lock( m_streamingMutex );
+   m_streamingDone.wait( lock, [this]() { return m_streamingTaskCount == 0; } );
+}
+
 void MeshCache::_initDefaultMeshes()
 {
    CmdListHandle transferList = GRIS::CreateCommandList( QueueUsage::TRANSFER, "Init Default Meshes" );
@@ -39,79 +178,265 @@ void MeshCache::_initDefaultMeshes()
 const Mesh& MeshCache::getMesh( const std::string_view name )
 {
    const std::string meshString( name );
-   auto it = m_meshes.find( meshString );
-   if( it != m_meshes.end() )
+   if( const Mesh* mesh = m_meshes.find( meshString ) )
    {
-      return it->second;
+      return *mesh;
    }
 
-   return m_meshes[""];
+   return m_emptyMesh;
 }
 
 bool MeshCache::loadMeshFromPath( CmdListHandle transferList, const std::string_view meshPath )
 {
    const std::string meshString( meshPath );
-   auto it = m_meshes.find( meshString );
-   if( it == m_meshes.end() )
+   return m_meshes.tryEmplace(
+       meshString,
+       [&]( Mesh& mesh )
+       {
+          // Mesh was not previously loaded, the cooked mesh file is mapped and uploaded as it
+          // is when there is one
+          MeshFile file;
+          uint64_t derivedDataKey = 0;
+          if( OpenCookedMesh( meshString, file, derivedDataKey ) )
+          {
+             UploadMesh(
+                 transferList,
+                 mesh,
+                 file.getHeader(),
+                 file.getVertexData(),
+                 file.getIndexData(),
+                 file.getLods(),
+                 file.getMeshlets(),
+                 meshPath );
+             return;
+          }
+
+          std::vector<Vertex> vertices;
+          std::vector<uint32_t> indices;
+          GraphicsIO::LoadMesh( meshString, vertices, indices, m_threadPool );
+
+          CookedMesh cooked;
+          CookMesh( vertices, indices, VertexFormat::COMPACT, cooked );
+          StoreCookedMesh( derivedDataKey, cooked );
+
+          UploadMesh( transferList, mesh, cooked, meshPath );
+       } );
+}
+
+bool MeshCache::loadMesh(
+    CmdListHandle transferList,
+    const std::string_view name,
+    const std::vector<Vertex>& vertices,
+    const std::vector<uint32_t>& indices,
+    std::shared_ptr<const OccluderGeometry> occluder,
+    VertexFormatFlag format )
+{
+   const std::string meshString( name );
+   return m_meshes.tryEmplace(
+       meshString,
+       [&]( Mesh& mesh )
+       {
+          // Generated meshes come in the order of their generator, not the one of the GPU. Some
+          // generators already are in a good order, it is only replaced when it misses less
+          std::vector<Vertex> optimizedVertices  = vertices;
+          std::vector<uint32_t> optimizedIndices = indices;
+          MeshOptimization::Optimize( optimizedVertices, optimizedIndices );
+
+          const uint32_t vertexCount          = static_cast<uint32_t>( vertices.size() );
+          const uint32_t optimizedVertexCount = static_cast<uint32_t>( optimizedVertices.size() );
+
+          const MeshOptimization::VertexCacheStats cache =
+              MeshOptimization::AnalyzeVertexCache( indices, vertexCount );
+          const MeshOptimization::VertexCacheStats optimizedCache =
+              MeshOptimization::AnalyzeVertexCache( optimizedIndices, optimizedVertexCount );
+          const bool isOptimized = optimizedCache.acmr < cache.acmr;
+
+          // Generated meshes are drawn as they are
+          CookedMesh cooked;
+          PackMesh(
+              isOptimized ? optimizedVertices : vertices,
+              isOptimized ? optimizedIndices : indices,
+              format,
+              cooked );
+
+          UploadMesh( transferList, mesh, cooked, name );
+
+          mesh.occluder = std::move( occluder );
+       } );
+}
+
+// ================================================================================================
+// Streaming
+// ================================================================================================
+MeshCache::StreamingState MeshCache::requestMesh( const std::string_view name )
+{
+   const std::string meshString( name );
+   if( m_meshes.contains( meshString ) ) return StreamingState::LOADED;
+
+   auto streamed = std::make_shared<StreamedMesh>();
    {
-      // Mesh was not previously loaded, load it
-      const std::string fullPath = MESH_PATH + meshString + "/";
+      std::unique_lock<std::mutex> lock( m_streamingMutex );
+
+      if( m_failedMeshes.count( meshString ) ) return StreamingState::FAILED;
 
-      std::vector<Vertex> vertices;
-      std::vector<uint32_t> indices;
-      GraphicsIO::LoadMesh( meshString, vertices, indices );
+      if( !m_streamingMeshes.insert( meshString ).second )
+      {
+         m_streamingStats.mergedCount++;
+         return StreamingState::LOADING;
+      }
 
-      Mesh& mesh = m_meshes[meshString];
+      // The upload could have happened between the lookup and the lock
+      if( m_meshes.contains( meshString ) )
+      {
+         m_streamingMeshes.erase( meshString );
+         return StreamingState::LOADED;
+      }
 
-      mesh.vertexBuffer = GRIS::CreateVertexBuffer(
-          transferList,
-          static_cast<uint32_t>( vertices.size() ),
-          static_cast<uint32_t>( sizeof( Vertex ) ),
-          vertices.data(),
-          meshPath );
+      m_streamingStats.requestCount++;
+      m_streamingTaskCount++;
+   }
+
+   streamed->name        = meshString;
+   streamed->requestTime = Clock::now();
 
-      mesh.vertexCount = static_cast<uint32_t>( vertices.size() );
+   if( m_threadPool.isInit() )
+   {
+      m_threadPool.submit(
+          EMP::ThreadPool::Lane::IO, [this, streamed]() { _readMesh( streamed ); } );
+   }
+   else
+   {
+      _readMesh( streamed );
+   }
 
-      mesh.indexBuffer = GRIS::CreateIndexBuffer(
-          transferList, static_cast<uint32_t>( indices.size() ), indices.data(), meshPath );
+   return StreamingState::LOADING;
+}
 
-      mesh.indexCount = static_cast<uint32_t>( indices.size() );
+void MeshCache::_readMesh( std::shared_ptr<StreamedMesh> streamed )
+{
+   CYD_TRACE( "Read Mesh" );
 
-      return true;
+   // Cooked meshes are copied out of their file here, the upload does not wait on the disk
+   MeshFile file;
+   if( OpenCookedMesh( streamed->name, file, streamed->derivedDataKey ) )
+   {
+      file.read( streamed->cooked );
+      streamed->isValid = true;
+
+      _finishStreaming( std::move( streamed ) );
+      return;
    }
 
-   return false;
+   if( m_threadPool.isInit() )
+   {
+      m_threadPool.submit(
+          EMP::ThreadPool::Lane::BACKGROUND, [this, streamed]() { _decodeMesh( streamed ); } );
+   }
+   else
+   {
+      _decodeMesh( std::move( streamed ) );
+   }
 }
 
-bool MeshCache::loadMesh(
-    CmdListHandle transferList,
-    const std::string_view name,
-    const std::vector<Vertex>& vertices,
-    const std::vector<uint32_t>& indices )
+void MeshCache::_decodeMesh( std::shared_ptr<StreamedMesh> streamed )
 {
-   const std::string meshString( name );
-   auto it = m_meshes.find( meshString );
-   if( it == m_meshes.end() )
+   CYD_TRACE( "Decode Mesh" );
+
+   std::vector<Vertex> vertices;
+   std::vector<uint32_t> indices;
+   streamed->isValid = ObjImporter::Import(
+       MESH_PATH + streamed->name + ".obj", vertices, indices, m_threadPool );
+
+   if( streamed->isValid )
    {
-      Mesh& mesh = m_meshes[meshString];
+      CookMesh( vertices, indices, VertexFormat::COMPACT, streamed->cooked );
+      StoreCookedMesh( streamed->derivedDataKey, streamed->cooked );
+   }
 
-      mesh.vertexBuffer = GRIS::CreateVertexBuffer(
-          transferList,
-          static_cast<uint32_t>( vertices.size() ),
-          static_cast<uint32_t>( sizeof( Vertex ) ),
-          vertices.data(),
-          name );
+   _finishStreaming( std::move( streamed ) );
+}
+
+void MeshCache::_finishStreaming( std::shared_ptr<StreamedMesh> streamed )
+{
+   std::unique_lock<std::mutex> lock( m_streamingMutex );
+
+   if( streamed->isValid )
+   {
+      m_readyMeshes.push_back( std::move( streamed ) );
+   }
+   else
+   {
+      printf( "Could not load mesh --> %s\n", streamed->name.c_str() );
+
+      m_streamingMeshes.erase( streamed->name );
+      m_failedMeshes.insert( streamed->name );
+   }
+
+   // Nothing of the cache is touched past this point
+   m_streamingTaskCount--;
+   m_streamingDone.notify_all();
+}
+
+void MeshCache::uploadStreamedMeshes( CmdListHandle transferList )
+{
+   CYD_TRACE( "Upload Streamed Meshes" );
+
+   std::vector<std::shared_ptr<StreamedMesh>> uploads;
+   {
+      std::unique_lock<std::mutex> lock( m_streamingMutex );
 
-      mesh.vertexCount = static_cast<uint32_t>( vertices.size() );
+      size_t uploadSize = 0;
+      while( !m_readyMeshes.empty() &&
+             ( uploads.empty() || uploadSize < STREAMING_BYTES_PER_FRAME ) )
+      {
+         const CookedMesh& cooked = m_readyMeshes.front()->cooked;
+         uploadSize += cooked.vertexData.size() + cooked.indexData.size();
 
-      mesh.indexBuffer = GRIS::CreateIndexBuffer(
-          transferList, static_cast<uint32_t>( indices.size() ), indices.data(), name );
+         uploads.push_back( std::move( m_readyMeshes.front() ) );
+         m_readyMeshes.pop_front();
+      }
+   }
+
+   if( uploads.empty() ) return;
+
+   for( const std::shared_ptr<StreamedMesh>& streamed : uploads )
+   {
+      m_meshes.tryEmplace(
+          streamed->name,
+          [&]( Mesh& mesh )
+          { UploadMesh( transferList, mesh, streamed->cooked, streamed->name ); } );
+   }
+
+   const Clock::time_point uploadTime = Clock::now();
 
-      mesh.indexCount = static_cast<uint32_t>( indices.size() );
+   std::unique_lock<std::mutex> lock( m_streamingMutex );
+   for( const std::shared_ptr<StreamedMesh>& streamed : uploads )
+   {
+      m_streamingMeshes.erase( streamed->name );
 
-      return true;
+      const Clock::duration latency = uploadTime - streamed->requestTime;
+      m_totalLatency += latency;
+      m_streamingStats.uploadCount++;
+      m_streamingStats.maxLatencyMs = std::max(
+          m_streamingStats.maxLatencyMs,
+          std::chrono::duration<double, std::milli>( latency ).count() );
    }
+}
 
-   return false;
+MeshCache::StreamingStats MeshCache::getStreamingStats() const
+{
+   std::unique_lock<std::mutex> lock( m_streamingMutex );
+
+   StreamingStats stats = m_streamingStats;
+   stats.readyCount     = static_cast<uint32_t>( m_readyMeshes.size() );
+   stats.loadingCount   = static_cast<uint32_t>( m_streamingMeshes.size() ) - stats.readyCount;
+
+   if( stats.uploadCount )
+   {
+      stats.averageLatencyMs =
+          std::chrono::duration<double, std::milli>( m_totalLatency ).count() / stats.uploadCount;
+   }
+
+   return stats;
+}
 }
-}
\ No newline at end of file
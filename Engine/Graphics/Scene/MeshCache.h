@@ -5,39 +5,116 @@
 #include <Graphics/Handles/ResourceHandle.h>
 #include <Graphics/Scene/Mesh.h>
 
+#include <Multithreading/ConcurrentHashMap.h>
+
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string_view>
-#include <unordered_map>
+#include <unordered_set>
+
+namespace EMP
+{
+class ThreadPool;
+}
 
 namespace CYD
 {
 class Vertex;
 
-// For read-only assets loaded from disk
+// For read-only assets loaded from disk. Lookups can be done from any thread, a mesh is only ever
+// loaded once even if multiple threads ask for it at the same time. OBJ meshes are cooked once,
+// the cooked meshes are kept in the derived data cache and mapped from there afterwards.
+//
+// Meshes can also be streamed: the request is queued, the mesh file is read on the IO lane of the
+// thread pool and the OBJ meshes without one are decoded on the background lane. The main thread
+// then uploads the meshes that are ready on its transfer list, a few at a time.
 class MeshCache final
 {
   public:
-   MeshCache();
+   // OBJ meshes are parsed on the workers of the thread pool
+   explicit MeshCache( EMP::ThreadPool& threadPool );
    NON_COPIABLE( MeshCache );
-   virtual ~MeshCache() = default;
+   virtual ~MeshCache();
 
    // TODO
    // void cleanup();
 
    const Mesh& getMesh( const std::string_view name );
 
+   // Loaded meshes are packed in the compact vertex format, generated ones in the format given. It
+   // has to be the one of the pipelines drawing the mesh
    bool loadMeshFromPath( CmdListHandle transferList, const std::string_view meshPath );
    bool loadMesh(
        CmdListHandle transferList,
        const std::string_view name,
        const std::vector<Vertex>& vertices,
-       const std::vector<uint32_t>& indices );
+       const std::vector<uint32_t>& indices,
+       std::shared_ptr<const OccluderGeometry> occluder = nullptr,
+       VertexFormatFlag format                          = VertexFormat::COMPACT );
+
+   // Streaming
+   // =============================================================================================
+   enum class StreamingState
+   {
+      LOADING,
+      LOADED,
+      FAILED  // The mesh could not be read, it is not requested again
+   };
+
+   // Queues the loading of a mesh from disk if it is not in the cache yet. Requests for a mesh
+   // already on its way are merged with the first one
+   StreamingState requestMesh( const std::string_view name );
+
+   // Uploads the meshes that are ready since the last call on the transfer list, up to the byte
+   // budget of a frame. At least one mesh is uploaded, however large it is
+   void uploadStreamedMeshes( CmdListHandle transferList );
+
+   struct StreamingStats
+   {
+      uint32_t loadingCount = 0;  // Requested, being read or decoded
+      uint32_t readyCount   = 0;  // Waiting for their upload
+      uint64_t requestCount = 0;  // Since the start, merged requests not included
+      uint64_t mergedCount  = 0;  // Requests for meshes that were already on their way
+      uint64_t uploadCount  = 0;
+      double averageLatencyMs = 0.0;  // From the request to the upload
+      double maxLatencyMs     = 0.0;
+   };
+
+   StreamingStats getStreamingStats() const;
 
   private:
+   using Clock = std::chrono::steady_clock;
+
+   struct StreamedMesh;
+
    void _initDefaultMeshes();
 
+   void _readMesh( std::shared_ptr<StreamedMesh> streamed );
+   void _decodeMesh( std::shared_ptr<StreamedMesh> streamed );
+   void _finishStreaming( std::shared_ptr<StreamedMesh> streamed );
+
    static constexpr uint32_t INITIAL_AMOUNT_RESOURCES = 128;
 
-   std::unordered_map<std::string, Mesh> m_meshes;
+   // Vertices and indices uploaded per frame, the staging memory of a frame is bounded by it
+   static constexpr size_t STREAMING_BYTES_PER_FRAME = 16 * 1024 * 1024;
+
+   EMP::ThreadPool& m_threadPool;
+
+   const Mesh m_emptyMesh;  // Returned when a mesh is not found
+   EMP::ConcurrentHashMap<std::string, Mesh> m_meshes;
+
+   // Streaming, everything below is behind the mutex
+   mutable std::mutex m_streamingMutex;
+   std::condition_variable m_streamingDone;
+   uint32_t m_streamingTaskCount = 0;  // Waited for on destruction, the tasks point to the cache
+   std::unordered_set<std::string> m_streamingMeshes;  // Requested and not uploaded yet
+   std::unordered_set<std::string> m_failedMeshes;
+   std::deque<std::shared_ptr<StreamedMesh>> m_readyMeshes;
+   StreamingStats m_streamingStats;
+   Clock::duration m_totalLatency = {};
 };
 }
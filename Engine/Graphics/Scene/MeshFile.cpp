@@ -0,0 +1,276 @@
+#include <Graphics/Scene/MeshFile.h>
+
+#include <Common/Assert.h>
+
+#include <Graphics/Utility/GraphicsIO.h>
+#include <Graphics/Utility/MeshOptimization.h>
+#include <Graphics/Utility/MeshSimplification.h>
+
+#include <IO/DerivedDataCache.h>
+
+#include <Profiling.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <utility>
+
+namespace CYD
+{
+static_assert( sizeof( MeshFileHeader ) == 136, "MeshFile: A new header needs a new version" );
+static_assert( sizeof( MeshLod ) == 12, "MeshFile: New LODs need a new version" );
+static_assert( sizeof( Meshlet ) == 44, "MeshFile: New meshlets need a new version" );
+static_assert( std::is_trivially_copyable_v<MeshFileHeader> );
+static_assert( std::is_trivially_copyable_v<MeshLod> );
+static_assert( std::is_trivially_copyable_v<Meshlet> );
+
+static constexpr uint64_t STREAM_ALIGNMENT = 16;
+
+// Bumped when the cooking changes, the meshes cooked before are cooked again
+static constexpr uint32_t MESH_COOK_VERSION = 1;
+
+static uint64_t AlignStream( uint64_t offset )
+{
+   return ( offset + STREAM_ALIGNMENT - 1 ) & ~( STREAM_ALIGNMENT - 1 );
+}
+
+// ================================================================================================
+uint64_t GetMeshSourceKey( const void* objData, size_t objSize, VertexFormatFlag format )
+{
+   const uint32_t parameters[] = { MESH_COOK_VERSION, MeshFileHeader::VERSION, format };
+
+   const uint64_t key = EMP::DerivedDataCache::Hash( parameters, sizeof( parameters ) );
+   return EMP::DerivedDataCache::Hash( objData, objSize, key );
+}
+
+// ================================================================================================
+void CookMesh(
+    std::vector<Vertex>& vertices,
+    std::vector<uint32_t>& indices,
+    VertexFormatFlag format,
+    CookedMesh& cooked )
+{
+   CYD_TRACE( "Cook Mesh" );
+
+   const uint32_t vertexCount = static_cast<uint32_t>( vertices.size() );
+   cooked.sourceCache         = MeshOptimization::AnalyzeVertexCache( indices, vertexCount );
+
+   // Sorted for the vertex cache and the overdraw first, the meshlets follow that order
+   MeshOptimization::OptimizeVertexCache( indices, vertexCount );
+   MeshOptimization::OptimizeOverdraw( vertices, indices );
+
+   // The full detail mesh is reordered in meshlets, the coarser LODs follow it in the same index
+   // buffer
+   std::vector<uint32_t> meshletIndices;
+   BuildMeshlets( vertices, indices, 0, meshletIndices, cooked.meshlets );
+
+   if( cooked.meshlets.size() <= 1 )
+   {
+      cooked.meshlets.clear();
+   }
+
+   std::vector<uint32_t> lodIndices;
+   cooked.header.lodCount =
+       MeshSimplification::GenerateLods( vertices, meshletIndices, lodIndices, cooked.lods );
+
+   // The simplification keeps the order of the triangles it started from, with holes
+   std::vector<uint32_t> lodRange;
+   for( uint32_t lod = 1; lod < cooked.header.lodCount; ++lod )
+   {
+      const auto first = lodIndices.begin() + cooked.lods[lod].firstIndex;
+      lodRange.assign( first, first + cooked.lods[lod].indexCount );
+
+      MeshOptimization::OptimizeVertexCache( lodRange, vertexCount );
+      std::copy( lodRange.begin(), lodRange.end(), first );
+   }
+
+   // Vertices in the order they are first drawn, unused ones are dropped
+   MeshOptimization::OptimizeVertexFetch( vertices, lodIndices );
+
+   const size_t fullIndexCount =
+       cooked.header.lodCount ? cooked.lods[0].indexCount : lodIndices.size();
+   cooked.cookedCache = MeshOptimization::AnalyzeVertexCache(
+       std::vector<uint32_t>( lodIndices.begin(), lodIndices.begin() + fullIndexCount ),
+       static_cast<uint32_t>( vertices.size() ) );
+
+   PackMesh( vertices, lodIndices, format, cooked );
+}
+
+// ================================================================================================
+void PackMesh(
+    const std::vector<Vertex>& vertices,
+    const std::vector<uint32_t>& indices,
+    VertexFormatFlag format,
+    CookedMesh& cooked )
+{
+   MeshFileHeader& header = cooked.header;
+
+   header.vertexCount  = static_cast<uint32_t>( vertices.size() );
+   header.indexCount   = static_cast<uint32_t>( indices.size() );
+   header.meshletCount = static_cast<uint32_t>( cooked.meshlets.size() );
+
+   header.bounds = ComputeAABB( vertices.data(), header.vertexCount, sizeof( Vertex ) );
+   header.boundingSphere = ComputeBoundingSphere(
+       vertices.data(), header.vertexCount, sizeof( Vertex ), header.bounds );
+
+   // Meshes that were not simplified are drawn whole
+   if( header.lodCount == 0 )
+   {
+      cooked.lods[0]  = { 0, header.indexCount, 0.0f };
+      header.lodCount = 1;
+   }
+
+   // The positions are only remapped when quantized, the dequantization is the identity otherwise
+   const VertexLayout layout( format );
+
+   header.vertexFormat         = format;
+   header.vertexStride         = layout.getStride();
+   header.positionQuantization = PositionQuantization();
+   if( format & VertexFormat::QUANTIZED_POSITION )
+   {
+      header.positionQuantization =
+          PositionQuantization::FromBounds( header.bounds.min, header.bounds.max );
+   }
+
+   layout.pack( vertices, header.positionQuantization, cooked.vertexData );
+
+   // The CPU stages work on 32-bit indices, they are narrowed once the vertex count is final
+   header.indexType = GetNarrowestIndexType( header.vertexCount );
+   cooked.indexData.resize( indices.size() * GetIndexSizeInBytes( header.indexType ) );
+
+   if( header.indexType == IndexType::UNSIGNED_INT16 )
+   {
+      uint16_t* narrowIndices = reinterpret_cast<uint16_t*>( cooked.indexData.data() );
+      std::copy( indices.begin(), indices.end(), narrowIndices );
+   }
+   else
+   {
+      std::memcpy( cooked.indexData.data(), indices.data(), cooked.indexData.size() );
+   }
+}
+
+// ================================================================================================
+void SerializeMeshFile( const CookedMesh& cooked, std::vector<uint8_t>& file )
+{
+   MeshFileHeader header = cooked.header;
+
+   header.vertexOffset  = AlignStream( sizeof( MeshFileHeader ) );
+   header.indexOffset   = AlignStream( header.vertexOffset + cooked.vertexData.size() );
+   header.lodOffset     = AlignStream( header.indexOffset + cooked.indexData.size() );
+   header.meshletOffset = AlignStream( header.lodOffset + header.lodCount * sizeof( MeshLod ) );
+
+   const uint64_t fileSize = header.meshletOffset + header.meshletCount * sizeof( Meshlet );
+
+   file.assign( fileSize, 0 );
+   std::memcpy( file.data(), &header, sizeof( MeshFileHeader ) );
+   std::memcpy( &file[header.vertexOffset], cooked.vertexData.data(), cooked.vertexData.size() );
+   std::memcpy( &file[header.indexOffset], cooked.indexData.data(), cooked.indexData.size() );
+   std::memcpy(
+       &file[header.lodOffset], cooked.lods.data(), header.lodCount * sizeof( MeshLod ) );
+   std::memcpy(
+       &file[header.meshletOffset],
+       cooked.meshlets.data(),
+       header.meshletCount * sizeof( Meshlet ) );
+}
+
+bool WriteMeshFile( const std::string& path, const CookedMesh& cooked )
+{
+   std::vector<uint8_t> file;
+   SerializeMeshFile( cooked, file );
+
+   std::ofstream stream( path, std::ios::binary | std::ios::trunc );
+   if( !stream.is_open() ) return false;
+
+   stream.write( reinterpret_cast<const char*>( file.data() ), file.size() );
+
+   return stream.good();
+}
+
+// ================================================================================================
+bool MeshFile::open( const std::string& path )
+{
+   EMP::VirtualFile file;
+   if( !GraphicsIO::GetFileSystem().open( path, file ) )
+   {
+      m_file.close();
+      m_header = nullptr;
+      return false;
+   }
+
+   return open( std::move( file ), path );
+}
+
+bool MeshFile::open( EMP::VirtualFile&& file, const std::string& path )
+{
+   m_file   = std::move( file );
+   m_header = nullptr;
+
+   if( m_file.getSize() < sizeof( MeshFileHeader ) )
+   {
+      printf( "MeshFile: %s is truncated\n", path.c_str() );
+      m_file.close();
+      return false;
+   }
+
+   const MeshFileHeader* header = reinterpret_cast<const MeshFileHeader*>( m_file.getData() );
+   if( header->magic != MeshFileHeader::MAGIC || header->version != MeshFileHeader::VERSION )
+   {
+      printf(
+          "MeshFile: %s is not a mesh file of version %u, it has to be converted again\n",
+          path.c_str(),
+          MeshFileHeader::VERSION );
+      m_file.close();
+      return false;
+   }
+
+   const uint64_t vertexSize = uint64_t( header->vertexCount ) * header->vertexStride;
+   const uint64_t indexSize =
+       uint64_t( header->indexCount ) * GetIndexSizeInBytes( header->indexType );
+
+   const bool isComplete =
+       header->lodCount >= 1 && header->lodCount <= MAX_MESH_LODS &&
+       header->vertexStride == VertexLayout( header->vertexFormat ).getStride() &&
+       header->vertexOffset + vertexSize <= m_file.getSize() &&
+       header->indexOffset + indexSize <= m_file.getSize() &&
+       header->lodOffset + header->lodCount * sizeof( MeshLod ) <= m_file.getSize() &&
+       header->meshletOffset + header->meshletCount * sizeof( Meshlet ) <= m_file.getSize();
+
+   if( !isComplete )
+   {
+      printf( "MeshFile: %s is truncated\n", path.c_str() );
+      m_file.close();
+      return false;
+   }
+
+   m_header = header;
+
+   return true;
+}
+
+const MeshLod* MeshFile::getLods() const
+{
+   return reinterpret_cast<const MeshLod*>( m_file.getData() + m_header->lodOffset );
+}
+
+const Meshlet* MeshFile::getMeshlets() const
+{
+   return reinterpret_cast<const Meshlet*>( m_file.getData() + m_header->meshletOffset );
+}
+
+void MeshFile::read( CookedMesh& cooked ) const
+{
+   CYD_ASSERT( m_header && "MeshFile: Reading a file that is not open" );
+
+   const size_t vertexSize = size_t( m_header->vertexCount ) * m_header->vertexStride;
+   const size_t indexSize =
+       size_t( m_header->indexCount ) * GetIndexSizeInBytes( m_header->indexType );
+
+   cooked.header = *m_header;
+   cooked.vertexData.assign( getVertexData(), getVertexData() + vertexSize );
+   cooked.indexData.assign( getIndexData(), getIndexData() + indexSize );
+   std::copy( getLods(), getLods() + m_header->lodCount, cooked.lods.begin() );
+   cooked.meshlets.assign( getMeshlets(), getMeshlets() + m_header->meshletCount );
+}
+}
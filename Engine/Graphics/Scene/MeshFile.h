@@ -0,0 +1,140 @@
+#pragma once
+
+#include <Graphics/GraphicsTypes.h>
+#include <Graphics/Scene/Bounds.h>
+#include <Graphics/Scene/Mesh.h>
+#include <Graphics/Scene/Meshlets.h>
+#include <Graphics/Utility/MeshOptimization.h>
+#include <Graphics/VertexLayout.h>
+
+#include <IO/VirtualFileSystem.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ================================================================================================
+// Forwards
+// ================================================================================================
+namespace CYD
+{
+class Vertex;
+}
+
+// ================================================================================================
+// Definition
+// ================================================================================================
+/*
+Meshes are cooked for the GPU before they are uploaded: reordered for the vertex cache, split in
+meshlets, simplified in LODs, packed in their vertex format and with their indices narrowed. The
+cooked mesh can be written in a mesh file, loading it back is mapping the file and copying its
+streams to staging memory, there is nothing left to parse or compute.
+
+A mesh file is the header followed by its streams, each one aligned on 16 bytes:
+   - Vertices, vertexCount * vertexStride bytes in the vertex format of the header
+   - Indices, indexCount indices of the index type of the header, the LODs one after the other
+   - LODs, lodCount MeshLod
+   - Meshlets, meshletCount Meshlet, only for meshes large enough to have more than one
+
+The structs are written as they are in memory, the file is only read back by the same platform.
+Files of another version are rejected, they have to be converted again. The header keeps the key
+of the source the mesh was cooked from, a file whose source has been edited since is stale.
+*/
+namespace CYD
+{
+struct MeshFileHeader
+{
+   static constexpr uint32_t MAGIC   = 0x4D445943;  // "CYDM"
+   static constexpr uint32_t VERSION = 2;
+
+   uint32_t magic   = MAGIC;
+   uint32_t version = VERSION;
+
+   VertexFormatFlag vertexFormat = 0;
+   uint32_t vertexStride         = 0;
+   uint32_t vertexCount          = 0;
+
+   IndexType indexType   = IndexType::UNSIGNED_INT32;
+   uint8_t padding[3]    = {};
+   uint32_t indexCount   = 0;  // Of every LOD
+   uint32_t lodCount     = 0;
+   uint32_t meshletCount = 0;
+   uint32_t reserved     = 0;
+
+   AABB bounds;
+   BoundingSphere boundingSphere;
+   PositionQuantization positionQuantization;
+
+   // From the start of the file
+   uint64_t vertexOffset  = 0;
+   uint64_t indexOffset   = 0;
+   uint64_t lodOffset     = 0;
+   uint64_t meshletOffset = 0;
+
+   uint64_t sourceKey = 0;  // GetMeshSourceKey of the OBJ file, 0 for generated meshes
+};
+
+// Cooked in memory, ready to be uploaded or written in a mesh file
+struct CookedMesh
+{
+   MeshFileHeader header;
+   std::vector<uint8_t> vertexData;
+   std::vector<uint8_t> indexData;
+   std::array<MeshLod, MAX_MESH_LODS> lods = {};
+   std::vector<Meshlet> meshlets;
+
+   // Vertex cache of the full detail LOD as it came in and as it was cooked, not in the file
+   MeshOptimization::VertexCacheStats sourceCache;
+   MeshOptimization::VertexCacheStats cookedCache;
+};
+
+// Hash of the content of an OBJ file and of how it is cooked, it changes whenever the cooked
+// mesh would
+uint64_t GetMeshSourceKey( const void* objData, size_t objSize, VertexFormatFlag format );
+
+// Cooks a mesh loaded from disk, with meshlets and LODs. The vertices and indices are reordered
+void CookMesh(
+    std::vector<Vertex>& vertices,
+    std::vector<uint32_t>& indices,
+    VertexFormatFlag format,
+    CookedMesh& cooked );
+
+// Only packs the vertices and narrows the indices, the mesh is drawn as it is in a single LOD
+void PackMesh(
+    const std::vector<Vertex>& vertices,
+    const std::vector<uint32_t>& indices,
+    VertexFormatFlag format,
+    CookedMesh& cooked );
+
+// The mesh file as it is written on disk
+void SerializeMeshFile( const CookedMesh& cooked, std::vector<uint8_t>& file );
+bool WriteMeshFile( const std::string& path, const CookedMesh& cooked );
+
+// Mesh file mapped in memory or packed in an archive, its streams are read in place
+class MeshFile
+{
+  public:
+   static constexpr char EXTENSION[] = ".cydmesh";
+
+   // Fails on missing files, and on files that are truncated or of another version
+   bool open( const std::string& path );
+
+   // Takes a file already open, the path is only used in the messages
+   bool open( EMP::VirtualFile&& file, const std::string& path );
+
+   const MeshFileHeader& getHeader() const { return *m_header; }
+
+   const uint8_t* getVertexData() const { return m_file.getData() + m_header->vertexOffset; }
+   const uint8_t* getIndexData() const { return m_file.getData() + m_header->indexOffset; }
+   const MeshLod* getLods() const;
+   const Meshlet* getMeshlets() const;
+
+   // Copies the streams out of the mapping, for meshes uploaded after the file is closed
+   void read( CookedMesh& cooked ) const;
+
+  private:
+   EMP::VirtualFile m_file;
+   const MeshFileHeader* m_header = nullptr;
+};
+}
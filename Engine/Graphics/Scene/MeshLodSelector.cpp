@@ -0,0 +1,69 @@
+#include <Graphics/Scene/MeshLodSelector.h>
+
+#include <Common/Assert.h>
+
+#include <Graphics/Scene/Bounds.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace CYD
+{
+// Views inside of a bounding sphere see the mesh up close, from this far
+static constexpr float MIN_DISTANCE = 1e-3f;
+
+void MeshLodSelector::begin(
+    const glm::vec3& viewPosition,
+    const glm::mat4& projMat,
+    uint32_t screenHeight )
+{
+   m_viewPosition = viewPosition;
+
+   // The projection scales Y by the cotangent of half of the field of view, over half the screen
+   m_pixelsPerUnit = std::abs( projMat[1][1] ) * 0.5f * static_cast<float>( screenHeight );
+
+   m_stats = {};
+}
+
+float MeshLodSelector::getProjectedSize( float length, const BoundingSphere& worldSphere ) const
+{
+   const float distance = std::max(
+       glm::distance( m_viewPosition, worldSphere.center ) - worldSphere.radius, MIN_DISTANCE );
+
+   return length * m_pixelsPerUnit / distance;
+}
+
+uint32_t MeshLodSelector::select(
+    const std::array<MeshLod, MAX_MESH_LODS>& lods,
+    uint32_t lodCount,
+    uint32_t currentLod,
+    const BoundingSphere& worldSphere,
+    float worldScale )
+{
+   CYD_ASSERT( lodCount > 0 && lodCount <= MAX_MESH_LODS && "MeshLodSelector: Invalid LOD count" );
+
+   // The errors grow with every LOD, the projection only scales them
+   const float pixelsPerError = getProjectedSize( worldScale, worldSphere );
+   const float coarserLimit   = m_errorThreshold * ( 1.0f - m_hysteresis );
+
+   uint32_t lod = std::min( currentLod, lodCount - 1 );
+
+   while( lod > 0 && lods[lod].error * pixelsPerError > m_errorThreshold )
+   {
+      lod--;
+   }
+
+   while( lod + 1 < lodCount && lods[lod + 1].error * pixelsPerError <= coarserLimit )
+   {
+      lod++;
+   }
+
+   m_stats.meshCount++;
+   m_stats.lodCounts[lod]++;
+   m_stats.switchCount += lod != currentLod ? 1 : 0;
+   m_stats.fullTriangles += lods[0].indexCount / 3;
+   m_stats.drawnTriangles += lods[lod].indexCount / 3;
+
+   return lod;
+}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Common/Include.h>
+
+#include <Graphics/Scene/Mesh.h>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+
+// ================================================================================================
+// Forwards
+// ================================================================================================
+namespace CYD
+{
+struct BoundingSphere;
+}
+
+// ================================================================================================
+// Definition
+// ================================================================================================
+/*
+Picks the level of detail of meshes from the size their simplification error takes on screen. The
+error of a LOD is projected from the closest point of the bounding sphere of the mesh, the coarsest
+LOD whose error stays under the threshold is drawn.
+
+Switching back and forth on the threshold pops. A mesh only goes to a coarser LOD once its error is
+below the threshold by the hysteresis, and back to a finer one as soon as it is above.
+*/
+namespace CYD
+{
+class MeshLodSelector
+{
+  public:
+   MeshLodSelector() = default;
+   NON_COPIABLE( MeshLodSelector );
+   ~MeshLodSelector() = default;
+
+   struct Stats
+   {
+      uint32_t meshCount = 0;  // With more than one LOD
+      std::array<uint32_t, MAX_MESH_LODS> lodCounts = {};
+      uint32_t switchCount    = 0;
+      uint64_t fullTriangles  = 0;  // Had every mesh been drawn at full detail
+      uint64_t drawnTriangles = 0;
+   };
+
+   // In pixels, and as a fraction of the threshold
+   void setErrorThreshold( float pixels ) { m_errorThreshold = pixels; }
+   void setHysteresis( float hysteresis ) { m_hysteresis = hysteresis; }
+
+   // Perspective view the LODs are selected for, resets the counters
+   void begin( const glm::vec3& viewPosition, const glm::mat4& projMat, uint32_t screenHeight );
+
+   // LOD to draw a mesh with, from the one it was drawn with last. The sphere is in world space
+   uint32_t select(
+       const std::array<MeshLod, MAX_MESH_LODS>& lods,
+       uint32_t lodCount,
+       uint32_t currentLod,
+       const BoundingSphere& worldSphere,
+       float worldScale );
+
+   // Size in pixels of a world space length at the closest point of the sphere
+   float getProjectedSize( float length, const BoundingSphere& worldSphere ) const;
+
+   const Stats& getStats() const { return m_stats; }
+
+  private:
+   glm::vec3 m_viewPosition = glm::vec3( 0.0f );
+   float m_pixelsPerUnit    = 0.0f;  // At a distance of 1
+
+   float m_errorThreshold = 1.0f;
+   float m_hysteresis     = 0.25f;
+
+   Stats m_stats;
+};
+}
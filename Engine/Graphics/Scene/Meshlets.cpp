@@ -0,0 +1,314 @@
+#include <Graphics/Scene/Meshlets.h>
+
+#include <Common/Assert.h>
+
+#include <Graphics/VertexLayout.h>
+#include <Graphics/Utility/MeshOptimization.h>
+
+#include <Profiling.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace CYD
+{
+static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+// Meshlet being grown, its vertices are marked with its index while it is
+struct MeshletBuilder
+{
+   std::vector<uint32_t> vertices;
+   std::vector<uint32_t> triangles;
+   std::vector<uint32_t> localIndices;
+   std::vector<uint32_t> localVertices;  // Per vertex of the mesh, its index in the meshlet
+   glm::vec3 positionSum = glm::vec3( 0.0f );
+   uint32_t index        = 0;
+};
+
+static void FinishMeshlet(
+    const std::vector<Vertex>& vertices,
+    const std::vector<uint32_t>& indices,
+    MeshletBuilder& builder,
+    std::vector<uint32_t>& meshletIndices,
+    std::vector<Meshlet>& meshlets,
+    std::vector<glm::vec3>& scratch )
+{
+   Meshlet& meshlet      = meshlets.emplace_back();
+   meshlet.firstIndex    = static_cast<uint32_t>( meshletIndices.size() );
+   meshlet.triangleCount = static_cast<uint32_t>( builder.triangles.size() );
+   meshlet.vertexCount   = static_cast<uint32_t>( builder.vertices.size() );
+
+   scratch.clear();
+   for( const uint32_t vertex : builder.vertices )
+   {
+      scratch.push_back( vertices[vertex].pos );
+   }
+
+   const AABB box = ComputeAABB( scratch.data(), meshlet.vertexCount, sizeof( glm::vec3 ) );
+   meshlet.bounds =
+       ComputeBoundingSphere( scratch.data(), meshlet.vertexCount, sizeof( glm::vec3 ), box );
+
+   // The cone holds the normals of the triangles, not the ones of the vertices
+   scratch.clear();
+   glm::vec3 normalSum = glm::vec3( 0.0f );
+
+   // The triangles were added in the order the meshlet grew, they are sorted again for the vertex
+   // cache on the vertices of the meshlet
+   std::vector<uint32_t>& localIndices = builder.localIndices;
+   localIndices.clear();
+
+   for( const uint32_t triangle : builder.triangles )
+   {
+      const glm::vec3& p0 = vertices[indices[3 * triangle + 0]].pos;
+      const glm::vec3& p1 = vertices[indices[3 * triangle + 1]].pos;
+      const glm::vec3& p2 = vertices[indices[3 * triangle + 2]].pos;
+
+      localIndices.push_back( builder.localVertices[indices[3 * triangle + 0]] );
+      localIndices.push_back( builder.localVertices[indices[3 * triangle + 1]] );
+      localIndices.push_back( builder.localVertices[indices[3 * triangle + 2]] );
+
+      const glm::vec3 normal = glm::cross( p1 - p0, p2 - p0 );
+      const float length     = glm::length( normal );
+      if( length == 0.0f ) continue;
+
+      scratch.push_back( normal / length );
+      normalSum += scratch.back();
+   }
+
+   MeshOptimization::OptimizeVertexCache( localIndices, meshlet.vertexCount );
+
+   for( const uint32_t localIndex : localIndices )
+   {
+      meshletIndices.push_back( builder.vertices[localIndex] );
+   }
+
+   const float axisLength = glm::length( normalSum );
+   if( axisLength > 0.0f )
+   {
+      meshlet.coneAxis = normalSum / axisLength;
+
+      float minDot = 1.0f;
+      for( const glm::vec3& normal : scratch )
+      {
+         minDot = std::min( minDot, glm::dot( meshlet.coneAxis, normal ) );
+      }
+
+      // Normals spread over a half space or more face every view
+      meshlet.coneCutoff = minDot > 0.0f ? std::sqrt( 1.0f - minDot * minDot ) : 1.0f;
+   }
+
+   builder.vertices.clear();
+   builder.triangles.clear();
+   builder.positionSum = glm::vec3( 0.0f );
+   builder.index++;
+}
+
+// ================================================================================================
+void BuildMeshlets(
+    const std::vector<Vertex>& vertices,
+    const std::vector<uint32_t>& indices,
+    uint32_t firstIndex,
+    std::vector<uint32_t>& meshletIndices,
+    std::vector<Meshlet>& meshlets )
+{
+   CYD_TRACE( "Build Meshlets" );
+
+   CYD_ASSERT( indices.size() % 3 == 0 && "Meshlets: Expected a triangle list" );
+
+   const uint32_t vertexCount   = static_cast<uint32_t>( vertices.size() );
+   const uint32_t triangleCount = static_cast<uint32_t>( indices.size() / 3 );
+
+   meshletIndices.clear();
+   meshletIndices.reserve( indices.size() );
+   meshlets.clear();
+
+   // Triangles around each vertex
+   std::vector<uint32_t> adjacencyOffsets( vertexCount + 1, 0 );
+   for( const uint32_t index : indices )
+   {
+      adjacencyOffsets[index + 1]++;
+   }
+
+   for( uint32_t i = 1; i <= vertexCount; ++i )
+   {
+      adjacencyOffsets[i] += adjacencyOffsets[i - 1];
+   }
+
+   std::vector<uint32_t> adjacency( indices.size() );
+   {
+      std::vector<uint32_t> fill( adjacencyOffsets.begin(), adjacencyOffsets.end() - 1 );
+      for( uint32_t i = 0; i < indices.size(); ++i )
+      {
+         adjacency[fill[indices[i]]++] = i / 3;
+      }
+   }
+
+   std::vector<uint8_t> isEmitted( triangleCount, 0 );
+   std::vector<uint32_t> vertexMeshlets( vertexCount, INVALID_INDEX );
+   std::vector<glm::vec3> scratch;
+
+   MeshletBuilder builder;
+   builder.vertices.reserve( Meshlet::MAX_VERTICES );
+   builder.triangles.reserve( Meshlet::MAX_TRIANGLES );
+   builder.localVertices.resize( vertexCount );
+
+   auto isInMeshlet = [&]( uint32_t vertex ) { return vertexMeshlets[vertex] == builder.index; };
+
+   auto newVertexCount = [&]( uint32_t triangle )
+   {
+      return ( isInMeshlet( indices[3 * triangle + 0] ) ? 0 : 1 ) +
+             ( isInMeshlet( indices[3 * triangle + 1] ) ? 0 : 1 ) +
+             ( isInMeshlet( indices[3 * triangle + 2] ) ? 0 : 1 );
+   };
+
+   auto getCentroid = [&]( uint32_t triangle )
+   {
+      return ( vertices[indices[3 * triangle + 0]].pos + vertices[indices[3 * triangle + 1]].pos +
+               vertices[indices[3 * triangle + 2]].pos ) /
+             3.0f;
+   };
+
+   uint32_t seedCursor   = 0;
+   uint32_t emittedCount = 0;
+
+   while( emittedCount < triangleCount )
+   {
+      // The triangles touching the meshlet that add the fewest vertices, the closest to its
+      // center between them
+      uint32_t best          = INVALID_INDEX;
+      uint32_t bestNewCount  = 4;
+      float bestSqDistance   = std::numeric_limits<float>::max();
+      const glm::vec3 center = builder.vertices.empty()
+                                   ? glm::vec3( 0.0f )
+                                   : builder.positionSum / float( builder.vertices.size() );
+
+      for( const uint32_t vertex : builder.vertices )
+      {
+         for( uint32_t a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1]; ++a )
+         {
+            const uint32_t triangle = adjacency[a];
+            if( isEmitted[triangle] ) continue;
+
+            const uint32_t newCount = newVertexCount( triangle );
+            if( builder.vertices.size() + newCount > Meshlet::MAX_VERTICES ) continue;
+            if( newCount > bestNewCount ) continue;
+
+            const glm::vec3 offset = getCentroid( triangle ) - center;
+            const float sqDistance = glm::dot( offset, offset );
+
+            if( newCount < bestNewCount || sqDistance < bestSqDistance )
+            {
+               best           = triangle;
+               bestNewCount   = newCount;
+               bestSqDistance = sqDistance;
+            }
+         }
+      }
+
+      // A meshlet that cannot grow anymore is done, the next one starts from the first triangle
+      // left in the order of the mesh
+      if( best == INVALID_INDEX )
+      {
+         if( !builder.triangles.empty() )
+         {
+            FinishMeshlet( vertices, indices, builder, meshletIndices, meshlets, scratch );
+         }
+
+         while( isEmitted[seedCursor] )
+         {
+            seedCursor++;
+         }
+
+         best = seedCursor;
+      }
+
+      isEmitted[best] = 1;
+      emittedCount++;
+
+      builder.triangles.push_back( best );
+      for( uint32_t k = 0; k < 3; ++k )
+      {
+         const uint32_t vertex = indices[3 * best + k];
+         if( isInMeshlet( vertex ) ) continue;
+
+         vertexMeshlets[vertex]        = builder.index;
+         builder.localVertices[vertex] = static_cast<uint32_t>( builder.vertices.size() );
+         builder.vertices.push_back( vertex );
+         builder.positionSum += vertices[vertex].pos;
+      }
+
+      if( builder.triangles.size() == Meshlet::MAX_TRIANGLES ||
+          builder.vertices.size() == Meshlet::MAX_VERTICES )
+      {
+         FinishMeshlet( vertices, indices, builder, meshletIndices, meshlets, scratch );
+      }
+   }
+
+   if( !builder.triangles.empty() )
+   {
+      FinishMeshlet( vertices, indices, builder, meshletIndices, meshlets, scratch );
+   }
+
+   for( Meshlet& meshlet : meshlets )
+   {
+      meshlet.firstIndex += firstIndex;
+   }
+}
+
+// ================================================================================================
+void CullMeshlets(
+    const std::vector<Meshlet>& meshlets,
+    const glm::vec3& viewPosition,
+    const glm::vec4* frustumPlanes,
+    float scale,
+    std::vector<IndexRange>& ranges,
+    MeshletCullStats& stats )
+{
+   const size_t firstRange = ranges.size();
+
+   for( const Meshlet& meshlet : meshlets )
+   {
+      stats.testedCount++;
+
+      const glm::vec3& center = meshlet.bounds.center;
+      const float radius      = meshlet.bounds.radius;
+
+      bool isInFrustum = true;
+      for( uint32_t i = 0; i < 6 && isInFrustum; ++i )
+      {
+         isInFrustum = glm::dot( glm::vec3( frustumPlanes[i] ), center ) + frustumPlanes[i].w >=
+                       -radius * scale;
+      }
+
+      if( !isInFrustum )
+      {
+         stats.frustumCulledCount++;
+         continue;
+      }
+
+      // Every triangle faces away when the view is behind the cone, by more than the sphere
+      const glm::vec3 toCenter = center - viewPosition;
+      if( glm::dot( toCenter, meshlet.coneAxis ) >=
+          meshlet.coneCutoff * glm::length( toCenter ) + radius )
+      {
+         stats.backfaceCulledCount++;
+         continue;
+      }
+
+      const uint32_t indexCount = 3 * meshlet.triangleCount;
+
+      if( ranges.size() > firstRange &&
+          ranges.back().firstIndex + ranges.back().indexCount == meshlet.firstIndex )
+      {
+         ranges.back().indexCount += indexCount;
+      }
+      else
+      {
+         ranges.push_back( { meshlet.firstIndex, indexCount } );
+      }
+   }
+
+   stats.rangeCount += static_cast<uint32_t>( ranges.size() - firstRange );
+}
+}
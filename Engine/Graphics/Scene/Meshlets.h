@@ -0,0 +1,81 @@
+#pragma once
+
+#include <Graphics/Scene/Bounds.h>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// ================================================================================================
+// Forwards
+// ================================================================================================
+namespace CYD
+{
+class Vertex;
+}
+
+// ================================================================================================
+// Definition
+// ================================================================================================
+/*
+Meshlets are clusters of neighbouring triangles of a mesh, small enough to be culled on their own
+when the mesh is only partly visible. The triangles of a mesh are reordered meshlet by meshlet, a
+meshlet is a range of the index buffer.
+
+Besides its bounding sphere, a meshlet has a cone holding the normals of its triangles. The whole
+meshlet faces away from a view that is inside of the cone behind it, it is backface culled at once.
+*/
+namespace CYD
+{
+struct Meshlet
+{
+   static constexpr uint32_t MAX_VERTICES  = 64;
+   static constexpr uint32_t MAX_TRIANGLES = 124;
+
+   uint32_t firstIndex    = 0;
+   uint32_t triangleCount = 0;
+   uint32_t vertexCount   = 0;
+
+   // Local space
+   BoundingSphere bounds;
+   glm::vec3 coneAxis = glm::vec3( 0.0f );  // Average normal of the triangles
+   float coneCutoff   = 1.0f;  // Sine of the spread of the normals, 1 when they go every way
+};
+
+// Range of an index buffer drawn in one call
+struct IndexRange
+{
+   uint32_t firstIndex = 0;
+   uint32_t indexCount = 0;
+};
+
+struct MeshletCullStats
+{
+   uint32_t testedCount         = 0;
+   uint32_t frustumCulledCount  = 0;
+   uint32_t backfaceCulledCount = 0;
+   uint32_t rangeCount          = 0;
+};
+
+// Splits a triangle list in meshlets of neighbouring triangles, growing each one with the
+// triangles that add the fewest vertices. The triangles are written meshlet by meshlet in
+// meshletIndices, starting at the first index given
+void BuildMeshlets(
+    const std::vector<Vertex>& vertices,
+    const std::vector<uint32_t>& indices,
+    uint32_t firstIndex,
+    std::vector<uint32_t>& meshletIndices,
+    std::vector<Meshlet>& meshlets );
+
+// Appends the index ranges of the visible meshlets, consecutive ones are merged. The view and
+// the 6 frustum planes are in the space of the mesh, with planes that measure world distances.
+// The scale goes from local to world and has to be uniform for the cones to hold
+void CullMeshlets(
+    const std::vector<Meshlet>& meshlets,
+    const glm::vec3& viewPosition,
+    const glm::vec4* frustumPlanes,
+    float scale,
+    std::vector<IndexRange>& ranges,
+    MeshletCullStats& stats );
+}
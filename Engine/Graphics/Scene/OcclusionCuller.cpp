@@ -0,0 +1,486 @@
+#include <Graphics/Scene/OcclusionCuller.h>
+
+#include <Common/Assert.h>
+
+#include <Graphics/Scene/Bounds.h>
+#include <Graphics/Scene/Mesh.h>
+
+#include <Multithreading/ThreadPool.h>
+
+#include <Profiling.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <immintrin.h>
+
+namespace CYD
+{
+// Triangles are clipped to a guard band a bit larger than the screen so that the edge functions
+// stay precise, the part outside of the screen is never rasterized anyway
+static constexpr float GUARD_BAND = 2.0f;
+static constexpr float MIN_W      = 1e-5f;
+
+// Clipping planes in homogeneous space, a vertex is inside when the distance is positive
+static constexpr uint32_t CLIP_PLANE_COUNT = 6;
+static float ClipDistance( const glm::vec4& v, uint32_t plane )
+{
+   switch( plane )
+   {
+      case 0: return v.w - v.z;  // Near plane, reverse-Z
+      case 1: return v.w - MIN_W;
+      case 2: return GUARD_BAND * v.w + v.x;
+      case 3: return GUARD_BAND * v.w - v.x;
+      case 4: return GUARD_BAND * v.w + v.y;
+      default: return GUARD_BAND * v.w - v.y;
+   }
+}
+
+static float ElapsedMs( std::chrono::steady_clock::time_point start )
+{
+   return std::chrono::duration<float, std::milli>( std::chrono::steady_clock::now() - start )
+       .count();
+}
+
+// ================================================================================================
+OcclusionCuller::OcclusionCuller( uint32_t width, uint32_t height )
+{
+   m_tilesX = ( width + TILE_WIDTH - 1 ) / TILE_WIDTH;
+   m_tilesY = ( height + TILE_HEIGHT - 1 ) / TILE_HEIGHT;
+   m_width  = m_tilesX * TILE_WIDTH;
+   m_height = m_tilesY * TILE_HEIGHT;
+
+   m_blocksX     = m_width / BLOCK_SIZE;
+   m_blocksY     = m_height / BLOCK_SIZE;
+   m_blockStride = ( m_blocksX + 3 ) & ~3u;
+
+   m_tileBins.resize( m_tilesX * m_tilesY );
+   m_depths.resize( m_width * m_height, 0.0f );
+
+   // The padding never hides anything, tests can read 4 blocks past the last one of a row
+   m_blockDepths.resize( m_blockStride * m_blocksY + 3, std::numeric_limits<float>::max() );
+}
+
+OcclusionCuller::~OcclusionCuller() = default;
+
+void OcclusionCuller::begin( const glm::mat4& viewProjMat, uint32_t viewIndex )
+{
+   m_viewProjMat = viewProjMat;
+   m_viewIndex   = viewIndex;
+
+   m_triangles.clear();
+   for( std::vector<uint32_t>& bin : m_tileBins )
+   {
+      bin.clear();
+   }
+
+   m_stats = {};
+}
+
+// ================================================================================================
+// Setup
+// ================================================================================================
+void OcclusionCuller::addOccluder( const OccluderGeometry& geometry, const glm::mat4& modelMatrix )
+{
+   const auto start = std::chrono::steady_clock::now();
+
+   const glm::mat4 mvp = m_viewProjMat * modelMatrix;
+
+   m_clipPositions.resize( geometry.positions.size() );
+   for( uint32_t i = 0; i < geometry.positions.size(); ++i )
+   {
+      m_clipPositions[i] = mvp * glm::vec4( geometry.positions[i], 1.0f );
+   }
+
+   CYD_ASSERT( geometry.indices.size() % 3 == 0 );
+   for( uint32_t i = 0; i + 2 < geometry.indices.size(); i += 3 )
+   {
+      _addTriangle(
+          m_clipPositions[geometry.indices[i]],
+          m_clipPositions[geometry.indices[i + 1]],
+          m_clipPositions[geometry.indices[i + 2]] );
+   }
+
+   m_stats.occluderCount++;
+   m_stats.setupMs += ElapsedMs( start );
+}
+
+void OcclusionCuller::_addTriangle(
+    const glm::vec4& clip0,
+    const glm::vec4& clip1,
+    const glm::vec4& clip2 )
+{
+   // Every plane adds at most one vertex to the polygon
+   static constexpr uint32_t MAX_VERTICES = 3 + CLIP_PLANE_COUNT;
+
+   // Most triangles are either entirely inside or entirely outside of one of the planes
+   bool isInside = true;
+   for( uint32_t plane = 0; plane < CLIP_PLANE_COUNT; ++plane )
+   {
+      const float dist0 = ClipDistance( clip0, plane );
+      const float dist1 = ClipDistance( clip1, plane );
+      const float dist2 = ClipDistance( clip2, plane );
+
+      if( dist0 < 0.0f && dist1 < 0.0f && dist2 < 0.0f ) return;
+      isInside &= dist0 >= 0.0f && dist1 >= 0.0f && dist2 >= 0.0f;
+   }
+
+   if( isInside )
+   {
+      _setupTriangle( clip0, clip1, clip2 );
+      return;
+   }
+
+   glm::vec4 polygon[MAX_VERTICES] = { clip0, clip1, clip2 };
+   glm::vec4 clipped[MAX_VERTICES];
+   uint32_t vertexCount = 3;
+
+   for( uint32_t plane = 0; plane < CLIP_PLANE_COUNT && vertexCount >= 3; ++plane )
+   {
+      uint32_t clippedCount = 0;
+      for( uint32_t i = 0; i < vertexCount; ++i )
+      {
+         const glm::vec4& current = polygon[i];
+         const glm::vec4& next    = polygon[( i + 1 ) % vertexCount];
+
+         const float currentDist = ClipDistance( current, plane );
+         const float nextDist    = ClipDistance( next, plane );
+
+         if( currentDist >= 0.0f )
+         {
+            clipped[clippedCount++] = current;
+         }
+
+         if( ( currentDist >= 0.0f ) != ( nextDist >= 0.0f ) )
+         {
+            const float t           = currentDist / ( currentDist - nextDist );
+            clipped[clippedCount++] = glm::mix( current, next, t );
+         }
+      }
+
+      std::copy( clipped, clipped + clippedCount, polygon );
+      vertexCount = clippedCount;
+   }
+
+   for( uint32_t i = 1; i + 1 < vertexCount; ++i )
+   {
+      _setupTriangle( polygon[0], polygon[i], polygon[i + 1] );
+   }
+}
+
+void OcclusionCuller::_setupTriangle(
+    const glm::vec4& clip0,
+    const glm::vec4& clip1,
+    const glm::vec4& clip2 )
+{
+   const glm::vec2 screenScale = glm::vec2( m_width, m_height ) * 0.5f;
+
+   glm::vec3 v[3];
+   for( uint32_t i = 0; i < 3; ++i )
+   {
+      const glm::vec4& clip = i == 0 ? clip0 : ( i == 1 ? clip1 : clip2 );
+      const float invW      = 1.0f / clip.w;
+
+      v[i].x = ( clip.x * invW + 1.0f ) * screenScale.x;
+      v[i].y = ( clip.y * invW + 1.0f ) * screenScale.y;
+      v[i].z = clip.z * invW;
+   }
+
+   // Entirely past the far plane, would not write anything
+   if( v[0].z < 0.0f && v[1].z < 0.0f && v[2].z < 0.0f ) return;
+
+   const float area = ( v[1].x - v[0].x ) * ( v[2].y - v[0].y ) -
+                      ( v[2].x - v[0].x ) * ( v[1].y - v[0].y );
+   if( std::abs( area ) < 1e-6f ) return;
+
+   Triangle tri;
+
+   // Both windings are rasterized, the edges are flipped so that the inside is always positive
+   const float sign = area > 0.0f ? 1.0f : -1.0f;
+   for( uint32_t i = 0; i < 3; ++i )
+   {
+      const glm::vec3& a = v[( i + 1 ) % 3];
+      const glm::vec3& b = v[( i + 2 ) % 3];
+
+      tri.edges[i] = sign * glm::vec3( a.y - b.y, b.x - a.x, a.x * b.y - a.y * b.x );
+   }
+
+   const float dz1 = v[1].z - v[0].z;
+   const float dz2 = v[2].z - v[0].z;
+   tri.depth.x     = ( dz1 * ( v[2].y - v[0].y ) - dz2 * ( v[1].y - v[0].y ) ) / area;
+   tri.depth.y     = ( dz2 * ( v[1].x - v[0].x ) - dz1 * ( v[2].x - v[0].x ) ) / area;
+   tri.depth.z     = v[0].z - tri.depth.x * v[0].x - tri.depth.y * v[0].y;
+
+   // Pixels whose center is covered
+   const glm::vec3 minPos = glm::min( v[0], glm::min( v[1], v[2] ) );
+   const glm::vec3 maxPos = glm::max( v[0], glm::max( v[1], v[2] ) );
+
+   tri.minX = std::max( static_cast<int32_t>( std::floor( minPos.x ) ), 0 );
+   tri.minY = std::max( static_cast<int32_t>( std::floor( minPos.y ) ), 0 );
+   tri.maxX = std::min( static_cast<int32_t>( std::floor( maxPos.x ) ), int32_t( m_width ) - 1 );
+   tri.maxY = std::min( static_cast<int32_t>( std::floor( maxPos.y ) ), int32_t( m_height ) - 1 );
+
+   if( tri.minX > tri.maxX || tri.minY > tri.maxY ) return;
+
+   const uint32_t triIdx = static_cast<uint32_t>( m_triangles.size() );
+   m_triangles.push_back( tri );
+
+   // Binning in the tiles it overlaps
+   const uint32_t minTileX = tri.minX / TILE_WIDTH;
+   const uint32_t minTileY = tri.minY / TILE_HEIGHT;
+   const uint32_t maxTileX = tri.maxX / TILE_WIDTH;
+   const uint32_t maxTileY = tri.maxY / TILE_HEIGHT;
+   for( uint32_t tileY = minTileY; tileY <= maxTileY; ++tileY )
+   {
+      for( uint32_t tileX = minTileX; tileX <= maxTileX; ++tileX )
+      {
+         m_tileBins[tileY * m_tilesX + tileX].push_back( triIdx );
+      }
+   }
+}
+
+// ================================================================================================
+// Rasterization
+// ================================================================================================
+void OcclusionCuller::rasterize( EMP::ThreadPool& threadPool )
+{
+   CYD_TRACE( "OcclusionRasterize" );
+
+   const auto start = std::chrono::steady_clock::now();
+
+   const uint32_t tileCount = m_tilesX * m_tilesY;
+
+   // Tiles do not share any pixel or block, they can all be done at once
+   threadPool.parallelFor(
+       EMP::ThreadPool::Lane::FRAME_CRITICAL,
+       tileCount,
+       [this]( uint32_t tileIdx ) { _rasterizeTile( tileIdx ); } );
+
+   m_stats.triangleCount = static_cast<uint32_t>( m_triangles.size() );
+   m_stats.rasterizeMs   = ElapsedMs( start );
+}
+
+void OcclusionCuller::_rasterizeTile( uint32_t tileIdx )
+{
+   const int32_t tileX0 = ( tileIdx % m_tilesX ) * TILE_WIDTH;
+   const int32_t tileY0 = ( tileIdx / m_tilesX ) * TILE_HEIGHT;
+   const int32_t tileX1 = tileX0 + TILE_WIDTH - 1;
+   const int32_t tileY1 = tileY0 + TILE_HEIGHT - 1;
+
+   for( int32_t y = tileY0; y <= tileY1; ++y )
+   {
+      std::fill_n( &m_depths[y * m_width + tileX0], TILE_WIDTH, 0.0f );
+   }
+
+   const __m128 zero         = _mm_setzero_ps();
+   const __m128 pixelCenters = _mm_setr_ps( 0.5f, 1.5f, 2.5f, 3.5f );
+
+   for( const uint32_t triIdx : m_tileBins[tileIdx] )
+   {
+      const Triangle& tri = m_triangles[triIdx];
+
+      // Starting on a multiple of 4 which stays in the tile, pixels that are outside of the
+      // triangle fail the edge tests
+      const int32_t minX = std::max( tri.minX, tileX0 ) & ~3;
+      const int32_t maxX = std::min( tri.maxX, tileX1 );
+      const int32_t minY = std::max( tri.minY, tileY0 );
+      const int32_t maxY = std::min( tri.maxY, tileY1 );
+
+      const __m128 edge0X = _mm_set1_ps( tri.edges[0].x );
+      const __m128 edge1X = _mm_set1_ps( tri.edges[1].x );
+      const __m128 edge2X = _mm_set1_ps( tri.edges[2].x );
+      const __m128 depthX = _mm_set1_ps( tri.depth.x );
+
+      for( int32_t y = minY; y <= maxY; ++y )
+      {
+         const float centerY = y + 0.5f;
+
+         const __m128 row0     = _mm_set1_ps( tri.edges[0].y * centerY + tri.edges[0].z );
+         const __m128 row1     = _mm_set1_ps( tri.edges[1].y * centerY + tri.edges[1].z );
+         const __m128 row2     = _mm_set1_ps( tri.edges[2].y * centerY + tri.edges[2].z );
+         const __m128 rowDepth = _mm_set1_ps( tri.depth.y * centerY + tri.depth.z );
+
+         float* pRow = &m_depths[y * m_width];
+         for( int32_t x = minX; x <= maxX; x += 4 )
+         {
+            const __m128 startX  = _mm_set1_ps( static_cast<float>( x ) );
+            const __m128 centerX = _mm_add_ps( startX, pixelCenters );
+
+            const __m128 edge0 = _mm_add_ps( _mm_mul_ps( centerX, edge0X ), row0 );
+            const __m128 edge1 = _mm_add_ps( _mm_mul_ps( centerX, edge1X ), row1 );
+            const __m128 edge2 = _mm_add_ps( _mm_mul_ps( centerX, edge2X ), row2 );
+
+            __m128 inside = _mm_cmpge_ps( edge0, zero );
+            inside        = _mm_and_ps( inside, _mm_cmpge_ps( edge1, zero ) );
+            inside        = _mm_and_ps( inside, _mm_cmpge_ps( edge2, zero ) );
+
+            // Outside pixels get a depth of 0, the far plane, which never wins against the buffer
+            const __m128 depth = _mm_add_ps( _mm_mul_ps( centerX, depthX ), rowDepth );
+            const __m128 prev  = _mm_loadu_ps( pRow + x );
+            _mm_storeu_ps( pRow + x, _mm_max_ps( prev, _mm_and_ps( inside, depth ) ) );
+         }
+      }
+   }
+
+   // Farthest depth of every block of the tile
+   const uint32_t firstBlockX = tileX0 / BLOCK_SIZE;
+   const uint32_t firstBlockY = tileY0 / BLOCK_SIZE;
+   for( uint32_t blockY = firstBlockY; blockY < firstBlockY + TILE_HEIGHT / BLOCK_SIZE; ++blockY )
+   {
+      for( uint32_t blockX = firstBlockX; blockX < firstBlockX + TILE_WIDTH / BLOCK_SIZE; ++blockX )
+      {
+         const float* pBlock = &m_depths[blockY * BLOCK_SIZE * m_width + blockX * BLOCK_SIZE];
+
+         __m128 farthest = _mm_set1_ps( std::numeric_limits<float>::max() );
+         for( uint32_t row = 0; row < BLOCK_SIZE; ++row )
+         {
+            farthest = _mm_min_ps( farthest, _mm_loadu_ps( pBlock + row * m_width ) );
+            farthest = _mm_min_ps( farthest, _mm_loadu_ps( pBlock + row * m_width + 4 ) );
+         }
+
+         farthest = _mm_min_ps( farthest, _mm_movehl_ps( farthest, farthest ) );
+         farthest = _mm_min_ss( farthest, _mm_shuffle_ps( farthest, farthest, 1 ) );
+
+         m_blockDepths[blockY * m_blockStride + blockX] = _mm_cvtss_f32( farthest );
+      }
+   }
+}
+
+// ================================================================================================
+// Tests
+// ================================================================================================
+bool OcclusionCuller::isVisible( const AABB& worldBounds ) const
+{
+   if( !worldBounds.isValid() ) return true;
+
+   // The corners are the projected min corner plus the projected edges of the box
+   const __m128 col0 = _mm_loadu_ps( &m_viewProjMat[0][0] );
+   const __m128 col1 = _mm_loadu_ps( &m_viewProjMat[1][0] );
+   const __m128 col2 = _mm_loadu_ps( &m_viewProjMat[2][0] );
+   const __m128 col3 = _mm_loadu_ps( &m_viewProjMat[3][0] );
+
+   const glm::vec3& min = worldBounds.min;
+   const glm::vec3 size = worldBounds.max - worldBounds.min;
+
+   __m128 base = _mm_add_ps( _mm_mul_ps( col0, _mm_set1_ps( min.x ) ), col3 );
+   base        = _mm_add_ps( base, _mm_mul_ps( col1, _mm_set1_ps( min.y ) ) );
+   base        = _mm_add_ps( base, _mm_mul_ps( col2, _mm_set1_ps( min.z ) ) );
+
+   const __m128 edgeX = _mm_mul_ps( col0, _mm_set1_ps( size.x ) );
+   const __m128 edgeY = _mm_mul_ps( col1, _mm_set1_ps( size.y ) );
+   const __m128 edgeZ = _mm_mul_ps( col2, _mm_set1_ps( size.z ) );
+
+   __m128 corner0 = base;
+   __m128 corner1 = _mm_add_ps( base, edgeX );
+   __m128 corner2 = _mm_add_ps( base, edgeY );
+   __m128 corner3 = _mm_add_ps( corner1, edgeY );
+   __m128 corner4 = _mm_add_ps( corner0, edgeZ );
+   __m128 corner5 = _mm_add_ps( corner1, edgeZ );
+   __m128 corner6 = _mm_add_ps( corner2, edgeZ );
+   __m128 corner7 = _mm_add_ps( corner3, edgeZ );
+
+   // From one corner per register to one component per register, 4 corners at a time
+   _MM_TRANSPOSE4_PS( corner0, corner1, corner2, corner3 );
+   _MM_TRANSPOSE4_PS( corner4, corner5, corner6, corner7 );
+
+   const __m128 x0 = corner0, y0 = corner1, z0 = corner2, w0 = corner3;
+   const __m128 x1 = corner4, y1 = corner5, z1 = corner6, w1 = corner7;
+
+   // Crossing the near plane, it covers the whole view
+   const __m128 minW    = _mm_set1_ps( MIN_W );
+   const __m128 crosses = _mm_or_ps(
+       _mm_or_ps( _mm_cmplt_ps( w0, minW ), _mm_cmpgt_ps( z0, w0 ) ),
+       _mm_or_ps( _mm_cmplt_ps( w1, minW ), _mm_cmpgt_ps( z1, w1 ) ) );
+   if( _mm_movemask_ps( crosses ) ) return true;
+
+   const __m128 invW0 = _mm_div_ps( _mm_set1_ps( 1.0f ), w0 );
+   const __m128 invW1 = _mm_div_ps( _mm_set1_ps( 1.0f ), w1 );
+
+   const __m128 ndcX0 = _mm_mul_ps( x0, invW0 );
+   const __m128 ndcX1 = _mm_mul_ps( x1, invW1 );
+   const __m128 ndcY0 = _mm_mul_ps( y0, invW0 );
+   const __m128 ndcY1 = _mm_mul_ps( y1, invW1 );
+
+   // Bounds of the projected corners, reduced to the first lane
+   auto reduceMin = []( __m128 value )
+   {
+      value = _mm_min_ps( value, _mm_movehl_ps( value, value ) );
+      return _mm_cvtss_f32( _mm_min_ss( value, _mm_shuffle_ps( value, value, 1 ) ) );
+   };
+   auto reduceMax = []( __m128 value )
+   {
+      value = _mm_max_ps( value, _mm_movehl_ps( value, value ) );
+      return _mm_cvtss_f32( _mm_max_ss( value, _mm_shuffle_ps( value, value, 1 ) ) );
+   };
+
+   const glm::vec2 screenScale = glm::vec2( m_width, m_height ) * 0.5f;
+
+   const glm::vec2 minPos =
+       ( glm::vec2(
+             reduceMin( _mm_min_ps( ndcX0, ndcX1 ) ), reduceMin( _mm_min_ps( ndcY0, ndcY1 ) ) ) +
+         1.0f ) *
+       screenScale;
+   const glm::vec2 maxPos =
+       ( glm::vec2(
+             reduceMax( _mm_max_ps( ndcX0, ndcX1 ) ), reduceMax( _mm_max_ps( ndcY0, ndcY1 ) ) ) +
+         1.0f ) *
+       screenScale;
+   const float closest =
+       reduceMax( _mm_max_ps( _mm_mul_ps( z0, invW0 ), _mm_mul_ps( z1, invW1 ) ) );
+
+   // Out of the screen, this is for the frustum culling to decide
+   if( maxPos.x < 0.0f || maxPos.y < 0.0f || minPos.x >= m_width || minPos.y >= m_height )
+   {
+      return true;
+   }
+
+   const int32_t minBlockX = std::max( static_cast<int32_t>( minPos.x ), 0 ) / BLOCK_SIZE;
+   const int32_t minBlockY = std::max( static_cast<int32_t>( minPos.y ), 0 ) / BLOCK_SIZE;
+   const int32_t maxBlockX =
+       std::min( static_cast<int32_t>( maxPos.x ), int32_t( m_width ) - 1 ) / BLOCK_SIZE;
+   const int32_t maxBlockY =
+       std::min( static_cast<int32_t>( maxPos.y ), int32_t( m_height ) - 1 ) / BLOCK_SIZE;
+
+   // Visible as soon as the box is in front of the farthest occluder pixel of one block
+   const __m128 closestReg = _mm_set1_ps( closest );
+   for( int32_t blockY = minBlockY; blockY <= maxBlockY; ++blockY )
+   {
+      const float* pRow = &m_blockDepths[blockY * m_blockStride];
+      for( int32_t blockX = minBlockX; blockX <= maxBlockX; blockX += 4 )
+      {
+         const __m128 farthest = _mm_loadu_ps( pRow + blockX );
+         uint32_t mask         = _mm_movemask_ps( _mm_cmpge_ps( closestReg, farthest ) );
+
+         const int32_t remaining = maxBlockX - blockX + 1;
+         if( remaining < 4 )
+         {
+            mask &= ( 1u << remaining ) - 1;
+         }
+
+         if( mask ) return true;
+      }
+   }
+
+   return false;
+}
+
+void OcclusionCuller::cull( std::span<const AABB> worldBounds, std::vector<uint32_t>& indices )
+{
+   CYD_TRACE( "OcclusionCull" );
+
+   uint32_t visibleCount = 0;
+   for( const uint32_t index : indices )
+   {
+      if( isVisible( worldBounds[index] ) )
+      {
+         indices[visibleCount++] = index;
+      }
+   }
+
+   m_stats.testedCount += static_cast<uint32_t>( indices.size() );
+   m_stats.occludedCount += static_cast<uint32_t>( indices.size() ) - visibleCount;
+
+   indices.resize( visibleCount );
+}
+}
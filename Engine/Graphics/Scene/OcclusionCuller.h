@@ -0,0 +1,115 @@
+#pragma once
+
+#include <Common/Include.h>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// ================================================================================================
+// Forwards
+// ================================================================================================
+namespace CYD
+{
+struct AABB;
+struct OccluderGeometry;
+}
+
+namespace EMP
+{
+class ThreadPool;
+}
+
+// ================================================================================================
+// Definition
+// ================================================================================================
+/*
+Software occlusion culling. A few large occluders are rasterized on the CPU in a low resolution
+depth buffer, boxes are then tested against the farthest depth of every 8x8 block they cover.
+
+Depths are reverse-Z like the rest of the renderer, a larger depth is closer to the view. The
+screen is split in tiles that are rasterized in parallel on the threadpool.
+*/
+namespace CYD
+{
+class OcclusionCuller
+{
+  public:
+   static constexpr uint32_t DEFAULT_WIDTH  = 320;
+   static constexpr uint32_t DEFAULT_HEIGHT = 192;
+
+   // The resolution is rounded up to a multiple of the tile size
+   explicit OcclusionCuller( uint32_t width = DEFAULT_WIDTH, uint32_t height = DEFAULT_HEIGHT );
+   NON_COPIABLE( OcclusionCuller );
+   ~OcclusionCuller();
+
+   struct Stats
+   {
+      uint32_t occluderCount = 0;
+      uint32_t triangleCount = 0;  // After clipping
+      float setupMs          = 0.0f;
+      float rasterizeMs      = 0.0f;
+      uint32_t testedCount   = 0;
+      uint32_t occludedCount = 0;
+   };
+
+   // Clears the occluders of the previous frame
+   void begin( const glm::mat4& viewProjMat, uint32_t viewIndex );
+   void addOccluder( const OccluderGeometry& geometry, const glm::mat4& modelMatrix );
+   void rasterize( EMP::ThreadPool& threadPool );
+
+   // View the depth buffer was rasterized for, tests only make sense from the same view
+   uint32_t getViewIndex() const { return m_viewIndex; }
+
+   // Conservative, a box is only reported as hidden when it is behind the occluders everywhere it
+   // covers. Invalid boxes are always visible
+   bool isVisible( const AABB& worldBounds ) const;
+
+   // Removes the hidden entries from indices, which index into worldBounds. Counted in the stats
+   void cull( std::span<const AABB> worldBounds, std::vector<uint32_t>& indices );
+
+   const Stats& getStats() const { return m_stats; }
+
+  private:
+   static constexpr uint32_t BLOCK_SIZE  = 8;
+   static constexpr uint32_t TILE_WIDTH  = 64;
+   static constexpr uint32_t TILE_HEIGHT = 32;
+
+   // Screen space triangle with its edge functions and depth plane, in pixels
+   struct Triangle
+   {
+      glm::vec3 edges[3];  // Inside when x * edge.x + y * edge.y + edge.z >= 0
+      glm::vec3 depth;     // Depth at x, y is x * depth.x + y * depth.y + depth.z
+      int32_t minX;
+      int32_t minY;
+      int32_t maxX;
+      int32_t maxY;
+   };
+
+   void _addTriangle( const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2 );
+   void _setupTriangle( const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2 );
+   void _rasterizeTile( uint32_t tileIdx );
+
+   uint32_t m_width       = 0;
+   uint32_t m_height      = 0;
+   uint32_t m_tilesX      = 0;
+   uint32_t m_tilesY      = 0;
+   uint32_t m_blocksX     = 0;
+   uint32_t m_blocksY     = 0;
+   uint32_t m_blockStride = 0;  // Rows of blocks are padded to a multiple of 4
+
+   glm::mat4 m_viewProjMat = glm::mat4( 1.0f );
+   uint32_t m_viewIndex    = 0;
+
+   std::vector<glm::vec4> m_clipPositions;  // Scratch for the occluder being added
+   std::vector<Triangle> m_triangles;
+   std::vector<std::vector<uint32_t>> m_tileBins;  // Triangles overlapping every tile
+
+   std::vector<float> m_depths;       // Closest occluder of every pixel
+   std::vector<float> m_blockDepths;  // Farthest of the pixels of every block
+
+   Stats m_stats;
+};
+}
@@ -0,0 +1,68 @@
+#include <Graphics/Scene/ShadowCache.h>
+
+#include <Common/Assert.h>
+
+namespace CYD
+{
+// Weight of the last miss in the average cost of a static layer
+static constexpr float MISS_COST_WEIGHT = 0.1f;
+
+void ShadowCache::beginFrame()
+{
+   m_stats.hits          = 0;
+   m_stats.misses        = 0;
+   m_stats.invalidations = 0;
+   m_stats.savedMs       = 0.0f;
+}
+
+void ShadowCache::invalidate( uint32_t layerIdx )
+{
+   CYD_ASSERT( layerIdx < MAX_LAYERS && "ShadowCache: Layer out of range" );
+
+   if( m_layers[layerIdx].isValid )
+   {
+      m_layers[layerIdx].isValid = false;
+      m_stats.invalidations++;
+   }
+}
+
+void ShadowCache::invalidateAll()
+{
+   for( uint32_t i = 0; i < MAX_LAYERS; ++i )
+   {
+      invalidate( i );
+   }
+}
+
+bool ShadowCache::lookup( uint32_t layerIdx, const glm::mat4& viewProjMat )
+{
+   CYD_ASSERT( layerIdx < MAX_LAYERS && "ShadowCache: Layer out of range" );
+
+   // Cascades only move by whole texels, an unchanged view projection is bit for bit the same
+   const Layer& layer = m_layers[layerIdx];
+   if( layer.isValid && layer.viewProjMat == viewProjMat )
+   {
+      m_stats.hits++;
+      m_stats.totalHits++;
+      m_stats.savedMs += m_stats.missMs;
+      m_stats.totalSavedMs += m_stats.missMs;
+      return true;
+   }
+
+   m_stats.misses++;
+   m_stats.totalMisses++;
+   return false;
+}
+
+void ShadowCache::store( uint32_t layerIdx, const glm::mat4& viewProjMat, float renderMs )
+{
+   CYD_ASSERT( layerIdx < MAX_LAYERS && "ShadowCache: Layer out of range" );
+
+   m_layers[layerIdx].viewProjMat = viewProjMat;
+   m_layers[layerIdx].isValid     = true;
+
+   m_stats.missMs = m_stats.totalMisses > 1
+                        ? m_stats.missMs + MISS_COST_WEIGHT * ( renderMs - m_stats.missMs )
+                        : renderMs;
+}
+}
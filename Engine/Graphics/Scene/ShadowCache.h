@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Common/Include.h>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+
+// ================================================================================================
+// Definition
+// ================================================================================================
+/*
+Bookkeeping for the static layer of shadow cascades. The static casters of a cascade are rendered
+once in a layer of their own, the cascade is then drawn each time by copying that layer and adding
+the dynamic casters on top.
+
+A layer stays valid as long as its cascade is rendered with the same view projection and no static
+caster moved inside of it. Hits and misses are counted, a hit saves what the last misses cost.
+*/
+namespace CYD
+{
+class ShadowCache
+{
+  public:
+   static constexpr uint32_t MAX_LAYERS = 4;
+
+   ShadowCache() = default;
+   NON_COPIABLE( ShadowCache );
+   ~ShadowCache() = default;
+
+   struct Stats
+   {
+      uint32_t hits          = 0;  // This frame
+      uint32_t misses        = 0;
+      uint32_t invalidations = 0;  // Valid layers a static caster moved in
+      float savedMs          = 0.0f;
+      float missMs           = 0.0f;  // Average CPU time of a static layer render
+      uint64_t totalHits     = 0;
+      uint64_t totalMisses   = 0;
+      double totalSavedMs    = 0.0;
+   };
+
+   // Resets the counters of the frame
+   void beginFrame();
+
+   void invalidate( uint32_t layerIdx );
+   void invalidateAll();
+   bool isValid( uint32_t layerIdx ) const { return m_layers[layerIdx].isValid; }
+
+   // Whether the layer can be reused to render its cascade with this view projection, counted as
+   // a hit or a miss. A miss has to be followed by a store once the layer was rendered again
+   bool lookup( uint32_t layerIdx, const glm::mat4& viewProjMat );
+   void store( uint32_t layerIdx, const glm::mat4& viewProjMat, float renderMs );
+
+   const Stats& getStats() const { return m_stats; }
+
+  private:
+   struct Layer
+   {
+      glm::mat4 viewProjMat = glm::mat4( 1.0f );
+      bool isValid          = false;
+   };
+
+   std::array<Layer, MAX_LAYERS> m_layers;
+
+   Stats m_stats;
+};
+}
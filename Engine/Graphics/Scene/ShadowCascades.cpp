@@ -0,0 +1,265 @@
+#include <Graphics/Scene/ShadowCascades.h>
+
+#include <Graphics/Utility/Transforms.h>
+
+#include <Common/Assert.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace CYD
+{
+// Mix between the logarithmic and the uniform split schemes, closer to 1 gives more resolution to
+// the cascades close to the view
+static constexpr float SPLIT_LAMBDA = 0.8f;
+
+// Extra area covered by the cascades, relative to their slice. They stay valid while the view moves
+// inside of it
+static constexpr float CACHE_MARGIN = 0.15f;
+
+// Texels kept free on the edges of a cascade for the PCF kernel, so that it never samples the
+// cascades next to it in the atlas
+static constexpr float EDGE_TEXELS = 2.0f;
+
+// The light rotation is refreshed past about 0.5 degrees
+static constexpr float LIGHT_REFRESH_COS = 0.99996f;
+
+static glm::vec3 ForwardAxis( const glm::mat3& rotation )
+{
+   return glm::vec3( rotation[0][2], rotation[1][2], rotation[2][2] );
+}
+
+ShadowCascades::ShadowCascades(
+    uint32_t cascadeCount,
+    uint32_t resolution,
+    float shadowDistance,
+    float casterDistance )
+    : m_cascadeCount( cascadeCount ),
+      m_resolution( resolution ),
+      m_shadowDistance( shadowDistance ),
+      m_casterDistance( casterDistance )
+{
+   CYD_ASSERT(
+       cascadeCount > 0 && cascadeCount <= MAX_CASCADES &&
+       "ShadowCascades: Invalid cascade count" );
+   CYD_ASSERT( resolution > 2 * EDGE_TEXELS && "ShadowCascades: Resolution too small" );
+}
+
+void ShadowCascades::setUpdateInterval( uint32_t cascadeIdx, uint32_t frameCount )
+{
+   CYD_ASSERT( cascadeIdx < m_cascadeCount && "ShadowCascades: Cascade out of range" );
+   m_cascades[cascadeIdx].updateInterval = std::max( frameCount, 1u );
+}
+
+void ShadowCascades::update(
+    const glm::mat4& invViewMat,
+    const glm::mat4& invProjMat,
+    const glm::mat4& lightViewMat )
+{
+   m_stats = {};
+
+   // The light only turns the cascades once it has moved enough, a new rotation moves all of the
+   // texels and renders every cascade again
+   const glm::mat3 lightRotation = glm::mat3( lightViewMat );
+   if( !m_hasLight ||
+       glm::dot( ForwardAxis( lightRotation ), ForwardAxis( m_lightRotation ) ) <
+           LIGHT_REFRESH_COS )
+   {
+      m_lightRotation = lightRotation;
+      m_hasLight      = true;
+   }
+
+   // Planes and corner of the main view, reverse-Z puts the near plane at a depth of 1
+   const glm::vec4 nearPoint  = invProjMat * glm::vec4( 0.0f, 0.0f, 1.0f, 1.0f );
+   const glm::vec4 farPoint   = invProjMat * glm::vec4( 0.0f, 0.0f, 0.0f, 1.0f );
+   const glm::vec4 cornerView = invProjMat * glm::vec4( 1.0f, 1.0f, 1.0f, 1.0f );
+
+   const float near = -nearPoint.z / nearPoint.w;
+   const float far  = std::min( -farPoint.z / farPoint.w, m_shadowDistance );
+
+   // Squared tangent of the half diagonal of the view, the corners of a slice at depth d are at
+   // d * tanDiagonal from its axis
+   const glm::vec2 cornerTan = glm::vec2( cornerView ) / ( -cornerView.z );
+   const float sqTanDiagonal = glm::dot( cornerTan, cornerTan );
+   const float tanDiagonal   = std::sqrt( sqTanDiagonal );
+
+   float splits[MAX_CASCADES];
+   _computeSplits( near, far, splits );
+
+   uint32_t candidates[MAX_CASCADES];
+   uint32_t candidateCount = 0;
+   uint32_t forcedCount    = 0;
+
+   BoundingSphere slices[MAX_CASCADES];
+
+   for( uint32_t i = 0; i < m_cascadeCount; ++i )
+   {
+      Cascade& cascade = m_cascades[i];
+
+      const float sliceNear = i == 0 ? near : splits[i - 1];
+      const float sliceFar  = splits[i];
+
+      // Smallest sphere around the 8 corners of the slice, it does not change when the view turns
+      // which keeps the texel size of the cascade constant
+      float centerDepth = 0.5f * ( sliceNear + sliceFar ) * ( 1.0f + sqTanDiagonal );
+      float radius      = 0.0f;
+      if( centerDepth >= sliceFar )
+      {
+         centerDepth = sliceFar;
+         radius      = sliceFar * tanDiagonal;
+      }
+      else
+      {
+         const float toFar = sliceFar - centerDepth;
+         radius            = std::sqrt( toFar * toFar + sliceFar * sliceFar * sqTanDiagonal );
+      }
+
+      slices[i].center = glm::vec3( invViewMat * glm::vec4( 0.0f, 0.0f, -centerDepth, 1.0f ) );
+      slices[i].radius = radius;
+
+      cascade.splitFar     = sliceFar;
+      cascade.needsRender  = false;
+      cascade.wasScheduled = false;
+      cascade.wasRequested = false;
+      cascade.framesSinceUpdate++;
+
+      const bool isStale = !cascade.isValid || cascade.lightRotation != m_lightRotation ||
+                           !_covers( cascade, slices[i] );
+
+      if( isStale )
+      {
+         cascade.needsRender = true;
+         forcedCount++;
+      }
+      else if( cascade.framesSinceUpdate >= cascade.updateInterval )
+      {
+         candidates[candidateCount++] = i;
+      }
+   }
+
+   // Stale cascades are always rendered, the cascades that are only due share what is left of the
+   // budget. The most overdue go first, then the closest to the view
+   std::sort(
+       candidates,
+       candidates + candidateCount,
+       [this]( uint32_t first, uint32_t second )
+       {
+          const Cascade& firstCascade  = m_cascades[first];
+          const Cascade& secondCascade = m_cascades[second];
+
+          const int64_t firstLate =
+              int64_t( firstCascade.framesSinceUpdate ) - firstCascade.updateInterval;
+          const int64_t secondLate =
+              int64_t( secondCascade.framesSinceUpdate ) - secondCascade.updateInterval;
+
+          return firstLate != secondLate ? firstLate > secondLate : first < second;
+       } );
+
+   const uint32_t budget =
+       m_maxUpdatesPerFrame > forcedCount ? m_maxUpdatesPerFrame - forcedCount : 0;
+   const uint32_t scheduledCount = std::min( candidateCount, budget );
+
+   for( uint32_t i = 0; i < scheduledCount; ++i )
+   {
+      m_cascades[candidates[i]].needsRender  = true;
+      m_cascades[candidates[i]].wasScheduled = true;
+   }
+
+   // Only the stale cascades move, the scheduled ones are rendered again where they are
+   for( uint32_t i = 0; i < m_cascadeCount; ++i )
+   {
+      Cascade& cascade = m_cascades[i];
+      if( !cascade.needsRender ) continue;
+
+      if( !cascade.wasScheduled )
+      {
+         _fit( cascade, slices[i] );
+      }
+
+      cascade.framesSinceUpdate = 0;
+      cascade.isValid           = true;
+   }
+
+   m_stats.renderedCount  = forcedCount + scheduledCount;
+   m_stats.scheduledCount = scheduledCount;
+   m_stats.deferredCount  = candidateCount - scheduledCount;
+   m_stats.requestedCount = 0;
+}
+
+void ShadowCascades::requestRender( uint32_t cascadeIdx )
+{
+   Cascade& cascade = m_cascades[cascadeIdx];
+   if( !cascade.isValid || cascade.needsRender ) return;
+
+   cascade.needsRender       = true;
+   cascade.wasRequested      = true;
+   cascade.framesSinceUpdate = 0;
+
+   m_stats.renderedCount++;
+   m_stats.requestedCount++;
+}
+
+glm::vec3 ShadowCascades::getLightPosition( uint32_t cascadeIdx ) const
+{
+   const Cascade& cascade = m_cascades[cascadeIdx];
+
+   // Light space goes towards the light along +Z
+   const glm::vec3 lightSpacePos =
+       cascade.center + glm::vec3( 0.0f, 0.0f, cascade.radius + m_casterDistance );
+
+   return glm::transpose( cascade.lightRotation ) * lightSpacePos;
+}
+
+void ShadowCascades::_computeSplits( float near, float far, float* splits ) const
+{
+   for( uint32_t i = 1; i <= m_cascadeCount; ++i )
+   {
+      const float ratio       = static_cast<float>( i ) / m_cascadeCount;
+      const float logSplit    = near * std::pow( far / near, ratio );
+      const float linearSplit = near + ( far - near ) * ratio;
+
+      splits[i - 1] = SPLIT_LAMBDA * logSplit + ( 1.0f - SPLIT_LAMBDA ) * linearSplit;
+   }
+}
+
+void ShadowCascades::_fit( Cascade& cascade, const BoundingSphere& slice ) const
+{
+   // Rounding up the radius, the slice radius varies by a few ulps from one frame to the next
+   // and the texel size has to stay the same
+   const float edgeScale = m_resolution / ( m_resolution - 2.0f * EDGE_TEXELS );
+   const float radius    = std::ceil( slice.radius * ( 1.0f + CACHE_MARGIN ) * edgeScale );
+
+   // Moving the cascade by whole texels only, the casters rasterize the same way from one frame to
+   // the next instead of shimmering
+   const float texelSize = 2.0f * radius / m_resolution;
+
+   glm::vec3 center = m_lightRotation * slice.center;
+   center.x         = std::floor( center.x / texelSize ) * texelSize;
+   center.y         = std::floor( center.y / texelSize ) * texelSize;
+
+   cascade.lightRotation = m_lightRotation;
+   cascade.center        = center;
+   cascade.radius        = radius;
+
+   cascade.viewMat    = glm::mat4( m_lightRotation );
+   cascade.viewMat[3] = glm::vec4( -center, 1.0f );
+
+   // Casters between the light and the cascade are kept up to the caster distance
+   cascade.projMat = Transform::OrthoReverseZ(
+       -radius, radius, -radius, radius, -( radius + m_casterDistance ), radius );
+
+   cascade.frustum.update( cascade.projMat, cascade.viewMat );
+}
+
+bool ShadowCascades::_covers( const Cascade& cascade, const BoundingSphere& slice ) const
+{
+   // Area of the cascade without its edge texels
+   const float edgeScale     = ( m_resolution - 2.0f * EDGE_TEXELS ) / m_resolution;
+   const float coveredRadius = cascade.radius * edgeScale;
+
+   const glm::vec3 offset = glm::abs( cascade.lightRotation * slice.center - cascade.center );
+   const float maxOffset  = std::max( offset.x, std::max( offset.y, offset.z ) );
+
+   return maxOffset + slice.radius <= coveredRadius;
+}
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <Common/Include.h>
+
+#include <Graphics/Scene/Bounds.h>
+#include <Graphics/Scene/Frustum.h>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+
+// ================================================================================================
+// Definition
+// ================================================================================================
+/*
+Cascaded shadow maps for a directional light. The main view is split in depth slices, each cascade
+is an orthographic light view fitted around the bounding sphere of its slice.
+
+Cascades are stable. Their size only depends on the slice, not on the orientation of the view,
+and their center is snapped to their texels in light space. The light rotation they are built with
+is only refreshed when the light has turned past a threshold.
+
+A cascade does not have to be rendered every frame. Each one has an update interval in frames and
+covers a margin around its slice. A cascade is fitted again and rendered when its slice leaves what
+it covers or when the light has turned. When only its interval is over it is rendered again with
+the same fit, which keeps what was cached for it valid. Due cascades are limited to a number of
+updates per frame, the ones that do not fit wait for the next frames.
+*/
+namespace CYD
+{
+class ShadowCascades
+{
+  public:
+   static constexpr uint32_t MAX_CASCADES = 4;
+
+   // The shadows end at the shadow distance, or at the far plane of the view when it is closer.
+   // Casters are rendered up to the caster distance towards the light, past their cascade
+   ShadowCascades(
+       uint32_t cascadeCount,
+       uint32_t resolution,
+       float shadowDistance,
+       float casterDistance );
+   NON_COPIABLE( ShadowCascades );
+   ~ShadowCascades() = default;
+
+   struct Cascade
+   {
+      glm::mat4 viewMat = glm::mat4( 1.0f );
+      glm::mat4 projMat = glm::mat4( 1.0f );
+      Frustum frustum;
+
+      // View depth where the slice of the cascade ends
+      float splitFar = 0.0f;
+
+      // Light rotation and snapped light space center the cascade was rendered with, and the half
+      // size of the area it covers
+      glm::mat3 lightRotation = glm::mat3( 1.0f );
+      glm::vec3 center        = glm::vec3( 0.0f );
+      float radius            = 0.0f;
+
+      uint32_t updateInterval    = 1;
+      uint32_t framesSinceUpdate = 0;
+
+      bool isValid      = false;
+      bool needsRender  = false;  // This frame
+      bool wasScheduled = false;  // Rendered because its interval was over, with the same fit
+      bool wasRequested = false;  // Rendered with the same fit because what it shows changed
+   };
+
+   struct Stats
+   {
+      uint32_t renderedCount  = 0;
+      uint32_t scheduledCount = 0;
+      uint32_t deferredCount  = 0;  // Due, but over the budget of the frame
+      uint32_t requestedCount = 0;  // Rendered outside of the budget after the update
+   };
+
+   // Interval of 1 renders the cascade every frame
+   void setUpdateInterval( uint32_t cascadeIdx, uint32_t frameCount );
+   void setMaxUpdatesPerFrame( uint32_t updateCount ) { m_maxUpdatesPerFrame = updateCount; }
+
+   // Fits the cascades to the main view and decides which ones are rendered this frame. The light
+   // view matrix only gives the orientation of the light
+   void update(
+       const glm::mat4& invViewMat,
+       const glm::mat4& invProjMat,
+       const glm::mat4& lightViewMat );
+
+   // Renders a valid cascade this frame with the same fit, outside of the budget and whatever its
+   // interval. For a cascade whose casters changed since it was last rendered
+   void requestRender( uint32_t cascadeIdx );
+
+   uint32_t getCascadeCount() const { return m_cascadeCount; }
+   uint32_t getResolution() const { return m_resolution; }
+   const Cascade& getCascade( uint32_t cascadeIdx ) const { return m_cascades[cascadeIdx]; }
+
+   // Point towards the light from which the casters of a cascade are rendered, to sort them
+   glm::vec3 getLightPosition( uint32_t cascadeIdx ) const;
+
+   const Stats& getStats() const { return m_stats; }
+
+  private:
+   void _computeSplits( float near, float far, float* splits ) const;
+
+   void _fit( Cascade& cascade, const BoundingSphere& slice ) const;
+   bool _covers( const Cascade& cascade, const BoundingSphere& slice ) const;
+
+   std::array<Cascade, MAX_CASCADES> m_cascades;
+
+   uint32_t m_cascadeCount       = 0;
+   uint32_t m_resolution         = 0;
+   uint32_t m_maxUpdatesPerFrame = MAX_CASCADES;
+
+   float m_shadowDistance = 0.0f;
+   float m_casterDistance = 0.0f;
+
+   glm::mat3 m_lightRotation = glm::mat3( 1.0f );
+   bool m_hasLight           = false;
+
+   Stats m_stats;
+};
+}
@@ -0,0 +1,285 @@
+#include <Graphics/Scene/TerrainQuadtree.h>
+
+#include <Common/Assert.h>
+
+#include <Graphics/Scene/Bounds.h>
+
+#include <Profiling.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace CYD
+{
+// Heights generated on the CPU drift slightly from the GPU ones, relative to the height scale
+static constexpr float HEIGHT_MARGIN = 0.005f;
+
+static constexpr uint32_t ALL_PLANES_INSIDE = ( 1 << 6 ) - 1;
+
+static bool IntersectsSphere( const AABB& bounds, const glm::vec3& center, float radius )
+{
+   const glm::vec3 closest = glm::clamp( center, bounds.min, bounds.max );
+   const glm::vec3 offset  = closest - center;
+   return glm::dot( offset, offset ) <= radius * radius;
+}
+
+// ================================================================================================
+float TerrainQuadtree::getNodeSize( uint32_t lod ) const
+{
+   return m_size / static_cast<float>( 1 << ( m_lodCount - 1 - lod ) );
+}
+
+const glm::vec2& TerrainQuadtree::getNodeHeights( uint32_t lod, uint32_t x, uint32_t z ) const
+{
+   const uint32_t nodesPerSide = 1 << ( m_lodCount - 1 - lod );
+   return m_heights[lod][z * nodesPerSide + x];
+}
+
+// ================================================================================================
+void TerrainQuadtree::_allocate( float size, float heightScale, uint32_t lodCount )
+{
+   CYD_ASSERT( lodCount > 0 && lodCount <= MAX_LODS && "TerrainQuadtree: Invalid LOD count" );
+
+   m_size        = size;
+   m_heightScale = heightScale;
+   m_lodCount    = lodCount;
+
+   for( uint32_t lod = 0; lod < MAX_LODS; ++lod )
+   {
+      const uint32_t nodesPerSide = lod < lodCount ? 1 << ( lodCount - 1 - lod ) : 0;
+      m_heights[lod].resize( nodesPerSide * nodesPerSide );
+   }
+}
+
+void TerrainQuadtree::build(
+    const float* heights,
+    uint32_t width,
+    uint32_t height,
+    float size,
+    float heightScale,
+    uint32_t lodCount )
+{
+   CYD_TRACE( "TerrainQuadtree Build" );
+
+   _allocate( size, heightScale, lodCount );
+
+   // Leaves first, scanning the texels that bilinear samples inside of each leaf can touch
+   const uint32_t leavesPerSide = 1 << ( lodCount - 1 );
+
+   auto firstTexel = []( float coord, uint32_t count )
+   {
+      const int32_t texel = static_cast<int32_t>( std::floor( coord * count - 0.5f ) );
+      return static_cast<uint32_t>( std::clamp<int32_t>( texel, 0, count - 1 ) );
+   };
+
+   for( uint32_t z = 0; z < leavesPerSide; ++z )
+   {
+      const uint32_t row0 = firstTexel( static_cast<float>( z ) / leavesPerSide, height );
+      const uint32_t row1 = std::min(
+          firstTexel( static_cast<float>( z + 1 ) / leavesPerSide, height ) + 1, height - 1 );
+
+      for( uint32_t x = 0; x < leavesPerSide; ++x )
+      {
+         const uint32_t col0 = firstTexel( static_cast<float>( x ) / leavesPerSide, width );
+         const uint32_t col1 = std::min(
+             firstTexel( static_cast<float>( x + 1 ) / leavesPerSide, width ) + 1, width - 1 );
+
+         float minHeight = std::numeric_limits<float>::max();
+         float maxHeight = -std::numeric_limits<float>::max();
+
+         for( uint32_t row = row0; row <= row1; ++row )
+         {
+            const float* texels = heights + static_cast<size_t>( row ) * width;
+            for( uint32_t col = col0; col <= col1; ++col )
+            {
+               minHeight = std::min( minHeight, texels[col] );
+               maxHeight = std::max( maxHeight, texels[col] );
+            }
+         }
+
+         m_heights[0][z * leavesPerSide + x] =
+             glm::vec2( minHeight - HEIGHT_MARGIN, maxHeight + HEIGHT_MARGIN ) * heightScale;
+      }
+   }
+
+   // Then every parent from its 4 children
+   for( uint32_t lod = 1; lod < lodCount; ++lod )
+   {
+      const uint32_t nodesPerSide = 1 << ( lodCount - 1 - lod );
+      const std::vector<glm::vec2>& children = m_heights[lod - 1];
+
+      for( uint32_t z = 0; z < nodesPerSide; ++z )
+      {
+         for( uint32_t x = 0; x < nodesPerSide; ++x )
+         {
+            const uint32_t child = 2 * z * 2 * nodesPerSide + 2 * x;
+            const uint32_t below = child + 2 * nodesPerSide;
+
+            const glm::vec2& c0 = children[child];
+            const glm::vec2& c1 = children[child + 1];
+            const glm::vec2& c2 = children[below];
+            const glm::vec2& c3 = children[below + 1];
+
+            m_heights[lod][z * nodesPerSide + x] = glm::vec2(
+                std::min( std::min( c0.x, c1.x ), std::min( c2.x, c3.x ) ),
+                std::max( std::max( c0.y, c1.y ), std::max( c2.y, c3.y ) ) );
+         }
+      }
+   }
+}
+
+void TerrainQuadtree::buildFlat( float size, float heightScale, uint32_t lodCount )
+{
+   _allocate( size, heightScale, lodCount );
+
+   for( uint32_t lod = 0; lod < lodCount; ++lod )
+   {
+      std::fill( m_heights[lod].begin(), m_heights[lod].end(), glm::vec2( 0.0f, heightScale ) );
+   }
+}
+
+void TerrainQuadtree::setLodDistance( float lodDistance, float morphRatio )
+{
+   CYD_ASSERT( m_lodCount > 0 && "TerrainQuadtree: Distances set before building" );
+
+   float prevRange = 0.0f;
+   for( uint32_t lod = 0; lod < m_lodCount; ++lod )
+   {
+      const float range  = lodDistance * static_cast<float>( 1 << lod );
+      m_lodRanges[lod]   = range;
+      m_morphStarts[lod] = prevRange + ( range - prevRange ) * morphRatio;
+      prevRange          = range;
+   }
+
+   // The root is drawn at any distance and never morphs, there is no coarser grid to go to
+   m_lodRanges[m_lodCount - 1]   = std::numeric_limits<float>::max();
+   m_morphStarts[m_lodCount - 1] = std::numeric_limits<float>::max();
+}
+
+// ================================================================================================
+void TerrainQuadtree::select(
+    const glm::vec3& viewPosition,
+    const glm::vec4* frustumPlanes,
+    std::vector<Patch>& patches )
+{
+   CYD_TRACE( "TerrainQuadtree Select" );
+
+   const auto start = std::chrono::steady_clock::now();
+
+   m_stats        = {};
+   m_viewPosition = viewPosition;
+   m_patches      = &patches;
+
+   // Every plane is marked as already passed when there is nothing to cull against
+   uint32_t insideMask = ALL_PLANES_INSIDE;
+   if( frustumPlanes )
+   {
+      std::copy( frustumPlanes, frustumPlanes + 6, m_planes );
+      insideMask = 0;
+   }
+
+   patches.clear();
+
+   if( m_lodCount > 0 )
+   {
+      _selectNode( m_lodCount - 1, 0, 0, insideMask );
+   }
+
+   m_patches = nullptr;
+
+   m_stats.selectedCount = static_cast<uint32_t>( patches.size() );
+   m_stats.selectMs =
+       std::chrono::duration<float, std::milli>( std::chrono::steady_clock::now() - start )
+           .count();
+}
+
+bool TerrainQuadtree::_selectNode( uint32_t lod, uint32_t x, uint32_t z, uint32_t insideMask )
+{
+   m_stats.visitedCount++;
+
+   const AABB bounds = _getNodeBounds( lod, x, z );
+
+   // Culled nodes are done with, nothing of them is drawn
+   if( insideMask != ALL_PLANES_INSIDE && !_isInFrustum( bounds, insideMask ) )
+   {
+      m_stats.culledCount++;
+      return true;
+   }
+
+   if( !IntersectsSphere( bounds, m_viewPosition, m_lodRanges[lod] ) )
+   {
+      return false;
+   }
+
+   // The whole node is drawn at this LOD when none of it is close enough for the next one
+   if( lod == 0 || !IntersectsSphere( bounds, m_viewPosition, m_lodRanges[lod - 1] ) )
+   {
+      _addPatch( lod, x, z, lod, 1 );
+      return true;
+   }
+
+   for( uint32_t child = 0; child < 4; ++child )
+   {
+      const uint32_t childX = 2 * x + ( child & 1 );
+      const uint32_t childZ = 2 * z + ( child >> 1 );
+
+      // Out of range children are drawn as quarters of this node, with every other vertex of the
+      // grid to keep the density of this LOD
+      if( !_selectNode( lod - 1, childX, childZ, insideMask ) )
+      {
+         _addPatch( lod - 1, childX, childZ, lod, 2 );
+      }
+   }
+
+   return true;
+}
+
+AABB TerrainQuadtree::_getNodeBounds( uint32_t lod, uint32_t x, uint32_t z ) const
+{
+   const glm::vec2& heights = getNodeHeights( lod, x, z );
+
+   const float nodeSize = getNodeSize( lod );
+   const float minX     = -0.5f * m_size + x * nodeSize;
+   const float minZ     = -0.5f * m_size + z * nodeSize;
+
+   return { glm::vec3( minX, heights.x, minZ ),
+            glm::vec3( minX + nodeSize, heights.y, minZ + nodeSize ) };
+}
+
+bool TerrainQuadtree::_isInFrustum( const AABB& bounds, uint32_t& insideMask ) const
+{
+   const glm::vec3 center  = bounds.getCenter();
+   const glm::vec3 extents = bounds.getExtents();
+
+   for( uint32_t i = 0; i < 6; ++i )
+   {
+      if( insideMask & ( 1 << i ) ) continue;
+
+      const glm::vec3 normal = glm::vec3( m_planes[i] );
+      const float distance   = glm::dot( normal, center ) + m_planes[i].w;
+      const float radius     = glm::dot( glm::abs( normal ), extents );
+
+      if( distance + radius < 0.0f ) return false;
+      if( distance - radius >= 0.0f ) insideMask |= 1 << i;
+   }
+
+   return true;
+}
+
+void TerrainQuadtree::_addPatch(
+    uint32_t lod,
+    uint32_t x,
+    uint32_t z,
+    uint32_t drawLod,
+    uint32_t step )
+{
+   const float nodeSize = getNodeSize( lod );
+
+   Patch& patch     = m_patches->emplace_back();
+   patch.origin     = glm::vec2( x, z ) * nodeSize - 0.5f * m_size;
+   patch.size       = nodeSize;
+   patch.lodAndStep = drawLod | step << 8;
+}
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <Common/Include.h>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// ================================================================================================
+// Forwards
+// ================================================================================================
+namespace CYD
+{
+struct AABB;
+}
+
+// ================================================================================================
+// Definition
+// ================================================================================================
+/*
+Quadtree of a square heightfield terrain for continuous distance-dependent LOD (CDLOD). The root
+covers the whole terrain and every level below halves the size of its nodes, the leaves are the
+finest LOD. Nodes know the lowest and highest heights under them.
+
+Selection walks the tree from the root and keeps the coarsest nodes that are close enough to the
+view for their LOD. Every LOD covers twice the distance of the previous one, nodes morph into the
+grid of the next LOD over the end of their range so that neighbouring LODs meet without cracks.
+A node whose children are only partly in range is drawn as quarters at its own LOD.
+
+Everything is in the space of the terrain. The terrain spans [-size / 2, size / 2] on X and Z, the
+heights go from 0 to the height scale.
+*/
+namespace CYD
+{
+class TerrainQuadtree
+{
+  public:
+   static constexpr uint32_t MAX_LODS = 12;
+
+   TerrainQuadtree() = default;
+   NON_COPIABLE( TerrainQuadtree );
+   ~TerrainQuadtree() = default;
+
+   // Patch of the terrain grid to draw, GPU. Keep in sync with "TerrainPatch" in TERRAIN_CDLOD.h
+   struct Patch
+   {
+      glm::vec2 origin;     // Corner with the lowest X and Z
+      float size;
+      uint32_t lodAndStep;  // LOD in the low byte, step between the grid vertices above it
+   };
+
+   struct Stats
+   {
+      uint32_t visitedCount  = 0;
+      uint32_t culledCount   = 0;
+      uint32_t selectedCount = 0;
+      float selectMs         = 0.0f;
+   };
+
+   // Heights in [0, 1] covering the whole terrain, row major from the lowest X and Z. Node bounds
+   // include every texel a bilinear sample inside of the node can read
+   void build(
+       const float* heights,
+       uint32_t width,
+       uint32_t height,
+       float size,
+       float heightScale,
+       uint32_t lodCount );
+
+   // Without height data, every node spans the whole height range
+   void buildFlat( float size, float heightScale, uint32_t lodCount );
+
+   // The finest LOD ends at the LOD distance, the next ones at twice the distance of the previous.
+   // Morphing starts at the morph ratio of the range of a LOD
+   void setLodDistance( float lodDistance, float morphRatio );
+
+   // Fills patches with the nodes to draw, in the order of the tree walk. The 6 frustum planes
+   // point inside, nothing is culled without them
+   void select(
+       const glm::vec3& viewPosition,
+       const glm::vec4* frustumPlanes,
+       std::vector<Patch>& patches );
+
+   uint32_t getLodCount() const { return m_lodCount; }
+   float getNodeSize( uint32_t lod ) const;
+   float getLodRange( uint32_t lod ) const { return m_lodRanges[lod]; }
+   float getMorphStart( uint32_t lod ) const { return m_morphStarts[lod]; }
+
+   // Lowest and highest height under node (x, z) of a LOD, nodes go from the lowest X and Z
+   const glm::vec2& getNodeHeights( uint32_t lod, uint32_t x, uint32_t z ) const;
+
+   const Stats& getStats() const { return m_stats; }
+
+  private:
+   // False when the node is out of the range of its LOD, its parent then draws its area. The mask
+   // has a bit set for every plane the parent is fully inside of, the children skip them
+   bool _selectNode( uint32_t lod, uint32_t x, uint32_t z, uint32_t insideMask );
+
+   AABB _getNodeBounds( uint32_t lod, uint32_t x, uint32_t z ) const;
+   bool _isInFrustum( const AABB& bounds, uint32_t& insideMask ) const;
+
+   // Area of node (x, z) of a LOD, drawn with the morph of the draw LOD
+   void _addPatch( uint32_t lod, uint32_t x, uint32_t z, uint32_t drawLod, uint32_t step );
+
+   void _allocate( float size, float heightScale, uint32_t lodCount );
+
+   // Lowest and highest height of the nodes of each LOD, row major. The coarsest LOD is the root
+   std::array<std::vector<glm::vec2>, MAX_LODS> m_heights;
+
+   std::array<float, MAX_LODS> m_lodRanges   = {};
+   std::array<float, MAX_LODS> m_morphStarts = {};
+
+   uint32_t m_lodCount = 0;
+   float m_size        = 0.0f;
+   float m_heightScale = 0.0f;
+
+   // Selection state
+   glm::vec3 m_viewPosition;
+   glm::vec4 m_planes[6];
+   std::vector<Patch>* m_patches = nullptr;
+
+   Stats m_stats;
+};
+}
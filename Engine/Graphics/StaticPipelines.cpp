@@ -3,10 +3,12 @@
 #include <Common/Assert.h>
 
 #include <Graphics/PipelineInfos.h>
+#include <Graphics/Utility/GraphicsIO.h>
+
+#include <IO/VirtualFileSystem.h>
 
 #include <json/json.hpp>
 
-#include <fstream>
 #include <memory>
 
 namespace CYD::StaticPipelines
@@ -128,11 +130,54 @@ static PixelFormat StringToPixelFormat( const std::string& formatString )
    {
       return PixelFormat::RGB32F;
    }
+   if( formatString == "RG32F" )
+   {
+      return PixelFormat::RG32F;
+   }
+   if( formatString == "RGBA16_UNORM" )
+   {
+      return PixelFormat::RGBA16_UNORM;
+   }
+   if( formatString == "RG16F" )
+   {
+      return PixelFormat::RG16F;
+   }
+   if( formatString == "RG16_SNORM" )
+   {
+      return PixelFormat::RG16_SNORM;
+   }
+   if( formatString == "RGBA8_UNORM" )
+   {
+      return PixelFormat::RGBA8_UNORM;
+   }
 
    CYD_ASSERT( !"Pipelines: Could not recognize string as a pixel format" );
    return PixelFormat::RGBA32F;
 }
 
+static VertexFormatFlag StringToVertexFormat( const std::string& formatString )
+{
+   if( formatString == "QUANTIZED_POSITION" )
+   {
+      return VertexFormat::QUANTIZED_POSITION;
+   }
+   if( formatString == "OCTAHEDRAL_NORMAL" )
+   {
+      return VertexFormat::OCTAHEDRAL_NORMAL;
+   }
+   if( formatString == "HALF_UV" )
+   {
+      return VertexFormat::HALF_UV;
+   }
+   if( formatString == "COLOR" )
+   {
+      return VertexFormat::COLOR;
+   }
+
+   CYD_ASSERT( !"Pipelines: Could not recognize string as a vertex format" );
+   return 0;
+}
+
 static CompareOperator StringToCompareOp( const std::string& operatorString )
 {
    if( operatorString == "NEVER" )
@@ -175,16 +220,16 @@ static CompareOperator StringToCompareOp( const std::string& operatorString )
 bool Initialize()
 {
    // Parse pipeline infos from JSON description
-   nlohmann::json pipelineDescriptions;
-   std::ifstream pipelinesFile( PIPELINES_PATH );
-
-   if( !pipelinesFile.is_open() )
+   EMP::VirtualFile pipelinesFile;
+   if( !GraphicsIO::GetFileSystem().open( PIPELINES_PATH, pipelinesFile ) )
    {
       CYD_ASSERT( !"StaticPipelines: Could not find render pipelines file" );
       return false;
    }
 
-   pipelinesFile >> pipelineDescriptions;
+   const char* pipelinesText = reinterpret_cast<const char*>( pipelinesFile.getData() );
+   nlohmann::json pipelineDescriptions =
+       nlohmann::json::parse( pipelinesText, pipelinesText + pipelinesFile.getSize() );
 
    const auto& pipelines = pipelineDescriptions.front();
 
@@ -261,6 +306,19 @@ bool Initialize()
             pipInfo.polyMode = StringToPolygonMode( polyModeIt->front() );
          }
 
+         // Parsing vertex format, the layout of the meshes packed with it
+         const auto& vertexFormatIt = pipeline.find( "VERTEX_FORMAT" );
+         if( vertexFormatIt != pipeline.end() )
+         {
+            VertexFormatFlag format = 0;
+            for( const auto& formatFlag : *vertexFormatIt )
+            {
+               format |= StringToVertexFormat( formatFlag );
+            }
+
+            pipInfo.vertLayout = VertexLayout( format );
+         }
+
          // Parsing vertex layout
          const auto& vertexLayoutIt = pipeline.find( "VERTEX_LAYOUT" );
          if( vertexLayoutIt != pipeline.end() )
@@ -2,117 +2,166 @@
 
 #include <Common/Assert.h>
 
-#include <Graphics/VertexLayout.h>
+#include <Graphics/Utility/ObjImporter.h>
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tinyobjloader/tiny_obj_loader.h>
+#include <IO/DerivedDataCache.h>
+#include <IO/VirtualFileSystem.h>
+
+#include <cstring>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 
-#include <unordered_map>
-
 namespace CYD
 {
-static const char MESH_PATH[] = "../Engine/Data/Meshes/";
+static const char MESH_PATH[]         = "../Engine/Data/Meshes/";
+static const char DERIVED_DATA_PATH[] = "../Engine/Data/DerivedDataCache/";
 
 void GraphicsIO::LoadMesh(
     const std::string& path,
     std::vector<Vertex>& vertices,
-    std::vector<uint32_t>& indices )
+    std::vector<uint32_t>& indices,
+    EMP::ThreadPool& threadPool )
 {
-   tinyobj::attrib_t attrib;
-   std::vector<tinyobj::shape_t> shapes;
-   std::vector<tinyobj::material_t> materials;
-   std::string warn, err;
-
-   bool res = tinyobj::LoadObj(
-       &attrib, &shapes, &materials, &warn, &err, ( MESH_PATH + path + ".obj" ).c_str() );
+   bool res = ObjImporter::Import( MESH_PATH + path + ".obj", vertices, indices, threadPool );
    CYD_ASSERT( res && "Model loading failed" );
+}
 
-   vertices.reserve( shapes[0].mesh.num_face_vertices.size() );
-   indices.reserve( shapes[0].mesh.indices.size() );
+// Decoded image kept in the derived data cache, followed by its pixels
+struct CachedImageHeader
+{
+   static constexpr uint32_t MAGIC   = 0x49445943;  // "CYDI"
+   static constexpr uint32_t VERSION = 1;
 
-   std::unordered_map<Vertex, uint32_t> uniqueVertices = {};
+   uint32_t magic       = MAGIC;
+   uint32_t version     = VERSION;
+   int32_t width        = 0;
+   int32_t height       = 0;
+   int32_t size         = 0;
+   PixelFormat format   = PixelFormat::UNKNOWN;
+   uint8_t padding[3]   = {};
+   uint32_t reserved[2] = {};
+};
 
-   for( const auto& shape : shapes )
-   {
-      for( const auto& index : shape.mesh.indices )
-      {
-         Vertex vertex = {};
-
-         vertex.pos = {
-             attrib.vertices[3 * index.vertex_index + 0],
-             attrib.vertices[3 * index.vertex_index + 1],
-             attrib.vertices[3 * index.vertex_index + 2] };
-
-         if( !attrib.normals.empty() )
-         {
-            vertex.normal = {
-                attrib.normals[3 * index.normal_index + 0],
-                attrib.normals[3 * index.normal_index + 1],
-                attrib.normals[3 * index.normal_index + 2] };
-         }
-
-         if( !attrib.texcoords.empty() )
-         {
-            vertex.uv = {
-                attrib.texcoords[2 * index.texcoord_index + 0],
-                1.0f - attrib.texcoords[2 * index.texcoord_index + 1],
-                0.0f };
-         }
-
-         vertex.col = { 1.0f, 1.0f, 1.0f, 1.0f };
-
-         if( uniqueVertices.count( vertex ) == 0 )
-         {
-            uniqueVertices[vertex] = static_cast<uint32_t>( vertices.size() );
-            vertices.push_back( vertex );
-         }
-
-         indices.push_back( uniqueVertices[vertex] );
-      }
-   }
+static_assert( sizeof( CachedImageHeader ) == 32, "GraphicsIO: A new header needs a new version" );
+
+static constexpr char IMAGE_EXTENSION[] = ".cydimage";
+
+static bool ReadCachedImage( PixelFormat format, GraphicsIO::Image& image )
+{
+   const EMP::MappedFile& file = image.cachedFile;
+   if( file.getSize() < sizeof( CachedImageHeader ) ) return false;
+
+   const CachedImageHeader* header = reinterpret_cast<const CachedImageHeader*>( file.getData() );
+   const bool isValid = header->magic == CachedImageHeader::MAGIC &&
+                        header->version == CachedImageHeader::VERSION &&
+                        header->format == format && header->size >= 0 &&
+                        sizeof( CachedImageHeader ) + header->size <= file.getSize();
+   if( !isValid ) return false;
+
+   image.width  = header->width;
+   image.height = header->height;
+   image.size   = header->size;
+   image.pixels = file.getData() + sizeof( CachedImageHeader );
+
+   return true;
 }
 
-void* GraphicsIO::LoadImage(
-    const std::string& path,
-    PixelFormat format,
-    int& width,
-    int& height,
-    int& size )
+static void StoreCachedImage( uint64_t key, PixelFormat format, const GraphicsIO::Image& image )
 {
+   CachedImageHeader header;
+   header.width  = image.width;
+   header.height = image.height;
+   header.size   = image.size;
+   header.format = format;
+
+   std::vector<uint8_t> file( sizeof( CachedImageHeader ) + image.size );
+   std::memcpy( file.data(), &header, sizeof( CachedImageHeader ) );
+   std::memcpy( file.data() + sizeof( CachedImageHeader ), image.pixels, image.size );
+
+   GraphicsIO::GetDerivedDataCache().store( key, IMAGE_EXTENSION, file.data(), file.size() );
+}
+
+bool GraphicsIO::LoadImage( const std::string& path, PixelFormat format, Image& image )
+{
+   // The pixels depend on the content of the file and on the format they are decoded in
+   const uint32_t parameters[] = { CachedImageHeader::VERSION, static_cast<uint32_t>( format ) };
+
+   EMP::VirtualFile file;
+   if( !GetFileSystem().open( path, file ) )
+   {
+      // Could not find image
+      return false;
+   }
+
+   uint64_t key = EMP::DerivedDataCache::Hash( parameters, sizeof( parameters ) );
+   key          = EMP::DerivedDataCache::Hash( file.getData(), file.getSize(), key );
+
+   if( GetDerivedDataCache().load( key, IMAGE_EXTENSION, image.cachedFile ) &&
+       ReadCachedImage( format, image ) )
+   {
+      return true;
+   }
+
+   image.cachedFile.close();
+
+   const stbi_uc* fileData = file.getData();
+   const int fileSize      = static_cast<int>( file.getSize() );
+
    void* imageData = nullptr;
+   int width       = 0;
+   int height      = 0;
    int channels    = 0;
    switch( format )
    {
       case PixelFormat::RGBA32F:
-         imageData = stbi_loadf( path.c_str(), &width, &height, &channels, STBI_rgb_alpha );
+         imageData = stbi_loadf_from_memory(
+             fileData, fileSize, &width, &height, &channels, STBI_rgb_alpha );
          break;
       case PixelFormat::RGB32F:
-         imageData = stbi_loadf( path.c_str(), &width, &height, &channels, STBI_rgb );
+         imageData =
+             stbi_loadf_from_memory( fileData, fileSize, &width, &height, &channels, STBI_rgb );
          break;
       case PixelFormat::RGBA8_SRGB:
-         imageData = stbi_load( path.c_str(), &width, &height, &channels, STBI_rgb_alpha );
+         imageData = stbi_load_from_memory(
+             fileData, fileSize, &width, &height, &channels, STBI_rgb_alpha );
          break;
       case PixelFormat::R32F:
-         imageData = stbi_loadf( path.c_str(), &width, &height, &channels, 0 );
+         imageData = stbi_loadf_from_memory( fileData, fileSize, &width, &height, &channels, 0 );
          break;
       default:
          // TODO Format to pixel size function
          CYD_ASSERT( !"Not implemented" );
    }
 
-   size = width * height * GetPixelSizeInBytes( format );
-
    if( !imageData )
    {
-      // Could not load image, returning nullptr
-      return nullptr;
+      // Could not load image
+      return false;
    }
 
-   return imageData;
+   image.width  = width;
+   image.height = height;
+   image.size   = width * height * GetPixelSizeInBytes( format );
+   image.pixels = imageData;
+   image.decodedPixels.reset( imageData );
+
+   StoreCachedImage( key, format, image );
+
+   return true;
 }
 
 void GraphicsIO::FreeImage( void* imageData ) { stbi_image_free( imageData ); }
+
+EMP::DerivedDataCache& GraphicsIO::GetDerivedDataCache()
+{
+   static EMP::DerivedDataCache s_derivedDataCache( DERIVED_DATA_PATH );
+   return s_derivedDataCache;
+}
+
+EMP::VirtualFileSystem& GraphicsIO::GetFileSystem()
+{
+   static EMP::VirtualFileSystem s_fileSystem;
+   return s_fileSystem;
+}
 }
@@ -2,10 +2,20 @@
 
 #include <Graphics/GraphicsTypes.h>
 
+#include <IO/MappedFile.h>
+
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
+namespace EMP
+{
+class DerivedDataCache;
+class ThreadPool;
+class VirtualFileSystem;
+}
+
 namespace CYD
 {
 class Vertex;
@@ -15,9 +25,32 @@ namespace GraphicsIO
 void LoadMesh(
     const std::string& path,
     std::vector<Vertex>& vertices,
-    std::vector<uint32_t>& indices );
+    std::vector<uint32_t>& indices,
+    EMP::ThreadPool& threadPool );
 
-void* LoadImage( const std::string& path, PixelFormat format, int& width, int& height, int& size );
 void FreeImage( void* imageData );
+
+// Pixels of an image in the pixel format it was loaded in, either decoded or mapped from the
+// derived data cache
+struct Image
+{
+   int width  = 0;
+   int height = 0;
+   int size   = 0;  // Of the pixels, in bytes
+
+   const void* pixels = nullptr;
+
+   EMP::MappedFile cachedFile;
+   std::unique_ptr<void, void ( * )( void* )> decodedPixels = { nullptr, &FreeImage };
+};
+
+// Images are decoded once, the next loads map the decoded pixels kept in the derived data cache
+bool LoadImage( const std::string& path, PixelFormat format, Image& image );
+
+// Shared by the assets loaded from disk, kept next to them
+EMP::DerivedDataCache& GetDerivedDataCache();
+
+// Every asset is read through it, from the archives mounted or from loose files
+EMP::VirtualFileSystem& GetFileSystem();
 }
 }
\ No newline at end of file
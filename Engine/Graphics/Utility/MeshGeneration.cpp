@@ -81,6 +81,43 @@ void PatchGrid( std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, u
    }
 }
 
+void UnitGrid( std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t resolution )
+{
+   const uint32_t size = resolution + 1;
+   vertices.resize( size * size );
+
+   for( uint32_t z = 0; z < size; ++z )
+   {
+      for( uint32_t x = 0; x < size; ++x )
+      {
+         const glm::vec2 coords = glm::vec2( x, z ) / static_cast<float>( resolution );
+
+         Vertex& vertex = vertices[z * size + x];
+         vertex.pos     = glm::vec3( coords.x, 0.0f, coords.y );
+         vertex.uv      = glm::vec3( coords, 0.0f );
+         vertex.normal  = glm::vec3( 0.0f, 1.0f, 0.0f );
+      }
+   }
+
+   indices.clear();
+   indices.reserve( resolution * resolution * 6 );
+   for( uint32_t z = 0; z < resolution; ++z )
+   {
+      for( uint32_t x = 0; x < resolution; ++x )
+      {
+         const uint32_t corner = z * size + x;
+
+         indices.push_back( corner );
+         indices.push_back( corner + size );
+         indices.push_back( corner + size + 1 );
+
+         indices.push_back( corner );
+         indices.push_back( corner + size + 1 );
+         indices.push_back( corner + 1 );
+      }
+   }
+}
+
 // Recursive subdivision function for icosphere generation
 static void subdivide(
     std::unordered_map<Vertex, uint32_t>& uniqueVertices,
@@ -20,6 +20,10 @@ void TriangleGrid(
 
 void PatchGrid( std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t patchSize );
 
+// Grid of resolution x resolution quads covering [0, 1] on X and Z, with matching UVs. The
+// primitive used for rendering should be triangle lists
+void UnitGrid( std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t resolution );
+
 void Icosphere(
     std::vector<Vertex>& vertices,
     std::vector<uint32_t>& indices,
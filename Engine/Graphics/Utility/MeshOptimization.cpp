@@ -0,0 +1,382 @@
+#include <Graphics/Utility/MeshOptimization.h>
+
+#include <Common/Assert.h>
+
+#include <Graphics/VertexLayout.h>
+
+#include <Profiling.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace CYD::MeshOptimization
+{
+static constexpr uint32_t INVALID_VERTEX = 0xFFFFFFFF;
+
+// Triangles around each vertex, the ones of a vertex are at [offsets[v], offsets[v + 1])
+struct TriangleAdjacency
+{
+   std::vector<uint32_t> offsets;
+   std::vector<uint32_t> triangles;
+};
+
+static void BuildAdjacency(
+    const std::vector<uint32_t>& indices,
+    uint32_t vertexCount,
+    TriangleAdjacency& adjacency )
+{
+   adjacency.offsets.assign( vertexCount + 1, 0 );
+   for( const uint32_t index : indices )
+   {
+      adjacency.offsets[index + 1]++;
+   }
+
+   std::partial_sum(
+       adjacency.offsets.begin(), adjacency.offsets.end(), adjacency.offsets.begin() );
+
+   adjacency.triangles.resize( indices.size() );
+
+   std::vector<uint32_t> fill( adjacency.offsets.begin(), adjacency.offsets.end() - 1 );
+   for( uint32_t i = 0; i < indices.size(); ++i )
+   {
+      adjacency.triangles[fill[indices[i]]++] = i / 3;
+   }
+}
+
+// FIFO cache with timestamps, a vertex is in the cache when it was added less than cacheSize
+// misses ago. Returns the number of misses of the triangle
+static uint32_t UpdateCache(
+    const uint32_t* triangle,
+    std::vector<uint32_t>& timestamps,
+    uint32_t& time,
+    uint32_t cacheSize )
+{
+   uint32_t misses = 0;
+   for( uint32_t k = 0; k < 3; ++k )
+   {
+      if( time - timestamps[triangle[k]] > cacheSize )
+      {
+         timestamps[triangle[k]] = time++;
+         misses++;
+      }
+   }
+
+   return misses;
+}
+
+// ================================================================================================
+VertexCacheStats AnalyzeVertexCache(
+    const std::vector<uint32_t>& indices,
+    uint32_t vertexCount,
+    uint32_t cacheSize )
+{
+   VertexCacheStats stats;
+   if( indices.empty() ) return stats;
+
+   std::vector<uint32_t> timestamps( vertexCount, 0 );
+   std::vector<uint8_t> isUsed( vertexCount, 0 );
+
+   uint32_t time      = cacheSize + 1;
+   uint32_t misses    = 0;
+   uint32_t usedCount = 0;
+
+   for( size_t i = 0; i < indices.size(); i += 3 )
+   {
+      misses += UpdateCache( &indices[i], timestamps, time, cacheSize );
+   }
+
+   for( const uint32_t index : indices )
+   {
+      usedCount += isUsed[index] ? 0 : 1;
+      isUsed[index] = 1;
+   }
+
+   stats.acmr = static_cast<float>( misses ) / static_cast<float>( indices.size() / 3 );
+   stats.atvr = static_cast<float>( misses ) / static_cast<float>( usedCount );
+
+   return stats;
+}
+
+// ================================================================================================
+void OptimizeVertexCache( std::vector<uint32_t>& indices, uint32_t vertexCount )
+{
+   CYD_TRACE( "Vertex Cache Optimization" );
+
+   CYD_ASSERT( indices.size() % 3 == 0 && "MeshOptimization: Expected a triangle list" );
+
+   const uint32_t triangleCount = static_cast<uint32_t>( indices.size() / 3 );
+   if( triangleCount == 0 ) return;
+
+   TriangleAdjacency adjacency;
+   BuildAdjacency( indices, vertexCount, adjacency );
+
+   // Triangles left to emit around each vertex
+   std::vector<uint32_t> liveCounts( vertexCount );
+   for( uint32_t v = 0; v < vertexCount; ++v )
+   {
+      liveCounts[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+   }
+
+   std::vector<uint32_t> timestamps( vertexCount, 0 );
+   std::vector<uint8_t> isEmitted( triangleCount, 0 );
+
+   // Vertices of the emitted triangles, to go back to when a fan ends with nothing around it
+   std::vector<uint32_t> deadEnds;
+   std::vector<uint32_t> candidates;
+
+   std::vector<uint32_t> result;
+   result.reserve( indices.size() );
+
+   uint32_t time      = CACHE_SIZE + 1;
+   uint32_t cursor    = 0;
+   uint32_t fanVertex = 0;
+
+   auto skipDeadEnd = [&]()
+   {
+      while( !deadEnds.empty() )
+      {
+         const uint32_t vertex = deadEnds.back();
+         deadEnds.pop_back();
+
+         if( liveCounts[vertex] > 0 ) return vertex;
+      }
+
+      while( cursor < vertexCount )
+      {
+         if( liveCounts[cursor] > 0 ) return cursor;
+         cursor++;
+      }
+
+      return INVALID_VERTEX;
+   };
+
+   while( fanVertex != INVALID_VERTEX )
+   {
+      candidates.clear();
+
+      // Emitting every triangle around the fan vertex
+      for( uint32_t a = adjacency.offsets[fanVertex]; a < adjacency.offsets[fanVertex + 1]; ++a )
+      {
+         const uint32_t triangle = adjacency.triangles[a];
+         if( isEmitted[triangle] ) continue;
+
+         isEmitted[triangle] = 1;
+
+         for( uint32_t k = 0; k < 3; ++k )
+         {
+            const uint32_t vertex = indices[3 * triangle + k];
+            result.push_back( vertex );
+
+            deadEnds.push_back( vertex );
+            candidates.push_back( vertex );
+            liveCounts[vertex]--;
+
+            if( time - timestamps[vertex] > CACHE_SIZE )
+            {
+               timestamps[vertex] = time++;
+            }
+         }
+      }
+
+      // The next fan is the candidate that stays in the cache the longest, as long as its
+      // triangles can all be emitted before it leaves the cache
+      fanVertex         = INVALID_VERTEX;
+      uint32_t bestTime = 0;
+
+      for( const uint32_t vertex : candidates )
+      {
+         if( liveCounts[vertex] == 0 ) continue;
+
+         uint32_t priority = 0;
+         if( time - timestamps[vertex] + 2 * liveCounts[vertex] <= CACHE_SIZE )
+         {
+            priority = time - timestamps[vertex];
+         }
+
+         if( fanVertex == INVALID_VERTEX || priority > bestTime )
+         {
+            fanVertex = vertex;
+            bestTime  = priority;
+         }
+      }
+
+      if( fanVertex == INVALID_VERTEX )
+      {
+         fanVertex = skipDeadEnd();
+      }
+   }
+
+   CYD_ASSERT( result.size() == indices.size() && "MeshOptimization: Triangles were lost" );
+
+   indices = std::move( result );
+}
+
+// ================================================================================================
+void OptimizeOverdraw(
+    const std::vector<Vertex>& vertices,
+    std::vector<uint32_t>& indices,
+    float threshold )
+{
+   CYD_TRACE( "Overdraw Optimization" );
+
+   const uint32_t vertexCount   = static_cast<uint32_t>( vertices.size() );
+   const uint32_t triangleCount = static_cast<uint32_t>( indices.size() / 3 );
+   if( triangleCount == 0 ) return;
+
+   std::vector<uint32_t> timestamps( vertexCount, 0 );
+   uint32_t time = CACHE_SIZE + 1;
+
+   // The cache order starts a new fan from scratch wherever every vertex of a triangle misses,
+   // the triangles in between are hard clusters
+   std::vector<uint32_t> hardClusters;
+   for( uint32_t t = 0; t < triangleCount; ++t )
+   {
+      if( UpdateCache( &indices[3 * t], timestamps, time, CACHE_SIZE ) == 3 || t == 0 )
+      {
+         hardClusters.push_back( t );
+      }
+   }
+   hardClusters.push_back( triangleCount );
+
+   // Hard clusters are split again wherever the triangles before already have a low enough ACMR
+   std::vector<uint32_t> clusters;
+   for( uint32_t c = 0; c + 1 < hardClusters.size(); ++c )
+   {
+      const uint32_t start = hardClusters[c];
+      const uint32_t end   = hardClusters[c + 1];
+
+      time += CACHE_SIZE + 1;
+
+      uint32_t clusterMisses = 0;
+      for( uint32_t t = start; t < end; ++t )
+      {
+         clusterMisses += UpdateCache( &indices[3 * t], timestamps, time, CACHE_SIZE );
+      }
+
+      const float maxAcmr =
+          threshold * static_cast<float>( clusterMisses ) / static_cast<float>( end - start );
+
+      uint32_t splitStart = start;
+      uint32_t misses     = 0;
+      time += CACHE_SIZE + 1;
+
+      for( uint32_t t = start; t < end; ++t )
+      {
+         misses += UpdateCache( &indices[3 * t], timestamps, time, CACHE_SIZE );
+
+         if( static_cast<float>( misses ) <= maxAcmr * static_cast<float>( t + 1 - splitStart ) )
+         {
+            clusters.push_back( splitStart );
+            splitStart = t + 1;
+            misses     = 0;
+            time += CACHE_SIZE + 1;
+         }
+      }
+
+      if( splitStart < end )
+      {
+         clusters.push_back( splitStart );
+      }
+   }
+   clusters.push_back( triangleCount );
+
+   // Centroids are weighted by the area of the triangles
+   struct ClusterInfo
+   {
+      glm::vec3 centroid = glm::vec3( 0.0f );
+      glm::vec3 normal   = glm::vec3( 0.0f );
+      float area         = 0.0f;
+   };
+
+   const uint32_t clusterCount = static_cast<uint32_t>( clusters.size() - 1 );
+   std::vector<ClusterInfo> infos( clusterCount );
+
+   ClusterInfo mesh;
+   for( uint32_t c = 0; c < clusterCount; ++c )
+   {
+      ClusterInfo& info = infos[c];
+
+      for( uint32_t t = clusters[c]; t < clusters[c + 1]; ++t )
+      {
+         const glm::vec3& p0 = vertices[indices[3 * t + 0]].pos;
+         const glm::vec3& p1 = vertices[indices[3 * t + 1]].pos;
+         const glm::vec3& p2 = vertices[indices[3 * t + 2]].pos;
+
+         const glm::vec3 normal = glm::cross( p1 - p0, p2 - p0 );
+         const float area       = glm::length( normal );
+
+         info.centroid += ( p0 + p1 + p2 ) * ( area / 3.0f );
+         info.normal += normal;
+         info.area += area;
+      }
+
+      mesh.centroid += info.centroid;
+      mesh.area += info.area;
+
+      info.centroid = info.area > 0.0f ? info.centroid / info.area : glm::vec3( 0.0f );
+   }
+
+   mesh.centroid = mesh.area > 0.0f ? mesh.centroid / mesh.area : glm::vec3( 0.0f );
+
+   // Clusters facing away from the center are on the outside, they go first
+   std::vector<float> sortKeys( clusterCount );
+   for( uint32_t c = 0; c < clusterCount; ++c )
+   {
+      const float normalLength = glm::length( infos[c].normal );
+      sortKeys[c] =
+          normalLength > 0.0f
+              ? glm::dot( infos[c].centroid - mesh.centroid, infos[c].normal / normalLength )
+              : 0.0f;
+   }
+
+   std::vector<uint32_t> order( clusterCount );
+   std::iota( order.begin(), order.end(), 0 );
+   std::stable_sort(
+       order.begin(),
+       order.end(),
+       [&sortKeys]( uint32_t a, uint32_t b ) { return sortKeys[a] > sortKeys[b]; } );
+
+   std::vector<uint32_t> result;
+   result.reserve( indices.size() );
+
+   for( const uint32_t c : order )
+   {
+      result.insert(
+          result.end(), indices.begin() + 3 * clusters[c], indices.begin() + 3 * clusters[c + 1] );
+   }
+
+   indices = std::move( result );
+}
+
+// ================================================================================================
+void OptimizeVertexFetch( std::vector<Vertex>& vertices, std::vector<uint32_t>& indices )
+{
+   CYD_TRACE( "Vertex Fetch Optimization" );
+
+   std::vector<uint32_t> remap( vertices.size(), INVALID_VERTEX );
+
+   std::vector<Vertex> result;
+   result.reserve( vertices.size() );
+
+   for( uint32_t& index : indices )
+   {
+      if( remap[index] == INVALID_VERTEX )
+      {
+         remap[index] = static_cast<uint32_t>( result.size() );
+         result.push_back( vertices[index] );
+      }
+
+      index = remap[index];
+   }
+
+   vertices = std::move( result );
+}
+
+// ================================================================================================
+void Optimize( std::vector<Vertex>& vertices, std::vector<uint32_t>& indices )
+{
+   OptimizeVertexCache( indices, static_cast<uint32_t>( vertices.size() ) );
+   OptimizeOverdraw( vertices, indices );
+   OptimizeVertexFetch( vertices, indices );
+}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace CYD
+{
+class Vertex;
+
+/*
+Reorders triangle lists for the GPU. The triangles are sorted for the post-transform vertex cache
+with Tipsify (Sander, Nehab and Barczak), then the clusters of that order are sorted so that the
+outer ones, likely to hide the others, come first. The vertices are finally laid out in the order
+the triangles first use them, for the vertex fetch.
+
+The cache is measured with the average cache miss ratio (ACMR), vertices transformed per triangle,
+and the average transform to vertex ratio (ATVR), vertices transformed per vertex used. An ATVR of 1
+is as good as it gets, every vertex is only transformed once.
+*/
+namespace MeshOptimization
+{
+// Of the FIFO cache simulated to sort and measure triangles, recent GPUs have at least this many
+// vertices in flight
+static constexpr uint32_t CACHE_SIZE = 16;
+
+struct VertexCacheStats
+{
+   float acmr = 0.0f;
+   float atvr = 0.0f;
+};
+
+VertexCacheStats AnalyzeVertexCache(
+    const std::vector<uint32_t>& indices,
+    uint32_t vertexCount,
+    uint32_t cacheSize = CACHE_SIZE );
+
+// Sorts the triangles for the vertex cache, they keep their winding
+void OptimizeVertexCache( std::vector<uint32_t>& indices, uint32_t vertexCount );
+
+// Sorts the clusters of triangles sorted for the vertex cache from the outside of the mesh in. A
+// cluster is split when its ACMR can stay under the one of the cluster times the threshold, more
+// clusters lower the overdraw but miss the cache more often
+void OptimizeOverdraw(
+    const std::vector<Vertex>& vertices,
+    std::vector<uint32_t>& indices,
+    float threshold = 1.05f );
+
+// Sorts the vertices in the order they are first used by the indices, the unused ones are removed
+void OptimizeVertexFetch( std::vector<Vertex>& vertices, std::vector<uint32_t>& indices );
+
+// The three of them, for the triangle lists of the mesh cache
+void Optimize( std::vector<Vertex>& vertices, std::vector<uint32_t>& indices );
+}
+}
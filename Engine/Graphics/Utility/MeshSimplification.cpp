@@ -0,0 +1,576 @@
+#include <Graphics/Utility/MeshSimplification.h>
+
+#include <Common/Assert.h>
+
+#include <Graphics/VertexLayout.h>
+
+#include <Profiling.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace CYD::MeshSimplification
+{
+// Border and seam edges are held in place by planes perpendicular to their triangles, weighted
+// above the planes of the surface so that the outline of the mesh is kept
+static constexpr float EDGE_WEIGHT = 10.0f;
+
+// A pass only goes this much above the cost of the last collapse it needs, the other collapses
+// wait for the next pass where their cost is up to date
+static constexpr float PASS_ERROR_SLACK = 1.5f;
+
+// Collapses that turn a triangle by more than about 75 degrees are refused, they fold the surface
+static constexpr float MIN_NORMAL_COS = 0.25f;
+
+// A coarser LOD needs at least this many triangles, and to save enough of them over the previous
+static constexpr uint32_t MIN_LOD_TRIANGLES = 64;
+static constexpr float MAX_LOD_RATIO        = 0.8f;
+
+enum class PointKind : uint8_t
+{
+   MANIFOLD,     // Free to collapse into any neighbour
+   CONSTRAINED,  // On a border or a seam, only collapses along it
+   LOCKED        // Corners of borders and seams, and non-manifold points
+};
+
+// Symmetric 4x4 matrix summing the squared distances to a set of planes, weighted
+struct Quadric
+{
+   float a00 = 0.0f, a11 = 0.0f, a22 = 0.0f;
+   float a10 = 0.0f, a20 = 0.0f, a21 = 0.0f;
+   float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+   float c = 0.0f;
+   float w = 0.0f;
+};
+
+struct Collapse
+{
+   uint32_t from;  // Points, the first vertex of their wedges
+   uint32_t to;
+   float cost;
+};
+
+struct PositionHash
+{
+   size_t operator()( const glm::vec3& p ) const
+   {
+      const uint32_t x = std::bit_cast<uint32_t>( p.x );
+      const uint32_t y = std::bit_cast<uint32_t>( p.y );
+      const uint32_t z = std::bit_cast<uint32_t>( p.z );
+      return ( x * 73856093 ) ^ ( y * 19349663 ) ^ ( z * 83492791 );
+   }
+};
+
+static uint64_t EdgeKey( uint32_t a, uint32_t b ) { return uint64_t( a ) << 32 | b; }
+
+static uint64_t UndirectedEdgeKey( uint32_t a, uint32_t b )
+{
+   return EdgeKey( std::min( a, b ), std::max( a, b ) );
+}
+
+static void AddPlane( Quadric& q, const glm::vec3& n, float d, float weight )
+{
+   q.a00 += weight * n.x * n.x;
+   q.a11 += weight * n.y * n.y;
+   q.a22 += weight * n.z * n.z;
+   q.a10 += weight * n.y * n.x;
+   q.a20 += weight * n.z * n.x;
+   q.a21 += weight * n.z * n.y;
+   q.b0 += weight * n.x * d;
+   q.b1 += weight * n.y * d;
+   q.b2 += weight * n.z * d;
+   q.c += weight * d * d;
+   q.w += weight;
+}
+
+static void AddQuadric( Quadric& q, const Quadric& other )
+{
+   q.a00 += other.a00;
+   q.a11 += other.a11;
+   q.a22 += other.a22;
+   q.a10 += other.a10;
+   q.a20 += other.a20;
+   q.a21 += other.a21;
+   q.b0 += other.b0;
+   q.b1 += other.b1;
+   q.b2 += other.b2;
+   q.c += other.c;
+   q.w += other.w;
+}
+
+// Average squared distance to the planes of the quadric
+static float QuadricError( const Quadric& q, const glm::vec3& p )
+{
+   const float rx = q.a00 * p.x + q.a10 * p.y + q.a20 * p.z;
+   const float ry = q.a10 * p.x + q.a11 * p.y + q.a21 * p.z;
+   const float rz = q.a20 * p.x + q.a21 * p.y + q.a22 * p.z;
+
+   const float r = rx * p.x + ry * p.y + rz * p.z +
+                   2.0f * ( q.b0 * p.x + q.b1 * p.y + q.b2 * p.z ) + q.c;
+
+   return q.w > 0.0f ? std::fabs( r ) / q.w : 0.0f;
+}
+
+static float CollapseCost(
+    const std::vector<Quadric>& quadrics,
+    const std::vector<glm::vec3>& positions,
+    uint32_t from,
+    uint32_t to )
+{
+   Quadric q = quadrics[from];
+   AddQuadric( q, quadrics[to] );
+   return QuadricError( q, positions[to] );
+}
+
+// Triangles around each point, from the offsets of the points in triangles
+static void BuildAdjacency(
+    const std::vector<uint32_t>& points,
+    const std::vector<uint32_t>& indices,
+    std::vector<uint32_t>& offsets,
+    std::vector<uint32_t>& triangles )
+{
+   std::fill( offsets.begin(), offsets.end(), 0 );
+   for( const uint32_t index : indices )
+   {
+      offsets[points[index] + 1]++;
+   }
+
+   for( size_t i = 1; i < offsets.size(); ++i )
+   {
+      offsets[i] += offsets[i - 1];
+   }
+
+   triangles.resize( indices.size() );
+
+   std::vector<uint32_t> fill( offsets.begin(), offsets.end() - 1 );
+   for( uint32_t i = 0; i < indices.size(); ++i )
+   {
+      triangles[fill[points[indices[i]]]++] = i / 3;
+   }
+}
+
+// ================================================================================================
+float Simplify(
+    const std::vector<Vertex>& vertices,
+    const std::vector<uint32_t>& indices,
+    uint32_t targetIndexCount,
+    std::vector<uint32_t>& result )
+{
+   CYD_TRACE( "Mesh Simplify" );
+
+   CYD_ASSERT( indices.size() % 3 == 0 && "MeshSimplification: Expected a triangle list" );
+
+   result = indices;
+
+   const uint32_t vertexCount = static_cast<uint32_t>( vertices.size() );
+   if( vertexCount == 0 || result.size() <= targetIndexCount ) return 0.0f;
+
+   // Positions are normalized so that the quadrics keep their precision at any scale
+   glm::vec3 minPos = vertices[0].pos;
+   glm::vec3 maxPos = vertices[0].pos;
+   for( const Vertex& vertex : vertices )
+   {
+      minPos = glm::min( minPos, vertex.pos );
+      maxPos = glm::max( maxPos, vertex.pos );
+   }
+
+   const glm::vec3 extents = maxPos - minPos;
+   const float scale       = std::max( std::max( extents.x, extents.y ), extents.z );
+   const float invScale    = scale > 0.0f ? 1.0f / scale : 1.0f;
+
+   std::vector<glm::vec3> positions( vertexCount );
+   for( uint32_t i = 0; i < vertexCount; ++i )
+   {
+      // Adding zero turns negative zeros positive, they hash the same as the other zeros
+      positions[i] = ( vertices[i].pos - minPos ) * invScale + 0.0f;
+   }
+
+   // Vertices at the same position are wedges of one point, only differing by their attributes.
+   // Points are named after their first wedge, the wedges of a point are linked in a loop
+   std::vector<uint32_t> points( vertexCount );
+   std::vector<uint32_t> nextWedges( vertexCount );
+   {
+      std::unordered_map<glm::vec3, uint32_t, PositionHash> firstWedges;
+      firstWedges.reserve( vertexCount );
+
+      for( uint32_t i = 0; i < vertexCount; ++i )
+      {
+         const auto [it, isFirst] = firstWedges.emplace( positions[i], i );
+
+         points[i] = it->second;
+         if( isFirst )
+         {
+            nextWedges[i] = i;
+         }
+         else
+         {
+            nextWedges[i]          = nextWedges[it->second];
+            nextWedges[it->second] = i;
+         }
+      }
+   }
+
+   // Quadrics of the points, from the planes of their triangles weighted by area
+   std::vector<Quadric> quadrics( vertexCount );
+
+   for( size_t i = 0; i < result.size(); i += 3 )
+   {
+      const glm::vec3& p0 = positions[result[i + 0]];
+      const glm::vec3& p1 = positions[result[i + 1]];
+      const glm::vec3& p2 = positions[result[i + 2]];
+
+      glm::vec3 normal   = glm::cross( p1 - p0, p2 - p0 );
+      const float length = glm::length( normal );
+      if( length == 0.0f ) continue;
+
+      normal /= length;
+      const float d = -glm::dot( normal, p0 );
+
+      for( uint32_t k = 0; k < 3; ++k )
+      {
+         AddPlane( quadrics[points[result[i + k]]], normal, d, 0.5f * length );
+      }
+   }
+
+   // Edges without a twin going the other way are open. They are on a border, or on a seam when
+   // a triangle on the other side has the twin between other wedges of the same points
+   std::unordered_set<uint64_t> wedgeEdges;
+   std::unordered_set<uint64_t> pointEdges;
+   wedgeEdges.reserve( result.size() );
+   pointEdges.reserve( result.size() );
+
+   for( size_t i = 0; i < result.size(); i += 3 )
+   {
+      for( uint32_t k = 0; k < 3; ++k )
+      {
+         const uint32_t a = result[i + k];
+         const uint32_t b = result[i + ( k + 1 ) % 3];
+         wedgeEdges.insert( EdgeKey( a, b ) );
+         pointEdges.insert( EdgeKey( points[a], points[b] ) );
+      }
+   }
+
+   std::vector<uint32_t> borderCounts( vertexCount, 0 );
+   std::vector<uint32_t> seamCounts( vertexCount, 0 );
+   std::unordered_set<uint64_t> openEdges;  // Between points
+
+   for( size_t i = 0; i < result.size(); i += 3 )
+   {
+      for( uint32_t k = 0; k < 3; ++k )
+      {
+         const uint32_t a = result[i + k];
+         const uint32_t b = result[i + ( k + 1 ) % 3];
+         if( wedgeEdges.count( EdgeKey( b, a ) ) ) continue;
+
+         const uint32_t pa = points[a];
+         const uint32_t pb = points[b];
+
+         std::vector<uint32_t>& counts =
+             pointEdges.count( EdgeKey( pb, pa ) ) ? seamCounts : borderCounts;
+         counts[pa]++;
+         counts[pb]++;
+
+         openEdges.insert( UndirectedEdgeKey( pa, pb ) );
+
+         const glm::vec3& p0   = positions[a];
+         const glm::vec3& p1   = positions[b];
+         const glm::vec3& p2   = positions[result[i + ( k + 2 ) % 3]];
+         const glm::vec3 edge  = p1 - p0;
+         const glm::vec3 plane = glm::cross( edge, glm::cross( edge, p2 - p0 ) );
+
+         const float length = glm::length( plane );
+         if( length == 0.0f ) continue;
+
+         const glm::vec3 normal = plane / length;
+         const float d          = -glm::dot( normal, p0 );
+         const float weight     = EDGE_WEIGHT * glm::dot( edge, edge );
+
+         AddPlane( quadrics[pa], normal, d, weight );
+         AddPlane( quadrics[pb], normal, d, weight );
+      }
+   }
+
+   // A point in the middle of a border has 2 border edges. In the middle of a seam, it has 2 seam
+   // edges on each side of it. Anything else is a corner or a junction
+   std::vector<PointKind> kinds( vertexCount, PointKind::LOCKED );
+   for( uint32_t i = 0; i < vertexCount; ++i )
+   {
+      if( points[i] != i ) continue;
+
+      const bool isSingleWedge = nextWedges[i] == i;
+
+      if( borderCounts[i] == 0 && seamCounts[i] == 0 )
+      {
+         kinds[i] = isSingleWedge ? PointKind::MANIFOLD : PointKind::LOCKED;
+      }
+      else if(
+          ( borderCounts[i] == 2 && seamCounts[i] == 0 && isSingleWedge ) ||
+          ( seamCounts[i] == 4 && borderCounts[i] == 0 && nextWedges[nextWedges[i]] == i ) )
+      {
+         kinds[i] = PointKind::CONSTRAINED;
+      }
+   }
+
+   auto canCollapse = [&]( uint32_t from, uint32_t to )
+   {
+      return kinds[from] == PointKind::MANIFOLD ||
+             ( kinds[from] == PointKind::CONSTRAINED &&
+               openEdges.count( UndirectedEdgeKey( from, to ) ) );
+   };
+
+   std::vector<uint32_t> adjacencyOffsets( vertexCount + 1 );
+   std::vector<uint32_t> adjacency;
+   std::vector<uint32_t> wedgeRemap( vertexCount );
+   std::vector<uint8_t> isTouched( vertexCount );
+   std::vector<Collapse> collapses;
+
+   // Wedges of a point go to the wedges of the point it collapses into that they share a triangle
+   // with, so that the attributes on each side of a seam stay on their side
+   auto remapWedges = [&]( uint32_t from, uint32_t to )
+   {
+      uint32_t wedge = from;
+      do
+      {
+         bool isUsed  = false;
+         bool isFound = false;
+
+         for( uint32_t a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1] && !isFound;
+              ++a )
+         {
+            const uint32_t* triangle = &result[3 * adjacency[a]];
+            if( triangle[0] != wedge && triangle[1] != wedge && triangle[2] != wedge ) continue;
+
+            isUsed = true;
+            for( uint32_t k = 0; k < 3; ++k )
+            {
+               if( points[triangle[k]] == to )
+               {
+                  wedgeRemap[wedge] = triangle[k];
+                  isFound           = true;
+                  break;
+               }
+            }
+         }
+
+         if( isUsed && !isFound ) return false;
+
+         wedge = nextWedges[wedge];
+      } while( wedge != from );
+
+      return true;
+   };
+
+   auto resetWedges = [&]( uint32_t from )
+   {
+      uint32_t wedge = from;
+      do
+      {
+         wedgeRemap[wedge] = wedge;
+         wedge             = nextWedges[wedge];
+      } while( wedge != from );
+   };
+
+   // Whether moving the point flips one of the triangles that are kept
+   auto hasFlip = [&]( uint32_t from, uint32_t to )
+   {
+      for( uint32_t a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; ++a )
+      {
+         const uint32_t* triangle = &result[3 * adjacency[a]];
+
+         glm::vec3 before[3];
+         glm::vec3 after[3];
+         bool isRemoved = false;
+
+         for( uint32_t k = 0; k < 3; ++k )
+         {
+            const uint32_t point = points[triangle[k]];
+            isRemoved |= point == to;
+            before[k] = positions[point];
+            after[k]  = point == from ? positions[to] : before[k];
+         }
+
+         if( isRemoved ) continue;
+
+         const glm::vec3 n0 = glm::cross( before[1] - before[0], before[2] - before[0] );
+         const glm::vec3 n1 = glm::cross( after[1] - after[0], after[2] - after[0] );
+
+         if( glm::dot( n0, n1 ) < MIN_NORMAL_COS * glm::length( n0 ) * glm::length( n1 ) )
+         {
+            return true;
+         }
+      }
+
+      return false;
+   };
+
+   float maxCost = 0.0f;
+
+   while( result.size() > targetIndexCount )
+   {
+      const uint32_t triangleCount  = static_cast<uint32_t>( result.size() / 3 );
+      const uint32_t trianglesToCut = triangleCount - targetIndexCount / 3;
+
+      BuildAdjacency( points, result, adjacencyOffsets, adjacency );
+
+      // Every edge is seen from both of its triangles, the second one finds its points touched
+      collapses.clear();
+      for( size_t i = 0; i < result.size(); i += 3 )
+      {
+         for( uint32_t k = 0; k < 3; ++k )
+         {
+            const uint32_t a = points[result[i + k]];
+            const uint32_t b = points[result[i + ( k + 1 ) % 3]];
+
+            const bool canCollapseA = canCollapse( a, b );
+            const bool canCollapseB = canCollapse( b, a );
+            if( !canCollapseA && !canCollapseB ) continue;
+
+            const float costA = canCollapseA ? CollapseCost( quadrics, positions, a, b ) : 0.0f;
+            const float costB = canCollapseB ? CollapseCost( quadrics, positions, b, a ) : 0.0f;
+
+            if( canCollapseA && ( !canCollapseB || costA <= costB ) )
+            {
+               collapses.push_back( { a, b, costA } );
+            }
+            else
+            {
+               collapses.push_back( { b, a, costB } );
+            }
+         }
+      }
+
+      if( collapses.empty() ) break;
+
+      std::sort(
+          collapses.begin(),
+          collapses.end(),
+          []( const Collapse& lhs, const Collapse& rhs ) { return lhs.cost < rhs.cost; } );
+
+      // A collapse removes about 2 triangles
+      const size_t neededCollapses =
+          std::min<size_t>( ( trianglesToCut + 1 ) / 2, collapses.size() );
+      const float costLimit = collapses[neededCollapses - 1].cost * PASS_ERROR_SLACK;
+
+      std::fill( isTouched.begin(), isTouched.end(), uint8_t( 0 ) );
+      for( uint32_t i = 0; i < vertexCount; ++i )
+      {
+         wedgeRemap[i] = i;
+      }
+
+      uint32_t cutTriangles = 0;
+      uint32_t appliedCount = 0;
+
+      for( const Collapse& collapse : collapses )
+      {
+         if( collapse.cost > costLimit || cutTriangles >= trianglesToCut ) break;
+         if( isTouched[collapse.from] || isTouched[collapse.to] ) continue;
+
+         if( !remapWedges( collapse.from, collapse.to ) || hasFlip( collapse.from, collapse.to ) )
+         {
+            resetWedges( collapse.from );
+            continue;
+         }
+
+         for( uint32_t a = adjacencyOffsets[collapse.from];
+              a < adjacencyOffsets[collapse.from + 1];
+              ++a )
+         {
+            const uint32_t* triangle = &result[3 * adjacency[a]];
+
+            bool isRemoved = false;
+            for( uint32_t k = 0; k < 3; ++k )
+            {
+               const uint32_t point = points[triangle[k]];
+               isRemoved |= point == collapse.to;
+
+               // The open edges of the point move with it
+               if( kinds[collapse.from] == PointKind::CONSTRAINED && point != collapse.to &&
+                   point != collapse.from &&
+                   openEdges.count( UndirectedEdgeKey( collapse.from, point ) ) )
+               {
+                  openEdges.insert( UndirectedEdgeKey( collapse.to, point ) );
+               }
+            }
+
+            cutTriangles += isRemoved ? 1 : 0;
+         }
+
+         AddQuadric( quadrics[collapse.to], quadrics[collapse.from] );
+
+         isTouched[collapse.from] = 1;
+         isTouched[collapse.to]   = 1;
+
+         maxCost = std::max( maxCost, collapse.cost );
+         appliedCount++;
+      }
+
+      if( appliedCount == 0 ) break;
+
+      // Triangles that lost an edge are gone
+      size_t writeIdx = 0;
+      for( size_t i = 0; i < result.size(); i += 3 )
+      {
+         const uint32_t i0 = wedgeRemap[result[i + 0]];
+         const uint32_t i1 = wedgeRemap[result[i + 1]];
+         const uint32_t i2 = wedgeRemap[result[i + 2]];
+
+         if( points[i0] == points[i1] || points[i1] == points[i2] || points[i0] == points[i2] )
+         {
+            continue;
+         }
+
+         result[writeIdx++] = i0;
+         result[writeIdx++] = i1;
+         result[writeIdx++] = i2;
+      }
+
+      result.resize( writeIdx );
+   }
+
+   return std::sqrt( maxCost ) * scale;
+}
+
+uint32_t GenerateLods(
+    const std::vector<Vertex>& vertices,
+    const std::vector<uint32_t>& indices,
+    std::vector<uint32_t>& lodIndices,
+    std::array<MeshLod, MAX_MESH_LODS>& lods )
+{
+   CYD_TRACE( "Mesh LODs" );
+
+   lodIndices = indices;
+   lods[0]    = { 0, static_cast<uint32_t>( indices.size() ), 0.0f };
+
+   uint32_t lodCount = 1;
+   float error       = 0.0f;
+
+   std::vector<uint32_t> previous = indices;
+   std::vector<uint32_t> simplified;
+
+   while( lodCount < MAX_MESH_LODS )
+   {
+      const uint32_t targetTriangles = static_cast<uint32_t>( previous.size() / 6 );
+      if( targetTriangles < MIN_LOD_TRIANGLES ) break;
+
+      // Simplifying the previous LOD is faster than starting over from the full detail mesh, the
+      // errors add up to a bound of the distance to it
+      error += Simplify( vertices, previous, 3 * targetTriangles, simplified );
+
+      if( simplified.size() > MAX_LOD_RATIO * previous.size() ) break;
+
+      lods[lodCount] = {
+          static_cast<uint32_t>( lodIndices.size() ),
+          static_cast<uint32_t>( simplified.size() ),
+          error };
+      lodCount++;
+
+      lodIndices.insert( lodIndices.end(), simplified.begin(), simplified.end() );
+      std::swap( previous, simplified );
+   }
+
+   return lodCount;
+}
+}
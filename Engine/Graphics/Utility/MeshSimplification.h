@@ -0,0 +1,38 @@
+#pragma once
+
+#include <Graphics/Scene/Mesh.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace CYD
+{
+class Vertex;
+
+/*
+Mesh simplification with quadric error metrics (Garland and Heckbert). Edges are collapsed into one
+of their vertices, the simplified meshes keep the vertices they were given and only reference fewer
+of them. Vertices on borders and on attribute seams (UVs, normals) only move along them, corners
+of borders and seams never move.
+*/
+namespace MeshSimplification
+{
+// Collapses edges until the triangle list is down to the target index count or no edge can be
+// collapsed anymore. Returns the error of the simplified mesh, the largest distance it moved away
+// from the surface it was given, in the units of the vertices
+float Simplify(
+    const std::vector<Vertex>& vertices,
+    const std::vector<uint32_t>& indices,
+    uint32_t targetIndexCount,
+    std::vector<uint32_t>& result );
+
+// Chain of LODs each with half of the triangles of the previous one, stopping early when a mesh
+// cannot be simplified much further. The index lists of all the LODs follow each other in
+// lodIndices, the first LOD is the full detail mesh. Returns the number of LODs
+uint32_t GenerateLods(
+    const std::vector<Vertex>& vertices,
+    const std::vector<uint32_t>& indices,
+    std::vector<uint32_t>& lodIndices,
+    std::array<MeshLod, MAX_MESH_LODS>& lods );
+}
+}
@@ -1,6 +1,8 @@
 #include <Graphics/Utility/Noise.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <random>
 
 namespace CYD::Noise
@@ -20,6 +22,24 @@ const char* s_noiseNames[] =
 static_assert( ARRSIZE( s_noisePipelines ) == static_cast<size_t>( Type::COUNT ) );
 static_assert( ARRSIZE( s_noiseNames ) == static_cast<size_t>( Type::COUNT ) );
 
+static float Fract( float x ) { return x - std::floor( x ); }
+static float Mod289( float x ) { return x - std::floor( x * ( 1.0f / 289.0f ) ) * 289.0f; }
+static float Permute( float x ) { return Mod289( ( ( x * 34.0f ) + 1.0f ) * x ); }
+
+static float NoiseFinalize( float noiseValue, const ShaderParams& params )
+{
+   noiseValue = std::pow( noiseValue, params.exponent );
+
+   if( std::isnan( noiseValue ) ) noiseValue = 0.0f;
+   if( std::isinf( noiseValue ) ) noiseValue = 1.0f;
+
+   noiseValue = std::clamp( noiseValue, 0.0f, 1.0f );
+
+   if( params.invert ) noiseValue = 1.0f - noiseValue;
+
+   return noiseValue;
+}
+
 void Initialize()
 {
    if( !s_initialized )
@@ -51,4 +71,94 @@ PipelineIndex GetPipeline( Type type )
    const uint32_t typeIdx = static_cast<uint32_t>( type );
    return s_noisePipelines[typeIdx];
 }
+
+// ================================================================================================
+float SimplexNoise( const glm::vec2& v )
+{
+   // Skewed triangular grid, see SimplexNoise in NOISE.h
+   const float cx = 0.211324865405187f;   // (3.0-sqrt(3.0))/6.0
+   const float cy = 0.366025403784439f;   // 0.5*(sqrt(3.0)-1.0)
+   const float cz = -0.577350269189626f;  // -1.0 + 2.0 * C.x
+   const float cw = 0.024390243902439f;   // 1.0 / 41.0
+
+   // First corner
+   glm::vec2 i        = glm::floor( v + glm::dot( v, glm::vec2( cy ) ) );
+   const glm::vec2 x0 = v - i + glm::dot( i, glm::vec2( cx ) );
+
+   // Other two corners
+   const glm::vec2 i1 = x0.x > x0.y ? glm::vec2( 1.0f, 0.0f ) : glm::vec2( 0.0f, 1.0f );
+   const glm::vec2 x1 = x0 + cx - i1;
+   const glm::vec2 x2 = x0 + cz;
+
+   i.x = Mod289( i.x );
+   i.y = Mod289( i.y );
+
+   const glm::vec3 p = glm::vec3(
+       Permute( Permute( i.y ) + i.x ),
+       Permute( Permute( i.y + i1.y ) + i.x + i1.x ),
+       Permute( Permute( i.y + 1.0f ) + i.x + 1.0f ) );
+
+   glm::vec3 m = glm::max(
+       0.5f - glm::vec3( glm::dot( x0, x0 ), glm::dot( x1, x1 ), glm::dot( x2, x2 ) ), 0.0f );
+   m = m * m;
+   m = m * m;
+
+   // Gradients, 41 points over a line mapped onto a diamond
+   const glm::vec3 x =
+       2.0f * glm::vec3( Fract( p.x * cw ), Fract( p.y * cw ), Fract( p.z * cw ) ) - 1.0f;
+   const glm::vec3 h  = glm::abs( x ) - 0.5f;
+   const glm::vec3 ox = glm::floor( x + 0.5f );
+   const glm::vec3 a0 = x - ox;
+
+   m *= 1.79284291400159f - 0.85373472095314f * ( a0 * a0 + h * h );
+
+   const glm::vec3 g = glm::vec3(
+       a0.x * x0.x + h.x * x0.y, a0.y * x1.x + h.y * x1.y, a0.z * x2.x + h.z * x2.y );
+
+   return 130.0f * glm::dot( m, g );
+}
+
+float SimplexFBM( glm::vec2 uv, const ShaderParams& params )
+{
+   float finalNoise = 0.0f;
+
+   float frequency = params.frequency;
+   float amplitude = params.amplitude;
+
+   // uv * rot in GLSL, the row vector goes through the columns of the rotation
+   const float rotCos = std::cos( 0.5f );
+   const float rotSin = std::sin( 0.5f );
+
+   for( uint32_t i = 0; i < params.octaves; ++i )
+   {
+      float noiseValue = SimplexNoise( uv * frequency );
+      noiseValue       = params.ridged ? std::abs( noiseValue ) : noiseValue * 0.5f + 0.5f;
+
+      finalNoise += amplitude * noiseValue;
+
+      amplitude *= params.gain;
+      frequency *= params.lacunarity;
+
+      uv = glm::vec2( rotCos * uv.x + rotSin * uv.y, -rotSin * uv.x + rotCos * uv.y );
+   }
+
+   return NoiseFinalize( finalNoise, params );
+}
+
+void GenerateSimplex( uint32_t width, uint32_t height, const ShaderParams& params, float* values )
+{
+   const glm::vec2 dims = glm::vec2( width, height );
+
+   for( uint32_t y = 0; y < height; ++y )
+   {
+      for( uint32_t x = 0; x < width; ++x )
+      {
+         // Aspect ratio corrected
+         const glm::vec2 uv =
+             glm::vec2( x, y ) / dims * glm::vec2( dims.x / dims.y, 1.0f ) + params.seed;
+
+         values[y * width + x] = SimplexFBM( uv, params );
+      }
+   }
+}
 }
\ No newline at end of file
@@ -49,5 +49,13 @@ void Uninitialize();
 float GenerateRandomSeed();
 
 PipelineIndex GetPipeline( Type type );
+
+// CPU versions of the noise shaders, for the systems that need to know the values on the CPU. Keep
+// in sync with NOISE.h
+float SimplexNoise( const glm::vec2& v );
+float SimplexFBM( glm::vec2 uv, const ShaderParams& params );
+
+// Same values as SIMPLEX_NOISE.comp writes in a texture of this size, row major
+void GenerateSimplex( uint32_t width, uint32_t height, const ShaderParams& params, float* values );
 }
 }
\ No newline at end of file
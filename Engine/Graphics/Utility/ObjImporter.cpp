@@ -0,0 +1,648 @@
+#include <Graphics/Utility/ObjImporter.h>
+
+#include <Common/Assert.h>
+
+#include <Graphics/Utility/GraphicsIO.h>
+#include <Graphics/VertexLayout.h>
+
+#include <IO/VirtualFileSystem.h>
+#include <Multithreading/ThreadPool.h>
+
+#include <Profiling.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+namespace CYD::ObjImporter
+{
+static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+// Chunks are cut in more pieces than there are workers to even out their load, but not so small
+// that handing them out costs more than parsing them
+static constexpr size_t MIN_CHUNK_SIZE      = 256 * 1024;
+static constexpr uint32_t CHUNKS_PER_WORKER = 4;
+static constexpr uint32_t CORNERS_PER_BLOCK = 64 * 1024;
+static constexpr uint32_t MAX_SHARD_BITS    = 6;
+
+// Lines of the file parsed by the same worker
+struct Chunk
+{
+   const char* begin = nullptr;
+   const char* end   = nullptr;
+
+   // Counted by the first pass, the first ones are the sums of the counts of the previous chunks
+   uint32_t positionCount = 0;
+   uint32_t uvCount       = 0;
+   uint32_t normalCount   = 0;
+   uint32_t cornerCount   = 0;
+   uint32_t firstPosition = 0;
+   uint32_t firstUv       = 0;
+   uint32_t firstNormal   = 0;
+   uint32_t firstCorner   = 0;
+
+   bool isValid = true;
+};
+
+// Attributes of a corner of a triangle, the UV and normal are optional
+struct Corner
+{
+   uint32_t position = INVALID_INDEX;
+   uint32_t uv       = INVALID_INDEX;
+   uint32_t normal   = INVALID_INDEX;
+
+   bool operator==( const Corner& other ) const
+   {
+      return position == other.position && uv == other.uv && normal == other.normal;
+   }
+};
+
+struct ObjData
+{
+   std::vector<glm::vec3> positions;
+   std::vector<glm::vec2> uvs;  // Already flipped for the top-left origin of the textures
+   std::vector<glm::vec3> normals;
+   std::vector<Corner> corners;
+};
+
+struct TableEntry
+{
+   uint32_t hash   = 0;
+   uint32_t corner = INVALID_INDEX;  // First corner of the vertex
+};
+
+// ================================================================================================
+// Parallel work
+// ================================================================================================
+static uint32_t GetWorkerCount( const EMP::ThreadPool& threadPool )
+{
+   return threadPool.isInit() ? threadPool.getThreadCount() + 1 : 1;
+}
+
+// ================================================================================================
+// Parsing
+// ================================================================================================
+enum class LineType
+{
+   POSITION,
+   UV,
+   NORMAL,
+   FACE,
+   OTHER
+};
+
+static bool IsSpace( char c ) { return c == ' ' || c == '\t'; }
+static bool IsLineEnd( char c ) { return c == '\n' || c == '\r' || c == '#'; }
+
+static const char* SkipSpaces( const char* c, const char* end )
+{
+   while( c < end && IsSpace( *c ) ) ++c;
+   return c;
+}
+
+static const char* SkipToken( const char* c, const char* end )
+{
+   while( c < end && !IsSpace( *c ) && *c != '\n' && *c != '\r' ) ++c;
+   return c;
+}
+
+static const char* SkipLine( const char* c, const char* end )
+{
+   const void* lineEnd = std::memchr( c, '\n', end - c );
+   return lineEnd ? static_cast<const char*>( lineEnd ) + 1 : end;
+}
+
+// Reads the keyword of the line and moves past it
+static LineType ReadLineType( const char*& c, const char* end )
+{
+   c = SkipSpaces( c, end );
+
+   const auto isKeyword = [&]( const char* keyword, size_t length )
+   {
+      return size_t( end - c ) > length && std::memcmp( c, keyword, length ) == 0 &&
+             IsSpace( c[length] );
+   };
+
+   LineType type = LineType::OTHER;
+   size_t length = 0;
+
+   if( isKeyword( "v", 1 ) )
+   {
+      type   = LineType::POSITION;
+      length = 1;
+   }
+   else if( isKeyword( "vt", 2 ) )
+   {
+      type   = LineType::UV;
+      length = 2;
+   }
+   else if( isKeyword( "vn", 2 ) )
+   {
+      type   = LineType::NORMAL;
+      length = 2;
+   }
+   else if( isKeyword( "f", 1 ) )
+   {
+      type   = LineType::FACE;
+      length = 1;
+   }
+
+   c += length;
+
+   return type;
+}
+
+static bool IsDigit( char c ) { return c >= '0' && c <= '9'; }
+
+// Decimals exported by most tools fit the fast path of Clinger: when the digits and the power of
+// ten are both exact in a float, their quotient is rounded correctly. The others go through
+// from_chars. Missing components are left to zero
+static const char* ParseFloat( const char* c, const char* end, float& value )
+{
+   static constexpr float POWERS_OF_TEN[] = {
+       1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+   static constexpr uint32_t MAX_EXACT_DIGITS = 1 << 24;
+
+   c = SkipSpaces( c, end );
+   if( c < end && *c == '+' ) ++c;
+
+   const char* start     = c;
+   const bool isNegative = c < end && *c == '-';
+   if( isNegative ) ++c;
+
+   uint64_t digits       = 0;
+   uint32_t digitCount   = 0;
+   uint32_t decimalCount = 0;
+
+   for( ; c < end && IsDigit( *c ) && digitCount < 16; ++c, ++digitCount )
+   {
+      digits = digits * 10 + ( *c - '0' );
+   }
+
+   if( c < end && *c == '.' )
+   {
+      for( ++c; c < end && IsDigit( *c ) && digitCount < 16; ++c, ++digitCount, ++decimalCount )
+      {
+         digits = digits * 10 + ( *c - '0' );
+      }
+   }
+
+   const bool isExact = digitCount > 0 && digits <= MAX_EXACT_DIGITS &&
+                        decimalCount < std::size( POWERS_OF_TEN ) &&
+                        ( c == end || ( !IsDigit( *c ) && *c != 'e' && *c != 'E' ) );
+
+   if( !isExact )
+   {
+      value = 0.0f;
+      return std::from_chars( start, end, value ).ptr;
+   }
+
+   value = float( digits ) / POWERS_OF_TEN[decimalCount];
+   if( isNegative ) value = -value;
+
+   return c;
+}
+
+static const char* ParseInt( const char* c, const char* end, int64_t& value )
+{
+   const bool isNegative = c < end && *c == '-';
+   if( isNegative ) ++c;
+
+   value = 0;
+   for( ; c < end && IsDigit( *c ); ++c )
+   {
+      value = value * 10 + ( *c - '0' );
+   }
+
+   if( isNegative ) value = -value;
+
+   return c;
+}
+
+// OBJ indices start at 1, negative ones count back from the last attribute read before the face
+static uint32_t ResolveIndex( int64_t index, uint32_t readCount, uint32_t totalCount )
+{
+   const int64_t resolved = index > 0 ? index - 1 : int64_t( readCount ) + index;
+   return resolved >= 0 && resolved < totalCount ? uint32_t( resolved ) : INVALID_INDEX;
+}
+
+static uint32_t CountFaceCorners( const char* c, const char* end )
+{
+   uint32_t cornerCount = 0;
+   for( c = SkipSpaces( c, end ); c < end && !IsLineEnd( *c ); c = SkipSpaces( c, end ) )
+   {
+      c = SkipToken( c, end );
+      cornerCount++;
+   }
+
+   // In a fan of triangles
+   return cornerCount >= 3 ? 3 * ( cornerCount - 2 ) : 0;
+}
+
+static void CountChunk( Chunk& chunk )
+{
+   for( const char* c = chunk.begin; c < chunk.end; c = SkipLine( c, chunk.end ) )
+   {
+      switch( ReadLineType( c, chunk.end ) )
+      {
+         case LineType::POSITION:
+            chunk.positionCount++;
+            break;
+         case LineType::UV:
+            chunk.uvCount++;
+            break;
+         case LineType::NORMAL:
+            chunk.normalCount++;
+            break;
+         case LineType::FACE:
+            chunk.cornerCount += CountFaceCorners( c, chunk.end );
+            break;
+         case LineType::OTHER:
+            break;
+      }
+   }
+}
+
+static void ParseChunk( Chunk& chunk, ObjData& obj )
+{
+   const uint32_t positionCount = static_cast<uint32_t>( obj.positions.size() );
+   const uint32_t uvCount       = static_cast<uint32_t>( obj.uvs.size() );
+   const uint32_t normalCount   = static_cast<uint32_t>( obj.normals.size() );
+
+   glm::vec3* position = obj.positions.data() + chunk.firstPosition;
+   glm::vec2* uv       = obj.uvs.data() + chunk.firstUv;
+   glm::vec3* normal   = obj.normals.data() + chunk.firstNormal;
+   Corner* corner      = obj.corners.data() + chunk.firstCorner;
+
+   for( const char* c = chunk.begin; c < chunk.end; c = SkipLine( c, chunk.end ) )
+   {
+      switch( ReadLineType( c, chunk.end ) )
+      {
+         case LineType::POSITION:
+            c = ParseFloat( c, chunk.end, position->x );
+            c = ParseFloat( c, chunk.end, position->y );
+            c = ParseFloat( c, chunk.end, position->z );
+            position++;
+            break;
+         case LineType::UV:
+            c     = ParseFloat( c, chunk.end, uv->x );
+            c     = ParseFloat( c, chunk.end, uv->y );
+            uv->y = 1.0f - uv->y;
+            uv++;
+            break;
+         case LineType::NORMAL:
+            c = ParseFloat( c, chunk.end, normal->x );
+            c = ParseFloat( c, chunk.end, normal->y );
+            c = ParseFloat( c, chunk.end, normal->z );
+            normal++;
+            break;
+         case LineType::FACE:
+         {
+            // A token is a corner, faces of less than 3 corners have no triangle like in the count
+            const uint32_t positionsRead = uint32_t( position - obj.positions.data() );
+            const uint32_t uvsRead       = uint32_t( uv - obj.uvs.data() );
+            const uint32_t normalsRead   = uint32_t( normal - obj.normals.data() );
+
+            Corner first;
+            Corner previous;
+            uint32_t cornerIdx = 0;
+
+            for( c = SkipSpaces( c, chunk.end ); c < chunk.end && !IsLineEnd( *c );
+                 c = SkipSpaces( c, chunk.end ) )
+            {
+               int64_t index = 0;
+               Corner current;
+
+               c                = ParseInt( c, chunk.end, index );
+               current.position = ResolveIndex( index, positionsRead, positionCount );
+               chunk.isValid &= current.position != INVALID_INDEX;
+
+               if( c < chunk.end && *c == '/' )
+               {
+                  c = ParseInt( c + 1, chunk.end, index );
+                  if( index != 0 )
+                  {
+                     current.uv = ResolveIndex( index, uvsRead, uvCount );
+                     chunk.isValid &= current.uv != INVALID_INDEX;
+                  }
+               }
+
+               if( c < chunk.end && *c == '/' )
+               {
+                  c = ParseInt( c + 1, chunk.end, index );
+                  if( index != 0 )
+                  {
+                     current.normal = ResolveIndex( index, normalsRead, normalCount );
+                     chunk.isValid &= current.normal != INVALID_INDEX;
+                  }
+               }
+
+               c = SkipToken( c, chunk.end );
+
+               if( cornerIdx == 0 )
+               {
+                  first = current;
+               }
+               else if( cornerIdx >= 2 )
+               {
+                  corner[0] = first;
+                  corner[1] = previous;
+                  corner[2] = current;
+                  corner += 3;
+               }
+
+               previous = current;
+               cornerIdx++;
+            }
+            break;
+         }
+         case LineType::OTHER:
+            break;
+      }
+   }
+}
+
+// Cuts the file after line ends
+static std::vector<Chunk> SplitInChunks( const char* data, size_t size, uint32_t chunkCount )
+{
+   std::vector<Chunk> chunks;
+   chunks.reserve( chunkCount );
+
+   const char* end   = data + size;
+   const char* begin = data;
+
+   for( uint32_t chunkIdx = 1; chunkIdx <= chunkCount && begin < end; ++chunkIdx )
+   {
+      const char* chunkEnd = std::max( begin, data + size * chunkIdx / chunkCount );
+      if( chunkEnd < end )
+      {
+         chunkEnd = SkipLine( chunkEnd, end );
+      }
+
+      chunks.push_back( { begin, chunkEnd } );
+      begin = chunkEnd;
+   }
+
+   return chunks;
+}
+
+// ================================================================================================
+// Vertex merging
+// ================================================================================================
+static Vertex GetVertex( const ObjData& obj, const Corner& corner )
+{
+   Vertex vertex;
+   vertex.pos = obj.positions[corner.position];
+   vertex.normal =
+       corner.normal != INVALID_INDEX ? obj.normals[corner.normal] : glm::vec3( 0.0f );
+   vertex.uv =
+       corner.uv != INVALID_INDEX ? glm::vec3( obj.uvs[corner.uv], 0.0f ) : glm::vec3( 0.0f );
+
+   return vertex;
+}
+
+// FNV-1a on every component of the vertex followed by the finalizer of MurmurHash3. Zeroes of
+// both signs compare equal, they are hashed the same
+static uint32_t HashVertex( const Vertex& vertex )
+{
+   const float components[] = {
+       vertex.pos.x,
+       vertex.pos.y,
+       vertex.pos.z,
+       vertex.normal.x,
+       vertex.normal.y,
+       vertex.normal.z,
+       vertex.uv.x,
+       vertex.uv.y,
+       vertex.uv.z,
+       vertex.col.r,
+       vertex.col.g,
+       vertex.col.b,
+       vertex.col.a };
+
+   uint64_t hash = 14695981039346656037ull;
+   for( float component : components )
+   {
+      if( component == 0.0f ) component = 0.0f;
+
+      uint32_t bits;
+      std::memcpy( &bits, &component, sizeof( bits ) );
+      hash = ( hash ^ bits ) * 1099511628211ull;
+   }
+
+   hash ^= hash >> 33;
+   hash *= 0xff51afd7ed558ccdull;
+   hash ^= hash >> 33;
+
+   return static_cast<uint32_t>( hash );
+}
+
+static bool IsSameVertex( const ObjData& obj, const Corner& a, const Corner& b )
+{
+   return a == b || GetVertex( obj, a ) == GetVertex( obj, b );
+}
+
+// Points every corner of the shard to the first corner with the same vertex, returns how many
+// vertices the shard has
+static uint32_t MergeShard(
+    const ObjData& obj,
+    const std::vector<uint32_t>& hashes,
+    uint32_t shard,
+    uint32_t shardBits,
+    std::vector<uint32_t>& firstCorners )
+{
+   const uint32_t cornerCount = static_cast<uint32_t>( obj.corners.size() );
+
+   // Most meshes have a vertex for every 4 to 6 corners, the table grows when it has more
+   uint32_t capacity = 64;
+   while( capacity < ( cornerCount >> shardBits ) / 2 ) capacity *= 2;
+
+   std::vector<TableEntry> table( capacity );
+   uint32_t vertexCount = 0;
+
+   for( uint32_t cornerIdx = 0; cornerIdx < cornerCount; ++cornerIdx )
+   {
+      const uint32_t hash = hashes[cornerIdx];
+      if( shardBits && ( hash >> ( 32 - shardBits ) ) != shard ) continue;
+
+      // At most half full
+      if( 2 * ( vertexCount + 1 ) > table.size() )
+      {
+         std::vector<TableEntry> grown( 2 * table.size() );
+         const uint32_t grownMask = static_cast<uint32_t>( grown.size() - 1 );
+
+         for( const TableEntry& entry : table )
+         {
+            if( entry.corner == INVALID_INDEX ) continue;
+
+            uint32_t slot = entry.hash & grownMask;
+            while( grown[slot].corner != INVALID_INDEX ) slot = ( slot + 1 ) & grownMask;
+            grown[slot] = entry;
+         }
+
+         table = std::move( grown );
+      }
+
+      const uint32_t mask = static_cast<uint32_t>( table.size() - 1 );
+      for( uint32_t slot = hash & mask;; slot = ( slot + 1 ) & mask )
+      {
+         TableEntry& entry = table[slot];
+         if( entry.corner == INVALID_INDEX )
+         {
+            entry                   = { hash, cornerIdx };
+            firstCorners[cornerIdx] = cornerIdx;
+            vertexCount++;
+            break;
+         }
+
+         if( entry.hash == hash &&
+             IsSameVertex( obj, obj.corners[entry.corner], obj.corners[cornerIdx] ) )
+         {
+            firstCorners[cornerIdx] = entry.corner;
+            break;
+         }
+      }
+   }
+
+   return vertexCount;
+}
+
+// ================================================================================================
+bool Import(
+    const std::string& path,
+    std::vector<Vertex>& vertices,
+    std::vector<uint32_t>& indices,
+    EMP::ThreadPool& threadPool )
+{
+   CYD_TRACE( "Import OBJ" );
+
+   EMP::VirtualFile file;
+   if( !GraphicsIO::GetFileSystem().open( path, file ) )
+   {
+      printf( "ObjImporter: Could not open %s\n", path.c_str() );
+      return false;
+   }
+
+   const uint32_t workerCount = GetWorkerCount( threadPool );
+
+   const char* data = reinterpret_cast<const char*>( file.getData() );
+   const size_t chunkCount =
+       std::clamp<size_t>( file.getSize() / MIN_CHUNK_SIZE, 1, workerCount * CHUNKS_PER_WORKER );
+
+   std::vector<Chunk> chunks =
+       SplitInChunks( data, file.getSize(), static_cast<uint32_t>( chunkCount ) );
+
+   // Counting, then parsing every chunk where it goes
+   // =============================================================================================
+   threadPool.parallelFor(
+       EMP::ThreadPool::Lane::BACKGROUND,
+       static_cast<uint32_t>( chunks.size() ),
+       [&]( uint32_t chunkIdx ) { CountChunk( chunks[chunkIdx] ); } );
+
+   ObjData obj;
+   {
+      uint32_t positionCount = 0;
+      uint32_t uvCount       = 0;
+      uint32_t normalCount   = 0;
+      uint32_t cornerCount   = 0;
+
+      for( Chunk& chunk : chunks )
+      {
+         chunk.firstPosition = positionCount;
+         chunk.firstUv       = uvCount;
+         chunk.firstNormal   = normalCount;
+         chunk.firstCorner   = cornerCount;
+
+         positionCount += chunk.positionCount;
+         uvCount += chunk.uvCount;
+         normalCount += chunk.normalCount;
+         cornerCount += chunk.cornerCount;
+      }
+
+      obj.positions.resize( positionCount );
+      obj.uvs.resize( uvCount );
+      obj.normals.resize( normalCount );
+      obj.corners.resize( cornerCount );
+   }
+
+   threadPool.parallelFor(
+       EMP::ThreadPool::Lane::BACKGROUND,
+       static_cast<uint32_t>( chunks.size() ),
+       [&]( uint32_t chunkIdx ) { ParseChunk( chunks[chunkIdx], obj ); } );
+
+   const bool isValid = std::all_of(
+       chunks.begin(), chunks.end(), []( const Chunk& chunk ) { return chunk.isValid; } );
+
+   if( !isValid )
+   {
+      printf(
+          "ObjImporter: %s has faces using attributes that are not in the file\n", path.c_str() );
+      return false;
+   }
+
+   // Merging the corners in vertices
+   // =============================================================================================
+   const uint32_t cornerCount = static_cast<uint32_t>( obj.corners.size() );
+
+   std::vector<uint32_t> hashes( cornerCount );
+   threadPool.parallelFor(
+       EMP::ThreadPool::Lane::BACKGROUND,
+       ( cornerCount + CORNERS_PER_BLOCK - 1 ) / CORNERS_PER_BLOCK,
+       [&]( uint32_t blockIdx )
+       {
+          const uint32_t first = blockIdx * CORNERS_PER_BLOCK;
+          const uint32_t last  = std::min( first + CORNERS_PER_BLOCK, cornerCount );
+
+          for( uint32_t cornerIdx = first; cornerIdx < last; ++cornerIdx )
+          {
+             hashes[cornerIdx] = HashVertex( GetVertex( obj, obj.corners[cornerIdx] ) );
+          }
+       } );
+
+   // A shard per worker, every corner of a vertex is in the same shard
+   uint32_t shardBits = 0;
+   while( shardBits < MAX_SHARD_BITS && ( 1u << shardBits ) < workerCount ) shardBits++;
+
+   std::vector<uint32_t> firstCorners( cornerCount );
+   std::vector<uint32_t> shardVertexCounts( size_t( 1 ) << shardBits );
+
+   threadPool.parallelFor(
+       EMP::ThreadPool::Lane::BACKGROUND,
+       static_cast<uint32_t>( shardVertexCounts.size() ),
+       [&]( uint32_t shard )
+       { shardVertexCounts[shard] = MergeShard( obj, hashes, shard, shardBits, firstCorners ); } );
+
+   // In the order the corners first use the vertices. The first corner of a vertex is given its
+   // index once it is reached, the corners after it read it back
+   uint32_t vertexCount = 0;
+   for( const uint32_t shardVertexCount : shardVertexCounts )
+   {
+      vertexCount += shardVertexCount;
+   }
+
+   vertices.resize( vertexCount );
+   indices.resize( cornerCount );
+
+   uint32_t vertexIdx = 0;
+   for( uint32_t cornerIdx = 0; cornerIdx < cornerCount; ++cornerIdx )
+   {
+      const uint32_t firstCorner = firstCorners[cornerIdx];
+      if( firstCorner == cornerIdx )
+      {
+         vertices[vertexIdx]     = GetVertex( obj, obj.corners[cornerIdx] );
+         firstCorners[cornerIdx] = vertexIdx++;
+         indices[cornerIdx]      = firstCorners[cornerIdx];
+      }
+      else
+      {
+         indices[cornerIdx] = firstCorners[firstCorner];
+      }
+   }
+
+   CYD_ASSERT( vertexIdx == vertexCount && "ObjImporter: Vertices were lost while merging" );
+
+   return true;
+}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace EMP
+{
+class ThreadPool;
+}
+
+namespace CYD
+{
+class Vertex;
+
+/*
+Wavefront OBJ importer for the meshes loaded from disk. The file is mapped and cut in chunks of
+whole lines parsed by the workers of the thread pool. A first pass counts the attributes and the
+triangles of every chunk, which tells each chunk where to write in arrays allocated once for the
+whole file, and a second pass parses the chunks in place. Polygons are split in fans of triangles.
+
+The corners of the triangles are then merged in vertices, corners with the same attributes giving
+the same vertex. The corners are hashed on the workers and split in shards on their hash, each
+shard being merged in its own open-addressing table. The vertices are in the order the triangles
+first use them, whatever the number of workers.
+
+Only the positions, texture coordinates, normals and faces are read, the rest of the file is
+skipped.
+*/
+namespace ObjImporter
+{
+// Works on the calling thread alone when the thread pool is not initialized. Fails on missing
+// files and on faces using attributes that are not in the file
+bool Import(
+    const std::string& path,
+    std::vector<Vertex>& vertices,
+    std::vector<uint32_t>& indices,
+    EMP::ThreadPool& threadPool );
+}
+}
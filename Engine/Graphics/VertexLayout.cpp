@@ -1,7 +1,81 @@
 #include <Graphics/VertexLayout.h>
 
+#include <Common/Assert.h>
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 namespace CYD
 {
+// Folds a unit vector on the octahedron |x| + |y| + |z| = 1, whose lower half is unfolded over the
+// corners of the upper one. Keep in sync with DecodeOctahedral in VERTEX.h
+static glm::vec2 EncodeOctahedral( const glm::vec3& normal )
+{
+   const float sum   = std::abs( normal.x ) + std::abs( normal.y ) + std::abs( normal.z );
+   const glm::vec3 n = normal / sum;
+   if( n.z >= 0.0f ) return glm::vec2( n.x, n.y );
+
+   return glm::vec2(
+       ( 1.0f - std::abs( n.y ) ) * ( n.x >= 0.0f ? 1.0f : -1.0f ),
+       ( 1.0f - std::abs( n.x ) ) * ( n.y >= 0.0f ? 1.0f : -1.0f ) );
+}
+
+template <typename T>
+static void Write( uint8_t*& destination, const T& value )
+{
+   std::memcpy( destination, &value, sizeof( T ) );
+   destination += sizeof( T );
+}
+
+PositionQuantization PositionQuantization::FromBounds( const glm::vec3& min, const glm::vec3& max )
+{
+   const glm::vec3 extent = max - min;
+   const float scale      = std::max( { extent.x, extent.y, extent.z } );
+
+   PositionQuantization quantization;
+   quantization.offset = min;
+   quantization.scale  = scale > 0.0f ? scale : 1.0f;
+
+   return quantization;
+}
+
+glm::mat4 PositionQuantization::getDequantizationMatrix() const
+{
+   glm::mat4 dequantization( scale );
+   dequantization[3] = glm::vec4( offset, 1.0f );
+
+   return dequantization;
+}
+
+VertexLayout::VertexLayout( VertexFormatFlag format ) : m_format( format )
+{
+   const PixelFormat positionFormat =
+       format & VertexFormat::QUANTIZED_POSITION ? PixelFormat::RGBA16_UNORM : PixelFormat::RGB32F;
+   const PixelFormat normalFormat =
+       format & VertexFormat::OCTAHEDRAL_NORMAL ? PixelFormat::RG16_SNORM : PixelFormat::RGB32F;
+   const PixelFormat uvFormat =
+       format & VertexFormat::HALF_UV ? PixelFormat::RG16F : PixelFormat::RG32F;
+
+   uint32_t offset = 0;
+
+   addAttribute( positionFormat, 0, offset );
+   offset += GetPixelSizeInBytes( positionFormat );
+
+   addAttribute( normalFormat, 1, offset );
+   offset += GetPixelSizeInBytes( normalFormat );
+
+   addAttribute( uvFormat, 2, offset );
+   offset += GetPixelSizeInBytes( uvFormat );
+
+   if( format & VertexFormat::COLOR )
+   {
+      addAttribute( PixelFormat::RGBA8_UNORM, 3, offset );
+   }
+}
+
 void VertexLayout::addAttribute(
     PixelFormat vecFormat,
     uint32_t location,
@@ -10,4 +84,70 @@ void VertexLayout::addAttribute(
 {
    m_attributes.emplace_back( Attribute{ vecFormat, location, offset, binding } );
 }
-}
\ No newline at end of file
+
+uint32_t VertexLayout::getStride() const
+{
+   uint32_t stride = 0;
+   for( const Attribute& attribute : m_attributes )
+   {
+      stride = std::max( stride, attribute.offset + GetPixelSizeInBytes( attribute.vecFormat ) );
+   }
+
+   return stride;
+}
+
+void VertexLayout::pack(
+    const std::vector<Vertex>& vertices,
+    const PositionQuantization& quantization,
+    std::vector<uint8_t>& packed ) const
+{
+   CYD_ASSERT( !m_attributes.empty() && "VertexLayout: Packing without attributes" );
+
+   const uint32_t stride = getStride();
+   packed.resize( vertices.size() * stride );
+
+   uint8_t* destination = packed.data();
+
+   for( const Vertex& vertex : vertices )
+   {
+      if( m_format & VertexFormat::QUANTIZED_POSITION )
+      {
+         const glm::vec3 position = ( vertex.pos - quantization.offset ) / quantization.scale;
+         Write( destination, glm::packUnorm4x16( glm::vec4( position, 0.0f ) ) );
+      }
+      else
+      {
+         Write( destination, vertex.pos );
+      }
+
+      if( m_format & VertexFormat::OCTAHEDRAL_NORMAL )
+      {
+         const float length = glm::length( vertex.normal );
+         const glm::vec2 encoded =
+             length > 0.0f ? EncodeOctahedral( vertex.normal / length ) : glm::vec2( 0.0f );
+
+         Write( destination, glm::packSnorm2x16( encoded ) );
+      }
+      else
+      {
+         Write( destination, vertex.normal );
+      }
+
+      if( m_format & VertexFormat::HALF_UV )
+      {
+         Write( destination, glm::packHalf2x16( glm::vec2( vertex.uv ) ) );
+      }
+      else
+      {
+         Write( destination, glm::vec2( vertex.uv ) );
+      }
+
+      if( m_format & VertexFormat::COLOR )
+      {
+         Write( destination, glm::packUnorm4x8( vertex.col ) );
+      }
+   }
+
+   CYD_ASSERT( destination == packed.data() + packed.size() && "VertexLayout: Unexpected stride" );
+}
+}
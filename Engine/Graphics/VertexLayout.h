@@ -6,12 +6,47 @@
 
 #include <glm/glm.hpp>
 
+#include <vector>
+
 namespace CYD
 {
+class Vertex;
+
+// Attributes of the vertices of a mesh and their encodings, always at the same locations: position
+// at 0, normal at 1, UV at 2 and the optional color at 3. Without any flag, the position, normal
+// and UV are full floats and there is no color
+namespace VertexFormat
+{
+enum VertexFormat : Flag32
+{
+   QUANTIZED_POSITION = 1 << 0,  // 16 bits per axis in the bounds of the mesh
+   OCTAHEDRAL_NORMAL  = 1 << 1,  // Unit vector folded on an octahedron, 16 bits per component
+   HALF_UV            = 1 << 2,
+   COLOR              = 1 << 3,  // 8 bits per channel
+
+   COMPACT = QUANTIZED_POSITION | OCTAHEDRAL_NORMAL | HALF_UV
+};
+}
+using VertexFormatFlag = Flag32;
+
+// Offset and scale bringing quantized positions back to the local space of their mesh. The scale
+// is the same on every axis so that the dequantization can be folded in the model matrix, the
+// normals still point the right way once normalized
+struct PositionQuantization
+{
+   glm::vec3 offset = glm::vec3( 0.0f );
+   float scale      = 1.0f;
+
+   static PositionQuantization FromBounds( const glm::vec3& min, const glm::vec3& max );
+
+   glm::mat4 getDequantizationMatrix() const;
+};
+
 class VertexLayout
 {
   public:
    VertexLayout() = default;
+   explicit VertexLayout( VertexFormatFlag format );
    COPIABLE( VertexLayout );
    virtual ~VertexLayout() = default;
 
@@ -32,11 +67,22 @@ class VertexLayout
 
    const std::vector<Attribute>& getAttributes() const { return m_attributes; }
 
+   // Size of a vertex, for layouts with a single binding
+   uint32_t getStride() const;
+
+   // Encodes vertices for layouts built from a vertex format
+   void pack(
+       const std::vector<Vertex>& vertices,
+       const PositionQuantization& quantization,
+       std::vector<uint8_t>& packed ) const;
+
   private:
    std::vector<Attribute> m_attributes;
+   VertexFormatFlag m_format = 0;
 };
 
-// TODO More flexible vertex layouts
+// Vertex used on the CPU while a mesh is loaded or generated, packed in the vertex format of the
+// mesh when it is uploaded
 class Vertex final
 {
   public:
@@ -69,12 +115,16 @@ struct std::hash<CYD::Vertex>
       hashCombine( seed, vertex.pos.x );
       hashCombine( seed, vertex.pos.y );
       hashCombine( seed, vertex.pos.z );
+      hashCombine( seed, vertex.normal.x );
+      hashCombine( seed, vertex.normal.y );
+      hashCombine( seed, vertex.normal.z );
       hashCombine( seed, vertex.col.r );
       hashCombine( seed, vertex.col.g );
       hashCombine( seed, vertex.col.b );
       hashCombine( seed, vertex.col.a );
       hashCombine( seed, vertex.uv.x );
       hashCombine( seed, vertex.uv.y );
+      hashCombine( seed, vertex.uv.z );
 
       return seed;
    }
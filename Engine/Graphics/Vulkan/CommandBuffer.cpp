@@ -66,43 +66,63 @@ void CommandBuffer::acquire(
     const Device& device,
     const CommandBufferPool& pool,
     CYD::QueueUsageFlag usage,
-    const std::string_view name )
+    const std::string_view name,
+    const CommandBuffer* parent )
 {
    if( _isValidStateTransition( State::ACQUIRED ) )
    {
-      m_pDevice = &device;
-      m_pPool   = &pool;
-      m_usage   = usage;
-      m_name    = name;
+      m_pDevice     = &device;
+      m_pPool       = &pool;
+      m_usage       = usage;
+      m_name        = name;
+      m_isSecondary = parent != nullptr;
 
       VkCommandBufferAllocateInfo allocInfo = {};
       allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
       allocInfo.commandPool                 = m_pPool->getVKCommandPool();
-      allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+      allocInfo.level                       = m_isSecondary ? VK_COMMAND_BUFFER_LEVEL_SECONDARY
+                                                            : VK_COMMAND_BUFFER_LEVEL_PRIMARY;
       allocInfo.commandBufferCount          = 1;
 
       VkResult result =
           vkAllocateCommandBuffers( m_pDevice->getVKDevice(), &allocInfo, &m_vkCmdBuffer );
       CYD_ASSERT( result == VK_SUCCESS && "CommandBuffer: Could not allocate command buffer" );
 
-      VkFenceCreateInfo fenceInfo = {};
-      fenceInfo.sType             = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-
-      result = vkCreateFence( m_pDevice->getVKDevice(), &fenceInfo, nullptr, &m_vkFence );
-      CYD_ASSERT( result == VK_SUCCESS && "CommandBuffer: Could not create fence" );
-
       CYD_ASSERT(
           ( m_semsToSignal.empty() && m_semsToWait.empty() ) &&
           "CommandBuffer: Still have semaphores during acquire" );
 
-      m_semsToSignal.resize( 1 );
+      if( m_isSecondary )
+      {
+         // Inheriting the render pass the parent is currently in, it does not change until the
+         // secondary is executed
+         CYD_ASSERT(
+             parent->m_boundRenderPass && parent->m_secondaryContents &&
+             "CommandBuffer: Parent is not in a render pass with secondary contents" );
+
+         m_boundRenderPass     = parent->m_boundRenderPass;
+         m_boundRenderPassInfo = parent->m_boundRenderPassInfo;
+         m_boundFramebuffer    = parent->m_boundFramebuffer;
+         m_currentSubpass      = parent->m_currentSubpass;
+         m_renderArea          = parent->m_renderArea;
+      }
+      else
+      {
+         VkFenceCreateInfo fenceInfo = {};
+         fenceInfo.sType             = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+         result = vkCreateFence( m_pDevice->getVKDevice(), &fenceInfo, nullptr, &m_vkFence );
+         CYD_ASSERT( result == VK_SUCCESS && "CommandBuffer: Could not create fence" );
 
-      VkSemaphoreCreateInfo semaphoreInfo = {};
-      semaphoreInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+         m_semsToSignal.resize( 1 );
 
-      result = vkCreateSemaphore(
-          m_pDevice->getVKDevice(), &semaphoreInfo, nullptr, &m_semsToSignal[0] );
-      CYD_ASSERT( result == VK_SUCCESS && "CommandBuffer: Could not create semaphore" );
+         VkSemaphoreCreateInfo semaphoreInfo = {};
+         semaphoreInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+         result = vkCreateSemaphore(
+             m_pDevice->getVKDevice(), &semaphoreInfo, nullptr, &m_semsToSignal[0] );
+         CYD_ASSERT( result == VK_SUCCESS && "CommandBuffer: Could not create semaphore" );
+      }
 
       m_defaultSampler = m_pDevice->getSamplerCache().findOrCreate( {} );
 
@@ -134,11 +154,13 @@ void CommandBuffer::free()
 
       m_descSets.clear();
 
-      m_boundPip        = nullptr;
-      m_boundPipLayout  = nullptr;
-      m_boundRenderPass = nullptr;
+      m_boundPip         = nullptr;
+      m_boundPipLayout   = nullptr;
+      m_boundRenderPass  = nullptr;
+      m_boundFramebuffer = nullptr;
 
       m_boundPipInfo.reset();
+      m_boundRenderPassInfo.reset();
 
       vkFreeCommandBuffers(
           m_pDevice->getVKDevice(), m_pPool->getVKCommandPool(), 1, &m_vkCmdBuffer );
@@ -177,9 +199,12 @@ void CommandBuffer::release()
       vkDestroyFence( m_pDevice->getVKDevice(), m_vkFence, nullptr );
       m_vkFence = nullptr;
 
-      // The semaphore to signal at index 0 is always present and is owned by this command
-      // buffer
-      vkDestroySemaphore( m_pDevice->getVKDevice(), m_semsToSignal.front(), nullptr );
+      // The semaphore to signal at index 0 is owned by this command buffer, it is always present
+      // for primaries
+      if( !m_semsToSignal.empty() )
+      {
+         vkDestroySemaphore( m_pDevice->getVKDevice(), m_semsToSignal.front(), nullptr );
+      }
 
       m_stagesToWait.clear();
       m_semsToWait.clear();
@@ -192,7 +217,11 @@ void CommandBuffer::release()
 
 bool CommandBuffer::isCompleted()
 {
-   bool isCompleted = ( vkGetFenceStatus( m_pDevice->getVKDevice(), m_vkFence ) == VK_SUCCESS );
+   // Secondaries are done when nothing uses them anymore, their parent only releases them once it
+   // is done itself
+   bool isCompleted =
+       m_isSecondary ? !inUse()
+                     : ( vkGetFenceStatus( m_pDevice->getVKDevice(), m_vkFence ) == VK_SUCCESS );
 
    if( isCompleted && _isValidStateTransition( State::COMPLETED ) )
    {
@@ -204,6 +233,8 @@ bool CommandBuffer::isCompleted()
 
 void CommandBuffer::waitForCompletion() const
 {
+   CYD_ASSERT( !m_isSecondary && "CommandBuffer: Wait on the parent of a secondary instead" );
+
    vkWaitForFences( m_pDevice->getVKDevice(), 1, &m_vkFence, VK_TRUE, UINT64_MAX );
 }
 
@@ -294,6 +325,19 @@ void CommandBuffer::startRecording()
       beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
       beginInfo.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
+      // Secondaries only record the inside of the render pass of their parent
+      VkCommandBufferInheritanceInfo inheritanceInfo = {};
+      if( m_isSecondary )
+      {
+         inheritanceInfo.sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+         inheritanceInfo.renderPass  = m_boundRenderPass;
+         inheritanceInfo.subpass     = m_currentSubpass;
+         inheritanceInfo.framebuffer = m_boundFramebuffer;
+
+         beginInfo.flags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+         beginInfo.pInheritanceInfo = &inheritanceInfo;
+      }
+
       const VkResult result = vkBeginCommandBuffer( m_vkCmdBuffer, &beginInfo );
       CYD_ASSERT(
           result == VK_SUCCESS && "CommandBuffer: Failed to begin recording of command buffer" );
@@ -576,13 +620,16 @@ void CommandBuffer::beginRendering( Swapchain& swapchain )
 
    m_boundRenderPass     = renderPass;
    m_boundRenderPassInfo = swapchain.getRenderPass();
+   m_boundFramebuffer    = swapchain.getCurrentVKFramebuffer();
+   m_currentSubpass      = 0;
+   m_secondaryContents   = false;
 
    const VkExtent2D& extent = swapchain.getVKExtent();
 
    VkRenderPassBeginInfo passBeginInfo = {};
    passBeginInfo.sType                 = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
    passBeginInfo.renderPass            = m_boundRenderPass;
-   passBeginInfo.framebuffer           = swapchain.getCurrentVKFramebuffer();
+   passBeginInfo.framebuffer           = m_boundFramebuffer;
    passBeginInfo.renderArea.offset     = { 0, 0 };
    passBeginInfo.renderArea.extent     = extent;
 
@@ -600,7 +647,8 @@ void CommandBuffer::beginRendering( Swapchain& swapchain )
 
 void CommandBuffer::beginRendering(
     const CYD::Framebuffer& fb,
-    const std::vector<Texture*>& texTargets )
+    const std::vector<Texture*>& texTargets,
+    bool secondaryContents )
 {
    CYD_ASSERT( !texTargets.empty() && "CommandBuffer: No render targets" );
 
@@ -669,6 +717,7 @@ void CommandBuffer::beginRendering(
    m_boundRenderPassInfo = renderPassInfo;
    m_targets             = texTargets;
    m_currentSubpass      = 0;
+   m_secondaryContents   = secondaryContents;
 
    VkFramebufferCreateInfo framebufferInfo = {};
    framebufferInfo.sType                   = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
@@ -686,6 +735,7 @@ void CommandBuffer::beginRendering(
    CYD_ASSERT( result == VK_SUCCESS && "CommandBuffer: Could not create framebuffer" );
 
    m_curFramebuffers.push_back( vkFramebuffer );
+   m_boundFramebuffer = vkFramebuffer;
 
    VkRenderPassBeginInfo passBeginInfo = {};
    passBeginInfo.sType                 = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -699,7 +749,11 @@ void CommandBuffer::beginRendering(
 
    _setRenderArea( 0, 0, fbWidth, fbHeight );
 
-   vkCmdBeginRenderPass( m_vkCmdBuffer, &passBeginInfo, VK_SUBPASS_CONTENTS_INLINE );
+   vkCmdBeginRenderPass(
+       m_vkCmdBuffer,
+       &passBeginInfo,
+       m_secondaryContents ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                           : VK_SUBPASS_CONTENTS_INLINE );
 }
 
 void CommandBuffer::_setRenderArea( int offsetX, int offsetY, uint32_t width, uint32_t height )
@@ -956,13 +1010,18 @@ void CommandBuffer::dispatch( uint32_t workX, uint32_t workY, uint32_t workZ )
    vkCmdDispatch( m_vkCmdBuffer, workX, workY, workZ );
 }
 
-void CommandBuffer::nextPass() const
+void CommandBuffer::nextPass()
 {
    CYD_ASSERT(
        m_boundRenderPass &&
        "CommandBuffer: Cannot go to the next pass if there was no render pass to begin with!" );
 
-   vkCmdNextSubpass( m_vkCmdBuffer, VK_SUBPASS_CONTENTS_INLINE );
+   vkCmdNextSubpass(
+       m_vkCmdBuffer,
+       m_secondaryContents ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                           : VK_SUBPASS_CONTENTS_INLINE );
+
+   m_currentSubpass++;
 }
 
 void CommandBuffer::endRendering()
@@ -977,15 +1036,44 @@ void CommandBuffer::endRendering()
       texture->setPreviousAccess( m_boundRenderPassInfo->attachments[i].nextAccess );
    }
 
-   m_boundPip        = nullptr;
-   m_boundPipLayout  = nullptr;
-   m_boundRenderPass = nullptr;
+   m_boundPip          = nullptr;
+   m_boundPipLayout    = nullptr;
+   m_boundRenderPass   = nullptr;
+   m_boundFramebuffer  = nullptr;
+   m_secondaryContents = false;
    m_boundPipInfo.reset();
 
    m_targets.clear();
    m_renderArea = {};
 }
 
+void CommandBuffer::executeCommands( const std::vector<CommandBuffer*>& secondaries )
+{
+   CYD_ASSERT(
+       m_boundRenderPass && m_secondaryContents &&
+       "CommandBuffer: Secondaries can only be executed in a render pass with secondary contents" );
+
+   std::vector<VkCommandBuffer> vkCmdBuffers;
+   vkCmdBuffers.reserve( secondaries.size() );
+
+   for( CommandBuffer* secondary : secondaries )
+   {
+      CYD_ASSERT( secondary->isSecondary() && "CommandBuffer: Executing a primary command buffer" );
+
+      secondary->endRecording();
+      vkCmdBuffers.push_back( secondary->m_vkCmdBuffer );
+
+      // Submitted along with this command buffer, which keeps it in use until it is done
+      secondary->_isValidStateTransition( State::SUBMITTED );
+      _addDependency( secondary );
+   }
+
+   if( vkCmdBuffers.empty() ) return;
+
+   vkCmdExecuteCommands(
+       m_vkCmdBuffer, static_cast<uint32_t>( vkCmdBuffers.size() ), vkCmdBuffers.data() );
+}
+
 void CommandBuffer::copyBuffer( Buffer* src, Buffer* dst, const CYD::BufferCopyInfo& info )
 {
    CYD_ASSERT(
@@ -1067,6 +1155,8 @@ void CommandBuffer::copyTexture( Texture* src, Texture* dst, const CYD::TextureC
 
 void CommandBuffer::submit()
 {
+   CYD_ASSERT( !m_isSecondary && "CommandBuffer: Secondaries are executed by their parent" );
+
    if( _isValidStateTransition( State::SUBMITTED ) )
    {
       VkSubmitInfo submitInfo       = {};
@@ -65,11 +65,14 @@ class CommandBuffer final
 
    // Allocation and Deallocation
    // =============================================================================================
+   // With a parent, the command buffer is a secondary continuing the current render pass of the
+   // parent. It has no sync objects and is done executing once its parent is
    void acquire(
        const Device& device,
        const CommandBufferPool& pool,
        CYD::QueueUsageFlag usage,
-       const std::string_view name );
+       const std::string_view name,
+       const CommandBuffer* parent = nullptr );
    void free();     // Releases resources attached to this command buffer
    void release();  // Destroys the sync objects linked to this command buffer
 
@@ -83,6 +86,8 @@ class CommandBuffer final
    VkPipelineStageFlags getWaitStages() const noexcept;
    VkCommandBuffer getVKCmdBuffer() const noexcept { return m_vkCmdBuffer; }
    VkFence getVKFence() const noexcept { return m_vkFence; }
+   const CommandBufferPool* getPool() const noexcept { return m_pPool; }
+   CYD::QueueUsageFlag getUsage() const noexcept { return m_usage; }
 
    // Returns the semaphore that will be signaled when this command buffer is done execution
    VkSemaphore getDoneSemaphore() const;
@@ -94,6 +99,7 @@ class CommandBuffer final
    bool isReleased() const noexcept { return m_state == State::RELEASED; }
    bool isFree() const noexcept { return m_state == State::FREE; }
    bool isSubmitted() const noexcept { return m_state == State::SUBMITTED; }
+   bool isSecondary() const noexcept { return m_isSecondary; }
    bool isCompleted();
    void waitForCompletion() const;  // CPU Spinlock, avoid calling this
 
@@ -135,10 +141,17 @@ class CommandBuffer final
    // Rendering scope
    // =============================================================================================
    void beginRendering( Swapchain& swapchain );
-   void beginRendering( const CYD::Framebuffer& fb, const std::vector<Texture*>& targets );
-   void nextPass() const;
+   void beginRendering(
+       const CYD::Framebuffer& fb,
+       const std::vector<Texture*>& targets,
+       bool secondaryContents = false );
+   void nextPass();
    void endRendering();
 
+   // Ends the recording of the secondaries and executes them in order. The render pass has to be
+   // begun with secondary contents
+   void executeCommands( const std::vector<CommandBuffer*>& secondaries );
+
    // Dynamic State
    // =============================================================================================
    void setViewport( const CYD::Viewport& viewport ) const;
@@ -216,11 +229,13 @@ class CommandBuffer final
    VkPipeline m_boundPip             = nullptr;
    VkPipelineLayout m_boundPipLayout = nullptr;
 
-   VkRenderPass m_boundRenderPass = nullptr;
+   VkRenderPass m_boundRenderPass   = nullptr;
+   VkFramebuffer m_boundFramebuffer = nullptr;
    CYD::Rectangle m_renderArea;
    std::optional<RenderPassInfo> m_boundRenderPassInfo;
    std::vector<Texture*> m_targets;
    uint32_t m_currentSubpass = 0;
+   bool m_secondaryContents  = false;  // Subpasses are recorded in secondary command buffers
 
    // To keep in scope for destruction
    std::vector<VkFramebuffer> m_curFramebuffers;
@@ -272,5 +287,6 @@ class CommandBuffer final
    VkCommandBuffer m_vkCmdBuffer = nullptr;
    VkFence m_vkFence             = nullptr;
    VkSampler m_defaultSampler    = nullptr;
+   bool m_isSecondary            = false;
 };
 }
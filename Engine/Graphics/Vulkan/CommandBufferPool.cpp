@@ -29,7 +29,8 @@ CommandBufferPool::CommandBufferPool(
 
 CommandBuffer* CommandBufferPool::createCommandBuffer(
     CYD::QueueUsageFlag usage,
-    const std::string_view name )
+    const std::string_view name,
+    const CommandBuffer* parent )
 {
    // Check to see if we have a free spot for a command buffer. Either one that is already
    // released or one that has been completed, freed and is not in use anymore
@@ -48,7 +49,7 @@ CommandBuffer* CommandBufferPool::createCommandBuffer(
          it->release();
       }
 
-      it->acquire( *m_pDevice, *this, usage, name );
+      it->acquire( *m_pDevice, *this, usage, name, parent );
       m_cmdBuffersInUse++;
       return &*it;
    }
@@ -64,7 +65,8 @@ void CommandBufferPool::waitUntilDone()
    vkFences.reserve( m_cmdBuffers.size() );
    for( CommandBuffer& cmdBuffer : m_cmdBuffers )
    {
-      if( cmdBuffer.isSubmitted() )
+      // Secondaries have no fence, they are done along with their parent
+      if( cmdBuffer.isSubmitted() && cmdBuffer.getVKFence() )
       {
          vkFences.push_back( cmdBuffer.getVKFence() );
       }
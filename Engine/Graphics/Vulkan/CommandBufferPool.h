@@ -41,7 +41,11 @@ class CommandBufferPool final
 
    const VkCommandPool& getVKCommandPool() const { return m_vkPool; }
 
-   CommandBuffer* createCommandBuffer( CYD::QueueUsageFlag usage, const std::string_view name );
+   // Command buffers created with a parent are secondaries recording part of its render pass
+   CommandBuffer* createCommandBuffer(
+       CYD::QueueUsageFlag usage,
+       const std::string_view name,
+       const CommandBuffer* parent = nullptr );
 
    CYD::QueueUsageFlag getType() const noexcept { return m_type; }
    uint32_t getFamilyIndex() const noexcept { return m_familyIndex; }
@@ -52,8 +56,9 @@ class CommandBufferPool final
 
    const Device* m_pDevice = nullptr;
 
-   // Command Buffer Pool
-   static constexpr uint32_t MAX_CMD_BUFFERS_IN_FLIGHT = 16;
+   // Command Buffer Pool. Secondaries are only freed along with their parent, worker threads can
+   // hold several of them per system and per frame
+   static constexpr uint32_t MAX_CMD_BUFFERS_IN_FLIGHT = 64;
    std::vector<CommandBuffer> m_cmdBuffers;
    uint32_t m_cmdBuffersInUse = 0;
 
@@ -28,17 +28,10 @@ CommandBuffer* CommandPoolManager::acquire(
 {
    // TODO Implement support for EXACT type so that we can possibly send work (like transfer for
    // example) to another queue family
-   const std::thread::id threadId = std::this_thread::get_id();
-
-   const auto it = m_commandPools.find( threadId );
-   if( it == m_commandPools.end() )
-   {
-      // There were no command pools found for this thread, create them
-      _initializePoolsForThread( threadId );
-   }
+   PoolsPerQueueFamilyPerFrame& poolsPerFrame = _findOrInitializePoolsForThread();
 
    // Attempting to find a pool of the adequate type
-   PoolsPerQueueFamily& poolsPerQueueFamily = it->second[currentFrame];
+   PoolsPerQueueFamily& poolsPerQueueFamily = poolsPerFrame[currentFrame];
 
    const auto poolIt = std::find_if(
        poolsPerQueueFamily.begin(),
@@ -56,13 +49,24 @@ CommandBuffer* CommandPoolManager::acquire(
    return nullptr;
 }
 
-void CommandPoolManager::waitOnFrame( uint32_t currentFrame )
+CommandBuffer* CommandPoolManager::acquireSecondary(
+    const CommandBuffer& parent,
+    const std::string_view name,
+    const uint32_t currentFrame )
 {
-   const std::thread::id threadId = std::this_thread::get_id();
+   PoolsPerQueueFamilyPerFrame& poolsPerFrame = _findOrInitializePoolsForThread();
 
-   const auto it = m_commandPools.find( threadId );
+   // Secondary command buffers can only be executed by primaries of the same queue family
+   const uint32_t familyIdx = parent.getPool()->getFamilyIndex();
+   CYD_ASSERT( familyIdx < m_nbFamilies && "CommandPoolManager: Parent from an unknown family" );
 
-   PoolsPerQueueFamily& poolsPerFamily = it->second[currentFrame];
+   return poolsPerFrame[currentFrame][familyIdx].createCommandBuffer(
+       parent.getUsage(), name, &parent );
+}
+
+void CommandPoolManager::waitOnFrame( uint32_t currentFrame )
+{
+   PoolsPerQueueFamily& poolsPerFamily = _findOrInitializePoolsForThread()[currentFrame];
    for( auto& poolPerFamily : poolsPerFamily )
    {
       poolPerFamily.waitUntilDone();
@@ -71,6 +75,8 @@ void CommandPoolManager::waitOnFrame( uint32_t currentFrame )
 
 void CommandPoolManager::cleanup()
 {
+   std::unique_lock<std::mutex> lock( m_poolsMutex );
+
    for( auto& poolsPerThread : m_commandPools )
    {
       for( auto& poolPerFrame : poolsPerThread.second )
@@ -83,6 +89,24 @@ void CommandPoolManager::cleanup()
    }
 }
 
+CommandPoolManager::PoolsPerQueueFamilyPerFrame&
+CommandPoolManager::_findOrInitializePoolsForThread()
+{
+   const std::thread::id threadId = std::this_thread::get_id();
+
+   std::unique_lock<std::mutex> lock( m_poolsMutex );
+
+   auto it = m_commandPools.find( threadId );
+   if( it == m_commandPools.end() )
+   {
+      // There were no command pools found for this thread, create them
+      _initializePoolsForThread( threadId );
+      it = m_commandPools.find( threadId );
+   }
+
+   return it->second;
+}
+
 void CommandPoolManager::_initializePoolsForThread( const std::thread::id threadId )
 {
    m_commandPools[threadId].resize( m_nbFrames );
@@ -5,6 +5,7 @@
 #include <Graphics/GraphicsTypes.h>
 
 #include <cstdint>
+#include <mutex>
 #include <thread>
 #include <unordered_map>
 
@@ -37,11 +38,22 @@ class CommandPoolManager final
        bool presentable,
        uint32_t currentFrame );
 
+   // Can be called from any thread, secondary command buffers come from the pools of the calling
+   // thread in the same queue family as their parent
+   CommandBuffer* acquireSecondary(
+       const CommandBuffer& parent,
+       const std::string_view name,
+       uint32_t currentFrame );
+
    void waitOnFrame( uint32_t currentFrame );
 
    void cleanup();
 
   private:
+   using PoolsPerQueueFamily         = std::vector<CommandBufferPool>;  // Number of queue families
+   using PoolsPerQueueFamilyPerFrame = std::vector<PoolsPerQueueFamily>;  // In-flight frames
+
+   PoolsPerQueueFamilyPerFrame& _findOrInitializePoolsForThread();
    void _initializePoolsForThread( const std::thread::id threadId );
 
    const Device& m_device;
@@ -49,8 +61,9 @@ class CommandPoolManager final
    uint32_t m_nbFamilies;
    uint32_t m_nbFrames;
 
-   using PoolsPerQueueFamily         = std::vector<CommandBufferPool>;  // Number of queue families
-   using PoolsPerQueueFamilyPerFrame = std::vector<PoolsPerQueueFamily>;  // In-flight frames
+   // Worker threads can add their pools while others are acquiring from theirs. Map nodes do not
+   // move on insertion, the pools of a thread can be used outside of the lock
+   std::mutex m_poolsMutex;
 
    std::unordered_map<std::thread::id, PoolsPerQueueFamilyPerFrame> m_commandPools;
 };
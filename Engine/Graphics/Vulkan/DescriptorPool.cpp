@@ -69,6 +69,8 @@ VkDescriptorSet DescriptorPool::allocate( const CYD::ShaderSetInfo& layout ) con
    allocInfo.descriptorSetCount          = 1;
    allocInfo.pSetLayouts                 = &vkDescSetLayout;
 
+   std::unique_lock<std::mutex> lock( m_mutex );
+
    VkDescriptorSet vkDescSet;
    VkResult result = vkAllocateDescriptorSets( m_device.getVKDevice(), &allocInfo, &vkDescSet );
    CYD_ASSERT( result == VK_SUCCESS && "DescriptorPool: Failed to solo allocate descriptor set" );
@@ -78,11 +80,13 @@ VkDescriptorSet DescriptorPool::allocate( const CYD::ShaderSetInfo& layout ) con
 
 void DescriptorPool::free( const VkDescriptorSet& descSet ) const
 {
+   std::unique_lock<std::mutex> lock( m_mutex );
    vkFreeDescriptorSets( m_device.getVKDevice(), m_vkDescPool, 1, &descSet );
 }
 
 void DescriptorPool::free( const VkDescriptorSet* shaderSets, const uint32_t count ) const
 {
+   std::unique_lock<std::mutex> lock( m_mutex );
    vkFreeDescriptorSets( m_device.getVKDevice(), m_vkDescPool, count, shaderSets );
 }
 
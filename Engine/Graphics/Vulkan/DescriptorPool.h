@@ -2,6 +2,8 @@
 
 #include <Common/Include.h>
 
+#include <mutex>
+
 // ================================================================================================
 // Forwards
 // ================================================================================================
@@ -38,7 +40,8 @@ class DescriptorPool final
   private:
    const Device& m_device;
 
-
+   // Command buffers recorded on worker threads allocate and free their sets concurrently
+   mutable std::mutex m_mutex;
 
    VkDescriptorPool m_vkDescPool = nullptr;
 };
@@ -157,6 +157,12 @@ CommandBuffer* Device::createCommandBuffer(
    return m_commandPoolManager->acquire( usage, name, presentable, m_swapchain->getCurrentFrame() );
 }
 
+CommandBuffer*
+Device::createSecondaryCommandBuffer( const CommandBuffer& parent, const std::string_view name )
+{
+   return m_commandPoolManager->acquireSecondary( parent, name, m_swapchain->getCurrentFrame() );
+}
+
 // =================================================================================================
 // Device buffers
 
@@ -193,7 +199,7 @@ Buffer* Device::createVertexBuffer( size_t size, const std::string_view name )
 
 Buffer* Device::createIndexBuffer( size_t size, const std::string_view name )
 {
-   // TODO Support for uint16 and uint32
+   // The index type is only given when binding the buffer
    return _createBuffer(
        size,
        CYD::BufferUsage::TRANSFER_DST | CYD::BufferUsage::INDEX,
@@ -270,7 +276,10 @@ Swapchain* Device::createSwapchain( const CYD::SwapchainInfo& scInfo )
 void Device::cleanup()
 {
    m_commandPoolManager->cleanup();
+}
 
+void Device::releaseUnusedResources()
+{
    // Cleaning up textures
    for( auto& texture : m_textures )
    {
@@ -378,6 +387,7 @@ Device::~Device()
    vkDeviceWaitIdle( m_vkDevice );
 
    cleanup();
+   releaseUnusedResources();
 
    // Checking for any leaking resources
    CYD_ASSERT(
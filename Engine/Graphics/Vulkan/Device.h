@@ -61,6 +61,10 @@ class Device final
        const std::string_view name,
        bool presentable = false );
 
+   // Can be called from worker threads while the parent is in a render pass
+   CommandBuffer*
+   createSecondaryCommandBuffer( const CommandBuffer& parent, const std::string_view name );
+
    // Buffer creation function
    Buffer* createVertexBuffer( size_t size, const std::string_view name );
    Buffer* createIndexBuffer( size_t size, const std::string_view name );
@@ -69,7 +73,8 @@ class Device final
    Buffer* createStagingBuffer( size_t size );
    Texture* createTexture( const CYD::TextureDescription& desc );
 
-   void cleanup();  // Clean up unused resources
+   void cleanup();                 // Recycle command buffers that finished executing
+   void releaseUnusedResources();  // Release buffers and textures that are not used anymore
    void clearPipelines();
 
    void waitUntilIdle();  // CPU wait until device is done working
@@ -44,13 +44,35 @@ static VkShaderStageFlagBits shaderTypeToVKShaderStage( Shader::Type shaderType
 
 VkDescriptorSetLayout PipelineCache::findOrCreate( const CYD::ShaderSetInfo& shaderSetInfo )
 {
-   // Creating the descriptor set layout
-   const auto layoutIt = m_descSetLayouts.find( shaderSetInfo );
-   if( layoutIt != m_descSetLayouts.end() )
-   {
-      return layoutIt->second;
-   }
+   return m_descSetLayouts.findOrCreate(
+       shaderSetInfo, [&]() { return _createDescriptorSetLayout( shaderSetInfo ); } );
+}
 
+VkPipelineLayout PipelineCache::findOrCreate( const CYD::PipelineLayoutInfo& pipLayoutInfo )
+{
+   return m_pipLayouts.findOrCreate(
+       pipLayoutInfo, [&]() { return _createPipelineLayout( pipLayoutInfo ); } );
+}
+
+VkPipeline PipelineCache::findOrCreate( const CYD::ComputePipelineInfo& pipInfo )
+{
+   return m_computePipelines.findOrCreate(
+       pipInfo, [&]() { return _createComputePipeline( pipInfo ); } );
+}
+
+VkPipeline PipelineCache::findOrCreate(
+    const CYD::GraphicsPipelineInfo& pipInfo,
+    const RenderPassInfo& renderPassInfo,
+    VkRenderPass renderPass )
+{
+   return m_graphicsPipelines.findOrCreate(
+       pipInfo, [&]() { return _createGraphicsPipeline( pipInfo, renderPassInfo, renderPass ); } );
+}
+
+VkDescriptorSetLayout PipelineCache::_createDescriptorSetLayout(
+    const CYD::ShaderSetInfo& shaderSetInfo )
+{
+   // Creating the descriptor set layout
    std::vector<VkDescriptorSetLayoutBinding> descSetLayoutBindings;
    std::vector<VkDescriptorBindingFlagsEXT> descBindingFlags;
    descSetLayoutBindings.reserve( shaderSetInfo.shaderBindings.size() );
@@ -78,17 +100,12 @@ VkDescriptorSetLayout PipelineCache::findOrCreate( const CYD::ShaderSetInfo& sha
        vkCreateDescriptorSetLayout( m_device.getVKDevice(), &layoutInfo, nullptr, &descSetLayout );
    CYD_ASSERT( result == VK_SUCCESS && "PipelineCache: Could not create descriptor set layout" );
 
-   return m_descSetLayouts.insert( { shaderSetInfo, descSetLayout } ).first->second;
+   return descSetLayout;
 }
 
-VkPipelineLayout PipelineCache::findOrCreate( const CYD::PipelineLayoutInfo& pipLayoutInfo )
+VkPipelineLayout PipelineCache::_createPipelineLayout(
+    const CYD::PipelineLayoutInfo& pipLayoutInfo )
 {
-   const auto layoutIt = m_pipLayouts.find( pipLayoutInfo );
-   if( layoutIt != m_pipLayouts.end() )
-   {
-      return layoutIt->second;
-   }
-
    std::vector<VkPushConstantRange> vkRanges;
    vkRanges.reserve( pipLayoutInfo.ranges.size() );
    for( const auto& range : pipLayoutInfo.ranges )
@@ -120,18 +137,11 @@ VkPipelineLayout PipelineCache::findOrCreate( const CYD::PipelineLayoutInfo& pip
        vkCreatePipelineLayout( m_device.getVKDevice(), &pipelineLayoutInfo, nullptr, &pipLayout );
    CYD_ASSERT( result == VK_SUCCESS && "PipelineCache: Could not create pipeline layout" );
 
-   return m_pipLayouts.insert( { pipLayoutInfo, pipLayout } ).first->second;
+   return pipLayout;
 }
 
-VkPipeline PipelineCache::findOrCreate( const CYD::ComputePipelineInfo& pipInfo )
+VkPipeline PipelineCache::_createComputePipeline( const CYD::ComputePipelineInfo& pipInfo )
 {
-   // Attempting to find pipeline
-   const auto pipIt = m_computePipelines.find( pipInfo );
-   if( pipIt != m_computePipelines.end() )
-   {
-      return pipIt->second;
-   }
-
    // Building shader constants
    const CYD::ShaderConstants::Entry* entry = pipInfo.constants.getEntry( pipInfo.shader );
 
@@ -186,21 +196,14 @@ VkPipeline PipelineCache::findOrCreate( const CYD::ComputePipelineInfo& pipInfo
        m_device.getVKDevice(), nullptr, 1, &pipelineInfo, nullptr, &pipeline );
    CYD_ASSERT( result == VK_SUCCESS && "PipelineCache: Could not create compute pipeline" );
 
-   return m_computePipelines.insert( { pipInfo, pipeline } ).first->second;
+   return pipeline;
 }
 
-VkPipeline PipelineCache::findOrCreate(
+VkPipeline PipelineCache::_createGraphicsPipeline(
     const CYD::GraphicsPipelineInfo& pipInfo,
     const RenderPassInfo& renderPassInfo,
     VkRenderPass renderPass )
 {
-   // Attempting to find pipeline
-   const auto pipIt = m_graphicsPipelines.find( pipInfo );
-   if( pipIt != m_graphicsPipelines.end() )
-   {
-      return pipIt->second;
-   }
-
    // Scope protection for shader info structs
    std::vector<VkPipelineShaderStageCreateInfo> shaderCreateInfos;
    std::vector<VkSpecializationInfo> specInfos;
@@ -261,7 +264,6 @@ VkPipeline PipelineCache::findOrCreate(
    std::vector<VkVertexInputAttributeDescription> vkAttributes( attributes.size() );
    std::vector<VkVertexInputBindingDescription> vkBindings;
 
-   uint32_t vertBindingStride = 0;
    for( uint32_t i = 0; i < attributes.size(); ++i )
    {
       CYD::PixelFormat vecFormat = attributes[i].vecFormat;
@@ -270,8 +272,6 @@ VkPipeline PipelineCache::findOrCreate(
       vkAttributes[i].location = attributes[i].location;
       vkAttributes[i].format   = TypeConversions::cydToVkFormat( vecFormat );
       vkAttributes[i].offset   = attributes[i].offset;
-
-      vertBindingStride += GetPixelSizeInBytes( vecFormat );
    }
 
    // TODO More than one binding. For now, if we have attributes, we always have one vertex binding
@@ -280,7 +280,7 @@ VkPipeline PipelineCache::findOrCreate(
       // TODO Instancing
       VkVertexInputBindingDescription vertexBindingDesc = {};
       vertexBindingDesc.binding                         = 0;
-      vertexBindingDesc.stride                          = vertBindingStride;
+      vertexBindingDesc.stride                          = pipInfo.vertLayout.getStride();
       vertexBindingDesc.inputRate                       = VK_VERTEX_INPUT_RATE_VERTEX;
       vkBindings.push_back( std::move( vertexBindingDesc ) );
    }
@@ -427,35 +427,31 @@ VkPipeline PipelineCache::findOrCreate(
 
    CYD_ASSERT( result == VK_SUCCESS && "Could not create pipeline" );
 
-   return m_graphicsPipelines.insert( { pipInfo, pipeline } ).first->second;
+   return pipeline;
 }
 
 void PipelineCache::clear()
 {
    m_ShaderCache->reset();
 
-   for( const auto& pipeline : m_graphicsPipelines )
-   {
-      vkDestroyPipeline( m_device.getVKDevice(), pipeline.second, nullptr );
-   }
+   m_graphicsPipelines.forEach(
+       [this]( const CYD::GraphicsPipelineInfo&, VkPipeline pipeline )
+       { vkDestroyPipeline( m_device.getVKDevice(), pipeline, nullptr ); } );
    m_graphicsPipelines.clear();
 
-   for( const auto& pipeline : m_computePipelines )
-   {
-      vkDestroyPipeline( m_device.getVKDevice(), pipeline.second, nullptr );
-   }
+   m_computePipelines.forEach(
+       [this]( const CYD::ComputePipelineInfo&, VkPipeline pipeline )
+       { vkDestroyPipeline( m_device.getVKDevice(), pipeline, nullptr ); } );
    m_computePipelines.clear();
 
-   for( const auto& pipLayout : m_pipLayouts )
-   {
-      vkDestroyPipelineLayout( m_device.getVKDevice(), pipLayout.second, nullptr );
-   }
+   m_pipLayouts.forEach(
+       [this]( const CYD::PipelineLayoutInfo&, VkPipelineLayout pipLayout )
+       { vkDestroyPipelineLayout( m_device.getVKDevice(), pipLayout, nullptr ); } );
    m_pipLayouts.clear();
 
-   for( const auto& descSetLayout : m_descSetLayouts )
-   {
-      vkDestroyDescriptorSetLayout( m_device.getVKDevice(), descSetLayout.second, nullptr );
-   }
+   m_descSetLayouts.forEach(
+       [this]( const CYD::ShaderSetInfo&, VkDescriptorSetLayout descSetLayout )
+       { vkDestroyDescriptorSetLayout( m_device.getVKDevice(), descSetLayout, nullptr ); } );
    m_descSetLayouts.clear();
 }
 
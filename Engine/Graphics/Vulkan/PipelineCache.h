@@ -5,8 +5,9 @@
 #include <Graphics/GraphicsTypes.h>
 #include <Graphics/PipelineInfos.h>
 
+#include <Multithreading/ConcurrentHashMap.h>
+
 #include <memory>
-#include <unordered_map>
 
 // ================================================================================================
 // Forwards
@@ -46,17 +47,27 @@ class PipelineCache final
        VkRenderPass renderPass );
    VkPipeline findOrCreate( const CYD::ComputePipelineInfo& pipInfo );
 
+   // Not thread-safe, no other thread should be creating or fetching pipelines at this point
    void clear();
 
   private:
+   VkDescriptorSetLayout _createDescriptorSetLayout( const CYD::ShaderSetInfo& shaderSetInfo );
+   VkPipelineLayout _createPipelineLayout( const CYD::PipelineLayoutInfo& pipLayoutInfo );
+   VkPipeline _createGraphicsPipeline(
+       const CYD::GraphicsPipelineInfo& pipInfo,
+       const RenderPassInfo& renderPassInfo,
+       VkRenderPass renderPass );
+   VkPipeline _createComputePipeline( const CYD::ComputePipelineInfo& pipInfo );
+
    const Device& m_device;
 
    std::unique_ptr<ShaderCache> m_ShaderCache;
 
-   std::unordered_map<CYD::ShaderSetInfo, VkDescriptorSetLayout> m_descSetLayouts;
-   std::unordered_map<CYD::PipelineLayoutInfo, VkPipelineLayout> m_pipLayouts;
+   // Lookups are lock-free, pipelines and layouts are only ever created once per key
+   EMP::ConcurrentHashMap<CYD::ShaderSetInfo, VkDescriptorSetLayout> m_descSetLayouts;
+   EMP::ConcurrentHashMap<CYD::PipelineLayoutInfo, VkPipelineLayout> m_pipLayouts;
 
-   std::unordered_map<CYD::GraphicsPipelineInfo, VkPipeline> m_graphicsPipelines;
-   std::unordered_map<CYD::ComputePipelineInfo, VkPipeline> m_computePipelines;
+   EMP::ConcurrentHashMap<CYD::GraphicsPipelineInfo, VkPipeline> m_graphicsPipelines;
+   EMP::ConcurrentHashMap<CYD::ComputePipelineInfo, VkPipeline> m_computePipelines;
 };
 }
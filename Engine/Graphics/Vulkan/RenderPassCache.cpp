@@ -18,13 +18,12 @@ RenderPassCache::RenderPassCache( const Device& device ) : m_device( device )
 
 VkRenderPass RenderPassCache::findOrCreate( const RenderPassInfo& targetsInfo )
 {
-   // Find
-   const auto it = m_renderPasses.find( targetsInfo );
-   if( it != m_renderPasses.end() )
-   {
-      return it->second;
-   }
+   return m_renderPasses.findOrCreate(
+       targetsInfo, [&]() { return _createRenderPass( targetsInfo ); } );
+}
 
+VkRenderPass RenderPassCache::_createRenderPass( const RenderPassInfo& targetsInfo )
+{
    // Creating attachments
    std::vector<VkAttachmentReference> colorRefs;
    std::vector<VkAttachmentReference> depthRefs;
@@ -136,7 +135,7 @@ VkRenderPass RenderPassCache::findOrCreate( const RenderPassInfo& targetsInfo )
        vkCreateRenderPass( m_device.getVKDevice(), &renderPassInfo, nullptr, &renderPass );
    CYD_ASSERT( result == VK_SUCCESS && "RenderPass: Could not create default render pass" );
 
-   return m_renderPasses.insert( { targetsInfo, renderPass } ).first->second;
+   return renderPass;
 }
 
 void RenderPassCache::_createDefaultRenderPasses()
@@ -146,9 +145,8 @@ void RenderPassCache::_createDefaultRenderPasses()
 
 RenderPassCache::~RenderPassCache()
 {
-   for( const auto& renderPass : m_renderPasses )
-   {
-      vkDestroyRenderPass( m_device.getVKDevice(), renderPass.second, nullptr );
-   }
+   m_renderPasses.forEach(
+       [this]( const RenderPassInfo&, VkRenderPass renderPass )
+       { vkDestroyRenderPass( m_device.getVKDevice(), renderPass, nullptr ); } );
 }
 }
@@ -4,7 +4,7 @@
 
 #include <Graphics/Vulkan/VulkanTypes.h>
 
-#include <unordered_map>
+#include <Multithreading/ConcurrentHashMap.h>
 
 // ================================================================================================
 // Forwards
@@ -31,9 +31,10 @@ class RenderPassCache final
 
   private:
    void _createDefaultRenderPasses();
+   VkRenderPass _createRenderPass( const RenderPassInfo& targetsInfo );
 
    const Device& m_device;
 
-   std::unordered_map<RenderPassInfo, VkRenderPass> m_renderPasses;
+   EMP::ConcurrentHashMap<RenderPassInfo, VkRenderPass> m_renderPasses;
 };
 }
@@ -12,12 +12,11 @@ SamplerCache::SamplerCache( const Device& device ) : m_device( device ) {}
 
 const VkSampler SamplerCache::findOrCreate( const CYD::SamplerInfo& info )
 {
-   const auto it = m_samplers.find( info );
-   if( it != m_samplers.end() )
-   {
-      return it->second;
-   }
+   return m_samplers.findOrCreate( info, [&]() { return _createSampler( info ); } );
+}
 
+VkSampler SamplerCache::_createSampler( const CYD::SamplerInfo& info )
+{
    VkSamplerCreateInfo samplerInfo = {};
    samplerInfo.sType               = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
    samplerInfo.magFilter           = TypeConversions::cydToVkFilter( info.magFilter );
@@ -39,14 +38,13 @@ const VkSampler SamplerCache::findOrCreate( const CYD::SamplerInfo& info )
    VkResult result = vkCreateSampler( m_device.getVKDevice(), &samplerInfo, nullptr, &vkSampler );
    CYD_ASSERT( result == VK_SUCCESS && "SamplerCache: Could not create sampler" );
 
-   return m_samplers.insert( { info, vkSampler } ).first->second;
+   return vkSampler;
 }
 
 SamplerCache::~SamplerCache()
 {
-   for( const auto& sampler : m_samplers )
-   {
-      vkDestroySampler( m_device.getVKDevice(), sampler.second, nullptr );
-   }
+   m_samplers.forEach(
+       [this]( const CYD::SamplerInfo&, VkSampler sampler )
+       { vkDestroySampler( m_device.getVKDevice(), sampler, nullptr ); } );
 }
 }
\ No newline at end of file
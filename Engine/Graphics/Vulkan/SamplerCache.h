@@ -4,7 +4,7 @@
 
 #include <Graphics/GraphicsTypes.h>
 
-#include <unordered_map>
+#include <Multithreading/ConcurrentHashMap.h>
 
 // ================================================================================================
 // Forwards
@@ -30,7 +30,9 @@ class SamplerCache final
    const VkSampler findOrCreate( const CYD::SamplerInfo& info );
 
   private:
+   VkSampler _createSampler( const CYD::SamplerInfo& info );
+
    const Device& m_device;
-   std::unordered_map<CYD::SamplerInfo, VkSampler> m_samplers;
+   EMP::ConcurrentHashMap<CYD::SamplerInfo, VkSampler> m_samplers;
 };
 }
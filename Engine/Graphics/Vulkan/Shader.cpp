@@ -2,10 +2,11 @@
 
 #include <Common/Assert.h>
 
+#include <Graphics/Utility/GraphicsIO.h>
 #include <Graphics/Vulkan.h>
 #include <Graphics/Vulkan/Device.h>
 
-#include <fstream>
+#include <IO/VirtualFileSystem.h>
 
 namespace vk
 {
@@ -48,16 +49,12 @@ Shader::Shader( const Device& device, const std::string& shaderPath )
 
 void Shader::_readShaderFile()
 {
-   std::ifstream shaderFile( m_shaderPath, std::ios::ate | std::ios::binary );
-   CYD_ASSERT( shaderFile.is_open() && "Shader: Could not open shader file" );
+   EMP::VirtualFile shaderFile;
+   const bool isOpen = CYD::GraphicsIO::GetFileSystem().open( m_shaderPath, shaderFile );
+   CYD_ASSERT( isOpen && "Shader: Could not open shader file" );
 
-   size_t shaderSize = static_cast<size_t>( shaderFile.tellg() );
-
-   m_byteCode.resize( shaderSize );
-
-   shaderFile.seekg( 0 );
-   shaderFile.read( m_byteCode.data(), shaderSize );
-   shaderFile.close();
+   const char* byteCode = reinterpret_cast<const char*>( shaderFile.getData() );
+   m_byteCode.assign( byteCode, byteCode + shaderFile.getSize() );
 }
 
 void Shader::_createShaderModule()
@@ -2,9 +2,10 @@
 
 #include <Common/Assert.h>
 
+#include <Graphics/Utility/GraphicsIO.h>
 #include <Graphics/Vulkan/Shader.h>
 
-#include <filesystem>
+#include <IO/VirtualFileSystem.h>
 
 // Hard-coded shader directories
 static constexpr char SPIRV_SHADER_DIR[] = "../Shaders/";
@@ -16,16 +17,14 @@ ShaderCache::~ShaderCache() = default;
 
 void ShaderCache::_initializeAllShaders()
 {
-   CYD_ASSERT(
-       std::filesystem::exists( SPIRV_SHADER_DIR ) &&
-       "ShaderCache: Could not find compiled shader directory" );
+   // Packed in the archives or loose in the directory
+   const std::vector<std::string> shaderPaths =
+       CYD::GraphicsIO::GetFileSystem().list( SPIRV_SHADER_DIR );
 
-   auto directory = std::filesystem::directory_iterator( SPIRV_SHADER_DIR );
+   CYD_ASSERT( !shaderPaths.empty() && "ShaderCache: Could not find compiled shader directory" );
 
-   for( const auto& entry : directory )
+   for( const std::string& shaderPath : shaderPaths )
    {
-      std::string shaderPath = entry.path().generic_string();
-
       m_shaders.insert( { shaderPath, std::make_unique<Shader>( m_device, shaderPath ) } );
    }
 }
@@ -32,10 +32,16 @@ VkFormat cydToVkFormat( CYD::PixelFormat format )
          return VK_FORMAT_R8G8B8A8_SRGB;
       case CYD::PixelFormat::RGBA16F:
          return VK_FORMAT_R16G16B16A16_SFLOAT;
+      case CYD::PixelFormat::RGBA16_UNORM:
+         return VK_FORMAT_R16G16B16A16_UNORM;
       case CYD::PixelFormat::RGBA32F:
          return VK_FORMAT_R32G32B32A32_SFLOAT;
       case CYD::PixelFormat::RGB32F:
          return VK_FORMAT_R32G32B32_SFLOAT;
+      case CYD::PixelFormat::RG16F:
+         return VK_FORMAT_R16G16_SFLOAT;
+      case CYD::PixelFormat::RG16_SNORM:
+         return VK_FORMAT_R16G16_SNORM;
       case CYD::PixelFormat::RG32F:
          return VK_FORMAT_R32G32_SFLOAT;
       case CYD::PixelFormat::R32F:
@@ -62,10 +68,16 @@ CYD::PixelFormat vkToCydFormat( VkFormat format )
          return CYD::PixelFormat::RGBA8_SRGB;
       case VK_FORMAT_R16G16B16A16_SFLOAT:
          return CYD::PixelFormat::RGBA16F;
+      case VK_FORMAT_R16G16B16A16_UNORM:
+         return CYD::PixelFormat::RGBA16_UNORM;
       case VK_FORMAT_R32G32B32A32_SFLOAT:
          return CYD::PixelFormat::RGBA32F;
       case VK_FORMAT_R32G32B32_SFLOAT:
          return CYD::PixelFormat::RGB32F;
+      case VK_FORMAT_R16G16_SFLOAT:
+         return CYD::PixelFormat::RG16F;
+      case VK_FORMAT_R16G16_SNORM:
+         return CYD::PixelFormat::RG16_SNORM;
       case VK_FORMAT_R32G32_SFLOAT:
          return CYD::PixelFormat::RG32F;
       case VK_FORMAT_R32_SFLOAT:
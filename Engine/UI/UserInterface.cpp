@@ -2,17 +2,27 @@
 #include <UI/UserInterface.h>
 
 #include <Graphics/GRIS/RenderInterface.h>
+#include <Graphics/Scene/MeshCache.h>
+#include <Graphics/Scene/MeshLodSelector.h>
+#include <Graphics/Scene/OcclusionCuller.h>
+#include <Graphics/Scene/ShadowCache.h>
+#include <Graphics/Utility/GraphicsIO.h>
 
 #include <ECS/EntityManager.h>
 #include <ECS/Components/Transforms/TransformComponent.h>
 #include <ECS/Components/Rendering/RenderableComponent.h>
 #include <ECS/Components/Rendering/TessellatedComponent.h>
+#include <ECS/Components/Rendering/TerrainComponent.h>
 #include <ECS/Components/Procedural/ProceduralDisplacementComponent.h>
 #include <ECS/Components/Procedural/AtmosphereComponent.h>
 #include <ECS/Components/Procedural/FFTOceanComponent.h>
 #include <ECS/Components/Procedural/FogComponent.h>
 #include <ECS/SharedComponents/SceneComponent.h>
 
+#include <IO/DerivedDataCache.h>
+#include <IO/VirtualFileSystem.h>
+#include <Multithreading/ThreadPool.h>
+
 #include <ThirdParty/ImGui/imgui.h>
 
 #include <glm/gtc/type_ptr.hpp>
@@ -116,7 +126,10 @@ void DrawAboutWindow( CmdListHandle /*cmdList*/ )
    ImGui::End();
 }
 
-void DrawStatsOverlay( CmdListHandle /*cmdList*/ )
+void DrawStatsOverlay(
+    CmdListHandle /*cmdList*/,
+    const EMP::ThreadPool& threadPool,
+    const SceneComponent& scene )
 {
    ImGui::SetNextWindowBgAlpha( 0.25f );
 
@@ -131,6 +144,132 @@ void DrawStatsOverlay( CmdListHandle /*cmdList*/ )
    ImGui::Text( "Frametime: %.3f ms (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate );
    ImGui::Text( "Command Buffers: [0: %d, 1: %d]", 0, 0 );
 
+   ImGui::Separator();
+
+   static constexpr char LANE_NAMES[][16] = { "Frame", "Normal", "Background", "IO" };
+   static_assert( ARRSIZE( LANE_NAMES ) == static_cast<uint32_t>( EMP::ThreadPool::Lane::COUNT ) );
+
+   ImGui::Text( "Workers: %u", threadPool.getThreadCount() );
+   for( uint32_t i = 0; i < ARRSIZE( LANE_NAMES ); ++i )
+   {
+      const EMP::ThreadPool::LaneStats stats =
+          threadPool.getLaneStats( static_cast<EMP::ThreadPool::Lane>( i ) );
+      ImGui::Text(
+          "%s: %u queued, %.3f ms avg wait (%.3f ms max)",
+          LANE_NAMES[i],
+          stats.queueDepth,
+          stats.averageWaitMs,
+          stats.maxWaitMs );
+   }
+
+   const EMP::ThreadPool::LaneStats mainStats = threadPool.getMainThreadStats();
+   ImGui::Text(
+       "Main Thread: %u queued, %.3f ms avg wait (%.3f ms max)",
+       mainStats.queueDepth,
+       mainStats.averageWaitMs,
+       mainStats.maxWaitMs );
+
+   ImGui::Separator();
+
+   if( scene.occlusionCuller )
+   {
+      const OcclusionCuller::Stats& occlusion = scene.occlusionCuller->getStats();
+      const float occludedPercent =
+          occlusion.testedCount ? 100.0f * occlusion.occludedCount / occlusion.testedCount : 0.0f;
+
+      ImGui::Text(
+          "Occlusion: %u occluders, %u triangles, %.3f ms setup, %.3f ms raster",
+          occlusion.occluderCount,
+          occlusion.triangleCount,
+          occlusion.setupMs,
+          occlusion.rasterizeMs );
+      ImGui::Text(
+          "Occluded: %u/%u (%.1f%%)",
+          occlusion.occludedCount,
+          occlusion.testedCount,
+          occludedPercent );
+   }
+   else
+   {
+      ImGui::Text( "Occlusion: No occluders" );
+   }
+
+   if( scene.meshLodSelector )
+   {
+      const MeshLodSelector::Stats& lods = scene.meshLodSelector->getStats();
+      const float drawnPercent =
+          lods.fullTriangles ? 100.0f * lods.drawnTriangles / lods.fullTriangles : 0.0f;
+
+      static_assert( MAX_MESH_LODS == 4 );
+
+      ImGui::Text(
+          "Mesh LODs: %u meshes [%u, %u, %u, %u], %u switches",
+          lods.meshCount,
+          lods.lodCounts[0],
+          lods.lodCounts[1],
+          lods.lodCounts[2],
+          lods.lodCounts[3],
+          lods.switchCount );
+      ImGui::Text(
+          "Triangles: %llu/%llu (%.1f%%)",
+          static_cast<unsigned long long>( lods.drawnTriangles ),
+          static_cast<unsigned long long>( lods.fullTriangles ),
+          drawnPercent );
+   }
+
+   if( scene.meshCache )
+   {
+      const MeshCache::StreamingStats streaming = scene.meshCache->getStreamingStats();
+
+      ImGui::Text(
+          "Mesh Streaming: %u loading, %u ready, %llu uploaded, %llu merged",
+          streaming.loadingCount,
+          streaming.readyCount,
+          static_cast<unsigned long long>( streaming.uploadCount ),
+          static_cast<unsigned long long>( streaming.mergedCount ) );
+      ImGui::Text(
+          "Latency: %.3f ms avg (%.3f ms max)",
+          streaming.averageLatencyMs,
+          streaming.maxLatencyMs );
+   }
+
+   const EMP::DerivedDataCache::Stats derivedData = GraphicsIO::GetDerivedDataCache().getStats();
+   ImGui::Text(
+       "Derived Data: %llu hits, %llu misses, %.1f MB mapped, %.1f MB stored",
+       static_cast<unsigned long long>( derivedData.hitCount ),
+       static_cast<unsigned long long>( derivedData.missCount ),
+       derivedData.hitBytes / ( 1024.0 * 1024.0 ),
+       derivedData.storedBytes / ( 1024.0 * 1024.0 ) );
+
+   const EMP::VirtualFileSystem::Stats files = GraphicsIO::GetFileSystem().getStats();
+   ImGui::Text(
+       "Files: %llu packed in %u archives, %llu loose, %llu missing",
+       static_cast<unsigned long long>( files.packedOpenCount ),
+       files.archiveCount,
+       static_cast<unsigned long long>( files.looseOpenCount ),
+       static_cast<unsigned long long>( files.missCount ) );
+
+   if( scene.shadowCache )
+   {
+      const ShadowCache::Stats& shadows = scene.shadowCache->getStats();
+      const uint64_t totalLookups       = shadows.totalHits + shadows.totalMisses;
+      const float hitPercent = totalLookups ? 100.0f * shadows.totalHits / totalLookups : 0.0f;
+
+      ImGui::Text(
+          "Shadow Cache: %u hits, %u misses, %u invalidated, %.3f ms saved",
+          shadows.hits,
+          shadows.misses,
+          shadows.invalidations,
+          shadows.savedMs );
+      ImGui::Text(
+          "Cached: %llu/%llu (%.1f%%), %.3f ms per miss, %.1f ms saved",
+          static_cast<unsigned long long>( shadows.totalHits ),
+          static_cast<unsigned long long>( totalLookups ),
+          hitPercent,
+          shadows.missMs,
+          shadows.totalSavedMs );
+   }
+
    ImGui::End();
 }
 
@@ -218,6 +357,12 @@ void DrawComponentsMenu( CmdListHandle cmdList, ComponentType type, const BaseCo
          DrawTessellatedComponentMenu( cmdList, tessellated );
          break;
       }
+      case ComponentType::TERRAIN:
+      {
+         const TerrainComponent& terrain = *static_cast<const TerrainComponent*>( component );
+         DrawTerrainComponentMenu( cmdList, terrain );
+         break;
+      }
       case ComponentType::FOG:
       {
          const FogComponent& fog = *static_cast<const FogComponent*>( component );
@@ -532,6 +677,7 @@ void DrawRenderableComponentMenu( CmdListHandle cmdList, const RenderableCompone
    ImGui::Checkbox( "Is Visible", (bool*)&renderable.isVisible );
    ImGui::Checkbox( "Casts Shadows", (bool*)&renderable.isShadowCasting );
    ImGui::Checkbox( "Receives Shadows", (bool*)&renderable.isShadowReceiving );
+   ImGui::Checkbox( "Is Occluder", (bool*)&renderable.isOccluder );
 }
 
 void DrawTessellatedComponentMenu( CmdListHandle cmdList, const TessellatedComponent& tessellated )
@@ -542,6 +688,22 @@ void DrawTessellatedComponentMenu( CmdListHandle cmdList, const TessellatedCompo
        "Tessellation Factor", (float*)&tessellated.params.tessellationFactor, 0.0f, 1.0f );
 }
 
+void DrawTerrainComponentMenu( CmdListHandle cmdList, const TerrainComponent& terrain )
+{
+   ImGui::SliderFloat( "LOD Distance", (float*)&terrain.lodDistance, 50.0f, 2000.0f );
+   ImGui::SliderFloat( "Morph Ratio", (float*)&terrain.morphRatio, 0.0f, 0.95f );
+
+   ImGui::Value( "LODs", terrain.lodCount );
+   ImGui::Text( "Height Bounds: %s", terrain.hasHeightBounds ? "From Heights" : "Conservative" );
+   ImGui::Text(
+       "Nodes: %u visited, %u culled, %u patches",
+       terrain.stats.visitedCount,
+       terrain.stats.culledCount,
+       terrain.stats.selectedCount );
+   ImGui::Text( "Selection: %.3f ms", terrain.stats.selectMs );
+   ImGui::Value( "Shadow Patches", terrain.shadowPatchCount );
+}
+
 void DrawSceneSharedComponentMenu( CmdListHandle cmdList, const SceneComponent& scene )
 {
    const GBuffer::RenderTargets& rts = scene.gbuffer.getRenderTargets();
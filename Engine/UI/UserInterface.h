@@ -5,6 +5,11 @@
 #include <ECS/Components/ComponentTypes.h>
 #include <ECS/SharedComponents/SharedComponentType.h>
 
+namespace EMP
+{
+class ThreadPool;
+}
+
 namespace CYD
 {
 class EntityManager;
@@ -13,6 +18,7 @@ class BaseSharedComponent;
 class TransformComponent;
 class RenderableComponent;
 class TessellatedComponent;
+class TerrainComponent;
 class ProceduralDisplacementComponent;
 class AtmosphereComponent;
 class FFTOceanComponent;
@@ -35,7 +41,10 @@ void DrawMainMenuBar(
 
 void DrawMainWindow( CmdListHandle cmdList );
 void DrawAboutWindow( CmdListHandle cmdList );
-void DrawStatsOverlay( CmdListHandle cmdList );
+void DrawStatsOverlay(
+    CmdListHandle cmdList,
+    const EMP::ThreadPool& threadPool,
+    const SceneComponent& scene );
 
 // ECS
 void DrawECSWindow( CmdListHandle cmdList, const EntityManager& entityManager );
@@ -50,6 +59,7 @@ void DrawSharedComponentsMenu(
 void DrawTransformComponentMenu( CmdListHandle cmdList, const TransformComponent& transform );
 void DrawRenderableComponentMenu( CmdListHandle cmdList, const RenderableComponent& renderable );
 void DrawTessellatedComponentMenu( CmdListHandle cmdList, const TessellatedComponent& tessellated );
+void DrawTerrainComponentMenu( CmdListHandle cmdList, const TerrainComponent& terrain );
 void DrawProceduralDisplacementComponentMenu(
     CmdListHandle cmdList,
     const ProceduralDisplacementComponent& displacement );
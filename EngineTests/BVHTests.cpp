@@ -0,0 +1,302 @@
+#include <Test.h>
+
+#include <Graphics/Scene/BVH.h>
+#include <Graphics/Scene/Frustum.h>
+
+#include <Multithreading/ThreadPool.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace CYD;
+
+namespace
+{
+// Random boxes spread so that the density stays about the same whatever the count, with the
+// handles of the ones currently in the BVH
+struct Scene
+{
+   Scene( uint32_t count ) : rng( 3 ), worldSize( std::cbrt( static_cast<float>( count ) ) * 20.0f )
+   {
+      std::uniform_real_distribution<float> position( -worldSize, worldSize );
+      std::uniform_real_distribution<float> extent( 0.5f, 5.0f );
+
+      boxes.resize( count );
+      proxies.resize( count );
+      for( uint32_t i = 0; i < count; ++i )
+      {
+         const glm::vec3 center( position( rng ), position( rng ), position( rng ) );
+         const glm::vec3 extents( extent( rng ), extent( rng ), extent( rng ) );
+
+         boxes[i]   = { center - extents, center + extents };
+         proxies[i] = bvh.insert( boxes[i], i );
+      }
+
+      frustum.update(
+          glm::perspective( 1.0f, 1.7f, 0.1f, worldSize ),
+          glm::lookAt(
+              glm::vec3( 0.0f ), glm::vec3( 1.0f, 0.2f, 0.3f ), glm::vec3( 0.0f, 1.0f, 0.0f ) ) );
+   }
+
+   void move( uint32_t i )
+   {
+      std::uniform_real_distribution<float> offset( -2.0f, 2.0f );
+      const glm::vec3 delta( offset( rng ), offset( rng ), offset( rng ) );
+
+      boxes[i].min += delta;
+      boxes[i].max += delta;
+      bvh.update( proxies[i], boxes[i] );
+   }
+
+   glm::vec3 randomPoint()
+   {
+      std::uniform_real_distribution<float> position( -worldSize, worldSize );
+      return glm::vec3( position( rng ), position( rng ), position( rng ) );
+   }
+
+   std::mt19937 rng;
+   float worldSize;
+
+   BVH bvh;
+   std::vector<AABB> boxes;
+   std::vector<BVH::ProxyHandle> proxies;
+   Frustum frustum;
+};
+}
+
+// Brute force references
+// ================================================================================================
+static bool FrustumIntersects( const Frustum& frustum, const AABB& box )
+{
+   glm::vec4 planes[Frustum::COUNT];
+   frustum.getPlanes( planes );
+
+   for( const glm::vec4& plane : planes )
+   {
+      const glm::vec3 positive(
+          plane.x > 0.0f ? box.max.x : box.min.x,
+          plane.y > 0.0f ? box.max.y : box.min.y,
+          plane.z > 0.0f ? box.max.z : box.min.z );
+
+      if( glm::dot( glm::vec3( plane ), positive ) + plane.w < 0.0f ) return false;
+   }
+
+   return true;
+}
+
+static std::vector<uint32_t> QueryFrustum( const Scene& scene )
+{
+   std::vector<uint32_t> userDatas;
+   for( uint32_t i = 0; i < scene.boxes.size(); ++i )
+   {
+      if( scene.proxies[i] == BVH::INVALID_PROXY ) continue;
+
+      if( FrustumIntersects( scene.frustum, scene.boxes[i] ) ) userDatas.push_back( i );
+   }
+
+   return userDatas;
+}
+
+static std::vector<uint32_t> QuerySphere( const Scene& scene, const BoundingSphere& sphere )
+{
+   std::vector<uint32_t> userDatas;
+   for( uint32_t i = 0; i < scene.boxes.size(); ++i )
+   {
+      if( scene.proxies[i] == BVH::INVALID_PROXY ) continue;
+
+      const AABB& box         = scene.boxes[i];
+      const glm::vec3 closest = glm::clamp( sphere.center, box.min, box.max );
+      const glm::vec3 delta   = closest - sphere.center;
+      if( glm::dot( delta, delta ) <= sphere.radius * sphere.radius ) userDatas.push_back( i );
+   }
+
+   return userDatas;
+}
+
+// Distance to the closest box, or max float when there is none. Rays are never axis-parallel here
+static float Raycast( const Scene& scene, const BVH::Ray& ray )
+{
+   const glm::vec3 invDirection = 1.0f / ray.direction;
+
+   float closest = std::numeric_limits<float>::max();
+   for( uint32_t i = 0; i < scene.boxes.size(); ++i )
+   {
+      if( scene.proxies[i] == BVH::INVALID_PROXY ) continue;
+
+      const glm::vec3 t0    = ( scene.boxes[i].min - ray.origin ) * invDirection;
+      const glm::vec3 t1    = ( scene.boxes[i].max - ray.origin ) * invDirection;
+      const glm::vec3 tNear = glm::min( t0, t1 );
+      const glm::vec3 tFar  = glm::max( t0, t1 );
+
+      const float enter = std::max( { tNear.x, tNear.y, tNear.z, 0.0f } );
+      const float exit  = std::min( { tFar.x, tFar.y, tFar.z } );
+      if( enter <= exit ) closest = std::min( closest, enter );
+   }
+
+   return closest;
+}
+
+static bool MatchesBruteForce( Scene& scene )
+{
+   std::vector<uint32_t> userDatas;
+   scene.bvh.queryFrustum( scene.frustum, userDatas );
+   std::sort( userDatas.begin(), userDatas.end() );
+   bool isMatching = userDatas == QueryFrustum( scene );
+
+   for( uint32_t i = 0; i < 20; ++i )
+   {
+      const BoundingSphere sphere = { scene.randomPoint(), scene.worldSize / 8.0f };
+
+      userDatas.clear();
+      scene.bvh.querySphere( sphere, userDatas );
+      std::sort( userDatas.begin(), userDatas.end() );
+      isMatching &= userDatas == QuerySphere( scene, sphere );
+
+      const glm::vec3 origin = scene.randomPoint();
+      const BVH::Ray ray     = { origin, glm::normalize( scene.randomPoint() - origin ) };
+
+      const BVH::RayHit hit = scene.bvh.raycast( ray );
+      const float expected  = Raycast( scene, ray );
+      isMatching &= hit.isHit() ? std::abs( hit.distance - expected ) < 1e-3f
+                                : expected == std::numeric_limits<float>::max();
+   }
+
+   return isMatching;
+}
+
+// ================================================================================================
+TEST_CASE( BVHMatchesBruteForce )
+{
+   const uint32_t count = 20000;
+
+   Scene scene( count );
+   scene.bvh.build();
+   CHECK( MatchesBruteForce( scene ) );
+
+   for( uint32_t i = 0; i < count; i += 10 )
+   {
+      scene.move( i );
+   }
+   scene.bvh.refit();
+   CHECK( MatchesBruteForce( scene ) );
+
+   // Removes, inserts and moves while a build runs, then once its tree is applied
+   EMP::ThreadPool threadPool;
+   threadPool.init( 2 );
+
+   scene.bvh.rebuildAsync( threadPool );
+   for( uint32_t i = 3; i < count; i += 7 )
+   {
+      scene.bvh.remove( scene.proxies[i] );
+      scene.proxies[i] = BVH::INVALID_PROXY;
+   }
+   for( uint32_t i = 5; i < count; i += 13 )
+   {
+      if( scene.proxies[i] == BVH::INVALID_PROXY )
+      {
+         scene.proxies[i] = scene.bvh.insert( scene.boxes[i], i );
+      }
+      else
+      {
+         scene.move( i );
+      }
+   }
+   scene.bvh.refit();
+   CHECK( MatchesBruteForce( scene ) );
+
+   while( scene.bvh.isRebuilding() )
+   {
+      scene.bvh.refit();
+   }
+   CHECK( MatchesBruteForce( scene ) );
+
+   threadPool.shutdown();
+}
+
+TEST_CASE( BVHAxisParallelRays )
+{
+   const AABB box = { glm::vec3( 0.0f ), glm::vec3( 1.0f ) };
+
+   // Origins on a face plane of the box, with a zero direction component along that axis
+   const BVH::Ray onFace      = { glm::vec3( -5.0f, 0.0f, 0.5f ), glm::vec3( 1.0f, 0.0f, 0.0f ) };
+   const BVH::Ray onEdge      = { glm::vec3( 0.0f, 1.0f, -5.0f ), glm::vec3( 0.0f, 0.0f, 1.0f ) };
+   const BVH::Ray besideFace  = { glm::vec3( -5.0f, -0.5f, 0.5f ), glm::vec3( 1.0f, 0.0f, 0.0f ) };
+   const BVH::Ray insideAlong = { glm::vec3( 0.5f, 0.5f, 0.5f ), glm::vec3( 0.0f, -1.0f, 0.0f ) };
+
+   // Tested once linearly before a build, and once through the tree
+   BVH bvh;
+   bvh.insert( box, 7 );
+   for( uint32_t pass = 0; pass < 2; ++pass )
+   {
+      CHECK( bvh.raycast( onFace ).userData == 7 );
+      CHECK( bvh.raycast( onFace ).distance == 5.0f );
+      CHECK( bvh.raycast( onEdge ).userData == 7 );
+      CHECK( !bvh.raycast( besideFace ).isHit() );
+      CHECK( bvh.raycast( insideAlong ).distance == 0.0f );
+
+      bvh.build();
+   }
+}
+
+TEST_CASE( BVHBenchmark )
+{
+   EMP::ThreadPool threadPool;
+   threadPool.init( 1 );
+
+   for( const uint32_t count : { 10000u, 100000u, 1000000u } )
+   {
+      Scene scene( count );
+      const double buildMs = Tests::MeasureMs( [&]() { scene.bvh.build(); } );
+
+      // A tenth of the proxies moving every frame
+      const double refitMs = Tests::MeasureMs(
+          [&]()
+          {
+             for( uint32_t i = 0; i < count; i += 10 )
+             {
+                scene.move( i );
+             }
+             scene.bvh.refit();
+          } );
+
+      scene.bvh.rebuildAsync( threadPool );
+      while( scene.bvh.isRebuilding() )
+      {
+         scene.bvh.refit();
+      }
+
+      std::vector<uint32_t> userDatas;
+      const double frustumMs = Tests::MeasureMs(
+          [&]()
+          {
+             userDatas.clear();
+             scene.bvh.queryFrustum( scene.frustum, userDatas );
+          } );
+      const double bruteForceMs = Tests::MeasureMs( [&]() { QueryFrustum( scene ); } );
+
+      std::vector<BVH::Ray> rays( 1000 );
+      std::vector<BVH::RayHit> hits( rays.size() );
+      for( BVH::Ray& ray : rays )
+      {
+         const glm::vec3 origin = scene.randomPoint();
+         ray                    = { origin, glm::normalize( scene.randomPoint() - origin ) };
+      }
+      const double raysMs = Tests::MeasureMs( [&]() { scene.bvh.raycasts( rays, hits ); } );
+
+      printf(
+          "   %u boxes: build %.2fms, move 10%% + refit %.2fms, frustum %.3fms (brute force "
+          "%.3fms, %zu hits), 1000 rays %.3fms\n",
+          count,
+          buildMs,
+          refitMs,
+          frustumMs,
+          bruteForceMs,
+          userDatas.size(),
+          raysMs );
+   }
+
+   threadPool.shutdown();
+}
@@ -0,0 +1,248 @@
+#include <Test.h>
+
+#include <Multithreading/ConcurrentHashMap.h>
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+using EMP::ConcurrentHashMap;
+
+static constexpr uint32_t THREAD_COUNT = 8;
+
+template <class Function>
+static void RunOnThreads( Function&& function )
+{
+   std::vector<std::thread> threads;
+   for( uint32_t threadIdx = 0; threadIdx < THREAD_COUNT; ++threadIdx )
+   {
+      threads.emplace_back( function, threadIdx );
+   }
+
+   for( std::thread& thread : threads )
+   {
+      thread.join();
+   }
+}
+
+// Releases what it owns, it has to be built in place
+struct OwningValue
+{
+   OwningValue() = default;
+   OwningValue( const OwningValue& ) = delete;
+   OwningValue& operator=( const OwningValue& ) = delete;
+   ~OwningValue() { delete value; }
+
+   int* value = nullptr;
+};
+
+TEST_CASE( ConcurrentHashMapOperations )
+{
+   ConcurrentHashMap<std::string, int> map;
+
+   CHECK( map.insert( "a", 1 ) );
+   CHECK( !map.insert( "a", 2 ) );
+   CHECK( *map.find( "a" ) == 1 );
+
+   map.insertOrAssign( "a", 3 );
+   map.insertOrAssign( "b", 4 );
+   CHECK( *map.find( "a" ) == 3 );
+   CHECK( map.size() == 2 );
+
+   CHECK( map.erase( "a" ) );
+   CHECK( !map.erase( "a" ) );
+   CHECK( !map.contains( "a" ) );
+   CHECK( map.size() == 1 );
+
+   // Growing well past the first tables, with tombstones along the way
+   for( int i = 0; i < 10000; ++i )
+   {
+      map.insert( std::to_string( i ), i );
+      if( i % 3 == 0 ) map.erase( std::to_string( i / 2 ) );
+   }
+
+   size_t visitedCount = 0;
+   bool isConsistent   = true;
+   map.forEach(
+       [&]( const std::string& key, int value )
+       {
+          visitedCount++;
+          isConsistent &= key == "b" || std::to_string( value ) == key;
+       } );
+   CHECK( visitedCount == map.size() );
+   CHECK( isConsistent );
+
+   ConcurrentHashMap<int, OwningValue> owningMap;
+   CHECK( owningMap.tryEmplace( 3, []( OwningValue& owning ) { owning.value = new int( 4 ); } ) );
+   CHECK( !owningMap.tryEmplace( 3, []( OwningValue& ) {} ) );
+   CHECK( *owningMap.find( 3 )->value == 4 );
+
+   map.clear();
+   CHECK( map.empty() );
+   CHECK( !map.contains( "b" ) );
+}
+
+TEST_CASE( ConcurrentHashMapBuildsOnce )
+{
+   const int keyCount = 5000;
+
+   ConcurrentHashMap<std::string, int> map;
+   std::atomic<int> buildCount = 0;
+   std::atomic<bool> isCorrect = true;
+
+   RunOnThreads(
+       [&]( uint32_t threadIdx )
+       {
+          for( int i = 0; i < 20000; ++i )
+          {
+             const int key   = i % keyCount;
+             const int value = map.findOrCreate(
+                 std::to_string( key ),
+                 [&]()
+                 {
+                    buildCount++;
+                    return key;
+                 } );
+             if( value != key ) isCorrect = false;
+
+             // Writers on other keys at the same time
+             if( threadIdx == 0 ) map.erase( std::to_string( keyCount + i % 3000 ) );
+             if( threadIdx == 1 ) map.insertOrAssign( std::to_string( keyCount + i % 3000 ), i );
+          }
+       } );
+
+   CHECK( isCorrect );
+   CHECK( buildCount == keyCount );
+}
+
+TEST_CASE( ConcurrentHashMapThrowingFactory )
+{
+   const int keyCount = 200;
+
+   ConcurrentHashMap<int, int> map;
+   std::atomic<int> callCount  = 0;
+   std::atomic<int> throwCount = 0;
+   std::atomic<bool> isCorrect = true;
+
+   // Every third build throws, the waiters on that key have to try again instead of blocking
+   RunOnThreads(
+       [&]( uint32_t )
+       {
+          for( int key = 0; key < keyCount; ++key )
+          {
+             try
+             {
+                const int value = map.findOrCreate(
+                    key,
+                    [&]()
+                    {
+                       std::this_thread::sleep_for( std::chrono::microseconds( 50 ) );
+                       if( callCount++ % 3 == 0 ) throw std::runtime_error( "Build failed" );
+                       return key * 2;
+                    } );
+
+                if( value != key * 2 ) isCorrect = false;
+             }
+             catch( const std::runtime_error& )
+             {
+                throwCount++;
+             }
+          }
+       } );
+
+   CHECK( isCorrect );
+   CHECK( throwCount > 0 );
+   CHECK( map.size() == keyCount );
+
+   // A failed build leaves the key absent
+   try
+   {
+      map.findOrCreate( keyCount, []() -> int { throw std::runtime_error( "Build failed" ); } );
+   }
+   catch( const std::runtime_error& )
+   {
+   }
+
+   CHECK( !map.contains( keyCount ) );
+   CHECK( map.size() == keyCount );
+   CHECK( map.findOrCreate( keyCount, []() { return 5; } ) == 5 );
+}
+
+TEST_CASE( ConcurrentHashMapBenchmark )
+{
+   const int keyCount         = 20000;
+   const uint32_t accessCount = 1 << 18;
+
+   ConcurrentHashMap<int, int> map;
+   std::unordered_map<int, int> lockedMap;
+   std::mutex mutex;
+
+   for( int i = 0; i < keyCount / 2; ++i )
+   {
+      map.insert( i, i );
+      lockedMap[i] = i;
+   }
+
+   // One write every 64 accesses, like a cache warming up
+   std::atomic<uint64_t> foundCount = 0;
+   const double concurrentMs        = Tests::MeasureMs(
+       [&]()
+       {
+          RunOnThreads(
+              [&]( uint32_t threadIdx )
+              {
+                 uint64_t found = 0;
+                 for( uint32_t i = 0; i < accessCount; ++i )
+                 {
+                    const int key = ( ( i + threadIdx ) * 2654435761u ) % keyCount;
+                    if( i % 64 == 0 )
+                    {
+                       map.insert( key, key );
+                    }
+                    else
+                    {
+                       found += map.find( key ) ? 1 : 0;
+                    }
+                 }
+                 foundCount += found;
+              } );
+       } );
+
+   const double lockedMs = Tests::MeasureMs(
+       [&]()
+       {
+          RunOnThreads(
+              [&]( uint32_t threadIdx )
+              {
+                 uint64_t found = 0;
+                 for( uint32_t i = 0; i < accessCount; ++i )
+                 {
+                    const int key = ( ( i + threadIdx ) * 2654435761u ) % keyCount;
+
+                    std::unique_lock<std::mutex> lock( mutex );
+                    if( i % 64 == 0 )
+                    {
+                       lockedMap.emplace( key, key );
+                    }
+                    else
+                    {
+                       found += lockedMap.find( key ) != lockedMap.end() ? 1 : 0;
+                    }
+                 }
+                 foundCount += found;
+              } );
+       } );
+
+   CHECK( map.size() == lockedMap.size() );
+
+   printf(
+       "   %u threads, %u accesses each, 1/64 writes: concurrent map %.2fms, locked "
+       "unordered_map %.2fms\n",
+       THREAD_COUNT,
+       accessCount,
+       concurrentMs,
+       lockedMs );
+}
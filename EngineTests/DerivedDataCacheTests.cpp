@@ -0,0 +1,217 @@
+#include <Test.h>
+
+#include <Graphics/Scene/MeshFile.h>
+#include <Graphics/Utility/MeshGeneration.h>
+#include <Graphics/VertexLayout.h>
+
+#include <IO/DerivedDataCache.h>
+#include <IO/VirtualFileSystem.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+using namespace CYD;
+
+// Empty directory of its own for every test
+static std::string MakeCacheDirectory( const char* name )
+{
+   const std::filesystem::path directory = std::filesystem::temp_directory_path() / name;
+   std::filesystem::remove_all( directory );
+
+   return directory.string();
+}
+
+static bool IsEntry( const EMP::MappedFile& file, const std::vector<uint8_t>& content )
+{
+   return file.getSize() == content.size() &&
+          std::memcmp( file.getData(), content.data(), content.size() ) == 0;
+}
+
+// ================================================================================================
+TEST_CASE( DerivedDataCacheHash )
+{
+   // The reference values of xxHash64
+   CHECK( EMP::DerivedDataCache::Hash( "", 0 ) == 0xEF46DB3751D8E999ull );
+   CHECK( EMP::DerivedDataCache::Hash( "abc", 3 ) == 0x44BC2CF5AD770999ull );
+
+   // Every byte and the seed matter, past the 32 bytes hashed in stripes too
+   std::vector<uint8_t> data( 1000 );
+   for( uint32_t i = 0; i < data.size(); ++i )
+   {
+      data[i] = static_cast<uint8_t>( i * 7 );
+   }
+
+   const uint64_t hash = EMP::DerivedDataCache::Hash( data.data(), data.size() );
+   CHECK( hash == EMP::DerivedDataCache::Hash( data.data(), data.size() ) );
+   CHECK( hash != EMP::DerivedDataCache::Hash( data.data(), data.size(), 1 ) );
+   CHECK( hash != EMP::DerivedDataCache::Hash( data.data(), data.size() - 1 ) );
+
+   bool isEveryByteHashed = true;
+   for( const size_t i : { size_t( 0 ), size_t( 31 ), size_t( 32 ), size_t( 500 ), size_t( 999 ) } )
+   {
+      data[i] ^= 1;
+      isEveryByteHashed &= hash != EMP::DerivedDataCache::Hash( data.data(), data.size() );
+      data[i] ^= 1;
+   }
+   CHECK( isEveryByteHashed );
+}
+
+TEST_CASE( DerivedDataCacheHitsAndMisses )
+{
+   const std::string directory = MakeCacheDirectory( "DerivedDataCacheHitsAndMisses" );
+
+   const std::vector<uint8_t> entry( 10000, 3 );
+   const uint64_t key = EMP::DerivedDataCache::Hash( "source", 6 );
+
+   {
+      EMP::DerivedDataCache cache( directory );
+      EMP::MappedFile file;
+
+      CHECK( !cache.load( key, ".mesh", file ) );
+      CHECK( cache.store( key, ".mesh", entry.data(), entry.size() ) );
+      CHECK( cache.load( key, ".mesh", file ) );
+      CHECK( IsEntry( file, entry ) );
+
+      // The extension is part of the entry
+      EMP::MappedFile otherFile;
+      CHECK( !cache.load( key, ".image", otherFile ) );
+      CHECK( !cache.load( key + 1, ".mesh", otherFile ) );
+
+      const EMP::DerivedDataCache::Stats stats = cache.getStats();
+      CHECK( stats.hitCount == 1 );
+      CHECK( stats.missCount == 3 );
+      CHECK( stats.storeCount == 1 );
+      CHECK( stats.hitBytes == entry.size() );
+      CHECK( stats.storedBytes == entry.size() );
+   }
+
+   // Entries outlive the run that stored them, and nothing but them is left in the directory
+   {
+      EMP::DerivedDataCache cache( directory );
+      EMP::MappedFile file;
+
+      CHECK( cache.load( key, ".mesh", file ) );
+      CHECK( IsEntry( file, entry ) );
+   }
+
+   const auto fileCount = std::distance(
+       std::filesystem::directory_iterator( directory ), std::filesystem::directory_iterator() );
+   CHECK( fileCount == 1 );
+
+   std::filesystem::remove_all( directory );
+}
+
+TEST_CASE( DerivedDataCacheConcurrentStores )
+{
+   const std::string directory = MakeCacheDirectory( "DerivedDataCacheConcurrentStores" );
+   EMP::DerivedDataCache cache( directory );
+
+   // Threads cooking the same source store the same entry at once, loads only ever see it whole
+   const std::vector<uint8_t> entry( 1 << 20, 7 );
+   const uint64_t key = 42;
+
+   std::atomic<uint32_t> partialLoadCount = 0;
+   std::vector<std::thread> threads;
+   for( uint32_t i = 0; i < 4; ++i )
+   {
+      threads.emplace_back(
+          [&]()
+          {
+             for( uint32_t store = 0; store < 20; ++store )
+             {
+                cache.store( key, ".bin", entry.data(), entry.size() );
+
+                EMP::MappedFile file;
+                if( cache.load( key, ".bin", file ) && !IsEntry( file, entry ) )
+                {
+                   partialLoadCount++;
+                }
+             }
+          } );
+   }
+
+   for( std::thread& thread : threads )
+   {
+      thread.join();
+   }
+
+   CHECK( partialLoadCount == 0 );
+   CHECK( cache.getStats().hitCount == 80 );
+
+   const auto fileCount = std::distance(
+       std::filesystem::directory_iterator( directory ), std::filesystem::directory_iterator() );
+   CHECK( fileCount == 1 );
+
+   std::filesystem::remove_all( directory );
+}
+
+TEST_CASE( DerivedDataCacheBenchmark )
+{
+   const std::string directory = MakeCacheDirectory( "DerivedDataCacheBenchmark" );
+   EMP::DerivedDataCache cache( directory );
+
+   // A mesh cooked on a miss and stored, against the hit mapping the cooked mesh back
+   for( const uint32_t resolution : { 64u, 128u, 256u } )
+   {
+      std::vector<Vertex> sourceVertices;
+      std::vector<uint32_t> sourceIndices;
+      MeshGeneration::UnitGrid( sourceVertices, sourceIndices, resolution );
+      for( Vertex& vertex : sourceVertices )
+      {
+         vertex.pos.y = 0.05f * std::sin( vertex.pos.x * 13.0f ) * std::sin( vertex.pos.z * 11.0f );
+      }
+
+      const uint64_t key = EMP::DerivedDataCache::Hash(
+          sourceVertices.data(), sourceVertices.size() * sizeof( Vertex ) );
+
+      CookedMesh cooked;
+      const double coldMs = Tests::MeasureMs(
+          [&]()
+          {
+             std::vector<Vertex> vertices  = sourceVertices;
+             std::vector<uint32_t> indices = sourceIndices;
+
+             cooked = CookedMesh();
+             CookMesh( vertices, indices, VertexFormat::COMPACT, cooked );
+
+             std::vector<uint8_t> file;
+             SerializeMeshFile( cooked, file );
+             cache.store( key, MeshFile::EXTENSION, file.data(), file.size() );
+          },
+          0.0 );
+
+      CookedMesh read;
+      const double warmMs = Tests::MeasureMs(
+          [&]()
+          {
+             EMP::MappedFile cachedFile;
+             cache.load( key, MeshFile::EXTENSION, cachedFile );
+
+             MeshFile meshFile;
+             meshFile.open( EMP::VirtualFile( std::move( cachedFile ) ), "cached" );
+             meshFile.read( read );
+          } );
+      CHECK( read.vertexData == cooked.vertexData );
+
+      printf(
+          "   %ux%u grid: cold cook + store %.2fms, warm hit %.3fms (%.0fx)\n",
+          resolution,
+          resolution,
+          coldMs,
+          warmMs,
+          coldMs / warmMs );
+   }
+
+   const EMP::DerivedDataCache::Stats stats = cache.getStats();
+   printf(
+       "   %ju hits, %ju stores, %.1fMB mapped, %.1fMB stored\n",
+       static_cast<uintmax_t>( stats.hitCount ),
+       static_cast<uintmax_t>( stats.storeCount ),
+       stats.hitBytes / 1048576.0,
+       stats.storedBytes / 1048576.0 );
+
+   std::filesystem::remove_all( directory );
+}
@@ -0,0 +1,278 @@
+#include <Test.h>
+
+#include <Graphics/Scene/DrawList.h>
+
+#include <algorithm>
+#include <random>
+
+using namespace CYD;
+
+namespace
+{
+// What a render system knows about an entity when it adds its draw
+struct Draw
+{
+   PipelineIndex pipelineIdx;
+   MaterialIndex materialIdx;
+   VertexBufferHandle vertexBuffer;
+   float sqDistance;
+};
+}
+
+// Few pipelines, more materials and meshes, like a scene of props
+static std::vector<Draw> MakeDraws( uint32_t count )
+{
+   std::mt19937 rng( 1 );
+
+   std::vector<Draw> draws( count );
+   for( Draw& draw : draws )
+   {
+      draw.pipelineIdx  = rng() % 8;
+      draw.materialIdx  = rng() % 64;
+      draw.vertexBuffer = VertexBufferHandle( rng() % 200, 1, HandleType::VERTEXBUFFER );
+      draw.sqDistance   = static_cast<float>( rng() % 100000 );
+   }
+
+   return draws;
+}
+
+static void FillDrawList( DrawList& drawList, const std::vector<Draw>& draws )
+{
+   drawList.clear();
+   for( uint32_t i = 0; i < draws.size(); ++i )
+   {
+      const Draw& draw = draws[i];
+      drawList.add(
+          DrawList::MakeKey(
+              1, draw.pipelineIdx, draw.materialIdx, draw.vertexBuffer, draw.sqDistance ),
+          i );
+   }
+}
+
+// ================================================================================================
+TEST_CASE( DrawListKeyOrder )
+{
+   const VertexBufferHandle meshA( 0, 1, HandleType::VERTEXBUFFER );
+   const VertexBufferHandle meshB( 1, 1, HandleType::VERTEXBUFFER );
+
+   const uint64_t key = DrawList::MakeKey( 1, 2, 3, meshA, 10.0f );
+
+   // Every field outweighs all of the ones below it
+   CHECK( key < DrawList::MakeKey( 2, 0, 0, {}, 0.0f ) );
+   CHECK( key < DrawList::MakeKey( 1, 3, 0, {}, 0.0f ) );
+   CHECK( key < DrawList::MakeKey( 1, 2, 4, {}, 0.0f ) );
+   CHECK( key < DrawList::MakeKey( 1, 2, 3, meshB, 0.0f ) );
+   CHECK( key < DrawList::MakeKey( 1, 2, 3, meshA, 11.0f ) );
+
+   // A valid handle with index 0 is not the same as no vertex buffer, invalid indices go last
+   CHECK( DrawList::MakeKey( 1, 2, 3, {}, 10.0f ) < key );
+   CHECK( key < DrawList::MakeKey( 1, 2, INVALID_MATERIAL_IDX, meshA, 0.0f ) );
+   CHECK( key < DrawList::MakeKey( 1, INVALID_PIPELINE_IDX, 0, meshA, 0.0f ) );
+
+   // Negative distances clamp to the closest
+   const uint64_t closest = DrawList::MakeKey( 1, 2, 3, meshA, 0.0f );
+   CHECK( DrawList::MakeKey( 1, 2, 3, meshA, -5.0f ) == closest );
+
+   const uint64_t otherPipeline = DrawList::MakeKey( 1, 5, 3, meshA, 10.0f );
+   const uint64_t otherMaterial = DrawList::MakeKey( 1, 2, 5, meshA, 10.0f );
+   const uint64_t otherMesh     = DrawList::MakeKey( 1, 2, 3, meshB, 10.0f );
+   const uint64_t otherDepth    = DrawList::MakeKey( 1, 2, 3, meshA, 500.0f );
+
+   // Pipelines bring their material along
+   CHECK( DrawList::GetStateChanges( key, otherPipeline ) == DrawList::ALL - DrawList::MESH );
+   CHECK( DrawList::GetStateChanges( key, otherMaterial ) == DrawList::MATERIAL );
+   CHECK( DrawList::GetStateChanges( key, otherMesh ) == DrawList::MESH );
+   CHECK( DrawList::GetStateChanges( key, otherDepth ) == DrawList::NONE );
+}
+
+TEST_CASE( DrawListSortMatchesStableSort )
+{
+   // Both sides of the radix sort threshold. Equal keys keep the order they were added in
+   for( const uint32_t count : { 1u, 10u, 63u, 64u, 1000u, 100000u } )
+   {
+      DrawList drawList;
+      FillDrawList( drawList, MakeDraws( count ) );
+
+      std::vector<DrawList::Packet> expected(
+          drawList.getPackets().begin(), drawList.getPackets().end() );
+      std::stable_sort(
+          expected.begin(),
+          expected.end(),
+          []( const DrawList::Packet& first, const DrawList::Packet& second )
+          { return first.key < second.key; } );
+
+      drawList.sort();
+
+      const std::span<const DrawList::Packet> packets = drawList.getPackets();
+      CHECK( packets.size() == expected.size() );
+      CHECK( std::equal(
+          packets.begin(),
+          packets.end(),
+          expected.begin(),
+          []( const DrawList::Packet& first, const DrawList::Packet& second )
+          { return first.key == second.key && first.entityIdx == second.entityIdx; } ) );
+      CHECK( drawList.getStats().drawCount == count );
+   }
+}
+
+TEST_CASE( DrawListBenchmark )
+{
+   for( const uint32_t count : { 1000u, 10000u, 100000u } )
+   {
+      const std::vector<Draw> draws = MakeDraws( count );
+
+      DrawList drawList;
+      const double sortMs = Tests::MeasureMs(
+          [&]()
+          {
+             FillDrawList( drawList, draws );
+             drawList.sort();
+          } );
+
+      // Submitting in entity order, what the systems did before sorting
+      uint32_t unsortedPipelineChanges = 0;
+      uint32_t unsortedMaterialChanges = 0;
+      uint32_t unsortedMeshChanges     = 0;
+      FillDrawList( drawList, draws );
+      const std::span<const DrawList::Packet> unsorted = drawList.getPackets();
+      for( size_t i = 0; i < unsorted.size(); ++i )
+      {
+         const uint32_t changes = i == 0 ? DrawList::ALL
+                                         : DrawList::GetStateChanges(
+                                               unsorted[i - 1].key, unsorted[i].key );
+
+         unsortedPipelineChanges += ( changes & DrawList::PIPELINE ) ? 1 : 0;
+         unsortedMaterialChanges += ( changes & DrawList::MATERIAL ) ? 1 : 0;
+         unsortedMeshChanges += ( changes & DrawList::MESH ) ? 1 : 0;
+      }
+
+      std::vector<DrawList::Packet> packets;
+      const double stdSortMs = Tests::MeasureMs(
+          [&]()
+          {
+             FillDrawList( drawList, draws );
+             packets.assign( drawList.getPackets().begin(), drawList.getPackets().end() );
+             std::sort(
+                 packets.begin(),
+                 packets.end(),
+                 []( const DrawList::Packet& first, const DrawList::Packet& second )
+                 { return first.key < second.key; } );
+          } );
+
+      drawList.sort();
+      const DrawList::Stats& stats = drawList.getStats();
+
+      printf(
+          "   %u draws: fill + sort %.3fms (fill + std::sort %.3fms), pipeline/material/mesh "
+          "changes %u/%u/%u sorted, %u/%u/%u unsorted\n",
+          count,
+          sortMs,
+          stdSortMs,
+          stats.pipelineChanges,
+          stats.materialChanges,
+          stats.meshChanges,
+          unsortedPipelineChanges,
+          unsortedMaterialChanges,
+          unsortedMeshChanges );
+   }
+}
+
+// ================================================================================================
+TEST_CASE( DrawListBatching )
+{
+   const VertexBufferHandle meshA( 0, 1, HandleType::VERTEXBUFFER );
+   const VertexBufferHandle meshB( 1, 1, HandleType::VERTEXBUFFER );
+
+   // 3 draws of mesh A, one that cannot be instanced, 2 that refuse to merge, then 5 of mesh B
+   DrawList drawList;
+   for( uint32_t i = 0; i < 3; ++i )
+   {
+      drawList.add( DrawList::MakeKey( 1, 0, 0, meshA, 1.0f ), 0 );
+   }
+   drawList.add( DrawList::MakeKey( 1, 0, 0, meshA, 2.0f ), 1 );
+   drawList.add( DrawList::MakeKey( 1, 0, 0, meshA, 3.0f ), 2 );
+   drawList.add( DrawList::MakeKey( 1, 0, 0, meshA, 3.0f ), 3 );
+   for( uint32_t i = 0; i < 5; ++i )
+   {
+      drawList.add( DrawList::MakeKey( 1, 0, 0, meshB, 1.0f ), 0 );
+   }
+   drawList.sort();
+
+   const std::span<const DrawList::Packet> packets = drawList.getPackets();
+   const auto canInstance = [&]( uint32_t packetIdx ) { return packets[packetIdx].entityIdx != 1; };
+   const auto canMerge    = [&]( uint32_t prevPacketIdx, uint32_t packetIdx )
+   { return packets[prevPacketIdx].entityIdx != 2 || packets[packetIdx].entityIdx != 3; };
+
+   // At most 4 instances per batch, starting on multiples of 4
+   std::vector<DrawList::Batch> batches;
+   const uint32_t slotCount = drawList.batch( batches, 4, 4, canInstance, canMerge );
+
+   const std::vector<std::pair<uint32_t, uint32_t>> expected = {
+       { 3, 0 }, { 1, UINT32_MAX }, { 1, 4 }, { 1, 8 }, { 4, 12 }, { 1, 16 } };
+
+   CHECK( batches.size() == expected.size() );
+   CHECK( slotCount == 17 );
+
+   uint32_t nextPacket = 0;
+   for( uint32_t i = 0; i < std::min( batches.size(), expected.size() ); ++i )
+   {
+      const bool isInstanced = expected[i].second != UINT32_MAX;
+      CHECK( batches[i].firstPacket == nextPacket );
+      CHECK( batches[i].packetCount == expected[i].first );
+      CHECK( batches[i].isInstanced == isInstanced );
+      CHECK( !isInstanced || batches[i].firstInstance == expected[i].second );
+
+      nextPacket += batches[i].packetCount;
+   }
+}
+
+TEST_CASE( DrawListBatchingBenchmark )
+{
+   // Identical props, 4 meshes and 2 materials on one pipeline, as many draw calls as batches
+   for( const uint32_t count : { 1000u, 5000u, 20000u, 100000u } )
+   {
+      std::mt19937 rng( 3 );
+
+      std::vector<Draw> draws( count );
+      for( uint32_t i = 0; i < count; ++i )
+      {
+         draws[i].pipelineIdx  = 0;
+         draws[i].materialIdx  = i % 2;
+         draws[i].vertexBuffer = VertexBufferHandle( i % 4, 1, HandleType::VERTEXBUFFER );
+         draws[i].sqDistance   = static_cast<float>( rng() % 1000000 );
+      }
+
+      DrawList drawList;
+      FillDrawList( drawList, draws );
+      drawList.sort();
+
+      std::vector<DrawList::Batch> batches;
+      uint32_t slotCount = 0;
+
+      const double batchMs = Tests::MeasureMs(
+          [&]()
+          {
+             slotCount = drawList.batch(
+                 batches,
+                 1024,
+                 4,
+                 []( uint32_t ) { return true; },
+                 []( uint32_t, uint32_t ) { return true; } );
+          } );
+
+      uint32_t instanceCount = 0;
+      for( const DrawList::Batch& batch : batches )
+      {
+         instanceCount += batch.packetCount;
+      }
+      CHECK( instanceCount == count );
+      CHECK( slotCount >= count );
+
+      printf(
+          "   %u props: %zu draw calls instead of %u, batching %.3fms\n",
+          count,
+          batches.size(),
+          count,
+          batchMs );
+   }
+}
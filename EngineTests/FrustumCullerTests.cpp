@@ -0,0 +1,146 @@
+#include <Test.h>
+
+#include <Graphics/Scene/Bounds.h>
+#include <Graphics/Scene/Frustum.h>
+#include <Graphics/Scene/FrustumCuller.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <random>
+
+using namespace CYD;
+
+static Frustum MakeFrustum()
+{
+   const glm::mat4 projMat = glm::perspective( 1.0f, 1.7f, 0.1f, 1000.0f );
+   const glm::mat4 viewMat = glm::lookAt(
+       glm::vec3( 0.0f ), glm::vec3( 1.0f, 0.2f, 0.3f ), glm::vec3( 0.0f, 1.0f, 0.0f ) );
+
+   Frustum frustum;
+   frustum.update( projMat, viewMat );
+
+   return frustum;
+}
+
+// Random boxes around the camera, some of them rotated, and boxes centered on the planes of the
+// frustum so that they straddle them
+static void FillCuller( FrustumCuller& culler, uint32_t count, const Frustum& frustum )
+{
+   glm::vec4 planes[Frustum::COUNT];
+   frustum.getPlanes( planes );
+
+   std::mt19937 rng( 3 );
+   std::uniform_real_distribution<float> position( -500.0f, 500.0f );
+   std::uniform_real_distribution<float> extent( 0.1f, 20.0f );
+
+   culler.resize( count );
+   for( uint32_t i = 0; i < count; ++i )
+   {
+      glm::vec3 center( position( rng ), position( rng ), position( rng ) );
+      const glm::vec3 extents( extent( rng ), extent( rng ), extent( rng ) );
+
+      if( i % 3 == 0 )
+      {
+         const glm::vec4& plane = planes[i % Frustum::COUNT];
+         center -= ( glm::dot( glm::vec3( plane ), center ) + plane.w ) * glm::vec3( plane );
+      }
+
+      const AABB box = { center - extents, center + extents };
+      if( i % 5 == 0 )
+      {
+         const glm::mat4 rotation =
+             glm::rotate( glm::mat4( 1.0f ), position( rng ), glm::vec3( 0.27f, 0.53f, 0.80f ) );
+         culler.setBounds( i, box.transform( rotation ) );
+      }
+      else
+      {
+         culler.setBounds( i, box );
+      }
+   }
+}
+
+TEST_CASE( FrustumCullerMatchesScalar )
+{
+   const Frustum frustum = MakeFrustum();
+
+   // Not a multiple of the batch size, the padding is never visible
+   for( const uint32_t count : { 1u, 7u, 8u, 9u, 1001u, 100003u } )
+   {
+      FrustumCuller culler;
+      FillCuller( culler, count, frustum );
+
+      std::vector<uint32_t> visible;
+      std::vector<uint32_t> reference;
+      culler.cull( frustum, visible );
+      culler.cullScalar( frustum, reference );
+
+      CHECK( visible == reference );
+   }
+}
+
+TEST_CASE( FrustumCullerStraddlingBoxes )
+{
+   const Frustum frustum = MakeFrustum();
+
+   glm::vec4 planes[Frustum::COUNT];
+   frustum.getPlanes( planes );
+
+   // Points well inside the frustum pushed on each plane, boxes centered there are cut in half
+   const glm::vec3 inside = glm::normalize( glm::vec3( 1.0f, 0.2f, 0.3f ) ) * 50.0f;
+
+   FrustumCuller culler;
+   culler.resize( 2 * Frustum::COUNT + 2 );
+   for( uint32_t p = 0; p < Frustum::COUNT; ++p )
+   {
+      const glm::vec3 normal( planes[p] );
+      const glm::vec3 onPlane = inside - ( glm::dot( normal, inside ) + planes[p].w ) * normal;
+
+      // Straddling, and entirely behind the plane
+      culler.setBounds( 2 * p, { onPlane - glm::vec3( 0.01f ), onPlane + glm::vec3( 0.01f ) } );
+
+      const glm::vec3 behind = onPlane - normal * 1.0f;
+      culler.setBounds( 2 * p + 1, { behind - glm::vec3( 0.01f ), behind + glm::vec3( 0.01f ) } );
+   }
+
+   culler.setAlwaysVisible( 2 * Frustum::COUNT );
+   culler.setNeverVisible( 2 * Frustum::COUNT + 1 );
+
+   std::vector<uint32_t> visible;
+   std::vector<uint32_t> reference;
+   culler.cull( frustum, visible );
+   culler.cullScalar( frustum, reference );
+
+   std::vector<uint32_t> expected;
+   for( uint32_t p = 0; p < Frustum::COUNT; ++p )
+   {
+      expected.push_back( 2 * p );
+   }
+   expected.push_back( 2 * Frustum::COUNT );
+
+   CHECK( visible == expected );
+   CHECK( reference == expected );
+}
+
+TEST_CASE( FrustumCullerBenchmark )
+{
+   const uint32_t count  = 100000;
+   const Frustum frustum = MakeFrustum();
+
+   FrustumCuller culler;
+   FillCuller( culler, count, frustum );
+
+   std::vector<uint32_t> visible;
+   std::vector<uint32_t> reference;
+
+   const double simdMs   = Tests::MeasureMs( [&]() { culler.cull( frustum, visible ); } );
+   const double scalarMs = Tests::MeasureMs( [&]() { culler.cullScalar( frustum, reference ); } );
+
+   CHECK( visible == reference );
+
+   printf(
+       "   %u boxes, %zu visible: vectorized %.3fms, scalar %.3fms\n",
+       count,
+       visible.size(),
+       simdMs,
+       scalarMs );
+}
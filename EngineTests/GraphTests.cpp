@@ -0,0 +1,219 @@
+#include <Test.h>
+
+#include <Graph/CSRGraph.h>
+
+#include <Multithreading/ThreadPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+
+using EMP::CSRGraph;
+
+// Wide DAG, every node depends on a parent in the previous layers and on a few random earlier nodes
+static void BuildGraph( CSRGraph& graph, uint32_t nodeCount )
+{
+   std::mt19937 rng( 7 );
+
+   graph.reset();
+   graph.reserve( nodeCount, nodeCount * 3 );
+   graph.addNodes( nodeCount );
+   for( uint32_t node = 1; node < nodeCount; ++node )
+   {
+      graph.addEdge( ( node - 1 ) / 4, node );
+      if( node > 8 )
+      {
+         graph.addEdge( rng() % ( node - 1 ), node );
+      }
+   }
+
+   graph.build();
+}
+
+// Depth of every node from the root, UINT32_MAX when it cannot be reached
+static std::vector<uint32_t> ComputeDepths( const CSRGraph& graph, CSRGraph::NodeHandle root )
+{
+   std::vector<uint32_t> depths( graph.getNodeCount(), UINT32_MAX );
+   depths[root] = 0;
+
+   graph.breadthFirstSearch(
+       root,
+       [&]( CSRGraph::NodeHandle node )
+       {
+          for( const CSRGraph::NodeHandle child : graph.getChildren( node ) )
+          {
+             depths[child] = std::min( depths[child], depths[node] + 1 );
+          }
+       } );
+
+   return depths;
+}
+
+TEST_CASE( CSRGraphTopologicalSort )
+{
+   const uint32_t nodeCount = 100000;
+
+   CSRGraph graph;
+   BuildGraph( graph, nodeCount );
+
+   std::vector<CSRGraph::NodeHandle> order;
+   CHECK( graph.topologicalSort( order ) );
+   CHECK( order.size() == nodeCount );
+
+   std::vector<uint32_t> positions( nodeCount );
+   for( uint32_t i = 0; i < order.size(); ++i )
+   {
+      positions[order[i]] = i;
+   }
+
+   std::vector<uint32_t> levelOffsets;
+   CHECK( graph.topologicalLevels( order, levelOffsets ) );
+   CHECK( order.size() == nodeCount );
+
+   std::vector<uint32_t> levels( nodeCount );
+   for( uint32_t level = 0; level + 1 < levelOffsets.size(); ++level )
+   {
+      for( uint32_t i = levelOffsets[level]; i < levelOffsets[level + 1]; ++i )
+      {
+         levels[order[i]] = level;
+      }
+   }
+
+   // Parents come first, and in an earlier level
+   bool isOrdered = true;
+   for( CSRGraph::NodeHandle node = 0; node < nodeCount; ++node )
+   {
+      for( const CSRGraph::NodeHandle child : graph.getChildren( node ) )
+      {
+         isOrdered &= positions[node] < positions[child] && levels[node] < levels[child];
+      }
+   }
+   CHECK( isOrdered );
+
+   // A cycle makes the sort fail
+   graph.addEdge( nodeCount - 1, 0 );
+   graph.build();
+   CHECK( !graph.topologicalSort( order ) );
+   CHECK( !graph.topologicalLevels( order, levelOffsets ) );
+}
+
+TEST_CASE( CSRGraphTraversals )
+{
+   const uint32_t nodeCount = 100000;
+
+   CSRGraph graph;
+   BuildGraph( graph, nodeCount );
+
+   std::vector<uint32_t> dfsVisits( nodeCount, 0 );
+   std::vector<uint32_t> bfsVisits( nodeCount, 0 );
+   graph.depthFirstSearch( 0, [&]( CSRGraph::NodeHandle node ) { dfsVisits[node]++; } );
+   graph.breadthFirstSearch( 0, [&]( CSRGraph::NodeHandle node ) { bfsVisits[node]++; } );
+
+   const auto once = []( uint32_t visits ) { return visits == 1; };
+   CHECK( std::all_of( dfsVisits.begin(), dfsVisits.end(), once ) );
+   CHECK( std::all_of( bfsVisits.begin(), bfsVisits.end(), once ) );
+
+   // Every node visited once, and a level is done before the next one starts
+   EMP::ThreadPool threadPool;
+   threadPool.init( 4 );
+
+   std::atomic<uint32_t> nextTicket = 0;
+   std::vector<std::atomic<uint32_t>> tickets( nodeCount );
+   std::vector<std::atomic<uint32_t>> parallelVisits( nodeCount );
+   graph.parallelBreadthFirstSearch(
+       threadPool,
+       0,
+       [&]( CSRGraph::NodeHandle node )
+       {
+          parallelVisits[node]++;
+          tickets[node] = nextTicket++;
+       } );
+
+   threadPool.shutdown();
+
+   const std::vector<uint32_t> depths = ComputeDepths( graph, 0 );
+   const uint32_t maxDepth            = *std::max_element( depths.begin(), depths.end() );
+
+   std::vector<uint32_t> firstTickets( maxDepth + 1, UINT32_MAX );
+   std::vector<uint32_t> lastTickets( maxDepth + 1, 0 );
+
+   bool isVisitedOnce = true;
+   for( CSRGraph::NodeHandle node = 0; node < nodeCount; ++node )
+   {
+      isVisitedOnce &= parallelVisits[node] == 1;
+      firstTickets[depths[node]] = std::min<uint32_t>( firstTickets[depths[node]], tickets[node] );
+      lastTickets[depths[node]]  = std::max<uint32_t>( lastTickets[depths[node]], tickets[node] );
+   }
+   CHECK( isVisitedOnce );
+
+   bool isLevelSynchronous = true;
+   for( uint32_t depth = 0; depth < maxDepth; ++depth )
+   {
+      isLevelSynchronous &= lastTickets[depth] < firstTickets[depth + 1];
+   }
+   CHECK( isLevelSynchronous );
+}
+
+TEST_CASE( CSRGraphParallelSearchOnWorker )
+{
+   CSRGraph graph;
+   BuildGraph( graph, 100000 );
+
+   // The only worker runs the search, it must not wait on chunks queued behind itself
+   EMP::ThreadPool threadPool;
+   threadPool.init( 1 );
+
+   std::atomic<uint32_t> visitCount = 0;
+   threadPool
+       .submit(
+           [&]()
+           {
+              graph.parallelBreadthFirstSearch(
+                  threadPool, 0, [&]( CSRGraph::NodeHandle ) { visitCount++; } );
+           } )
+       .wait();
+
+   threadPool.shutdown();
+
+   CHECK( visitCount == graph.getNodeCount() );
+}
+
+TEST_CASE( CSRGraphBenchmark )
+{
+   EMP::ThreadPool threadPool;
+   threadPool.init( std::max( 2u, std::thread::hardware_concurrency() ) - 1 );
+
+   for( const uint32_t nodeCount : { 100000u, 1000000u } )
+   {
+      CSRGraph graph;
+      const double buildMs = Tests::MeasureMs( [&]() { BuildGraph( graph, nodeCount ); } );
+
+      std::vector<CSRGraph::NodeHandle> order;
+      std::vector<uint32_t> levelOffsets;
+      const double sortMs   = Tests::MeasureMs( [&]() { graph.topologicalSort( order ); } );
+      const double levelsMs = Tests::MeasureMs(
+          [&]() { graph.topologicalLevels( order, levelOffsets ); } );
+
+      std::atomic<uint64_t> sum = 0;
+      const auto visitor        = [&sum]( CSRGraph::NodeHandle node ) { sum += node; };
+
+      const double bfsMs = Tests::MeasureMs( [&]() { graph.breadthFirstSearch( 0, visitor ); } );
+      const double parallelBfsMs = Tests::MeasureMs(
+          [&]() { graph.parallelBreadthFirstSearch( threadPool, 0, visitor ); } );
+
+      printf(
+          "   %u nodes, %u edges: build %.2fms, sort %.2fms, levels %.2fms, BFS %.2fms, "
+          "parallel BFS %.2fms on %u workers\n",
+          nodeCount,
+          graph.getEdgeCount(),
+          buildMs,
+          sortMs,
+          levelsMs,
+          bfsMs,
+          parallelBfsMs,
+          threadPool.getThreadCount() );
+   }
+
+   threadPool.shutdown();
+}
@@ -0,0 +1,69 @@
+#include <Test.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// Runs the correctness tests and benchmarks of the engine, without any window or GPU. Without
+// arguments every test is run, otherwise only the tests whose name contains one of the arguments.
+// Returns 1 if any check failed
+
+namespace Tests
+{
+static uint32_t s_failureCount = 0;
+
+std::vector<TestCase>& GetTestCases()
+{
+   static std::vector<TestCase> testCases;
+   return testCases;
+}
+
+void ReportFailure( const char* file, int line, const char* expression )
+{
+   printf( "   FAILED %s:%d: %s\n", file, line, expression );
+   s_failureCount++;
+}
+}
+
+static bool IsSelected( const char* name, int argc, char** argv )
+{
+   if( argc <= 1 ) return true;
+
+   for( int i = 1; i < argc; ++i )
+   {
+      if( strstr( name, argv[i] ) ) return true;
+   }
+
+   return false;
+}
+
+int main( int argc, char** argv )
+{
+   uint32_t runCount    = 0;
+   uint32_t failedCount = 0;
+
+   for( const Tests::TestCase& testCase : Tests::GetTestCases() )
+   {
+      if( !IsSelected( testCase.name, argc, argv ) ) continue;
+
+      printf( "%s\n", testCase.name );
+
+      const uint32_t prevFailureCount = Tests::s_failureCount;
+      const auto start                = std::chrono::steady_clock::now();
+
+      testCase.function();
+
+      const std::chrono::duration<double, std::milli> duration =
+          std::chrono::steady_clock::now() - start;
+
+      const bool passed = Tests::s_failureCount == prevFailureCount;
+      printf( "   %s in %.1fms\n", passed ? "passed" : "FAILED", duration.count() );
+
+      runCount++;
+      failedCount += passed ? 0 : 1;
+   }
+
+   printf( "%u tests, %u failed\n", runCount, failedCount );
+
+   return failedCount ? 1 : 0;
+}
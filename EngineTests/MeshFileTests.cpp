@@ -0,0 +1,231 @@
+#include <Test.h>
+
+#include <Graphics/Scene/MeshFile.h>
+#include <Graphics/Utility/MeshGeneration.h>
+#include <Graphics/Utility/ObjImporter.h>
+#include <Graphics/VertexLayout.h>
+
+#include <IO/MappedFile.h>
+#include <IO/VirtualFileSystem.h>
+#include <Multithreading/ThreadPool.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace CYD;
+
+static std::string GetTempPath( const char* name )
+{
+   return ( std::filesystem::temp_directory_path() / name ).string();
+}
+
+// Wavy grid of resolution x resolution quads with positions, UVs and normals, the way exporters
+// write them
+static void WriteObjGrid( const std::string& path, uint32_t resolution )
+{
+   FILE* file = fopen( path.c_str(), "w" );
+
+   const uint32_t side = resolution + 1;
+   for( uint32_t z = 0; z < side; ++z )
+   {
+      for( uint32_t x = 0; x < side; ++x )
+      {
+         const float u = x / static_cast<float>( resolution );
+         const float v = z / static_cast<float>( resolution );
+         fprintf( file, "v %f %f %f\n", u - 0.5f, 0.02f * std::sin( u * 40.0f ), v - 0.5f );
+         fprintf( file, "vt %f %f\n", u, v );
+         fprintf( file, "vn %f %f %f\n", 0.0f, 1.0f, 0.0f );
+      }
+   }
+
+   for( uint32_t z = 0; z < resolution; ++z )
+   {
+      for( uint32_t x = 0; x < resolution; ++x )
+      {
+         // OBJ indices start at 1
+         const uint32_t corner    = z * side + x + 1;
+         const uint32_t corners[] = { corner, corner + side, corner + side + 1, corner + 1 };
+
+         fprintf( file, "f" );
+         for( const uint32_t index : corners )
+         {
+            fprintf( file, " %u/%u/%u", index, index, index );
+         }
+         fprintf( file, "\n" );
+      }
+   }
+
+   fclose( file );
+}
+
+static bool OpenMeshFile( const std::string& path, MeshFile& meshFile )
+{
+   EMP::MappedFile mappedFile;
+   if( !mappedFile.open( path ) ) return false;
+
+   return meshFile.open( EMP::VirtualFile( std::move( mappedFile ) ), path );
+}
+
+// Bumpy grid, large enough for meshlets and LODs
+static void CookGrid( CookedMesh& cooked )
+{
+   std::vector<Vertex> vertices;
+   std::vector<uint32_t> indices;
+   MeshGeneration::UnitGrid( vertices, indices, 64 );
+   for( Vertex& vertex : vertices )
+   {
+      vertex.pos.y = 0.05f * std::sin( vertex.pos.x * 13.0f ) * std::sin( vertex.pos.z * 11.0f );
+   }
+
+   CookMesh( vertices, indices, VertexFormat::COMPACT, cooked );
+}
+
+// ================================================================================================
+TEST_CASE( MeshFileRoundTrip )
+{
+   CookedMesh cooked;
+   CookGrid( cooked );
+   cooked.header.sourceKey = 42;
+
+   CHECK( cooked.header.lodCount > 1 );
+   CHECK( cooked.header.meshletCount > 1 );
+   CHECK( cooked.cookedCache.acmr < cooked.sourceCache.acmr );
+   CHECK( cooked.cookedCache.atvr >= 1.0f );
+
+   const std::string path = GetTempPath( "MeshFileRoundTrip.cydmesh" );
+   CHECK( WriteMeshFile( path, cooked ) );
+
+   // Every stream comes back as it was cooked, aligned for the GPU copies
+   MeshFile meshFile;
+   CHECK( OpenMeshFile( path, meshFile ) );
+
+   CookedMesh read;
+   meshFile.read( read );
+
+   const MeshFileHeader& header = meshFile.getHeader();
+   CHECK( header.sourceKey == 42 );
+   CHECK( header.vertexCount == cooked.header.vertexCount );
+   CHECK( header.indexCount == cooked.header.indexCount );
+   CHECK( header.indexType == cooked.header.indexType );
+   CHECK( header.vertexOffset % 16 == 0 && header.indexOffset % 16 == 0 );
+   CHECK( read.vertexData == cooked.vertexData );
+   CHECK( read.indexData == cooked.indexData );
+   CHECK( std::memcmp(
+              read.lods.data(), cooked.lods.data(), header.lodCount * sizeof( MeshLod ) ) == 0 );
+   CHECK( read.meshlets.size() == cooked.meshlets.size() );
+   CHECK( std::memcmp(
+              read.meshlets.data(),
+              cooked.meshlets.data(),
+              read.meshlets.size() * sizeof( Meshlet ) ) == 0 );
+
+   meshFile = MeshFile();
+   std::filesystem::remove( path );
+}
+
+TEST_CASE( MeshFileRejectsInvalidFiles )
+{
+   CookedMesh cooked;
+   CookGrid( cooked );
+
+   std::vector<uint8_t> file;
+   SerializeMeshFile( cooked, file );
+
+   const std::string path = GetTempPath( "MeshFileRejectsInvalidFiles.cydmesh" );
+   const auto writeFile   = [&]( const std::vector<uint8_t>& content )
+   {
+      std::ofstream stream( path, std::ios::binary | std::ios::trunc );
+      stream.write( reinterpret_cast<const char*>( content.data() ), content.size() );
+   };
+
+   MeshFile meshFile;
+
+   // Cut in the middle of its streams
+   writeFile( std::vector<uint8_t>( file.begin(), file.begin() + file.size() / 2 ) );
+   CHECK( !OpenMeshFile( path, meshFile ) );
+
+   // Of another version
+   std::vector<uint8_t> oldFile = file;
+   reinterpret_cast<MeshFileHeader*>( oldFile.data() )->version = MeshFileHeader::VERSION - 1;
+   writeFile( oldFile );
+   CHECK( !OpenMeshFile( path, meshFile ) );
+
+   writeFile( file );
+   CHECK( OpenMeshFile( path, meshFile ) );
+
+   meshFile = MeshFile();
+   std::filesystem::remove( path );
+}
+
+TEST_CASE( MeshFileSourceKey )
+{
+   const char obj[]       = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+   const char editedObj[] = "v 0 0 0\nv 2 0 0\nv 0 1 0\nf 1 2 3\n";
+
+   // The key follows the content of the OBJ file and the format it is cooked in, a mesh file
+   // holding another key is stale
+   const uint64_t key = GetMeshSourceKey( obj, sizeof( obj ), VertexFormat::COMPACT );
+   CHECK( key == GetMeshSourceKey( obj, sizeof( obj ), VertexFormat::COMPACT ) );
+   CHECK( key != GetMeshSourceKey( editedObj, sizeof( editedObj ), VertexFormat::COMPACT ) );
+   CHECK( key != GetMeshSourceKey( obj, sizeof( obj ), 0 ) );
+   CHECK( key != 0 );
+}
+
+TEST_CASE( MeshFileBenchmark )
+{
+   EMP::ThreadPool threadPool;
+   threadPool.init( 1 );
+
+   // Importing and cooking the OBJ file, what a mesh without a mesh file costs, against mapping
+   // the mesh file and copying its streams out
+   for( const uint32_t resolution : { 64u, 128u, 256u } )
+   {
+      const std::string objPath  = GetTempPath( "MeshFileBenchmark.obj" );
+      const std::string meshPath = GetTempPath( "MeshFileBenchmark.cydmesh" );
+      WriteObjGrid( objPath, resolution );
+
+      CookedMesh cooked;
+      const double cookMs = Tests::MeasureMs(
+          [&]()
+          {
+             std::vector<Vertex> vertices;
+             std::vector<uint32_t> indices;
+             ObjImporter::Import( objPath, vertices, indices, threadPool );
+
+             cooked = CookedMesh();
+             CookMesh( vertices, indices, VertexFormat::COMPACT, cooked );
+          },
+          0.0 );
+
+      WriteMeshFile( meshPath, cooked );
+
+      CookedMesh read;
+      const double loadMs = Tests::MeasureMs(
+          [&]()
+          {
+             MeshFile meshFile;
+             OpenMeshFile( meshPath, meshFile );
+             meshFile.read( read );
+          } );
+      CHECK( read.indexData == cooked.indexData );
+
+      printf(
+          "   %ux%u grid, %u vertices: OBJ import + cook %.2fms, mesh file %.3fms (%.0fx), %ju "
+          "bytes instead of %ju\n",
+          resolution,
+          resolution,
+          cooked.header.vertexCount,
+          cookMs,
+          loadMs,
+          cookMs / loadMs,
+          static_cast<uintmax_t>( std::filesystem::file_size( meshPath ) ),
+          static_cast<uintmax_t>( std::filesystem::file_size( objPath ) ) );
+
+      std::filesystem::remove( objPath );
+      std::filesystem::remove( meshPath );
+   }
+
+   threadPool.shutdown();
+}
@@ -0,0 +1,275 @@
+#include <Test.h>
+
+#include <Graphics/Scene/Bounds.h>
+#include <Graphics/Scene/MeshLodSelector.h>
+#include <Graphics/Utility/MeshGeneration.h>
+#include <Graphics/Utility/MeshSimplification.h>
+#include <Graphics/VertexLayout.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace CYD;
+
+// Unit grid with bumps of a few hundredths, so that every collapse has a cost
+static void MakeHeightfield(
+    std::vector<Vertex>& vertices,
+    std::vector<uint32_t>& indices,
+    uint32_t resolution )
+{
+   MeshGeneration::UnitGrid( vertices, indices, resolution );
+   for( Vertex& vertex : vertices )
+   {
+      vertex.pos.y = 0.05f * std::sin( vertex.pos.x * 13.0f ) * std::sin( vertex.pos.z * 11.0f ) +
+                     0.02f * std::sin( vertex.pos.x * 41.0f + vertex.pos.z * 37.0f );
+   }
+}
+
+static float GetArea( const std::vector<Vertex>& vertices, const uint32_t* indices, size_t count )
+{
+   float area = 0.0f;
+   for( size_t i = 0; i < count; i += 3 )
+   {
+      const glm::vec3 edge0 = vertices[indices[i + 1]].pos - vertices[indices[i]].pos;
+      const glm::vec3 edge1 = vertices[indices[i + 2]].pos - vertices[indices[i]].pos;
+      area += 0.5f * glm::length( glm::cross( edge0, edge1 ) );
+   }
+
+   return area;
+}
+
+static bool IsValidTriangleList(
+    const std::vector<Vertex>& vertices,
+    const uint32_t* indices,
+    size_t count )
+{
+   bool isValid = count % 3 == 0;
+   for( size_t i = 0; i < count; i += 3 )
+   {
+      isValid &= indices[i] < vertices.size() && indices[i + 1] < vertices.size() &&
+                 indices[i + 2] < vertices.size();
+      isValid &= indices[i] != indices[i + 1] && indices[i + 1] != indices[i + 2] &&
+                 indices[i] != indices[i + 2];
+   }
+
+   return isValid;
+}
+
+// ================================================================================================
+TEST_CASE( MeshSimplificationFlatGrid )
+{
+   std::vector<Vertex> vertices;
+   std::vector<uint32_t> indices;
+   MeshGeneration::UnitGrid( vertices, indices, 32 );
+
+   // A flat square collapses to a handful of triangles without error, its corners stay and it
+   // keeps its area
+   std::vector<uint32_t> result;
+   const float error = MeshSimplification::Simplify( vertices, indices, 6, result );
+
+   CHECK( error < 1e-5f );
+   CHECK( result.size() < indices.size() / 50 );
+   CHECK( IsValidTriangleList( vertices, result.data(), result.size() ) );
+   CHECK( std::abs( GetArea( vertices, result.data(), result.size() ) - 1.0f ) < 1e-4f );
+
+   AABB bounds;
+   for( const uint32_t index : result )
+   {
+      bounds.extend( vertices[index].pos );
+   }
+   CHECK( bounds.min.x == 0.0f && bounds.min.z == 0.0f );
+   CHECK( bounds.max.x == 1.0f && bounds.max.z == 1.0f );
+}
+
+TEST_CASE( MeshSimplificationLodChain )
+{
+   std::vector<Vertex> vertices;
+   std::vector<uint32_t> indices;
+   MakeHeightfield( vertices, indices, 64 );
+
+   std::vector<uint32_t> lodIndices;
+   std::array<MeshLod, MAX_MESH_LODS> lods;
+   const uint32_t lodCount =
+       MeshSimplification::GenerateLods( vertices, indices, lodIndices, lods );
+
+   CHECK( lodCount == MAX_MESH_LODS );
+   CHECK( lods[0].firstIndex == 0 && lods[0].indexCount == indices.size() );
+   CHECK( lods[0].error == 0.0f );
+   CHECK( std::equal( indices.begin(), indices.end(), lodIndices.begin() ) );
+
+   // Each LOD about halves the triangles, gets a larger error and keeps the area of the grid
+   const float fullArea = GetArea( vertices, indices.data(), indices.size() );
+   for( uint32_t lod = 1; lod < lodCount; ++lod )
+   {
+      const uint32_t* lodStart = lodIndices.data() + lods[lod].firstIndex;
+
+      CHECK( lods[lod].firstIndex == lods[lod - 1].firstIndex + lods[lod - 1].indexCount );
+      CHECK( lods[lod].indexCount <= lods[lod - 1].indexCount * 6 / 10 );
+      CHECK( lods[lod].error >= lods[lod - 1].error );
+      CHECK( lods[lod].error < 0.07f );
+      CHECK( IsValidTriangleList( vertices, lodStart, lods[lod].indexCount ) );
+      CHECK( std::abs( GetArea( vertices, lodStart, lods[lod].indexCount ) / fullArea - 1.0f ) <
+             0.05f );
+   }
+}
+
+TEST_CASE( MeshLodSelectorHysteresis )
+{
+   std::array<MeshLod, MAX_MESH_LODS> lods;
+   for( uint32_t lod = 0; lod < MAX_MESH_LODS; ++lod )
+   {
+      lods[lod].indexCount = 3000 >> lod;
+      lods[lod].error      = lod == 0 ? 0.0f : 0.01f * static_cast<float>( 1 << lod );
+   }
+
+   const glm::mat4 projMat = glm::perspective( glm::radians( 60.0f ), 16.0f / 9.0f, 0.1f, 1e4f );
+
+   MeshLodSelector selector;
+   selector.setErrorThreshold( 1.0f );
+   selector.setHysteresis( 0.25f );
+   selector.begin( glm::vec3( 0.0f ), projMat, 1080 );
+
+   const auto selectAt = [&]( uint32_t currentLod, float distance )
+   {
+      const BoundingSphere sphere = { glm::vec3( 0.0f, 0.0f, distance ), 1.0f };
+      return selector.select( lods, MAX_MESH_LODS, currentLod, sphere, 1.0f );
+   };
+
+   // Walking away, the LOD only ever gets coarser and ends at the coarsest
+   uint32_t lod         = 0;
+   bool isMonotonic     = true;
+   float switchDistance = 0.0f;
+   for( float distance = 2.0f; distance < 1000.0f; distance *= 1.01f )
+   {
+      const uint32_t nextLod = selectAt( lod, distance );
+      isMonotonic &= nextLod >= lod;
+
+      if( lod == 0 && nextLod == 1 ) switchDistance = distance;
+      lod = nextLod;
+   }
+   CHECK( isMonotonic );
+   CHECK( lod == MAX_MESH_LODS - 1 );
+   CHECK( switchDistance > 0.0f );
+
+   // Shaking around the distance LOD 1 was picked at does not flip it back
+   selector.begin( glm::vec3( 0.0f ), projMat, 1080 );
+   lod = 1;
+   for( uint32_t frame = 0; frame < 100; ++frame )
+   {
+      lod = selectAt( lod, switchDistance * ( frame % 2 ? 1.02f : 0.98f ) );
+   }
+   CHECK( selector.getStats().switchCount == 0 );
+}
+
+TEST_CASE( MeshLodBenchmark )
+{
+   for( const uint32_t resolution : { 64u, 128u, 256u } )
+   {
+      std::vector<Vertex> vertices;
+      std::vector<uint32_t> indices;
+      MakeHeightfield( vertices, indices, resolution );
+
+      std::vector<uint32_t> lodIndices;
+      std::array<MeshLod, MAX_MESH_LODS> lods;
+      uint32_t lodCount = 0;
+
+      const double generateMs = Tests::MeasureMs(
+          [&]()
+          { lodCount = MeshSimplification::GenerateLods( vertices, indices, lodIndices, lods ); },
+          0.0 );
+
+      const size_t triangleCount = indices.size() / 3;
+      printf( "   %ux%u heightfield, %zu triangles ->", resolution, resolution, triangleCount );
+      for( uint32_t lod = 1; lod < lodCount; ++lod )
+      {
+         printf( " %u", lods[lod].indexCount / 3 );
+      }
+      printf( " in %.1fms\n", generateMs );
+   }
+
+   // 10000 meshes between 2 and 100 units, the view walking towards them
+   std::vector<Vertex> vertices;
+   std::vector<uint32_t> indices;
+   MakeHeightfield( vertices, indices, 64 );
+
+   std::vector<uint32_t> lodIndices;
+   std::array<MeshLod, MAX_MESH_LODS> lods;
+   const uint32_t lodCount =
+       MeshSimplification::GenerateLods( vertices, indices, lodIndices, lods );
+
+   const uint32_t meshCount = 10000;
+   std::mt19937 rng( 5 );
+   std::uniform_real_distribution<float> position( -2000.0f, 2000.0f );
+   std::uniform_real_distribution<float> scale( 2.0f, 100.0f );
+
+   std::vector<BoundingSphere> spheres( meshCount );
+   std::vector<float> scales( meshCount );
+   for( uint32_t i = 0; i < meshCount; ++i )
+   {
+      scales[i]  = scale( rng );
+      spheres[i] = { glm::vec3( position( rng ), 0.0f, position( rng ) ), 0.75f * scales[i] };
+   }
+
+   const glm::mat4 projMat = glm::perspective( glm::radians( 60.0f ), 16.0f / 9.0f, 0.1f, 1e4f );
+   const uint32_t frameCount = 100;
+
+   MeshLodSelector selector;
+   std::vector<uint32_t> currentLods( meshCount, 0 );
+
+   uint64_t fullTriangles  = 0;
+   uint64_t drawnTriangles = 0;
+   const double selectMs   = Tests::MeasureMs(
+       [&]()
+       {
+          for( uint32_t frame = 0; frame < frameCount; ++frame )
+          {
+             const float walk = 2500.0f - 25.0f * static_cast<float>( frame );
+             selector.begin( glm::vec3( 0.0f, 10.0f, walk ), projMat, 1080 );
+
+             for( uint32_t i = 0; i < meshCount; ++i )
+             {
+                currentLods[i] =
+                    selector.select( lods, lodCount, currentLods[i], spheres[i], scales[i] );
+             }
+
+             fullTriangles += selector.getStats().fullTriangles;
+             drawnTriangles += selector.getStats().drawnTriangles;
+          }
+       } );
+
+   // Shaking the view back and forth by 10 units every frame, with and without hysteresis
+   uint32_t switchCounts[2] = {};
+   for( uint32_t withHysteresis = 0; withHysteresis < 2; ++withHysteresis )
+   {
+      selector.setHysteresis( withHysteresis ? 0.25f : 0.0f );
+      std::fill( currentLods.begin(), currentLods.end(), 0 );
+
+      for( uint32_t frame = 0; frame < frameCount; ++frame )
+      {
+         const float shake = frame % 2 ? 5.0f : -5.0f;
+         selector.begin( glm::vec3( 0.0f, 10.0f, 1000.0f + shake ), projMat, 1080 );
+
+         for( uint32_t i = 0; i < meshCount; ++i )
+         {
+            currentLods[i] =
+                selector.select( lods, lodCount, currentLods[i], spheres[i], scales[i] );
+         }
+
+         // The first frames settle from the finest LOD
+         if( frame >= 10 ) switchCounts[withHysteresis] += selector.getStats().switchCount;
+      }
+   }
+
+   printf(
+       "   %u meshes over %u frames: %.1f%% of the triangles drawn, selection %.3fms per frame, "
+       "%.1f switches per frame shaking with hysteresis, %.1f without\n",
+       meshCount,
+       frameCount,
+       100.0 * static_cast<double>( drawnTriangles ) / static_cast<double>( fullTriangles ),
+       selectMs / frameCount,
+       switchCounts[1] / static_cast<float>( frameCount - 10 ),
+       switchCounts[0] / static_cast<float>( frameCount - 10 ) );
+}
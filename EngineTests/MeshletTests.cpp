@@ -0,0 +1,310 @@
+#include <Test.h>
+
+#include <Graphics/Scene/Bounds.h>
+#include <Graphics/Scene/Frustum.h>
+#include <Graphics/Scene/Meshlets.h>
+#include <Graphics/Utility/MeshGeneration.h>
+#include <Graphics/VertexLayout.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <unordered_set>
+
+using namespace CYD;
+
+// Unit sphere of rings x segments quads, counter-clockwise seen from the outside
+static void MakeSphere(
+    std::vector<Vertex>& vertices,
+    std::vector<uint32_t>& indices,
+    uint32_t rings,
+    uint32_t segments )
+{
+   vertices.clear();
+   indices.clear();
+
+   for( uint32_t ring = 0; ring <= rings; ++ring )
+   {
+      const float theta = glm::pi<float>() * static_cast<float>( ring ) / rings;
+      for( uint32_t segment = 0; segment <= segments; ++segment )
+      {
+         const float phi = 2.0f * glm::pi<float>() * static_cast<float>( segment ) / segments;
+         const glm::vec3 position(
+             std::sin( theta ) * std::cos( phi ),
+             std::cos( theta ),
+             std::sin( theta ) * std::sin( phi ) );
+         vertices.emplace_back( position, position );
+      }
+   }
+
+   for( uint32_t ring = 0; ring < rings; ++ring )
+   {
+      for( uint32_t segment = 0; segment < segments; ++segment )
+      {
+         const uint32_t i0 = ring * ( segments + 1 ) + segment;
+         const uint32_t i1 = i0 + segments + 1;
+
+         // The quads touching the poles are a single triangle
+         if( ring > 0 ) indices.insert( indices.end(), { i0, i0 + 1, i1 } );
+         if( ring + 1 < rings ) indices.insert( indices.end(), { i0 + 1, i1 + 1, i1 } );
+      }
+   }
+}
+
+static glm::vec3 GetTriangleNormal( const std::vector<Vertex>& vertices, const uint32_t* triangle )
+{
+   const glm::vec3& p0 = vertices[triangle[0]].pos;
+   return glm::cross( vertices[triangle[1]].pos - p0, vertices[triangle[2]].pos - p0 );
+}
+
+// Triangles as sorted index triplets, to compare lists regardless of the order of the triangles
+// and of the rotation of their indices
+static std::vector<std::array<uint32_t, 3>> GetTriangles( const uint32_t* indices, size_t count )
+{
+   std::vector<std::array<uint32_t, 3>> triangles;
+   for( size_t i = 0; i < count; i += 3 )
+   {
+      std::array<uint32_t, 3> triangle = { indices[i], indices[i + 1], indices[i + 2] };
+      std::sort( triangle.begin(), triangle.end() );
+      triangles.push_back( triangle );
+   }
+
+   std::sort( triangles.begin(), triangles.end() );
+   return triangles;
+}
+
+static Frustum MakeFrustum( const glm::vec3& viewPosition, const glm::vec3& target )
+{
+   const glm::mat4 projMat =
+       glm::perspective( glm::radians( 60.0f ), 16.0f / 9.0f, 0.01f, 1000.0f );
+
+   Frustum frustum;
+   frustum.update( projMat, glm::lookAt( viewPosition, target, glm::vec3( 0.0f, 1.0f, 0.0f ) ) );
+
+   return frustum;
+}
+
+// ================================================================================================
+TEST_CASE( MeshletsPartitionMesh )
+{
+   std::vector<Vertex> vertices;
+   std::vector<uint32_t> indices;
+   MakeSphere( vertices, indices, 48, 96 );
+
+   // Ranges placed after other indices in the index buffer, like the LODs of a mesh
+   const uint32_t firstIndex = 300;
+   std::vector<uint32_t> meshletIndices;
+   std::vector<Meshlet> meshlets;
+   BuildMeshlets( vertices, indices, firstIndex, meshletIndices, meshlets );
+
+   CHECK( meshletIndices.size() == indices.size() );
+   CHECK( GetTriangles( meshletIndices.data(), meshletIndices.size() ) ==
+          GetTriangles( indices.data(), indices.size() ) );
+
+   // Meshlets follow each other, stay under the limits and bound their triangles. The winding of
+   // the triangles is kept
+   uint32_t nextIndex      = firstIndex;
+   bool isWithinLimits     = true;
+   bool isBounded          = true;
+   bool isWindingKept      = true;
+   bool isConeConservative = true;
+   for( const Meshlet& meshlet : meshlets )
+   {
+      CHECK( meshlet.firstIndex == nextIndex );
+      nextIndex += 3 * meshlet.triangleCount;
+
+      std::unordered_set<uint32_t> meshletVertices;
+      for( uint32_t i = 0; i < 3 * meshlet.triangleCount; i += 3 )
+      {
+         const uint32_t* triangle = meshletIndices.data() + meshlet.firstIndex - firstIndex + i;
+         meshletVertices.insert( triangle, triangle + 3 );
+
+         for( uint32_t corner = 0; corner < 3; ++corner )
+         {
+            const glm::vec3 offset = vertices[triangle[corner]].pos - meshlet.bounds.center;
+            isBounded &= glm::length( offset ) <= meshlet.bounds.radius * 1.0001f;
+         }
+
+         const glm::vec3 normal = glm::normalize( GetTriangleNormal( vertices, triangle ) );
+         isWindingKept &= glm::dot( normal, vertices[triangle[0]].pos ) > 0.0f;
+
+         // The sine of the spread is the cosine of the angle between the axis and the cone side
+         const float minDot = std::sqrt( 1.0f - meshlet.coneCutoff * meshlet.coneCutoff );
+         isConeConservative &= meshlet.coneCutoff == 1.0f ||
+                               glm::dot( normal, meshlet.coneAxis ) >= minDot - 1e-4f;
+      }
+
+      isWithinLimits &= meshlet.triangleCount <= Meshlet::MAX_TRIANGLES;
+      isWithinLimits &= meshletVertices.size() <= Meshlet::MAX_VERTICES;
+      isWithinLimits &= meshletVertices.size() == meshlet.vertexCount;
+   }
+
+   CHECK( isWithinLimits );
+   CHECK( isBounded );
+   CHECK( isWindingKept );
+   CHECK( isConeConservative );
+}
+
+TEST_CASE( MeshletsCullingKeepsVisibleTriangles )
+{
+   std::vector<Vertex> vertices;
+   std::vector<uint32_t> indices;
+   MakeSphere( vertices, indices, 48, 96 );
+
+   std::vector<uint32_t> meshletIndices;
+   std::vector<Meshlet> meshlets;
+   BuildMeshlets( vertices, indices, 0, meshletIndices, meshlets );
+
+   std::mt19937 rng( 3 );
+   std::uniform_real_distribution<float> coord( -1.0f, 1.0f );
+
+   // Every triangle facing the view with a corner in the frustum has to be drawn
+   bool isVisibleDrawn = true;
+   MeshletCullStats stats;
+   for( uint32_t view = 0; view < 200; ++view )
+   {
+      const glm::vec3 direction =
+          glm::normalize( glm::vec3( coord( rng ), coord( rng ), coord( rng ) ) );
+      const glm::vec3 viewPosition = direction * ( 1.2f + 2.0f * std::abs( coord( rng ) ) );
+      const glm::vec3 target       = glm::vec3( coord( rng ), coord( rng ), coord( rng ) ) * 0.5f;
+
+      const Frustum frustum = MakeFrustum( viewPosition, target );
+      glm::vec4 planes[Frustum::COUNT];
+      frustum.getPlanes( planes );
+
+      std::vector<IndexRange> ranges;
+      CullMeshlets( meshlets, viewPosition, planes, 1.0f, ranges, stats );
+
+      std::vector<bool> isDrawn( meshletIndices.size() / 3, false );
+      for( const IndexRange& range : ranges )
+      {
+         std::fill_n( isDrawn.begin() + range.firstIndex / 3, range.indexCount / 3, true );
+      }
+
+      for( uint32_t i = 0; i < meshletIndices.size(); i += 3 )
+      {
+         const uint32_t* triangle = meshletIndices.data() + i;
+         const glm::vec3& p0      = vertices[triangle[0]].pos;
+         if( glm::dot( GetTriangleNormal( vertices, triangle ), viewPosition - p0 ) <= 0.0f )
+         {
+            continue;
+         }
+
+         const bool isInFrustum = std::any_of(
+             triangle,
+             triangle + 3,
+             [&]( uint32_t index )
+             {
+                return std::all_of(
+                    std::begin( planes ),
+                    std::end( planes ),
+                    [&]( const glm::vec4& plane )
+                    {
+                       return glm::dot( glm::vec3( plane ), vertices[index].pos ) + plane.w >=
+                              0.0f;
+                    } );
+             } );
+
+         isVisibleDrawn &= !isInFrustum || isDrawn[i / 3];
+      }
+   }
+
+   CHECK( isVisibleDrawn );
+   CHECK( stats.frustumCulledCount > 0 );
+   CHECK( stats.backfaceCulledCount > 0 );
+}
+
+TEST_CASE( MeshletsBenchmark )
+{
+   struct TestMesh
+   {
+      const char* name;
+      std::vector<Vertex> vertices;
+      std::vector<uint32_t> indices;
+      bool isFlat;
+   };
+
+   std::array<TestMesh, 3> meshes = {};
+   meshes[0].name = "sphere";
+   MakeSphere( meshes[0].vertices, meshes[0].indices, 128, 256 );
+   meshes[1].name   = "64x64 grid";
+   meshes[1].isFlat = true;
+   MeshGeneration::UnitGrid( meshes[1].vertices, meshes[1].indices, 64 );
+   meshes[2].name   = "256x256 grid";
+   meshes[2].isFlat = true;
+   MeshGeneration::UnitGrid( meshes[2].vertices, meshes[2].indices, 256 );
+
+   for( const TestMesh& mesh : meshes )
+   {
+      std::vector<uint32_t> meshletIndices;
+      std::vector<Meshlet> meshlets;
+      const double buildMs = Tests::MeasureMs(
+          [&]()
+          {
+             meshletIndices.clear();
+             BuildMeshlets( mesh.vertices, mesh.indices, 0, meshletIndices, meshlets );
+          } );
+
+      const uint32_t vertexCount = static_cast<uint32_t>( mesh.vertices.size() );
+      const AABB box = ComputeAABB( mesh.vertices.data(), vertexCount, sizeof( Vertex ) );
+      const BoundingSphere sphere =
+          ComputeBoundingSphere( mesh.vertices.data(), vertexCount, sizeof( Vertex ), box );
+
+      // Views around the mesh, above it for the grids, looking at points close to its center
+      std::mt19937 rng( 3 );
+      std::uniform_real_distribution<float> coord( -1.0f, 1.0f );
+
+      const uint32_t viewCount = 1000;
+      std::vector<glm::vec3> viewPositions( viewCount );
+      std::vector<std::array<glm::vec4, Frustum::COUNT>> viewPlanes( viewCount );
+      for( uint32_t view = 0; view < viewCount; ++view )
+      {
+         const float up       = mesh.isFlat ? std::abs( coord( rng ) ) + 0.2f : coord( rng );
+         const float distance = mesh.isFlat ? 0.3f + 1.5f * std::abs( coord( rng ) )
+                                            : 1.5f + 2.0f * std::abs( coord( rng ) );
+         const glm::vec3 direction = glm::normalize( glm::vec3( coord( rng ), up, coord( rng ) ) );
+         const glm::vec3 offset( coord( rng ), mesh.isFlat ? 0.0f : coord( rng ), coord( rng ) );
+
+         const glm::vec3 target = sphere.center + offset * sphere.radius * 0.5f;
+
+         viewPositions[view] = sphere.center + direction * distance * sphere.radius;
+         MakeFrustum( viewPositions[view], target ).getPlanes( viewPlanes[view].data() );
+      }
+
+      MeshletCullStats stats;
+      uint64_t drawnTriangles = 0;
+      std::vector<IndexRange> ranges;
+      const double cullMs = Tests::MeasureMs(
+          [&]()
+          {
+             stats          = {};
+             drawnTriangles = 0;
+             for( uint32_t view = 0; view < viewCount; ++view )
+             {
+                ranges.clear();
+                CullMeshlets(
+                    meshlets, viewPositions[view], viewPlanes[view].data(), 1.0f, ranges, stats );
+                for( const IndexRange& range : ranges )
+                {
+                   drawnTriangles += range.indexCount / 3;
+                }
+             }
+          } );
+
+      const size_t triangleCount = mesh.indices.size() / 3;
+      printf(
+          "   %s, %zu triangles: %zu meshlets built in %.2fms, %.1f%% frustum culled, %.1f%% "
+          "backface culled, %.1f%% of the triangles drawn in %.1f ranges, %.4fms per cull\n",
+          mesh.name,
+          triangleCount,
+          meshlets.size(),
+          buildMs,
+          100.0 * stats.frustumCulledCount / stats.testedCount,
+          100.0 * stats.backfaceCulledCount / stats.testedCount,
+          100.0 * drawnTriangles / ( static_cast<double>( triangleCount ) * viewCount ),
+          static_cast<double>( stats.rangeCount ) / viewCount,
+          cullMs / viewCount );
+   }
+}
@@ -0,0 +1,277 @@
+#include <Test.h>
+
+#include <Graphics/Utility/ObjImporter.h>
+#include <Graphics/VertexLayout.h>
+
+#include <Multithreading/ThreadPool.h>
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tinyobjloader/tiny_obj_loader.h>
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+using namespace CYD;
+
+static std::string GetTempPath( const char* name )
+{
+   return ( std::filesystem::temp_directory_path() / name ).string();
+}
+
+static void WriteFile( const std::string& path, const std::string& content )
+{
+   std::ofstream stream( path, std::ios::binary | std::ios::trunc );
+   stream.write( content.data(), content.size() );
+}
+
+// Wavy grid of resolution x resolution quads with positions, UVs and normals, each attribute in
+// its own block the way exporters write them
+static void WriteObjGrid( const std::string& path, uint32_t resolution )
+{
+   FILE* file = fopen( path.c_str(), "w" );
+   fprintf( file, "# Grid\no grid\n" );
+
+   const uint32_t side = resolution + 1;
+   for( uint32_t z = 0; z < side; ++z )
+   {
+      for( uint32_t x = 0; x < side; ++x )
+      {
+         const float u = x / static_cast<float>( resolution );
+         const float v = z / static_cast<float>( resolution );
+         fprintf( file, "v %f %f %f\n", u - 0.5f, 0.02f * std::sin( u * 40.0f ), v - 0.5f );
+      }
+   }
+
+   for( uint32_t z = 0; z < side; ++z )
+   {
+      for( uint32_t x = 0; x < side; ++x )
+      {
+         fprintf( file, "vt %f %f\n", x / float( resolution ), z / float( resolution ) );
+      }
+   }
+
+   for( uint32_t z = 0; z < side; ++z )
+   {
+      for( uint32_t x = 0; x < side; ++x )
+      {
+         const float slope = 0.8f * std::cos( x / static_cast<float>( resolution ) * 40.0f );
+         const float scale = 1.0f / std::sqrt( slope * slope + 1.0f );
+         fprintf( file, "vn %f %f %f\n", -slope * scale, scale, 0.0f );
+      }
+   }
+
+   fprintf( file, "s 1\nusemtl default\n" );
+   for( uint32_t z = 0; z < resolution; ++z )
+   {
+      for( uint32_t x = 0; x < resolution; ++x )
+      {
+         // OBJ indices start at 1
+         const uint32_t corner    = z * side + x + 1;
+         const uint32_t corners[] = { corner, corner + side, corner + side + 1, corner + 1 };
+
+         fprintf( file, "f" );
+         for( const uint32_t index : corners )
+         {
+            fprintf( file, " %u/%u/%u", index, index, index );
+         }
+         fprintf( file, "\n" );
+      }
+   }
+
+   fclose( file );
+}
+
+// The loader the importer replaced, tinyobjloader with the corners merged in a hash map
+static bool ReferenceImport(
+    const std::string& path,
+    std::vector<Vertex>& vertices,
+    std::vector<uint32_t>& indices )
+{
+   tinyobj::attrib_t attrib;
+   std::vector<tinyobj::shape_t> shapes;
+   std::vector<tinyobj::material_t> materials;
+   std::string warning;
+   std::string error;
+   if( !tinyobj::LoadObj( &attrib, &shapes, &materials, &warning, &error, path.c_str() ) )
+   {
+      return false;
+   }
+
+   std::unordered_map<Vertex, uint32_t> uniqueVertices;
+   for( const tinyobj::shape_t& shape : shapes )
+   {
+      for( const tinyobj::index_t& index : shape.mesh.indices )
+      {
+         Vertex vertex;
+         vertex.pos = {
+             attrib.vertices[3 * index.vertex_index + 0],
+             attrib.vertices[3 * index.vertex_index + 1],
+             attrib.vertices[3 * index.vertex_index + 2] };
+         vertex.normal = {
+             attrib.normals[3 * index.normal_index + 0],
+             attrib.normals[3 * index.normal_index + 1],
+             attrib.normals[3 * index.normal_index + 2] };
+         vertex.uv = {
+             attrib.texcoords[2 * index.texcoord_index + 0],
+             1.0f - attrib.texcoords[2 * index.texcoord_index + 1],
+             0.0f };
+
+         const auto it = uniqueVertices.emplace( vertex, uint32_t( vertices.size() ) );
+         if( it.second ) vertices.push_back( vertex );
+
+         indices.push_back( it.first->second );
+      }
+   }
+
+   return true;
+}
+
+// ================================================================================================
+TEST_CASE( ObjImporterParsesFaces )
+{
+   // A quad split in a fan, a triangle with relative indices and without UVs, and the lines the
+   // importer skips. Shared corners are merged, lines end in CRLF
+   const std::string obj =
+       "# Comment\r\n"
+       "mtllib scene.mtl\r\n"
+       "o quad\r\n"
+       "v 0 0 0\r\n"
+       "v 1 0 0\r\n"
+       "v 1 1 0  # Trailing comment\r\n"
+       "v 0 1 0\r\n"
+       "vt 0 0\r\n"
+       "vt 1 0\r\n"
+       "vt 1 1\r\n"
+       "vt 0 1\r\n"
+       "vn 0 0 1\r\n"
+       "usemtl default\r\n"
+       "s off\r\n"
+       "f 1/1/1 2/2/1 3/3/1 4/4/1\r\n"
+       "v 2 0 0\r\n"
+       "f -4//-1 -1//-1 -3//-1\r\n";
+
+   const std::string path = GetTempPath( "ObjImporterParsesFaces.obj" );
+   WriteFile( path, obj );
+
+   EMP::ThreadPool threadPool;
+   std::vector<Vertex> vertices;
+   std::vector<uint32_t> indices;
+   CHECK( ObjImporter::Import( path, vertices, indices, threadPool ) );
+
+   const std::vector<uint32_t> expectedIndices = { 0, 1, 2, 0, 2, 3, 4, 5, 6 };
+   CHECK( indices == expectedIndices );
+   CHECK( vertices.size() == 7 );
+
+   if( vertices.size() == 7 )
+   {
+      CHECK( vertices[1].pos == glm::vec3( 1.0f, 0.0f, 0.0f ) );
+      CHECK( vertices[2].pos == glm::vec3( 1.0f, 1.0f, 0.0f ) );
+      CHECK( vertices[1].normal == glm::vec3( 0.0f, 0.0f, 1.0f ) );
+
+      // V goes down the images
+      CHECK( vertices[3].uv == glm::vec3( 0.0f, 0.0f, 0.0f ) );
+      CHECK( vertices[1].uv == glm::vec3( 1.0f, 1.0f, 0.0f ) );
+
+      CHECK( vertices[5].pos == glm::vec3( 2.0f, 0.0f, 0.0f ) );
+      CHECK( vertices[5].uv == glm::vec3( 0.0f ) );
+   }
+
+   std::filesystem::remove( path );
+}
+
+TEST_CASE( ObjImporterRejectsInvalidFiles )
+{
+   const std::string path = GetTempPath( "ObjImporterRejectsInvalidFiles.obj" );
+
+   EMP::ThreadPool threadPool;
+   std::vector<Vertex> vertices;
+   std::vector<uint32_t> indices;
+   CHECK( !ObjImporter::Import( path, vertices, indices, threadPool ) );
+
+   // Faces using positions, UVs or normals that are not in the file
+   for( const char* obj :
+        { "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n",
+          "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1/1 2/1 3/1\n",
+          "v 0 0 0\nv 1 0 0\nv 0 1 0\nvn 0 0 1\nf 1//1 2//1 3//2\n",
+          "v 0 0 0\nv 1 0 0\nf -3 1 2\nv 0 1 0\n" } )
+   {
+      WriteFile( path, obj );
+      CHECK( !ObjImporter::Import( path, vertices, indices, threadPool ) );
+   }
+
+   std::filesystem::remove( path );
+}
+
+TEST_CASE( ObjImporterMatchesReference )
+{
+   // Large enough to be cut in many chunks, whose vertices are shared across chunks
+   const std::string path = GetTempPath( "ObjImporterMatchesReference.obj" );
+   WriteObjGrid( path, 400 );
+
+   std::vector<Vertex> expectedVertices;
+   std::vector<uint32_t> expectedIndices;
+   CHECK( ReferenceImport( path, expectedVertices, expectedIndices ) );
+
+   // The same vertices in the same order whatever the number of workers
+   for( const uint32_t workerCount : { 0u, 1u, 3u, 8u } )
+   {
+      EMP::ThreadPool threadPool;
+      if( workerCount ) threadPool.init( workerCount );
+
+      std::vector<Vertex> vertices;
+      std::vector<uint32_t> indices;
+      CHECK( ObjImporter::Import( path, vertices, indices, threadPool ) );
+      CHECK( vertices == expectedVertices );
+      CHECK( indices == expectedIndices );
+
+      if( workerCount ) threadPool.shutdown();
+   }
+
+   std::filesystem::remove( path );
+}
+
+TEST_CASE( ObjImporterBenchmark )
+{
+   for( const uint32_t resolution : { 100u, 250u, 500u } )
+   {
+      const std::string path = GetTempPath( "ObjImporterBenchmark.obj" );
+      WriteObjGrid( path, resolution );
+
+      std::vector<Vertex> vertices;
+      std::vector<uint32_t> indices;
+      const double referenceMs = Tests::MeasureMs(
+          [&]()
+          {
+             vertices.clear();
+             indices.clear();
+             ReferenceImport( path, vertices, indices );
+          },
+          0.0 );
+
+      printf(
+          "   %ux%u grid, %zu triangles, %ju bytes: tinyobjloader + hash map %.1fms",
+          resolution,
+          resolution,
+          indices.size() / 3,
+          static_cast<uintmax_t>( std::filesystem::file_size( path ) ),
+          referenceMs );
+
+      for( const uint32_t workerCount : { 0u, 1u, 4u } )
+      {
+         EMP::ThreadPool threadPool;
+         if( workerCount ) threadPool.init( workerCount );
+
+         const double importMs = Tests::MeasureMs(
+             [&]() { ObjImporter::Import( path, vertices, indices, threadPool ); } );
+         printf( ", importer on %u workers %.1fms", workerCount, importMs );
+
+         if( workerCount ) threadPool.shutdown();
+      }
+      printf( "\n" );
+
+      std::filesystem::remove( path );
+   }
+}
@@ -0,0 +1,238 @@
+#include <Test.h>
+
+#include <Multithreading/SPSCRingBuffer.h>
+
+#include <atomic>
+#include <thread>
+
+using EMP::SPSCByteRingBuffer;
+using EMP::SPSCRingBuffer;
+
+static constexpr uint64_t ELEMENT_COUNT = 2000000;
+
+// Both sides give their core away when they can't move, the test also runs on a single core
+static void WaitForOtherSide() { std::this_thread::yield(); }
+
+// The producer alternates single pushes, batches and zero-copy writes, the consumer does the same
+// with its reads. Elements have to come out in order, and size() has to stay in range while both
+// sides move
+static bool StreamElements( SPSCRingBuffer<uint64_t>& ring )
+{
+   std::atomic<bool> isDone    = false;
+   std::atomic<bool> isInRange = true;
+
+   std::thread observer(
+       [&]()
+       {
+          while( !isDone )
+          {
+             if( ring.size() > ring.getCapacity() ) isInRange = false;
+             WaitForOtherSide();
+          }
+       } );
+
+   std::thread producer(
+       [&]()
+       {
+          uint64_t batch[37];
+          for( uint64_t next = 0; next < ELEMENT_COUNT; )
+          {
+             const uint64_t prevNext = next;
+             switch( next % 3 )
+             {
+                case 0:
+                   next += ring.tryPush( next ) ? 1 : 0;
+                   break;
+                case 1:
+                {
+                   const size_t count = std::min( std::size( batch ), ELEMENT_COUNT - next );
+                   for( size_t i = 0; i < count; ++i )
+                   {
+                      batch[i] = next + i;
+                   }
+                   next += ring.tryPushBatch( { batch, count } );
+                   break;
+                }
+                default:
+                {
+                   const std::span<uint64_t> region = ring.beginWrite( ELEMENT_COUNT - next );
+                   for( size_t i = 0; i < region.size(); ++i )
+                   {
+                      region[i] = next + i;
+                   }
+                   ring.endWrite( region.size() );
+                   next += region.size();
+                   break;
+                }
+             }
+
+             if( next == prevNext ) WaitForOtherSide();
+          }
+       } );
+
+   bool isOrdered = true;
+   uint64_t batch[29];
+   for( uint64_t expected = 0; expected < ELEMENT_COUNT; )
+   {
+      const uint64_t prevExpected = expected;
+      switch( expected % 3 )
+      {
+         case 0:
+         {
+            uint64_t element;
+            if( ring.tryPop( element ) )
+            {
+               isOrdered &= element == expected++;
+            }
+            break;
+         }
+         case 1:
+         {
+            const size_t count = ring.tryPopBatch( batch );
+            for( size_t i = 0; i < count; ++i )
+            {
+               isOrdered &= batch[i] == expected++;
+            }
+            break;
+         }
+         default:
+         {
+            const std::span<const uint64_t> region = ring.beginRead();
+            for( const uint64_t element : region )
+            {
+               isOrdered &= element == expected++;
+            }
+            ring.endRead( region.size() );
+            break;
+         }
+      }
+
+      if( expected == prevExpected ) WaitForOtherSide();
+   }
+
+   producer.join();
+   isDone = true;
+   observer.join();
+
+   return isOrdered && isInRange && ring.empty();
+}
+
+// Records of varying sizes filled with their index, so that the ones wrapping around the end of
+// the storage are checked too
+static bool StreamRecords( SPSCByteRingBuffer& ring, uint32_t recordCount )
+{
+   const auto recordSize = [&ring]( uint32_t recordIdx )
+   { return 1 + ( recordIdx * 7919 ) % static_cast<uint32_t>( ring.getMaxRecordSize() / 4 ); };
+
+   std::thread producer(
+       [&]()
+       {
+          std::vector<uint8_t> record;
+          for( uint32_t recordIdx = 0; recordIdx < recordCount; )
+          {
+             record.assign( recordSize( recordIdx ), static_cast<uint8_t>( recordIdx ) );
+             if( ring.tryWrite( record.data(), static_cast<uint32_t>( record.size() ) ) )
+             {
+                recordIdx++;
+             }
+             else
+             {
+                WaitForOtherSide();
+             }
+          }
+       } );
+
+   bool isIntact = true;
+   std::vector<uint8_t> record( ring.getMaxRecordSize() );
+   for( uint32_t recordIdx = 0; recordIdx < recordCount; )
+   {
+      const size_t size = ring.tryRead( record.data(), record.size() );
+      if( size == 0 )
+      {
+         WaitForOtherSide();
+         continue;
+      }
+
+      isIntact &= size == recordSize( recordIdx );
+      for( size_t i = 0; i < size; ++i )
+      {
+         isIntact &= record[i] == static_cast<uint8_t>( recordIdx );
+      }
+      recordIdx++;
+   }
+
+   producer.join();
+
+   return isIntact && ring.empty();
+}
+
+TEST_CASE( SPSCRingBufferTwoThreads )
+{
+   // Small enough that both sides keep running into a full or an empty buffer
+   SPSCRingBuffer<uint64_t> ring( 100 );
+   CHECK( ring.getCapacity() == 128 );
+   CHECK( ring.empty() );
+   CHECK( StreamElements( ring ) );
+}
+
+TEST_CASE( SPSCByteRingBufferTwoThreads )
+{
+   SPSCByteRingBuffer ring( 4096 );
+   CHECK( ring.empty() );
+   CHECK( StreamRecords( ring, 200000 ) );
+}
+
+TEST_CASE( SPSCRingBufferBenchmark )
+{
+   SPSCRingBuffer<uint64_t> ring( 4096 );
+
+   uint64_t sum          = 0;
+   const double streamMs = Tests::MeasureMs(
+       [&]()
+       {
+          std::thread producer(
+              [&]()
+              {
+                 for( uint64_t i = 0; i < ELEMENT_COUNT; )
+                 {
+                    if( ring.tryPush( i ) )
+                    {
+                       i++;
+                    }
+                    else
+                    {
+                       WaitForOtherSide();
+                    }
+                 }
+              } );
+
+          uint64_t element;
+          for( uint64_t i = 0; i < ELEMENT_COUNT; )
+          {
+             if( ring.tryPop( element ) )
+             {
+                sum += element;
+                i++;
+             }
+             else
+             {
+                WaitForOtherSide();
+             }
+          }
+
+          producer.join();
+       } );
+
+   CHECK( sum % ( ELEMENT_COUNT * ( ELEMENT_COUNT - 1 ) / 2 ) == 0 );
+
+   SPSCByteRingBuffer byteRing( 1 << 16 );
+   const uint32_t recordCount = 500000;
+   const double recordMs =
+       Tests::MeasureMs( [&]() { StreamRecords( byteRing, recordCount ); } );
+
+   printf(
+       "   %.1fM elements/s one at a time, %.1fM records/s of up to %zu bytes\n",
+       ELEMENT_COUNT / streamMs / 1000.0,
+       recordCount / recordMs / 1000.0,
+       byteRing.getMaxRecordSize() / 4 );
+}
@@ -0,0 +1,286 @@
+#include <Test.h>
+
+#include <Graphics/Scene/Bounds.h>
+#include <Graphics/Scene/Frustum.h>
+#include <Graphics/Scene/TerrainQuadtree.h>
+#include <Graphics/Utility/Noise.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+using namespace CYD;
+
+static constexpr float HEIGHT_SCALE = 300.0f;
+
+static Frustum MakeFrustum( const glm::vec3& viewPosition )
+{
+   const glm::mat4 projMat =
+       glm::perspective( glm::radians( 60.0f ), 16.0f / 9.0f, 0.1f, 20000.0f );
+   const glm::mat4 viewMat = glm::lookAt(
+       viewPosition,
+       viewPosition + glm::vec3( 1.0f, -0.2f, 0.3f ),
+       glm::vec3( 0.0f, 1.0f, 0.0f ) );
+
+   Frustum frustum;
+   frustum.update( projMat, viewMat );
+
+   return frustum;
+}
+
+// LOD each leaf of the terrain is drawn with, row major, or UINT32_MAX where no patch covers it and
+// UINT32_MAX - 1 where several do
+static std::vector<uint32_t> RasterizePatches(
+    const TerrainQuadtree& quadtree,
+    float size,
+    const std::vector<TerrainQuadtree::Patch>& patches )
+{
+   const uint32_t leavesPerSide = 1 << ( quadtree.getLodCount() - 1 );
+   const float leafSize         = quadtree.getNodeSize( 0 );
+
+   std::vector<uint32_t> leafLods( leavesPerSide * leavesPerSide, UINT32_MAX );
+   for( const TerrainQuadtree::Patch& patch : patches )
+   {
+      const uint32_t x0    = static_cast<uint32_t>( ( patch.origin.x + 0.5f * size ) / leafSize );
+      const uint32_t z0    = static_cast<uint32_t>( ( patch.origin.y + 0.5f * size ) / leafSize );
+      const uint32_t count = static_cast<uint32_t>( patch.size / leafSize );
+
+      for( uint32_t z = z0; z < z0 + count; ++z )
+      {
+         for( uint32_t x = x0; x < x0 + count; ++x )
+         {
+            uint32_t& leafLod = leafLods[z * leavesPerSide + x];
+            leafLod           = leafLod == UINT32_MAX ? patch.lodAndStep & 0xFF : UINT32_MAX - 1;
+         }
+      }
+   }
+
+   return leafLods;
+}
+
+// ================================================================================================
+TEST_CASE( TerrainQuadtreeCoversTerrain )
+{
+   const float size = 8192.0f;
+
+   TerrainQuadtree quadtree;
+   quadtree.buildFlat( size, HEIGHT_SCALE, 8 );
+   quadtree.setLodDistance( 150.0f, 0.7f );
+
+   const uint32_t leavesPerSide = 1 << ( quadtree.getLodCount() - 1 );
+
+   std::vector<TerrainQuadtree::Patch> patches;
+   for( const glm::vec3& viewPosition :
+        { glm::vec3( 0.0f, 320.0f, 0.0f ),
+          glm::vec3( -4000.0f, 10.0f, 3900.0f ),
+          glm::vec3( 9000.0f, 2000.0f, 0.0f ) } )
+   {
+      quadtree.select( viewPosition, nullptr, patches );
+
+      // Every leaf drawn once, and neighbouring leaves at most one LOD apart so that the morphs
+      // meet
+      const std::vector<uint32_t> leafLods = RasterizePatches( quadtree, size, patches );
+
+      bool isCoveredOnce = true;
+      bool isContinuous  = true;
+      for( uint32_t z = 0; z < leavesPerSide; ++z )
+      {
+         for( uint32_t x = 0; x < leavesPerSide; ++x )
+         {
+            const uint32_t lod = leafLods[z * leavesPerSide + x];
+            isCoveredOnce &= lod < quadtree.getLodCount();
+
+            if( x + 1 < leavesPerSide )
+            {
+               const uint32_t right = leafLods[z * leavesPerSide + x + 1];
+               isContinuous &= std::max( lod, right ) - std::min( lod, right ) <= 1;
+            }
+            if( z + 1 < leavesPerSide )
+            {
+               const uint32_t below = leafLods[( z + 1 ) * leavesPerSide + x];
+               isContinuous &= std::max( lod, below ) - std::min( lod, below ) <= 1;
+            }
+         }
+      }
+
+      CHECK( isCoveredOnce );
+      CHECK( isContinuous );
+   }
+
+   // Close to the ground, the leaf under the view is at the finest LOD
+   quadtree.select( glm::vec3( 100.0f, 10.0f, 100.0f ), nullptr, patches );
+   const std::vector<uint32_t> leafLods = RasterizePatches( quadtree, size, patches );
+   const uint32_t leafUnderView =
+       static_cast<uint32_t>( ( 100.0f + 0.5f * size ) / quadtree.getNodeSize( 0 ) );
+   CHECK( leafLods[leafUnderView * leavesPerSide + leafUnderView] == 0 );
+}
+
+TEST_CASE( TerrainQuadtreeFrustumCulling )
+{
+   const float size = 8192.0f;
+
+   TerrainQuadtree quadtree;
+   quadtree.buildFlat( size, HEIGHT_SCALE, 8 );
+   quadtree.setLodDistance( 150.0f, 0.7f );
+
+   const glm::vec3 viewPosition( 0.0f, 320.0f, 0.0f );
+   const Frustum frustum = MakeFrustum( viewPosition );
+
+   glm::vec4 planes[Frustum::COUNT];
+   frustum.getPlanes( planes );
+
+   std::vector<TerrainQuadtree::Patch> allPatches;
+   std::vector<TerrainQuadtree::Patch> culledPatches;
+   quadtree.select( viewPosition, nullptr, allPatches );
+   quadtree.select( viewPosition, planes, culledPatches );
+
+   CHECK( !culledPatches.empty() );
+   CHECK( culledPatches.size() < allPatches.size() );
+
+   // Culling only removes patches, and only the ones entirely outside of the frustum
+   using Patch         = TerrainQuadtree::Patch;
+   const auto sameArea = []( const Patch& first, const Patch& second )
+   {
+      return std::tie( first.origin.x, first.origin.y, first.size, first.lodAndStep ) <
+             std::tie( second.origin.x, second.origin.y, second.size, second.lodAndStep );
+   };
+   std::sort( allPatches.begin(), allPatches.end(), sameArea );
+   std::sort( culledPatches.begin(), culledPatches.end(), sameArea );
+   CHECK( std::includes(
+       allPatches.begin(),
+       allPatches.end(),
+       culledPatches.begin(),
+       culledPatches.end(),
+       sameArea ) );
+
+   bool isCulledOutside = true;
+   for( const Patch& patch : allPatches )
+   {
+      if( std::binary_search( culledPatches.begin(), culledPatches.end(), patch, sameArea ) )
+      {
+         continue;
+      }
+
+      const AABB bounds = {
+          glm::vec3( patch.origin.x, 0.0f, patch.origin.y ),
+          glm::vec3( patch.origin.x + patch.size, HEIGHT_SCALE, patch.origin.y + patch.size ) };
+
+      const bool isOutside = std::any_of(
+          std::begin( planes ),
+          std::end( planes ),
+          [&]( const glm::vec4& plane )
+          {
+             const glm::vec3 normal( plane );
+             const float distance = glm::dot( normal, bounds.getCenter() ) + plane.w;
+             return distance + glm::dot( glm::abs( normal ), bounds.getExtents() ) < 0.0f;
+          } );
+      isCulledOutside &= isOutside;
+   }
+   CHECK( isCulledOutside );
+}
+
+TEST_CASE( TerrainQuadtreeNodeHeights )
+{
+   Noise::ShaderParams noiseParams;
+   noiseParams.frequency = 4.0f;
+   noiseParams.octaves   = 4;
+
+   const uint32_t resolution = 256;
+   std::vector<float> heights( resolution * resolution );
+   Noise::GenerateSimplex( resolution, resolution, noiseParams, heights.data() );
+
+   TerrainQuadtree quadtree;
+   quadtree.build( heights.data(), resolution, resolution, 4096.0f, HEIGHT_SCALE, 6 );
+
+   // The root spans every height, and every node spans the heights of its children
+   const auto [lowest, highest] = std::minmax_element( heights.begin(), heights.end() );
+   const uint32_t rootLod       = quadtree.getLodCount() - 1;
+   CHECK( quadtree.getNodeHeights( rootLod, 0, 0 ).x <= *lowest * HEIGHT_SCALE );
+   CHECK( quadtree.getNodeHeights( rootLod, 0, 0 ).y >= *highest * HEIGHT_SCALE );
+
+   bool isNested = true;
+   for( uint32_t lod = 1; lod <= rootLod; ++lod )
+   {
+      const uint32_t nodesPerSide = 1 << ( rootLod - lod );
+      for( uint32_t z = 0; z < nodesPerSide * 2; ++z )
+      {
+         for( uint32_t x = 0; x < nodesPerSide * 2; ++x )
+         {
+            const glm::vec2 parent = quadtree.getNodeHeights( lod, x / 2, z / 2 );
+            const glm::vec2 child  = quadtree.getNodeHeights( lod - 1, x, z );
+            isNested &= parent.x <= child.x && parent.y >= child.y;
+         }
+      }
+   }
+   CHECK( isNested );
+}
+
+TEST_CASE( TerrainQuadtreeBenchmark )
+{
+   Noise::ShaderParams noiseParams;
+   noiseParams.gain       = 0.318f;
+   noiseParams.frequency  = 2.609f;
+   noiseParams.lacunarity = 3.103f;
+   noiseParams.octaves    = 5;
+   noiseParams.ridged     = 1;
+   noiseParams.invert     = 1;
+
+   const uint32_t resolution = 2048;
+   std::vector<float> heights( resolution * resolution );
+   const double noiseMs = Tests::MeasureMs(
+       [&]() { Noise::GenerateSimplex( resolution, resolution, noiseParams, heights.data() ); },
+       0.0 );
+   printf( "   %u^2 simplex heights on the CPU %.1fms\n", resolution, noiseMs );
+
+   const glm::vec3 viewPosition( 0.0f, 320.0f, 0.0f );
+   const Frustum frustum = MakeFrustum( viewPosition );
+
+   glm::vec4 planes[Frustum::COUNT];
+   frustum.getPlanes( planes );
+
+   // 16, 64 and 256 km2 with leaves of at most 64 m
+   for( const float size : { 4000.0f, 8000.0f, 16000.0f } )
+   {
+      uint32_t lodCount = 1;
+      while( size / static_cast<float>( 1 << ( lodCount - 1 ) ) > 64.0f &&
+             lodCount < TerrainQuadtree::MAX_LODS )
+      {
+         lodCount++;
+      }
+
+      TerrainQuadtree quadtree;
+      const double buildMs = Tests::MeasureMs(
+          [&]()
+          {
+             quadtree.build(
+                 heights.data(), resolution, resolution, size, HEIGHT_SCALE, lodCount );
+          } );
+      quadtree.setLodDistance( 150.0f, 0.7f );
+
+      std::vector<TerrainQuadtree::Patch> patches;
+      const double viewMs =
+          Tests::MeasureMs( [&]() { quadtree.select( viewPosition, planes, patches ); } );
+      const TerrainQuadtree::Stats viewStats = quadtree.getStats();
+
+      // Shadow cascades select without culling
+      const double allMs =
+          Tests::MeasureMs( [&]() { quadtree.select( viewPosition, nullptr, patches ); } );
+      const TerrainQuadtree::Stats allStats = quadtree.getStats();
+
+      printf(
+          "   %.0f km2, %u LODs, %.1fm leaves: build %.2fms, view select %.4fms (%u visited, %u "
+          "culled, %u patches), unculled select %.4fms (%u patches)\n",
+          size * size / 1e6f,
+          lodCount,
+          quadtree.getNodeSize( 0 ),
+          buildMs,
+          viewMs,
+          viewStats.visitedCount,
+          viewStats.culledCount,
+          viewStats.selectedCount,
+          allMs,
+          allStats.selectedCount );
+   }
+}
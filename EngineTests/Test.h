@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+/*
+Minimal test harness. Every file registers its tests with TEST_CASE and Main runs them in order,
+a failed CHECK is reported and the test goes on. Benchmarks are tests that print their timings,
+they only check that the work they time gives the right result.
+*/
+namespace Tests
+{
+struct TestCase
+{
+   const char* name;
+   void ( *function )();
+};
+
+std::vector<TestCase>& GetTestCases();
+void ReportFailure( const char* file, int line, const char* expression );
+
+struct Registrar
+{
+   Registrar( const char* name, void ( *function )() )
+   {
+      GetTestCases().push_back( { name, function } );
+   }
+};
+
+// Average time of a run in milliseconds, over enough runs to last about the given duration
+template <class Function>
+double MeasureMs( Function&& function, double minTotalMs = 200.0 )
+{
+   using Milliseconds = std::chrono::duration<double, std::milli>;
+
+   uint32_t runCount = 0;
+   double totalMs    = 0.0;
+   while( totalMs < minTotalMs || runCount == 0 )
+   {
+      const auto start = std::chrono::steady_clock::now();
+      function();
+      totalMs += Milliseconds( std::chrono::steady_clock::now() - start ).count();
+      runCount++;
+   }
+
+   return totalMs / runCount;
+}
+}
+
+#define TEST_CASE( testName )                                                \
+   static void testName();                                                   \
+   static const Tests::Registrar testName##Registrar( #testName, testName ); \
+   static void testName()
+
+#define CHECK( expression )                                                          \
+   do                                                                                \
+   {                                                                                 \
+      if( !( expression ) ) Tests::ReportFailure( __FILE__, __LINE__, #expression ); \
+   } while( false )
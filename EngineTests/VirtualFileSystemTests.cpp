@@ -0,0 +1,202 @@
+#include <Test.h>
+
+#include <IO/Archive.h>
+#include <IO/VirtualFileSystem.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+// Empty directory of its own for every test
+static std::filesystem::path MakeDirectory( const char* name )
+{
+   const std::filesystem::path directory = std::filesystem::temp_directory_path() / name;
+   std::filesystem::remove_all( directory );
+   std::filesystem::create_directories( directory );
+
+   return directory;
+}
+
+static void WriteFile( const std::filesystem::path& path, const std::string& content )
+{
+   std::filesystem::create_directories( path.parent_path() );
+
+   std::ofstream stream( path, std::ios::binary | std::ios::trunc );
+   stream.write( content.data(), content.size() );
+}
+
+static bool IsContent( const uint8_t* data, size_t size, const std::string& content )
+{
+   return size == content.size() && std::memcmp( data, content.data(), size ) == 0;
+}
+
+static bool IsContent( const EMP::VirtualFile& file, const std::string& content )
+{
+   return file.isOpen() && IsContent( file.getData(), file.getSize(), content );
+}
+
+// ================================================================================================
+TEST_CASE( ArchiveRoundTrip )
+{
+   const std::filesystem::path directory = MakeDirectory( "ArchiveRoundTrip" );
+
+   // Names the way they are written in the code, normalized when packed
+   const std::vector<std::pair<std::string, std::string>> files = {
+       { "Pipelines.json", "{ \"pipelines\": [] }" },
+       { "Shaders/default.vert.spv", std::string( 1000, 'v' ) },
+       { "Shaders\\default.frag.spv", std::string( 3, 'f' ) },
+       { "./Data/../Data/Meshes/sphere.cydmesh", std::string( 100000, 'm' ) } };
+
+   std::vector<EMP::ArchiveSource> sources;
+   for( uint32_t i = 0; i < files.size(); ++i )
+   {
+      const std::filesystem::path path = directory / ( "source" + std::to_string( i ) );
+      WriteFile( path, files[i].second );
+      sources.push_back( { files[i].first, path.string() } );
+   }
+
+   const std::string archivePath = ( directory / "Assets.cydpak" ).string();
+   CHECK( EMP::WriteArchive( archivePath, sources ) );
+
+   EMP::Archive archive;
+   CHECK( archive.open( archivePath ) );
+   CHECK( archive.getEntryCount() == files.size() );
+
+   // Every file is found under its normalized name, aligned where it is mapped
+   for( const auto& [name, content] : files )
+   {
+      const uint8_t* data = nullptr;
+      size_t size         = 0;
+      int64_t sourceTime  = 0;
+
+      CHECK( archive.find( EMP::NormalizeArchiveName( name ), data, size, sourceTime ) );
+      CHECK( IsContent( data, size, content ) );
+      CHECK( reinterpret_cast<uintptr_t>( data ) % EMP::Archive::DATA_ALIGNMENT == 0 );
+      CHECK( sourceTime != 0 );
+   }
+
+   const uint8_t* data = nullptr;
+   size_t size         = 0;
+   int64_t sourceTime  = 0;
+   CHECK( EMP::NormalizeArchiveName( "./Data/../Data/Meshes/sphere.cydmesh" ) ==
+          "Data/Meshes/sphere.cydmesh" );
+   CHECK( !archive.find( "Shaders/missing.spv", data, size, sourceTime ) );
+
+   // The same name twice cannot be packed
+   sources.push_back( { "Pipelines.json", sources[0].path } );
+   CHECK( !EMP::WriteArchive( ( directory / "Duplicate.cydpak" ).string(), sources ) );
+
+   archive = EMP::Archive();
+   std::filesystem::remove_all( directory );
+}
+
+TEST_CASE( VirtualFileSystemLookup )
+{
+   const std::filesystem::path directory = MakeDirectory( "VirtualFileSystemLookup" );
+   const std::string packedPath          = ( directory / "Packed.json" ).string();
+   const std::string editedPath          = ( directory / "Edited.json" ).string();
+   const std::string loosePath           = ( directory / "Loose.json" ).string();
+
+   WriteFile( packedPath, "packed" );
+   WriteFile( editedPath, "packed" );
+
+   const std::string archivePath = ( directory / "Assets.cydpak" ).string();
+
+   const std::vector<EMP::ArchiveSource> sources = {
+       { packedPath, packedPath }, { editedPath, editedPath } };
+   CHECK( EMP::WriteArchive( archivePath, sources ) );
+
+   // The packed file shadows a loose file that was not touched since, an edited one is read from
+   // disk and files that were never packed too
+   WriteFile( editedPath, "edited" );
+   std::filesystem::last_write_time(
+       editedPath, std::filesystem::last_write_time( editedPath ) + std::chrono::seconds( 10 ) );
+   WriteFile( loosePath, "loose" );
+   std::filesystem::remove( packedPath );
+
+   EMP::VirtualFileSystem fileSystem;
+   CHECK( fileSystem.mount( archivePath ) );
+   CHECK( !fileSystem.mount( ( directory / "Missing.cydpak" ).string() ) );
+
+   EMP::VirtualFile file;
+   CHECK( fileSystem.open( packedPath, file ) );
+   CHECK( IsContent( file, "packed" ) );
+   CHECK( fileSystem.open( editedPath, file ) );
+   CHECK( IsContent( file, "edited" ) );
+   CHECK( fileSystem.open( loosePath, file ) );
+   CHECK( IsContent( file, "loose" ) );
+   CHECK( !fileSystem.open( ( directory / "Missing.json" ).string(), file ) );
+
+   const EMP::VirtualFileSystem::Stats stats = fileSystem.getStats();
+   CHECK( stats.archiveCount == 1 );
+   CHECK( stats.packedOpenCount == 1 );
+   CHECK( stats.looseOpenCount == 2 );
+   CHECK( stats.staleCount == 1 );
+   CHECK( stats.missCount == 1 );
+
+   // Packed and loose files are listed once each
+   const std::vector<std::string> paths = fileSystem.list( directory.string() );
+   CHECK( paths.size() == 4 );
+
+   file = EMP::VirtualFile();
+   std::filesystem::remove_all( directory );
+}
+
+TEST_CASE( VirtualFileSystemBenchmark )
+{
+   const std::filesystem::path directory = MakeDirectory( "VirtualFileSystemBenchmark" );
+
+   // Shaders and small assets, opened and read through at startup
+   const uint32_t fileCount = 500;
+
+   std::vector<std::string> paths;
+   std::vector<EMP::ArchiveSource> sources;
+   for( uint32_t i = 0; i < fileCount; ++i )
+   {
+      const std::string path = ( directory / ( "asset" + std::to_string( i ) ) ).string();
+      WriteFile( path, std::string( 4096 + i * 16, char( i ) ) );
+
+      paths.push_back( path );
+      sources.push_back( { path, path } );
+   }
+
+   const std::string archivePath = ( directory / "Assets.cydpak" ).string();
+   EMP::WriteArchive( archivePath, sources );
+
+   EMP::VirtualFileSystem looseFileSystem;
+   EMP::VirtualFileSystem packedFileSystem;
+   packedFileSystem.mount( archivePath );
+
+   const auto readAll = [&]( const EMP::VirtualFileSystem& fileSystem )
+   {
+      uint64_t sum = 0;
+      for( const std::string& path : paths )
+      {
+         EMP::VirtualFile file;
+         fileSystem.open( path, file );
+         for( size_t i = 0; i < file.getSize(); i += 64 )
+         {
+            sum += file.getData()[i];
+         }
+      }
+
+      return sum;
+   };
+
+   uint64_t looseSum  = 0;
+   uint64_t packedSum = 0;
+   const double looseMs  = Tests::MeasureMs( [&]() { looseSum = readAll( looseFileSystem ); } );
+   const double packedMs = Tests::MeasureMs( [&]() { packedSum = readAll( packedFileSystem ); } );
+   CHECK( looseSum == packedSum );
+   CHECK( packedFileSystem.getStats().looseOpenCount == 0 );
+
+   printf(
+       "   %u files: loose %.3fms, packed %.3fms (%.1fx)\n",
+       fileCount,
+       looseMs,
+       packedMs,
+       looseMs / packedMs );
+
+   std::filesystem::remove_all( directory );
+}
@@ -0,0 +1,106 @@
+#include <Graphics/Scene/MeshFile.h>
+#include <Graphics/Utility/GraphicsIO.h>
+#include <Graphics/VertexLayout.h>
+
+#include <IO/VirtualFileSystem.h>
+#include <Multithreading/ThreadPool.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Converts the OBJ meshes of the mesh directory to mesh files, the mesh cache maps them instead of
+// parsing and cooking the OBJ files again. Without arguments every OBJ mesh is converted, otherwise
+// only the meshes named, without their extension
+
+using namespace CYD;
+
+static constexpr char MESH_PATH[] = "../Engine/Data/Meshes/";
+
+static bool ConvertMesh( const std::string& name, EMP::ThreadPool& threadPool )
+{
+   const std::string objPath = MESH_PATH + name + ".obj";
+   if( !std::filesystem::exists( objPath ) )
+   {
+      printf( "Could not find %s\n", objPath.c_str() );
+      return false;
+   }
+
+   const auto start = std::chrono::steady_clock::now();
+
+   // The mesh cache cooks the mesh again once the OBJ file no longer matches this key
+   EMP::VirtualFile objFile;
+   if( !GraphicsIO::GetFileSystem().open( objPath, objFile ) )
+   {
+      printf( "Could not read %s\n", objPath.c_str() );
+      return false;
+   }
+
+   std::vector<Vertex> vertices;
+   std::vector<uint32_t> indices;
+   GraphicsIO::LoadMesh( name, vertices, indices, threadPool );
+
+   CookedMesh cooked;
+   CookMesh( vertices, indices, VertexFormat::COMPACT, cooked );
+   cooked.header.sourceKey =
+       GetMeshSourceKey( objFile.getData(), objFile.getSize(), VertexFormat::COMPACT );
+
+   const std::string meshPath = MESH_PATH + name + MeshFile::EXTENSION;
+   if( !WriteMeshFile( meshPath, cooked ) )
+   {
+      printf( "Could not write %s\n", meshPath.c_str() );
+      return false;
+   }
+
+   const std::chrono::duration<double, std::milli> duration =
+       std::chrono::steady_clock::now() - start;
+
+   printf(
+       "Converted mesh --> %s, %u vertices, %u indices, %u LODs, %u meshlets, ACMR %.3f -> %.3f, "
+       "ATVR %.3f -> %.3f, %ju bytes in %.1fms\n",
+       name.c_str(),
+       cooked.header.vertexCount,
+       cooked.header.indexCount,
+       cooked.header.lodCount,
+       cooked.header.meshletCount,
+       cooked.sourceCache.acmr,
+       cooked.cookedCache.acmr,
+       cooked.sourceCache.atvr,
+       cooked.cookedCache.atvr,
+       static_cast<uintmax_t>( std::filesystem::file_size( meshPath ) ),
+       duration.count() );
+
+   return true;
+}
+
+int main( int argc, char** argv )
+{
+   std::vector<std::string> names( argv + 1, argv + argc );
+
+   if( names.empty() )
+   {
+      for( const auto& entry : std::filesystem::directory_iterator( MESH_PATH ) )
+      {
+         if( entry.path().extension() == ".obj" )
+         {
+            names.push_back( entry.path().stem().string() );
+         }
+      }
+   }
+
+   EMP::ThreadPool threadPool;
+   threadPool.init( std::thread::hardware_concurrency() );
+
+   int result = 0;
+   for( const std::string& name : names )
+   {
+      result |= ConvertMesh( name, threadPool ) ? 0 : 1;
+   }
+
+   threadPool.shutdown();
+
+   return result;
+}
@@ -17,7 +17,7 @@
 #include <ECS/Components/Rendering/InstancedComponent.h>
 #include <ECS/Components/Rendering/MaterialComponent.h>
 #include <ECS/Components/Rendering/RenderableComponent.h>
-#include <ECS/Components/Rendering/TessellatedComponent.h>
+#include <ECS/Components/Rendering/TerrainComponent.h>
 #include <ECS/Systems/Debug/DebugDrawSystem.h>
 #include <ECS/Systems/Input/WindowSystem.h>
 #include <ECS/Systems/Lighting/LightUpdateSystem.h>
@@ -28,12 +28,16 @@
 #include <ECS/Systems/Procedural/FFTOceanSystem.h>
 #include <ECS/Systems/Procedural/AtmosphereSystem.h>
 #include <ECS/Systems/Rendering/TessellationUpdateSystem.h>
+#include <ECS/Systems/Rendering/TerrainSystem.h>
 #include <ECS/Systems/Rendering/ForwardRenderSystem.h>
 #include <ECS/Systems/Rendering/GBufferSystem.h>
 #include <ECS/Systems/Rendering/DeferredRenderSystem.h>
 #include <ECS/Systems/Rendering/AtmosphereRenderSystem.h>
 #include <ECS/Systems/Resources/MaterialLoaderSystem.h>
 #include <ECS/Systems/Resources/MeshLoaderSystem.h>
+#include <ECS/Systems/Scene/MeshLodSystem.h>
+#include <ECS/Systems/Scene/OcclusionSystem.h>
+#include <ECS/Systems/Scene/SpatialIndexSystem.h>
 #include <ECS/Systems/Scene/ViewUpdateSystem.h>
 #include <ECS/Systems/UI/ImGuiSystem.h>
 
@@ -47,6 +51,8 @@
 
 #include <UI/UserInterface.h>
 
+#include <Multithreading/TimerWheel.h>
+
 #include <Profiling.h>
 
 #include <cstdlib>
@@ -61,13 +67,28 @@ VKSandbox::VKSandbox( uint32_t width, uint32_t height, const char* title )
    StaticPipelines::Initialize();
    Noise::Initialize();
 
-   m_meshes    = std::make_unique<MeshCache>();
+   m_meshes    = std::make_unique<MeshCache>( *m_threadPool );
    m_materials = std::make_unique<MaterialCache>();
    m_ecs       = std::make_unique<EntityManager>();
 }
 
+// Releasing unused GPU resources scans every resource slot, no need to do it every frame
+static constexpr uint64_t RELEASE_RESOURCES_PERIOD_FRAMES = 30;
+
+// Terrain of 126x126 local units scaled by 50, 6.3 km on a side. The height map displaces it by up
+// to 10 units
+static constexpr float TERRAIN_SIZE         = 126.0f;
+static constexpr float TERRAIN_HEIGHT_SCALE = 10.0f;
+static constexpr uint32_t TERRAIN_LODS      = 7;
+static constexpr float TERRAIN_LOD_DISTANCE = 300.0f;  // Meters
+
 void VKSandbox::preLoop()
 {
+   // Deferred Work
+   // =============================================================================================
+   m_frameTimers->schedulePeriodic(
+       RELEASE_RESOURCES_PERIOD_FRAMES, []() { GRIS::ReleaseUnusedResources(); } );
+
    // Systems Initialization
    // =============================================================================================
 
@@ -84,17 +105,21 @@ void VKSandbox::preLoop()
    // Physics/Motion
    m_ecs->addSystem<PlayerMoveSystem>();
    m_ecs->addSystem<MotionSystem>();
+   m_ecs->addSystem<SpatialIndexSystem>( *m_threadPool );
 
    // Pre-Render
+   m_ecs->addSystem<OcclusionSystem>( *m_threadPool );
+   m_ecs->addSystem<MeshLodSystem>();
    m_ecs->addSystem<ProceduralDisplacementSystem>( *m_materials );
+   m_ecs->addSystem<TerrainSystem>( *m_threadPool );
    m_ecs->addSystem<AtmosphereSystem>();
    m_ecs->addSystem<FFTOceanSystem>( *m_materials );
-   m_ecs->addSystem<ShadowMapSystem>( *m_materials );
-   m_ecs->addSystem<GBufferSystem>( *m_materials );
+   m_ecs->addSystem<ShadowMapSystem>( *m_materials, *m_threadPool );
+   m_ecs->addSystem<GBufferSystem>( *m_materials, *m_threadPool );
 
    // Rendering
    m_ecs->addSystem<DeferredRenderSystem>();
-   m_ecs->addSystem<ForwardRenderSystem>( *m_materials );
+   m_ecs->addSystem<ForwardRenderSystem>( *m_materials, *m_threadPool );
 
    // Post-Process
    m_ecs->addSystem<AtmosphereRenderSystem>();
@@ -105,16 +130,27 @@ void VKSandbox::preLoop()
 #endif
 
    // UI
-   m_ecs->addSystem<ImGuiSystem>( *m_ecs );
+   m_ecs->addSystem<ImGuiSystem>( *m_ecs, *m_threadPool );
 
    // Creating terrain mesh
    // =============================================================================================
    CmdListHandle transferList = GRIS::CreateCommandList( QueueUsage::TRANSFER, "Initial Transfer" );
 
+   // A single patch, instanced over the nodes the terrain selects
    std::vector<Vertex> vertices;
    std::vector<uint32_t> indices;
-   MeshGeneration::PatchGrid( vertices, indices, 64 );
-   m_meshes->loadMesh( transferList, "GRID", vertices, indices );
+   MeshGeneration::UnitGrid( vertices, indices, TerrainComponent::PATCH_RESOLUTION );
+
+   // The patches rebuild their positions from the UVs with the model matrix of the terrain as is,
+   // their positions are not quantized. The terrain system gives the terrain its occluder, built
+   // from the heights of the terrain
+   m_meshes->loadMesh(
+       transferList,
+       "TERRAIN_PATCH",
+       vertices,
+       indices,
+       nullptr,
+       VertexFormat::OCTAHEDRAL_NORMAL | VertexFormat::HALF_UV );
 
    GRIS::SubmitCommandList( transferList );
    GRIS::WaitOnCommandList( transferList );
@@ -140,7 +176,7 @@ void VKSandbox::preLoop()
 
    // Terrain
    MaterialComponent::Description terrainMaterialDesc;
-   terrainMaterialDesc.pipelineName = "TERRAIN_GBUFFER";
+   terrainMaterialDesc.pipelineName = "TERRAIN_CDLOD";
    terrainMaterialDesc.materialName = "TERRAIN_DISPLACEMENT";
 
    Noise::ShaderParams terrainNoise;
@@ -152,10 +188,12 @@ void VKSandbox::preLoop()
    terrainNoise.octaves    = 5;
 
    const EntityHandle terrain = m_ecs->createEntity( "Terrain" );
-   m_ecs->assign<RenderableComponent>( terrain, RenderableComponent::Type::DEFERRED, true, true );
+   m_ecs->assign<RenderableComponent>(
+       terrain, RenderableComponent::Type::DEFERRED, true, true, true, true );
    m_ecs->assign<TransformComponent>( terrain, glm::vec3( 0.0f, 0.0f, 0.0f ), glm::vec3( 50.0f ) );
-   m_ecs->assign<MeshComponent>( terrain, "GRID" );
-   m_ecs->assign<TessellatedComponent>( terrain, 0.04f, 0.85f );
+   m_ecs->assign<MeshComponent>( terrain, "TERRAIN_PATCH" );
+   m_ecs->assign<TerrainComponent>(
+       terrain, TERRAIN_SIZE, TERRAIN_HEIGHT_SCALE, TERRAIN_LODS, TERRAIN_LOD_DISTANCE );
    m_ecs->assign<MaterialComponent>( terrain, terrainMaterialDesc );
    m_ecs->assign<ProceduralDisplacementComponent>(
        terrain, Noise::Type::SIMPLEX_NOISE, 2048, 2048, terrainNoise );
@@ -119,6 +119,45 @@ project "VKSandbox"
 
 		buildoutputs { "%{cfg.targetdir}/%{file.basename}.png" }
 
+project "MeshConverter"
+	location "Build/MeshConverter"
+	language "C++"
+	cppdialect "C++20"
+	kind "ConsoleApp"
+	architecture "x86_64"
+
+	includedirs { "MeshConverter", "Engine", "Emporium", "include" }
+	links { "Engine" }
+
+	files { "MeshConverter/**.h",
+			"MeshConverter/**.cpp" }
+
+project "AssetPacker"
+	location "Build/AssetPacker"
+	language "C++"
+	cppdialect "C++20"
+	kind "ConsoleApp"
+	architecture "x86_64"
+
+	includedirs { "AssetPacker", "Emporium" }
+	links { "Emporium" }
+
+	files { "AssetPacker/**.h",
+			"AssetPacker/**.cpp" }
+
+project "EngineTests"
+	location "Build/EngineTests"
+	language "C++"
+	cppdialect "C++20"
+	kind "ConsoleApp"
+	architecture "x86_64"
+
+	includedirs { "EngineTests", "Engine", "Emporium", "include" }
+	links { "Engine" }
+
+	files { "EngineTests/**.h",
+			"EngineTests/**.cpp" }
+
 workspace "CydoniaShaders"
 	location "build"
 	configurations { "Release" }